@@ -7,7 +7,6 @@ layout(location = 0) in VS_OUT {
     vec2 uv;
     vec3 eye_position;
     vec3 frag_position;
-    vec4 frag_position_light_space;
 } fs_in;
 
 layout(std140, binding = 1) uniform LightData {
@@ -20,61 +19,23 @@ layout(std140, binding = 1) uniform LightData {
     float light_quadratic;
 };
 
-struct Material {
-    vec3 ambient;
-    vec3 diffuse;
-    vec3 specular;
-    float shininess;
-    float alpha;
-    sampler2D diffuse_texture;
-    sampler2D specular_texture;
-};
-uniform Material material;
+#include <material_data.glsl>
 
-uniform sampler2D shadow_map;
+uniform uint material_index;
 
-#include <blinn_phong_lighting.glsl>
+layout(binding = 0) uniform sampler2D diffuse_texture;
+layout(binding = 1) uniform sampler2D specular_texture;
 
-float calculateShadowFactor(vec4 frag_pos_light_space)
-{
-    vec3 projected_coords = frag_pos_light_space.xyz / frag_pos_light_space.w;
-    projected_coords = projected_coords * 0.5 + 0.5;
-    float closest_depth = texture(shadow_map, projected_coords.xy).r;
-    float current_depth = projected_coords.z;
-
-    // vec3 normal = normalize(fs_in.normal);
-    // vec3 light_dir = normalize(light_position - fs_in.eye_position);
-    // float bias = max(0.05 * (1.0 - dot(normal, light_dir)), 0.005);
-    // float shadow = (current_depth - bias) > closest_depth ? 1.0 : 0.0;
-
-    // float shadow = current_depth > closest_depth ? 1.0 : 0.0;
-
-    // float bias = 0.005;
-    float bias = 0.00001;
-    float shadow = 0.0;
-    vec2 texel_size = 1.0 / textureSize(shadow_map, 0);
-    for(int x = -1; x <= 1; ++x)
-    {
-        for(int y = -1; y <= 1; ++y)
-        {
-            float pcf_depth = texture(shadow_map, projected_coords.xy + vec2(x, y) * texel_size).r;
-            shadow += current_depth - bias > pcf_depth  ? 1.0 : 0.0;
-        }
-    }
-    shadow /= 9.0;
-
-    if(projected_coords.z > 1.0)
-    {
-        shadow = 0.0;
-    }
-
-    return shadow;
-}
+layout(binding = 2) uniform sampler2D shadow_map;
+
+#include <blinn_phong_lighting.glsl>
+#include <shadow_cascades.glsl>
 
 void main() {
+    MaterialData material = materials[material_index];
 
-    vec3 Kd = texture(material.diffuse_texture, fs_in.uv).rgb;
-    vec3 Ks = texture(material.specular_texture, fs_in.uv).rgb;
+    vec3 Kd = texture(diffuse_texture, fs_in.uv).rgb;
+    vec3 Ks = texture(specular_texture, fs_in.uv).rgb;
 
     // vec3 ambient_color = light_ambient * material.ambient * Kd;
     vec3 ambient_color = light_ambient * 0.1 * Kd;
@@ -82,14 +43,14 @@ void main() {
     vec3 to_light = normalize(light_position - fs_in.frag_position);
     vec3 normal = normalize(fs_in.normal);
 
-    vec3 diffuse_color = light_diffuse * calculateDiffuseComponent(to_light, normal, material.diffuse * Kd);
+    vec3 diffuse_color = light_diffuse * calculateDiffuseComponent(to_light, normal, material.diffuse.rgb * Kd);
 
     vec3 view_direction = normalize(fs_in.eye_position - fs_in.frag_position);
-    vec3 specular_color = light_specular * calculateSpecularComponent(view_direction, to_light, normal, material.specular * Ks, material.shininess);
+    vec3 specular_color = light_specular * calculateSpecularComponent(view_direction, to_light, normal, material.specular_shininess.rgb * Ks, material.specular_shininess.w);
 
     float attenuation = calculateAttenuation(light_constant, light_linear, light_quadratic, length(light_position - fs_in.frag_position));
 
-    float shadow = calculateShadowFactor(fs_in.frag_position_light_space);
+    float shadow = calculateCascadedShadowFactor(shadow_map, fs_in.frag_position, normal);
 
     vec4 light_intensity = vec4(ambient_color + (1.0 - shadow) * (diffuse_color + specular_color), 1.0) / attenuation;
 
@@ -10,13 +10,7 @@ layout(std140, binding = 0) uniform PerFrameData {
     vec3 camera_position;
 };
 
-layout(std140, binding = 2) uniform ShadowPassBuffer
-{
-    uniform mat4 light_projection;
-    uniform mat4 light_view;
-   // uniform vec3 light_position;
-    //uniform vec3 light_direction;
-};
+#include <vertex_decode.glsl>
 
 uniform mat4 model;
 uniform mat4 normal_matrix;
@@ -26,14 +20,13 @@ layout(location = 0) out VS_OUT {
     vec2 uv;
     vec3 eye_position;
     vec3 frag_position;
-    vec4 frag_position_light_space;
 } vs_out;
 
 void main() {
-    vs_out.normal = vec3(normal_matrix * vec4(normal, 1.0));
+    vec3 object_position = decodePosition(position);
+    vs_out.normal = vec3(normal_matrix * vec4(decodeNormal(normal), 1.0));
     vs_out.uv = uv;
     vs_out.eye_position = camera_position;
-    vs_out.frag_position = vec3(model * vec4(position, 1.0));
-    vs_out.frag_position_light_space = light_projection * light_view * vec4(vs_out.frag_position, 1.0);
-    gl_Position = projection * view * model * vec4(position, 1.0);
+    vs_out.frag_position = vec3(model * vec4(object_position, 1.0));
+    gl_Position = projection * view * model * vec4(object_position, 1.0);
 }
@@ -0,0 +1,58 @@
+#version 460 core
+
+layout(location = 0) out vec4 frag_color;
+
+layout(location = 0) in VS_OUT {
+    vec3 normal;
+    vec2 uv;
+    vec3 eye_position;
+    vec3 frag_position;
+} fs_in;
+
+layout(location = 4) flat in uint material_index;
+
+layout(std140, binding = 1) uniform LightData {
+    vec3 light_position;
+    vec3 light_ambient;
+    vec3 light_diffuse;
+    vec3 light_specular;
+    float light_constant;
+    float light_linear;
+    float light_quadratic;
+};
+
+#include <material_data.glsl>
+
+layout(binding = 0) uniform sampler2D diffuse_texture;
+layout(binding = 1) uniform sampler2D specular_texture;
+
+layout(binding = 2) uniform sampler2D shadow_map;
+
+#include <blinn_phong_lighting.glsl>
+#include <shadow_cascades.glsl>
+
+void main() {
+    MaterialData material = materials[material_index];
+
+    vec3 Kd = texture(diffuse_texture, fs_in.uv).rgb;
+    vec3 Ks = texture(specular_texture, fs_in.uv).rgb;
+
+    // vec3 ambient_color = light_ambient * material.ambient * Kd;
+    vec3 ambient_color = light_ambient * 0.1 * Kd;
+
+    vec3 to_light = normalize(light_position - fs_in.frag_position);
+    vec3 normal = normalize(fs_in.normal);
+
+    vec3 diffuse_color = light_diffuse * calculateDiffuseComponent(to_light, normal, material.diffuse.rgb * Kd);
+
+    vec3 view_direction = normalize(fs_in.eye_position - fs_in.frag_position);
+    vec3 specular_color = light_specular * calculateSpecularComponent(view_direction, to_light, normal, material.specular_shininess.rgb * Ks, material.specular_shininess.w);
+
+    float attenuation = calculateAttenuation(light_constant, light_linear, light_quadratic, length(light_position - fs_in.frag_position));
+
+    float shadow = calculateCascadedShadowFactor(shadow_map, fs_in.frag_position, normal);
+
+    vec4 light_intensity = vec4(ambient_color + (1.0 - shadow) * (diffuse_color + specular_color), 1.0) / attenuation;
+
+    frag_color = light_intensity;
+}
\ No newline at end of file
@@ -0,0 +1,32 @@
+#version 460 core
+
+layout(location = 0) in vec3 position;
+layout(location = 1) in vec3 normal;
+layout(location = 2) in vec2 uv;
+
+layout(std140, binding = 0) uniform PerFrameData {
+    uniform mat4 projection;
+    uniform mat4 view;
+    vec3 camera_position;
+};
+
+#include <static_draw_data.glsl>
+
+layout(location = 0) out VS_OUT {
+    vec3 normal;
+    vec2 uv;
+    vec3 eye_position;
+    vec3 frag_position;
+} vs_out;
+
+layout(location = 4) flat out uint material_index;
+
+void main() {
+    StaticDraw draw = static_draws[gl_BaseInstance];
+    vs_out.normal = vec3(draw.normal_matrix * vec4(normal, 1.0));
+    vs_out.uv = uv;
+    vs_out.eye_position = camera_position;
+    vs_out.frag_position = vec3(draw.model * vec4(position, 1.0));
+    material_index = draw.material_index;
+    gl_Position = projection * view * draw.model * vec4(position, 1.0);
+}
@@ -9,6 +9,8 @@ layout(location = 0) in VS_OUT {
     vec3 frag_position;
 } fs_in;
 
+layout(location = 4) flat in vec4 instance_color;
+
 layout(std140, binding = 1) uniform LightData {
     vec3 light_position;
     vec3 light_ambient;
@@ -19,23 +21,20 @@ layout(std140, binding = 1) uniform LightData {
     float light_quadratic;
 };
 
-struct Material {
-    vec3 ambient;
-    vec3 diffuse;
-    vec3 specular;
-    float shininess;
-    float alpha;
-    sampler2D diffuse_texture;
-    sampler2D specular_texture;
-};
-uniform Material material;
+#include <material_data.glsl>
+
+uniform uint material_index;
+
+layout(binding = 0) uniform sampler2D diffuse_texture;
+layout(binding = 1) uniform sampler2D specular_texture;
 
 #include <blinn_phong_lighting.glsl>
 
 void main() {
+    MaterialData material = materials[material_index];
 
-    vec3 Kd = texture(material.diffuse_texture, fs_in.uv).rgb;
-    vec3 Ks = texture(material.specular_texture, fs_in.uv).rgb;
+    vec3 Kd = texture(diffuse_texture, fs_in.uv).rgb;
+    vec3 Ks = texture(specular_texture, fs_in.uv).rgb;
 
     // vec3 ambient_color = light_ambient * material.ambient * Kd;
     vec3 ambient_color = light_ambient * 0.1 * Kd;
@@ -43,10 +42,10 @@ void main() {
     vec3 to_light = normalize(light_position - fs_in.frag_position);
     vec3 normal = normalize(fs_in.normal);
 
-    vec3 diffuse_color = light_diffuse * calculateDiffuseComponent(to_light, normal, material.diffuse * Kd);
+    vec3 diffuse_color = light_diffuse * calculateDiffuseComponent(to_light, normal, material.diffuse.rgb * instance_color.rgb * Kd);
 
     vec3 view_direction = normalize(fs_in.eye_position - fs_in.frag_position);
-    vec3 specular_color = light_specular * calculateSpecularComponent(view_direction, to_light, normal, material.specular * Ks, material.shininess);
+    vec3 specular_color = light_specular * calculateSpecularComponent(view_direction, to_light, normal, material.specular_shininess.rgb * Ks, material.specular_shininess.w);
 
     float attenuation = calculateAttenuation(light_constant, light_linear, light_quadratic, length(light_position - fs_in.frag_position));
 
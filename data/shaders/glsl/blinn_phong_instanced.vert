@@ -3,8 +3,6 @@
 layout(location = 0) in vec3 position;
 layout(location = 1) in vec3 normal;
 layout(location = 2) in vec2 uv;
-layout(location = 3) in mat4 model;
-layout(location = 7) in mat4 normal_matrix;
 
 layout(std140, binding = 0) uniform PerFrameData {
     uniform mat4 projection;
@@ -12,8 +10,10 @@ layout(std140, binding = 0) uniform PerFrameData {
     vec3 camera_position;
 };
 
-//uniform mat4 model;
-//uniform mat4 normal_matrix;
+#include <instance_data.glsl>
+#include <vertex_decode.glsl>
+
+uniform uint instance_offset;
 
 layout(location = 0) out VS_OUT {
     vec3 normal;
@@ -22,10 +22,15 @@ layout(location = 0) out VS_OUT {
     vec3 frag_position;
 } vs_out;
 
+layout(location = 4) flat out vec4 instance_color;
+
 void main() {
-    vs_out.normal = vec3(normal_matrix * vec4(normal, 1.0));
+    InstanceData instance = instances[instance_offset + gl_InstanceID];
+    vec3 object_position = decodePosition(position);
+    vs_out.normal = vec3(instance.normal_matrix * vec4(decodeNormal(normal), 1.0));
     vs_out.uv = uv;
     vs_out.eye_position = camera_position;
-    vs_out.frag_position = vec3(model * vec4(position, 1.0));
-    gl_Position = projection * view * model * vec4(position, 1.0);
+    vs_out.frag_position = vec3(instance.model * vec4(object_position, 1.0));
+    instance_color = instance.color;
+    gl_Position = projection * view * instance.model * vec4(object_position, 1.0);
 }
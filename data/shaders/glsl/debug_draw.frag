@@ -1,10 +1,10 @@
 #version 460 core
 
-uniform vec3 color;
+layout(location = 0) in vec4 color;
 
 layout(location = 0) out vec4 frag_color;
 
 void main()
 {
-    frag_color = vec4(color, 1.0);
-}
\ No newline at end of file
+    frag_color = color;
+}
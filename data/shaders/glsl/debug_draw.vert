@@ -1,13 +1,17 @@
 #version 460 core
 
-struct DebugData
+// Every instance is a line segment (points have start == end) expanded into a screen space quad of the given width, so
+// lines and points of any width and color go through a single instanced draw.
+struct DebugPrimitive
 {
-    vec4 position;
+    vec4 start_width; // xyz: start, w: width in pixels
+    vec4 end;
+    vec4 color;
 };
 
-layout(std430, binding = 0) restrict readonly buffer DebugDataBuffer
+layout(std430, binding = 6) restrict readonly buffer DebugPrimitiveBuffer
 {
-    DebugData positions[];
+    DebugPrimitive primitives[];
 };
 
 layout(std140, binding = 0) uniform PerFrameData {
@@ -16,9 +20,50 @@ layout(std140, binding = 0) uniform PerFrameData {
     vec3 camera_position;
 };
 
-uniform mat4 model;
+uniform vec2 viewport_size;
+
+layout(location = 0) out vec4 color;
+
+// (end of the segment, side of the segment) of the two triangles of the quad
+const vec2 kCorners[6] = vec2[](vec2(0.0, -1.0), vec2(1.0, -1.0), vec2(1.0, 1.0),
+                                vec2(0.0, -1.0), vec2(1.0, 1.0), vec2(0.0, 1.0));
 
 void main()
 {
-    gl_Position = projection * view * model * vec4(positions[gl_VertexID].position);
-}
\ No newline at end of file
+    DebugPrimitive primitive = primitives[gl_InstanceID];
+    vec2 corner = kCorners[gl_VertexID];
+
+    vec4 a = projection * view * vec4(primitive.start_width.xyz, 1.0);
+    vec4 b = projection * view * vec4(primitive.end.xyz, 1.0);
+
+    // clip the segment against the near plane, the screen space direction is meaningless behind the camera
+    const float kNear = 1e-4;
+    if(a.w < kNear && b.w < kNear)
+    {
+        gl_Position = vec4(0.0, 0.0, 2.0, 1.0); // outside of the clip volume
+        color = vec4(0.0);
+        return;
+    }
+    else if(a.w < kNear && b.w >= kNear)
+    {
+        a = mix(a, b, (kNear - a.w) / (b.w - a.w));
+    }
+    else if(b.w < kNear && a.w >= kNear)
+    {
+        b = mix(b, a, (kNear - b.w) / (a.w - b.w));
+    }
+
+    vec2 half_viewport = 0.5 * viewport_size;
+    vec2 direction = b.xy / b.w * half_viewport - a.xy / a.w * half_viewport;
+    direction = length(direction) > 1e-4 ? normalize(direction) : vec2(1.0, 0.0);
+    vec2 normal = vec2(-direction.y, direction.x);
+
+    // square caps: the quad extends half the width past both ends, which turns a point into a square
+    vec2 offset = (normal * corner.y + direction * (2.0 * corner.x - 1.0)) * 0.5 * primitive.start_width.w;
+
+    vec4 position = corner.x == 0.0 ? a : b;
+    position.xy += offset / half_viewport * position.w;
+
+    gl_Position = position;
+    color = primitive.color;
+}
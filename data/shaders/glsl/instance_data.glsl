@@ -0,0 +1,14 @@
+// Per instance data of the instanced draws. A draw reads its instances from instances[instance_offset] on, one per
+// gl_InstanceID.
+
+struct InstanceData
+{
+    mat4 model;
+    mat4 normal_matrix;
+    vec4 color;
+};
+
+layout(std430, binding = 7) restrict readonly buffer InstanceDataBuffer
+{
+    InstanceData instances[];
+};
@@ -0,0 +1,12 @@
+// Material parameters of the frame, one entry per distinct material. Draws index it with their material slot.
+
+struct MaterialData
+{
+    vec4 diffuse;
+    vec4 specular_shininess; // xyz: specular, w: shininess
+};
+
+layout(std430, binding = 4) restrict readonly buffer MaterialDataBuffer
+{
+    MaterialData materials[];
+};
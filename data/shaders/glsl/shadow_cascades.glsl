@@ -0,0 +1,67 @@
+// Cascaded shadow maps of the directional shadow casting light.
+// The cascades are stored as tiles of a single depth atlas, cascade i lives in tile (i % 2, i / 2).
+
+#define SHADOW_CASCADE_COUNT 4
+
+layout(std140, binding = 2) uniform ShadowPassBuffer
+{
+    mat4 light_view_projections[SHADOW_CASCADE_COUNT];
+    vec4 cascade_splits;    // view space depth where every cascade ends
+    vec4 camera_depth_axis; // dot(camera_depth_axis, vec4(world_position, 1.0)) is the view space depth
+    vec4 light_direction;   // direction the light travels in, world space
+};
+
+vec2 getShadowCascadeTileOffset(int cascade)
+{
+    return vec2(cascade % 2, cascade / 2) * 0.5;
+}
+
+int selectShadowCascade(vec3 world_position)
+{
+    float depth = dot(camera_depth_axis, vec4(world_position, 1.0));
+    for(int i = 0; i < SHADOW_CASCADE_COUNT; ++i)
+    {
+        if(depth < cascade_splits[i])
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+float calculateCascadedShadowFactor(sampler2D shadow_atlas, vec3 world_position, vec3 normal)
+{
+    int cascade = selectShadowCascade(world_position);
+    if(cascade < 0)
+    {
+        return 0.0;
+    }
+
+    vec4 light_space_position = light_view_projections[cascade] * vec4(world_position, 1.0);
+    vec3 projected_coords = light_space_position.xyz / light_space_position.w;
+    projected_coords = projected_coords * 0.5 + 0.5;
+    if(projected_coords.z > 1.0)
+    {
+        return 0.0;
+    }
+
+    // keep the pcf kernel inside the tile of the cascade
+    vec2 texel_size = 1.0 / textureSize(shadow_atlas, 0);
+    vec2 tile_min = getShadowCascadeTileOffset(cascade) + texel_size;
+    vec2 tile_max = getShadowCascadeTileOffset(cascade) + 0.5 - texel_size;
+    vec2 atlas_coords = getShadowCascadeTileOffset(cascade) + projected_coords.xy * 0.5;
+
+    float current_depth = projected_coords.z;
+    float bias = max(0.0005 * (1.0 - dot(normal, -light_direction.xyz)), 0.00005);
+    float shadow = 0.0;
+    for(int x = -1; x <= 1; ++x)
+    {
+        for(int y = -1; y <= 1; ++y)
+        {
+            vec2 sample_coords = clamp(atlas_coords + vec2(x, y) * texel_size, tile_min, tile_max);
+            float pcf_depth = texture(shadow_atlas, sample_coords).r;
+            shadow += current_depth - bias > pcf_depth ? 1.0 : 0.0;
+        }
+    }
+    return shadow / 9.0;
+}
@@ -6,18 +6,13 @@ layout(location = 0) in vec3 position;
 layout(location = 1) in vec3 normal;
 layout(location = 2) in vec3 uv;
 
-layout(std140, binding = 2) uniform ShadowPassBuffer
-{
-    uniform mat4 light_projection;
-    uniform mat4 light_view;
-    // uniform vec3 light_position;
-    // uniform vec3 light_direction;
-};
+#include <shadow_cascades.glsl>
+#include <vertex_decode.glsl>
 
 uniform mat4 model;
+uniform int cascade_index;
 
 void main()
 {
-    gl_Position = light_projection * light_view * model * vec4(position, 1.0);
-    // gl_Position = light_projection * light_view * vec4(position, 1.0);
+    gl_Position = light_view_projections[cascade_index] * model * vec4(decodePosition(position), 1.0);
 }
\ No newline at end of file
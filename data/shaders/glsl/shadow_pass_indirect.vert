@@ -0,0 +1,15 @@
+// Shadow pass vertex shader for the static geometry
+
+#version 460 core
+
+layout(location = 0) in vec3 position;
+
+#include <shadow_cascades.glsl>
+#include <static_draw_data.glsl>
+
+uniform int cascade_index;
+
+void main()
+{
+    gl_Position = light_view_projections[cascade_index] * static_draws[gl_BaseInstance].model * vec4(position, 1.0);
+}
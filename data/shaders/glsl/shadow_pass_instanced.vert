@@ -0,0 +1,18 @@
+// Shadow pass vertex shader for the instanced draws
+
+#version 460 core
+
+layout(location = 0) in vec3 position;
+
+#include <shadow_cascades.glsl>
+#include <instance_data.glsl>
+#include <vertex_decode.glsl>
+
+uniform uint instance_offset;
+uniform int cascade_index;
+
+void main()
+{
+    gl_Position = light_view_projections[cascade_index] * instances[instance_offset + gl_InstanceID].model *
+                  vec4(decodePosition(position), 1.0);
+}
@@ -14,13 +14,7 @@ layout(std430, binding = 0) restrict readonly buffer VertexBuffer
     VertexData vertices[];
 };
 
-layout(std140, binding = 2) uniform ShadowPassBuffer
-{
-    uniform mat4 light_projection;
-    uniform mat4 light_view;
-   // uniform vec3 light_position;
-    //uniform vec3 light_direction;
-};
+#include <shadow_cascades.glsl>
 
 vec3 getPosition(int vertex_index)
 {
@@ -28,10 +22,10 @@ vec3 getPosition(int vertex_index)
 }
 
 uniform mat4 model;
+uniform int cascade_index;
 
 void main()
 {
     vec3 position = getPosition(gl_VertexID);
-    gl_Position = light_projection * light_view * model * vec4(position, 1.0);
-    // gl_Position = light_projection * light_view * vec4(position, 1.0);
+    gl_Position = light_view_projections[cascade_index] * model * vec4(position, 1.0);
 }
\ No newline at end of file
@@ -6,6 +6,8 @@ layout(location = 2) in vec2 uv;
 layout(location = 3) in vec4 weights;
 layout(location = 4) in ivec4 joints;
 
+#include <vertex_decode.glsl>
+
 // uniform mat4 view;
 // uniform mat4 projection;
 uniform mat4 model;
@@ -17,7 +19,12 @@ layout(std140, binding = 0) uniform PerFrameData {
     vec3 camera_position;
 };
 
-uniform mat4 skin_transforms[120];
+// skinning palettes of all the skinned draws of the frame, skin_offset is the first joint of this draw
+layout(std430, binding = 5) restrict readonly buffer SkinTransformBuffer
+{
+    mat4 skin_transforms[];
+};
+uniform uint skin_offset;
 
 layout (location = 0) out VS_OUT
 {
@@ -25,22 +32,23 @@ layout (location = 0) out VS_OUT
     vec2 uv;
     vec3 eye_position;
     vec3 frag_position;
-    vec4 frag_position_light_space;
 } vs_out;
 
 void main()
 {
-    mat4 skin = skin_transforms[joints.x] * weights.x;
-    skin += skin_transforms[joints.y] * weights.y;
-    skin += skin_transforms[joints.z] * weights.z;
-    skin += skin_transforms[joints.w] * weights.w;
+    mat4 skin = skin_transforms[skin_offset + uint(joints.x)] * weights.x;
+    skin += skin_transforms[skin_offset + uint(joints.y)] * weights.y;
+    skin += skin_transforms[skin_offset + uint(joints.z)] * weights.z;
+    skin += skin_transforms[skin_offset + uint(joints.w)] * weights.w;
+
+    vec3 object_position = decodePosition(position);
 
     // mat4 normal_matrix = transpose(inverse(model));
-    vs_out.normal = mat3(skin * normal_matrix) * normal;
+    vs_out.normal = mat3(skin * normal_matrix) * decodeNormal(normal);
     // vs_out.normal = mat3(normal_matrix) * normal;
     vs_out.uv = uv;
     vs_out.eye_position = camera_position;
-    vs_out.frag_position = vec3(model * skin * vec4(position, 1.0));
-    gl_Position = projection * view * model * skin * vec4(position, 1.0);
+    vs_out.frag_position = vec3(model * skin * vec4(object_position, 1.0));
+    gl_Position = projection * view * model * skin * vec4(object_position, 1.0);
     // gl_Position = projection * view * model * vec4(position, 1.0);
 }
\ No newline at end of file
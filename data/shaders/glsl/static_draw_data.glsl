@@ -0,0 +1,13 @@
+// Per draw data of the static geometry, indexed by the base instance of the indirect draw command.
+
+struct StaticDraw
+{
+    mat4 model;
+    mat4 normal_matrix;
+    uint material_index;
+};
+
+layout(std430, binding = 3) restrict readonly buffer StaticDrawBuffer
+{
+    StaticDraw static_draws[];
+};
@@ -0,0 +1,27 @@
+// Decode of the vertex streams, set per draw by the renderer (see VertexDecode in gl_vertex_array.h). Packed positions
+// arrive as unorm16 in the bounds of the mesh and packed normals as octahedral snorm16 pairs in normal.xy, the weights,
+// uvs and joint indices are converted by the vertex fetch. Full precision streams use scale 1, offset 0.
+
+uniform vec3 position_scale;
+uniform vec3 position_offset;
+uniform bool octahedral_normals;
+
+vec3 decodePosition(vec3 position)
+{
+    return position_offset + position_scale * position;
+}
+
+vec3 decodeNormal(vec3 normal)
+{
+    if(!octahedral_normals)
+    {
+        return normal;
+    }
+
+    // unfold the lower half of the octahedron
+    vec3  n = vec3(normal.xy, 1.0 - abs(normal.x) - abs(normal.y));
+    float t = max(-n.z, 0.0);
+    n.x += n.x >= 0.0 ? -t : t;
+    n.y += n.y >= 0.0 ? -t : t;
+    return normalize(n);
+}
@@ -0,0 +1,287 @@
+#include "cloth_cpu_solver.h"
+
+#include <algorithm>
+#include <cmath>
+#include <execution>
+#include <ranges>
+
+namespace sputnik::demos
+{
+
+namespace
+{
+
+// The kernels take their arrays as __restrict parameters, compilers only rely on the qualifier for function
+// parameters. The arrays of a kernel never overlap, so the loops vectorize across columns without alias checks. GCC and
+// Clang only vectorize the square root of the spring loop with -fno-math-errno.
+
+void accumulateSpringForces(const float* __restrict position_x,
+                            const float* __restrict position_y,
+                            const float* __restrict position_z,
+                            float* __restrict       force_x,
+                            float* __restrict       force_y,
+                            float* __restrict       force_z,
+                            const ptrdiff_t&        neighbour_offset,
+                            const unsigned&         begin,
+                            const unsigned&         end,
+                            const float&            rest_length,
+                            const float&            stiffness)
+{
+    for(unsigned col = begin; col < end; ++col)
+    {
+        // distance between the current particle and its neighbour
+        const float r_x    = position_x[col + neighbour_offset] - position_x[col];
+        const float r_y    = position_y[col + neighbour_offset] - position_y[col];
+        const float r_z    = position_z[col + neighbour_offset] - position_z[col];
+        const float length = std::sqrt(r_x * r_x + r_y * r_y + r_z * r_z);
+
+        // force = spring-constant * (distance_from_neighbor - spring's rest_length) * normalize(distance_from_neighbor)
+        const float scale = stiffness * (length - rest_length) / length;
+        force_x[col] += r_x * scale;
+        force_y[col] += r_y * scale;
+        force_z[col] += r_z * scale;
+    }
+}
+
+void integrateParticles(const float* __restrict force_x,
+                        const float* __restrict force_y,
+                        const float* __restrict force_z,
+                        const float* __restrict in_position_x,
+                        const float* __restrict in_position_y,
+                        const float* __restrict in_position_z,
+                        const float* __restrict in_velocity_x,
+                        const float* __restrict in_velocity_y,
+                        const float* __restrict in_velocity_z,
+                        float* __restrict       out_position_x,
+                        float* __restrict       out_position_y,
+                        float* __restrict       out_position_z,
+                        float* __restrict       out_velocity_x,
+                        float* __restrict       out_velocity_y,
+                        float* __restrict       out_velocity_z,
+                        const unsigned&         count,
+                        const float&            damping,
+                        const float&            inv_mass,
+                        const float&            dt)
+{
+    const float half_dt2 = 0.5f * dt * dt;
+    for(unsigned i = 0; i < count; ++i)
+    {
+        const float acceleration_x = (force_x[i] - damping * in_velocity_x[i]) * inv_mass;
+        const float acceleration_y = (force_y[i] - damping * in_velocity_y[i]) * inv_mass;
+        const float acceleration_z = (force_z[i] - damping * in_velocity_z[i]) * inv_mass;
+
+        out_position_x[i] = in_position_x[i] + in_velocity_x[i] * dt + acceleration_x * half_dt2;
+        out_position_y[i] = in_position_y[i] + in_velocity_y[i] * dt + acceleration_y * half_dt2;
+        out_position_z[i] = in_position_z[i] + in_velocity_z[i] * dt + acceleration_z * half_dt2;
+        out_velocity_x[i] = in_velocity_x[i] + acceleration_x * dt;
+        out_velocity_y[i] = in_velocity_y[i] + acceleration_y * dt;
+        out_velocity_z[i] = in_velocity_z[i] + acceleration_z * dt;
+    }
+}
+
+} // namespace
+
+void ClothCpuSolver::ClothState::resize(const size_t& count)
+{
+    position_x.resize(count);
+    position_y.resize(count);
+    position_z.resize(count);
+    velocity_x.resize(count);
+    velocity_y.resize(count);
+    velocity_z.resize(count);
+}
+
+void ClothCpuSolver::initialize(const uvec2&             num_particles,
+                                const std::vector<vec4>& positions,
+                                const std::vector<vec4>& velocities)
+{
+    m_num_particles = num_particles;
+
+    const size_t count = size_t(num_particles.x) * num_particles.y;
+    m_states[0].resize(count);
+    m_states[1].resize(count);
+    m_force_x.resize(count);
+    m_force_y.resize(count);
+    m_force_z.resize(count);
+
+    setState(positions, velocities);
+}
+
+void ClothCpuSolver::setParameters(const ClothSimulationParameters& parameters)
+{
+    m_parameters = parameters;
+}
+
+const ClothSimulationParameters& ClothCpuSolver::getParameters() const
+{
+    return m_parameters;
+}
+
+void ClothCpuSolver::step(const unsigned& iterations)
+{
+    std::ranges::iota_view rows(0u, m_num_particles.y);
+    for(unsigned i = 0; i < iterations; ++i)
+    {
+        std::for_each(std::execution::par,
+                      rows.begin(),
+                      rows.end(),
+                      [this](const unsigned& row) { integrateRow(row); });
+
+        // swap the read and write buffers
+        m_read_state_index = 1 - m_read_state_index;
+    }
+}
+
+void ClothCpuSolver::setState(const std::vector<vec4>& positions, const std::vector<vec4>& velocities)
+{
+    ClothState& state = m_states[m_read_state_index];
+    for(size_t i = 0; i < state.position_x.size(); ++i)
+    {
+        state.position_x[i] = positions[i].x;
+        state.position_y[i] = positions[i].y;
+        state.position_z[i] = positions[i].z;
+        state.velocity_x[i] = velocities[i].x;
+        state.velocity_y[i] = velocities[i].y;
+        state.velocity_z[i] = velocities[i].z;
+    }
+}
+
+void ClothCpuSolver::getState(std::vector<vec4>& positions_out, std::vector<vec4>& velocities_out) const
+{
+    getPositions(positions_out);
+
+    const ClothState& state = m_states[m_read_state_index];
+    velocities_out.resize(state.velocity_x.size());
+    for(size_t i = 0; i < state.velocity_x.size(); ++i)
+    {
+        velocities_out[i] = {state.velocity_x[i], state.velocity_y[i], state.velocity_z[i], 0.0f};
+    }
+}
+
+void ClothCpuSolver::getPositions(std::vector<vec4>& positions_out) const
+{
+    const ClothState& state = m_states[m_read_state_index];
+    positions_out.resize(state.position_x.size());
+    for(size_t i = 0; i < state.position_x.size(); ++i)
+    {
+        positions_out[i] = {state.position_x[i], state.position_y[i], state.position_z[i], 1.0f};
+    }
+}
+
+void ClothCpuSolver::integrateRow(const unsigned& row)
+{
+    const unsigned  cols      = m_num_particles.x;
+    const unsigned  rows      = m_num_particles.y;
+    const size_t    row_start = size_t(row) * cols;
+    const ptrdiff_t stride    = ptrdiff_t(cols);
+
+    const ClothState& in  = m_states[m_read_state_index];
+    ClothState&       out = m_states[1 - m_read_state_index];
+
+    float* force_x = m_force_x.data() + row_start;
+    float* force_y = m_force_y.data() + row_start;
+    float* force_z = m_force_z.data() + row_start;
+
+    // initialize force accumulation with gravitational force
+    const vec3 weight = m_parameters.gravity * m_parameters.particle_mass;
+    std::fill_n(force_x, cols, weight.x);
+    std::fill_n(force_y, cols, weight.y);
+    std::fill_n(force_z, cols, weight.z);
+
+    // The springs are accumulated in the order of the compute shader: above, below, left, right, upper left, upper
+    // right, lower left and lower right. Whether the row above/below exists is uniform across the row, the missing
+    // left/right neighbours only shrink the column range.
+    const bool  has_row_above = row < rows - 1;
+    const bool  has_row_below = row > 0;
+    const auto& rest_h        = m_parameters.rest_length_horizontal;
+    const auto& rest_v        = m_parameters.rest_length_vertical;
+    const auto& rest_d        = m_parameters.rest_length_diagonal;
+    if(has_row_above)
+    {
+        accumulateSprings(row_start, stride, 0, cols, rest_v);
+    }
+    if(has_row_below)
+    {
+        accumulateSprings(row_start, -stride, 0, cols, rest_v);
+    }
+    accumulateSprings(row_start, -1, 1, cols, rest_h);
+    accumulateSprings(row_start, 1, 0, cols - 1, rest_h);
+    if(has_row_above)
+    {
+        accumulateSprings(row_start, stride - 1, 1, cols, rest_d);
+        accumulateSprings(row_start, stride + 1, 0, cols - 1, rest_d);
+    }
+    if(has_row_below)
+    {
+        accumulateSprings(row_start, -stride - 1, 1, cols, rest_d);
+        accumulateSprings(row_start, -stride + 1, 0, cols - 1, rest_d);
+    }
+
+    // apply damping and integrate using Newton-Euler integration
+    integrateParticles(force_x,
+                       force_y,
+                       force_z,
+                       in.position_x.data() + row_start,
+                       in.position_y.data() + row_start,
+                       in.position_z.data() + row_start,
+                       in.velocity_x.data() + row_start,
+                       in.velocity_y.data() + row_start,
+                       in.velocity_z.data() + row_start,
+                       out.position_x.data() + row_start,
+                       out.position_y.data() + row_start,
+                       out.position_z.data() + row_start,
+                       out.velocity_x.data() + row_start,
+                       out.velocity_y.data() + row_start,
+                       out.velocity_z.data() + row_start,
+                       cols,
+                       m_parameters.damping,
+                       1.0f / m_parameters.particle_mass,
+                       m_parameters.delta_t);
+
+    // pin a few of the particles in the top row
+    if(row == rows - 1)
+    {
+        for(unsigned col = 0; col < cols; ++col)
+        {
+            if(isPinned(row, col))
+            {
+                const size_t i    = row_start + col;
+                out.position_x[i] = in.position_x[i];
+                out.position_y[i] = in.position_y[i];
+                out.position_z[i] = in.position_z[i];
+                out.velocity_x[i] = 0.0f;
+                out.velocity_y[i] = 0.0f;
+                out.velocity_z[i] = 0.0f;
+            }
+        }
+    }
+}
+
+void ClothCpuSolver::accumulateSprings(const size_t&    row_start,
+                                       const ptrdiff_t& neighbour_offset,
+                                       const unsigned&  begin,
+                                       const unsigned&  end,
+                                       const float&     rest_length)
+{
+    const ClothState& in = m_states[m_read_state_index];
+    accumulateSpringForces(in.position_x.data() + row_start,
+                           in.position_y.data() + row_start,
+                           in.position_z.data() + row_start,
+                           m_force_x.data() + row_start,
+                           m_force_y.data() + row_start,
+                           m_force_z.data() + row_start,
+                           neighbour_offset,
+                           begin,
+                           end,
+                           rest_length,
+                           m_parameters.spring_stiffness);
+}
+
+bool ClothCpuSolver::isPinned(const unsigned& row, const unsigned& col) const
+{
+    const unsigned cols = m_num_particles.x;
+    return row == m_num_particles.y - 1 &&
+           (col == 0 || col == cols / 4 || col == cols * 2 / 4 || col == cols * 3 / 4 || col == cols - 1);
+}
+
+} // namespace sputnik::demos
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <vector.hpp>
+
+#include <cstddef>
+#include <vector>
+
+namespace sputnik::demos
+{
+
+using namespace ramanujan;
+using namespace ramanujan::experimental;
+
+/*!
+ * @brief Parameters of the cloth simulation. These mirror the uniforms of cloth_integration.comp, defaults included, so
+ * that both backends simulate the same cloth.
+ */
+struct ClothSimulationParameters
+{
+    vec3  gravity{0.0f, -10.0f, 0.0f};
+    float particle_mass{0.1f};
+    float spring_stiffness{4750.0f};
+    float rest_length_horizontal{0.0f};
+    float rest_length_vertical{0.0f};
+    float rest_length_diagonal{0.0f};
+    float delta_t{0.000005f};
+    float damping{0.1f};
+};
+
+/*!
+ * @brief CPU implementation of cloth_integration.comp. The particles use the same row-major grid layout as the shader
+ * storage buffers and every particle is connected to its 8 neighbours.
+ *
+ * @details The state is kept in structure of arrays form and double buffered like the compute shader. Rows are
+ * integrated in parallel. Within a row each spring direction is accumulated in a separate, branch free loop over the
+ * columns that have a neighbour in that direction. The loops take their arrays as __restrict parameters so that the
+ * compiler can vectorize across columns.
+ */
+class ClothCpuSolver
+{
+public:
+    ClothCpuSolver() = default;
+
+    /*!
+     * @brief Sets up the grid. Positions and velocities are given in the layout of the shader storage buffers.
+     */
+    void initialize(const uvec2& num_particles, const std::vector<vec4>& positions, const std::vector<vec4>& velocities);
+
+    void                             setParameters(const ClothSimulationParameters& parameters);
+    const ClothSimulationParameters& getParameters() const;
+
+    /*!
+     * @brief Runs the given number of integration steps, each one corresponds to a single compute dispatch.
+     */
+    void step(const unsigned& iterations);
+
+    void setState(const std::vector<vec4>& positions, const std::vector<vec4>& velocities);
+    void getState(std::vector<vec4>& positions_out, std::vector<vec4>& velocities_out) const;
+    void getPositions(std::vector<vec4>& positions_out) const;
+
+private:
+    struct ClothState
+    {
+        std::vector<float> position_x;
+        std::vector<float> position_y;
+        std::vector<float> position_z;
+        std::vector<float> velocity_x;
+        std::vector<float> velocity_y;
+        std::vector<float> velocity_z;
+
+        void resize(const size_t& count);
+    };
+
+    void integrateRow(const unsigned& row);
+
+    /*!
+     * @brief Adds the spring forces between the particles [begin, end) of a row and their neighbours at the given
+     * offset.
+     */
+    void accumulateSprings(const size_t&    row_start,
+                           const ptrdiff_t& neighbour_offset,
+                           const unsigned&  begin,
+                           const unsigned&  end,
+                           const float&     rest_length);
+
+    bool isPinned(const unsigned& row, const unsigned& col) const;
+
+private:
+    uvec2                     m_num_particles{0, 0};
+    ClothSimulationParameters m_parameters;
+
+    ClothState   m_states[2];
+    unsigned int m_read_state_index{0};
+
+    // force accumulators, every row only touches its own segment
+    std::vector<float> m_force_x;
+    std::vector<float> m_force_y;
+    std::vector<float> m_force_z;
+};
+
+} // namespace sputnik::demos
@@ -2,6 +2,7 @@
 
 #include <editor/editor_camera.h>
 #include <graphics/api/camera.h>
+#include <graphics/api/asset_manager.h>
 // #include <graphics/glcore/uniform.h>
 // #include <graphics/api/renderer.h>
 #include <core/systems/render_system.h>
@@ -11,6 +12,10 @@
 #include <matrix.hpp>
 
 #include <glad/glad.h>
+#include <imgui.h>
+
+#include <chrono>
+#include <cmath>
 
 namespace sputnik::demos
 {
@@ -28,9 +33,14 @@ void ComputerShaderClothDemoLayer::OnAttach()
 
     m_vao = std::make_unique<OglVertexArray>();
 
-    m_compute_integration_shader = std::make_shared<OglShaderProgram>();
-    m_compute_integration_shader->addShaderStage("../../data/shaders/compute/cloth/cloth_integration.comp");
-    m_compute_integration_shader->configure();
+    // compute shaders are core since OpenGL 4.3, without them the cloth is simulated on the CPU
+    m_compute_supported = GLAD_GL_VERSION_4_3 != 0;
+    if(m_compute_supported)
+    {
+        m_compute_integration_shader = std::make_shared<OglShaderProgram>();
+        m_compute_integration_shader->addShaderStage("../../data/shaders/compute/cloth/cloth_integration.comp");
+        m_compute_integration_shader->configure();
+    }
 
     // m_compute_normal_shader =
     //     std::make_shared<sputnik::graphics::glcore::Shader>("../../data/shaders/compute/cloth/cloth_normal.comp");
@@ -104,17 +114,56 @@ void ComputerShaderClothDemoLayer::OnAttach()
 
     std::vector<vec4> initial_velocity(m_num_particles.x * m_num_particles.y);
 
-    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, m_position_ssbos[0]); // bind the buffer to the binding point 0
-    glBufferData(GL_SHADER_STORAGE_BUFFER, m_buffer_size, &m_initial_positions[0], GL_DYNAMIC_DRAW);
+    // the springs are at rest in the initial grid
+    m_cloth_parameters.rest_length_horizontal = dx;
+    m_cloth_parameters.rest_length_vertical   = dy;
+    m_cloth_parameters.rest_length_diagonal   = std::sqrt(dx * dx + dy * dy);
+
+    if(m_compute_supported)
+    {
+        m_compute_integration_shader->bind();
+        m_compute_integration_shader->setFloat3("gravity", m_cloth_parameters.gravity);
+        m_compute_integration_shader->setFloat("particle_mass", m_cloth_parameters.particle_mass);
+        m_compute_integration_shader->setFloat("particle_inv_mass", 1.0f / m_cloth_parameters.particle_mass);
+        m_compute_integration_shader->setFloat("springK", m_cloth_parameters.spring_stiffness);
+        m_compute_integration_shader->setFloat("rest_length_horizontal", m_cloth_parameters.rest_length_horizontal);
+        m_compute_integration_shader->setFloat("rest_length_vertical", m_cloth_parameters.rest_length_vertical);
+        m_compute_integration_shader->setFloat("rest_length_diagonal", m_cloth_parameters.rest_length_diagonal);
+        m_compute_integration_shader->setFloat("delta_t", m_cloth_parameters.delta_t);
+        m_compute_integration_shader->setFloat("damping_const", m_cloth_parameters.damping);
+        m_compute_integration_shader->unbind();
+    }
+
+    m_cpu_solver.setParameters(m_cloth_parameters);
+    m_cpu_solver.initialize(m_num_particles, m_initial_positions, initial_velocity);
+    m_backend = m_compute_supported ? ClothBackend::GpuCompute : ClothBackend::Cpu;
+
+    glGenQueries(1, &m_simulation_query);
 
-    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, m_position_ssbos[1]); // bind the buffer to the binding point 1
-    glBufferData(GL_SHADER_STORAGE_BUFFER, m_buffer_size, NULL, GL_DYNAMIC_DRAW);
+    if(m_compute_supported)
+    {
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, m_position_ssbos[0]); // bind the buffer to the binding point 0
+        glBufferData(GL_SHADER_STORAGE_BUFFER, m_buffer_size, &m_initial_positions[0], GL_DYNAMIC_DRAW);
+
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, m_position_ssbos[1]); // bind the buffer to the binding point 1
+        glBufferData(GL_SHADER_STORAGE_BUFFER, m_buffer_size, NULL, GL_DYNAMIC_DRAW);
 
-    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, m_velocity_ssbos[0]); // bind the buffer to the binding point 2
-    glBufferData(GL_SHADER_STORAGE_BUFFER, m_buffer_size, &initial_velocity[0], GL_DYNAMIC_DRAW);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, m_velocity_ssbos[0]); // bind the buffer to the binding point 2
+        glBufferData(GL_SHADER_STORAGE_BUFFER, m_buffer_size, &initial_velocity[0], GL_DYNAMIC_DRAW);
 
-    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, m_velocity_ssbos[1]); // bind the buffer to the binding point 3
-    glBufferData(GL_SHADER_STORAGE_BUFFER, m_buffer_size, NULL, GL_DYNAMIC_DRAW);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, m_velocity_ssbos[1]); // bind the buffer to the binding point 3
+        glBufferData(GL_SHADER_STORAGE_BUFFER, m_buffer_size, NULL, GL_DYNAMIC_DRAW);
+    }
+    else
+    {
+        // without shader storage buffers only the positions are needed, as vertex buffers for drawing
+        for(unsigned int i = 0; i < 2; ++i)
+        {
+            glBindBuffer(GL_ARRAY_BUFFER, m_position_ssbos[i]);
+            glBufferData(GL_ARRAY_BUFFER, m_buffer_size, &m_initial_positions[0], GL_DYNAMIC_DRAW);
+        }
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
 
     glGenBuffers(1, &m_particle_grid_vbo);
     glBindBuffer(GL_ARRAY_BUFFER, m_particle_grid_vbo);
@@ -131,8 +180,10 @@ void ComputerShaderClothDemoLayer::OnAttach()
     glBufferData(GL_ELEMENT_ARRAY_BUFFER, m_indices.size() * sizeof(unsigned int), &m_indices[0], GL_STATIC_DRAW);
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 
-    m_color_texture   = std::make_shared<OglTexture2D>("../../data/assets/fabric_basecolor.jpg");
-    m_opacity_texture = std::make_shared<OglTexture2D>("../../data/assets/fabric_opacity.jpg");
+    AssetManager* asset_manager = AssetManager::getInstance();
+
+    m_color_texture   = asset_manager->wait(asset_manager->loadTexture("../../data/assets/fabric_basecolor.jpg"));
+    m_opacity_texture = asset_manager->wait(asset_manager->loadTexture("../../data/assets/fabric_opacity.jpg"));
 
     RenderSystem* render_system = RenderSystem::getInstance();
     render_system->setCameraType(CameraType::EditorCamera);
@@ -146,6 +197,7 @@ void ComputerShaderClothDemoLayer::OnDetach()
     glDeleteBuffers(2, m_velocity_ssbos);
     glDeleteBuffers(1, &m_particle_grid_vbo);
     glDeleteBuffers(1, &m_texture_coord_vbo);
+    glDeleteQueries(1, &m_simulation_query);
 }
 
 void ComputerShaderClothDemoLayer::OnUpdate(const core::TimeStep& time_step)
@@ -185,22 +237,13 @@ void ComputerShaderClothDemoLayer::OnUpdate(const core::TimeStep& time_step)
     }
 
     // update the positions and velocities
+    if(m_backend == ClothBackend::GpuCompute)
     {
-        m_compute_integration_shader->bind(); // Bind the compute shader
-        for(int i = 0; i < 5; i++)
-        {
-            glDispatchCompute(m_num_particles.x / 10, m_num_particles.y / 10, 1);
-            glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
-
-            // swap the read and write buffers
-            m_read_buffer_index = 1 - m_read_buffer_index;
-            glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, m_position_ssbos[m_read_buffer_index]);
-            glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, m_position_ssbos[1 - m_read_buffer_index]);
-            glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, m_velocity_ssbos[m_read_buffer_index]);
-            glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, m_velocity_ssbos[1 - m_read_buffer_index]);
-        }
-
-        m_compute_integration_shader->unbind(); // Unbind the compute shader
+        simulateOnGpu();
+    }
+    else
+    {
+        simulateOnCpu();
     }
 
     // draw the cloth
@@ -279,8 +322,121 @@ void ComputerShaderClothDemoLayer::OnUpdate(const core::TimeStep& time_step)
     m_vao->unbind();
 }
 
+void ComputerShaderClothDemoLayer::simulateOnGpu()
+{
+    // collect the timing of an earlier frame without stalling, a new query is only issued once it's available
+    if(m_simulation_query_pending)
+    {
+        int available = 0;
+        glGetQueryObjectiv(m_simulation_query, GL_QUERY_RESULT_AVAILABLE, &available);
+        if(available)
+        {
+            GLuint64 elapsed_ns = 0;
+            glGetQueryObjectui64v(m_simulation_query, GL_QUERY_RESULT, &elapsed_ns);
+            m_simulation_time_ms       = float(double(elapsed_ns) * 1e-6);
+            m_simulation_query_pending = false;
+        }
+    }
+
+    const bool issue_query = !m_simulation_query_pending;
+    if(issue_query)
+    {
+        glBeginQuery(GL_TIME_ELAPSED, m_simulation_query);
+    }
+
+    m_compute_integration_shader->bind(); // Bind the compute shader
+    for(unsigned int i = 0; i < kIterationsPerFrame; i++)
+    {
+        glDispatchCompute(m_num_particles.x / 10, m_num_particles.y / 10, 1);
+        glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+        // swap the read and write buffers
+        m_read_buffer_index = 1 - m_read_buffer_index;
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, m_position_ssbos[m_read_buffer_index]);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, m_position_ssbos[1 - m_read_buffer_index]);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, m_velocity_ssbos[m_read_buffer_index]);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, m_velocity_ssbos[1 - m_read_buffer_index]);
+    }
+    m_compute_integration_shader->unbind(); // Unbind the compute shader
+
+    if(issue_query)
+    {
+        glEndQuery(GL_TIME_ELAPSED);
+        m_simulation_query_pending = true;
+    }
+}
+
+void ComputerShaderClothDemoLayer::simulateOnCpu()
+{
+    const auto start = std::chrono::steady_clock::now();
+    m_cpu_solver.step(kIterationsPerFrame);
+    m_cpu_solver.getPositions(m_cpu_positions);
+    const std::chrono::duration<float, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    m_simulation_time_ms                                   = elapsed.count();
+
+    // the cloth and the particles are drawn from this buffer
+    glBindBuffer(GL_ARRAY_BUFFER, m_position_ssbos[1 - m_read_buffer_index]);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, m_buffer_size, &m_cpu_positions[0]);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void ComputerShaderClothDemoLayer::setBackend(const ClothBackend& backend)
+{
+    if(backend == m_backend || (backend == ClothBackend::GpuCompute && !m_compute_supported))
+    {
+        return;
+    }
+
+    // the shader storage buffers at the read index hold the input of the next dispatch
+    if(backend == ClothBackend::Cpu)
+    {
+        m_cpu_positions.resize(m_num_particles.x * m_num_particles.y);
+        m_cpu_velocities.resize(m_num_particles.x * m_num_particles.y);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_position_ssbos[m_read_buffer_index]);
+        glGetBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, m_buffer_size, &m_cpu_positions[0]);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_velocity_ssbos[m_read_buffer_index]);
+        glGetBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, m_buffer_size, &m_cpu_velocities[0]);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+        m_cpu_solver.setState(m_cpu_positions, m_cpu_velocities);
+    }
+    else
+    {
+        m_cpu_solver.getState(m_cpu_positions, m_cpu_velocities);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_position_ssbos[m_read_buffer_index]);
+        glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, m_buffer_size, &m_cpu_positions[0]);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_velocity_ssbos[m_read_buffer_index]);
+        glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, m_buffer_size, &m_cpu_velocities[0]);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    }
+
+    m_backend                  = backend;
+    m_simulation_query_pending = false;
+    m_simulation_time_ms       = 0.0f;
+}
+
 void ComputerShaderClothDemoLayer::OnEvent() {}
 
-void ComputerShaderClothDemoLayer::OnUpdateUI(const core::TimeStep& time_step) {}
+void ComputerShaderClothDemoLayer::OnUpdateUI(const core::TimeStep& time_step)
+{
+    if(ImGui::Begin("Cloth"))
+    {
+        if(m_compute_supported)
+        {
+            int backend = static_cast<int>(m_backend);
+            ImGui::RadioButton("GPU (compute)", &backend, static_cast<int>(ClothBackend::GpuCompute));
+            ImGui::SameLine();
+            ImGui::RadioButton("CPU", &backend, static_cast<int>(ClothBackend::Cpu));
+            setBackend(static_cast<ClothBackend>(backend));
+        }
+        else
+        {
+            ImGui::Text("Compute shaders are not supported, simulating on the CPU");
+        }
+
+        ImGui::Text("Particles: %u x %u", m_num_particles.x, m_num_particles.y);
+        ImGui::Text("Simulation: %.3f ms (%u steps)", m_simulation_time_ms, kIterationsPerFrame);
+    }
+    ImGui::End();
+}
 
 } // namespace sputnik::demos
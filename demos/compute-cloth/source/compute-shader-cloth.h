@@ -7,6 +7,8 @@
 #include <graphics/glcore/gl_shader.h>
 #include <graphics/glcore/gl_texture.h>
 
+#include "cloth_cpu_solver.h"
+
 #include <vector2.h>
 #include <vector3.h>
 #include <vector.hpp>
@@ -22,6 +24,16 @@ using namespace ramanujan::experimental;
 using namespace sputnik::graphics::gl;
 using namespace sputnik::graphics::api;
 
+/*!
+ * @brief Where the cloth is simulated. Both backends share the grid layout and the simulation parameters, the CPU one
+ * is the fallback for contexts without compute shaders.
+ */
+enum class ClothBackend
+{
+    GpuCompute,
+    Cpu
+};
+
 class ComputerShaderClothDemoLayer : public core::Layer
 {
 
@@ -36,6 +48,18 @@ public:
     virtual void OnUpdateUI(const core::TimeStep& time_step);
 
 private:
+    void simulateOnGpu();
+    void simulateOnCpu();
+
+    /*!
+     * @brief Switches the simulation backend, carrying over the current state of the cloth.
+     */
+    void setBackend(const ClothBackend& backend);
+
+private:
+    // Number of integration steps per frame, i.e. compute dispatches or CPU solver iterations
+    static constexpr unsigned int kIterationsPerFrame = 5;
+
     // Shader storage buffer objects
     // We'll lay out the particle positions/velocities in row-major order starting at the lower left and proceeding to
     // the upper right of the lattice.
@@ -66,6 +90,18 @@ private:
     std::shared_ptr<OglShaderProgram> m_compute_normal_shader;
     std::shared_ptr<OglShaderProgram> m_cloth_shader;
     std::shared_ptr<OglShaderProgram> m_particles_shader;
+
+    ClothSimulationParameters m_cloth_parameters;
+    ClothBackend              m_backend{ClothBackend::GpuCompute};
+    bool                      m_compute_supported{false};
+    ClothCpuSolver            m_cpu_solver;
+    std::vector<vec4>         m_cpu_positions;
+    std::vector<vec4>         m_cpu_velocities;
+
+    // Simulation cost of the active backend, the GPU one is measured with a timer query
+    unsigned int m_simulation_query{0};
+    bool         m_simulation_query_pending{false};
+    float        m_simulation_time_ms{0.0f};
 };
 
 class ComputerShaderClothDemo : public sputnik::main::Application
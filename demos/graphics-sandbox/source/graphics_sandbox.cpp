@@ -3,6 +3,7 @@
 #include <core/core.h>
 #include <editor/editor_camera.h>
 #include <graphics/api/camera.h>
+#include <graphics/api/asset_manager.h>
 #include <graphics/api/color_material.h>
 #include <graphics/glcore/gl_vertex_array.h>
 #include <vector.hpp>
@@ -152,14 +153,19 @@ void GraphicsSandboxDemoLayer::OnAttach()
     light.diffuse       = vec3(1.0f, 1.0f, 1.0f);
     light.specular      = vec3(1.0f, 1.0f, 1.0f);
 
-    m_cloth_diff_texture = std::make_shared<OglTexture2D>("../../data/assets/fabric_basecolor.jpg", false);
+    AssetManager* asset_manager = AssetManager::getInstance();
+    m_cloth_diff_texture =
+        asset_manager->wait(asset_manager->loadTexture("../../data/assets/fabric_basecolor.jpg", false));
 
+    // the models below are modified (CPU skinning, made static), they are loaded as copies of their own
     m_animated_model = Model::LoadModel("../../data/assets/Woman.gltf");
     // m_animated_model     = Model::LoadModel("../../data/assets/suzanne_blender_monkey.glb");
-    m_diff_texture_woman = std::make_shared<OglTexture2D>("../../data/assets/Woman.png", false);
+    m_diff_texture_woman = asset_manager->wait(asset_manager->loadTexture("../../data/assets/Woman.png", false));
 
     m_sphere = Model::LoadModel("../../data/assets/sphere.gltf");
     m_box    = Model::LoadModel("../../data/assets/box/Box.gltf");
+    m_sphere->makeStatic();
+    m_box->makeStatic();
 
     // binding point of VertexData SSBO in blinn phong pvp program is 0
     m_pvp_vertex_buffer = std::make_shared<OglBuffer>((void*)cube_verts.data(), sizeof(VertexData) * cube_verts.size());
@@ -188,7 +194,7 @@ void GraphicsSandboxDemoLayer::OnUpdate(const core::TimeStep& time_step)
         Material material     = {};
         material.diff_texture = nullptr;
         material.shader_name  = "blinn_phong";
-        m_sphere->draw(material, model);
+        m_sphere->drawStatic(material, model);
     }
     // render sphere
 
@@ -202,7 +208,7 @@ void GraphicsSandboxDemoLayer::OnUpdate(const core::TimeStep& time_step)
         Material material     = {};
         material.diff_texture = nullptr;
         material.shader_name  = "blinn_phong";
-        m_box->draw(material, model);
+        m_box->drawStatic(material, model);
     }
     // render box
 
@@ -0,0 +1,32 @@
+------------------------------------------------------------- PROJECT MESH-COOKER CONFIGURATION ------------------------------------------------------
+
+-- Offline cooker for the glTF assets. Writes the cooked mesh (.smesh) next to every glTF file that is missing one or
+-- whose cooked mesh is older than the source, directories are searched recursively:
+--   mesh-cooker [--force] PATH...
+
+project "mesh-cooker"
+kind "ConsoleApp"
+language "C++"
+characterset("MBCS")
+
+-- targetdir("$(SolutionDir)_output/bin/" .. outputdir .. "/%{prj.name}")
+objdir("$(SolutionDir)_output/bin-intermediate/" .. outputdir .. "/%{prj.name}")
+
+files
+{
+  "source/**.hpp",
+  "source/**.cpp",
+}
+
+externalincludedirs
+{
+  "$(SolutionDir)engine/source",
+  "%{include_dir.ramanujan}",
+  "%{include_dir.spdlog}",
+  "%{include_dir.glm}",
+}
+
+links
+{
+  "engine"
+}
@@ -0,0 +1,107 @@
+#include <core/logging/logging_core.h>
+#include <graphics/core/geometry/mesh_cooker.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace sputnik::demos
+{
+
+struct CookerOptions
+{
+    bool                     force{false}; // cook even when the cooked mesh is up to date
+    std::vector<std::string> paths;
+};
+
+bool parseOptions(int argc, char** argv, CookerOptions& options)
+{
+    for(int i = 1; i < argc; ++i)
+    {
+        const std::string_view argument = argv[i];
+        if(argument == "--force")
+        {
+            options.force = true;
+        }
+        else if(argument.starts_with("--"))
+        {
+            return false;
+        }
+        else
+        {
+            options.paths.emplace_back(argument);
+        }
+    }
+    return !options.paths.empty();
+}
+
+bool isGltfFile(const std::filesystem::path& path)
+{
+    return path.extension() == ".gltf" || path.extension() == ".glb";
+}
+
+void collectSources(const std::filesystem::path& path, std::vector<std::filesystem::path>& sources)
+{
+    if(!std::filesystem::is_directory(path))
+    {
+        sources.push_back(path);
+        return;
+    }
+
+    for(const auto& entry : std::filesystem::recursive_directory_iterator(path))
+    {
+        if(entry.is_regular_file() && isGltfFile(entry.path()))
+        {
+            sources.push_back(entry.path());
+        }
+    }
+}
+
+} // namespace sputnik::demos
+
+int main(int argc, char** argv)
+{
+    using namespace sputnik::demos;
+    using sputnik::graphics::core::MeshCooker;
+
+    CookerOptions options;
+    if(!parseOptions(argc, argv, options))
+    {
+        std::fprintf(stderr, "usage: %s [--force] PATH...\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    sputnik::core::Logger::Init();
+
+    std::vector<std::filesystem::path> sources;
+    for(const std::string& path : options.paths)
+    {
+        collectSources(path, sources);
+    }
+
+    unsigned cooked = 0;
+    unsigned failed = 0;
+    for(const auto& source : sources)
+    {
+        const std::string source_path = source.string();
+        const std::string cooked_path = MeshCooker::getCookedPath(source_path);
+        if(!options.force && MeshCooker::isUpToDate(source_path, cooked_path))
+        {
+            continue;
+        }
+        if(MeshCooker::cook(source_path, cooked_path))
+        {
+            ++cooked;
+        }
+        else
+        {
+            ++failed;
+        }
+    }
+
+    std::printf("%u cooked, %u up to date, %u failed\n", cooked, unsigned(sources.size()) - cooked - failed, failed);
+    return failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
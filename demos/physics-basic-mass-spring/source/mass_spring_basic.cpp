@@ -3,6 +3,7 @@
 // #include <graphics/api/renderer.h>
 // #include <graphics/glcore/uniform.h>
 #include <graphics/api/color_material.h>
+#include <graphics/api/asset_manager.h>
 #include <core/systems/render_system.h>
 
 #include <core/logging/logging_core.h>
@@ -27,8 +28,9 @@ MassSpringBasicDemoLayer::~MassSpringBasicDemoLayer() {}
 
 void MassSpringBasicDemoLayer::OnAttach()
 {
-    m_box    = Model::LoadModel("../../data/assets/box/Box.gltf");
-    m_sphere = Model::LoadModel("../../data/assets/sphere.gltf");
+    AssetManager* asset_manager = AssetManager::getInstance();
+    m_box                       = asset_manager->wait(asset_manager->loadModel("../../data/assets/box/Box.gltf"));
+    m_sphere                    = asset_manager->wait(asset_manager->loadModel("../../data/assets/sphere.gltf"));
 
     // anchor particle
     m_particles.push_back(std::make_shared<Particle>());
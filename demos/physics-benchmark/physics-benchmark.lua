@@ -0,0 +1,43 @@
+------------------------------------------------------------- PROJECT PHYSICS-BENCHMARK CONFIGURATION ------------------------------------------------
+
+-- Headless benchmark of the physics demo scenes. Builds the scenes without a window, runs a fixed number of steps and
+-- reports the per stage timings as JSON:
+--   physics-benchmark [--steps N] [--warmup N] [--dt SECONDS] [--scenario NAME] [--output FILE]
+
+project "physics-benchmark"
+kind "ConsoleApp"
+language "C++"
+characterset("MBCS")
+
+-- targetdir("$(SolutionDir)_output/bin/" .. outputdir .. "/%{prj.name}")
+objdir("$(SolutionDir)_output/bin-intermediate/" .. outputdir .. "/%{prj.name}")
+
+files
+{
+  "source/**.hpp",
+  "source/**.cpp",
+
+  -- the rigid body world lives in the physics sandbox
+  "../physics-sandbox/source/physics_world.h",
+  "../physics-sandbox/source/physics_world.cpp",
+  "../physics-sandbox/source/phx/**.hpp",
+  "../physics-sandbox/source/phx/**.cpp",
+}
+
+includedirs
+{
+  "../physics-sandbox/source",
+}
+
+externalincludedirs
+{
+  "$(SolutionDir)engine/source",
+  "%{include_dir.ramanujan}",
+  "%{include_dir.spdlog}",
+  "%{include_dir.glm}",
+}
+
+links
+{
+  "engine"
+}
@@ -0,0 +1,391 @@
+#include "benchmark_scenarios.hpp"
+
+#include <physics/physics_core.h>
+#include <physics/particle_world.h>
+#include <physics/particle_constraints.h>
+#include <physics/particle_force_generator.h>
+#include <physics/mass-aggregate/mass_spring_systems.hpp>
+
+#include "physics_world.h"
+
+namespace sputnik::demos
+{
+
+using namespace sputnik::physics;
+
+using ::physics::mad::MassAggregateBodySpecification;
+using ::physics::mad::MassAggregateCurve;
+using ::physics::mad::MassAggregateSystem;
+using ::physics::mad::MassAggregateVolume;
+
+using phx::rb::PhxSphereGeometry;
+
+/*!
+ * @brief Scenes simulated by a ParticleWorld (rope bridge, mass-spring cube and rope).
+ */
+class ParticleWorldScenario : public BenchmarkScenario
+{
+public:
+    ParticleWorldScenario(const std::string& name, const unsigned& max_contacts)
+        : BenchmarkScenario{name}
+        , m_world{max_contacts}
+    {
+    }
+
+    virtual size_t getBodyCount() const noexcept override { return m_particles.size(); }
+
+    virtual void step(const float& dt) noexcept override
+    {
+        m_world.startFrame();
+        m_world.simulatePhysics(dt);
+    }
+
+    virtual const PhysicsStepStats& getLastStepStats() const noexcept override { return m_world.getLastStepStats(); }
+
+protected:
+    std::shared_ptr<Particle> addParticle(const vec3& position, const real& mass, const real& damping, const vec3& acc)
+    {
+        std::shared_ptr<Particle> particle = std::make_shared<Particle>();
+        particle->setPosition(position);
+        particle->setVelocity({0.0f, 0.0f, 0.0f});
+        particle->setMass(mass);
+        particle->setDamping(damping);
+        particle->setAcceleration(acc);
+        particle->clearAccumulator();
+        m_particles.push_back(particle);
+        m_world.getParticles().push_back(particle);
+        return particle;
+    }
+
+    void addGroundContacts()
+    {
+        std::shared_ptr<GroundContactGenerator> ground_contact_generator = std::make_shared<GroundContactGenerator>();
+        ground_contact_generator->init(m_world.getParticles());
+        m_world.getContactGenerators().push_back(ground_contact_generator);
+    }
+
+protected:
+    ParticleWorld                          m_world;
+    std::vector<std::shared_ptr<Particle>> m_particles;
+};
+
+/*!
+ * @brief Same setup as physics-rope-bridge, with the extra mass at its initial position.
+ */
+class RopeBridgeScenario : public ParticleWorldScenario
+{
+public:
+    RopeBridgeScenario() : ParticleWorldScenario{"rope-bridge", (kParticleCount + 1) * 10}
+    {
+        for(unsigned i = 0; i < kParticleCount; ++i)
+        {
+            addParticle({real(i / 2) * 2.0f - 5.0f, 4.0f, real(i % 2) * 2.0f - 1.0f}, kBaseMass, 0.9f, kGravity);
+        }
+        addParticle({0.0f, 4.0f, 0.0f}, kBaseMass, 0.9f, kGravity);
+        addGroundContacts();
+
+        for(unsigned i = 0; i < kCableCount; ++i)
+        {
+            std::shared_ptr<ParticleCable> cable = std::make_shared<ParticleCable>();
+            cable->m_particles[0]                = m_particles[i];
+            cable->m_particles[1]                = m_particles[i + 2];
+            cable->m_max_length                  = 1.9f;
+            cable->m_restitution                 = 0.3f;
+            m_world.getContactGenerators().push_back(cable);
+        }
+
+        for(unsigned i = 0; i < kAnchoredCableCount; ++i)
+        {
+            std::shared_ptr<AnchoredParticleCable> cable = std::make_shared<AnchoredParticleCable>();
+            cable->m_particle                            = m_particles[i];
+            cable->m_anchor      = {real(i / 2) * 2.2f - 5.5f, 6.0f, real(i % 2) * 1.6f - 0.8f};
+            cable->m_max_length  = i < 6 ? real(i / 2) * 0.5f + 3.0f : 5.5f - real(i / 2) * 0.5f;
+            cable->m_restitution = 0.5f;
+            m_world.getContactGenerators().push_back(cable);
+        }
+
+        for(unsigned i = 0; i < kRodCount; ++i)
+        {
+            std::shared_ptr<ParticleRod> rod = std::make_shared<ParticleRod>();
+            rod->m_particles[0]              = m_particles[i * 2];
+            rod->m_particles[1]              = m_particles[i * 2 + 1];
+            rod->m_length                    = 2.0f;
+            m_world.getContactGenerators().push_back(rod);
+        }
+
+        // the extra mass sits on the first pair of particles, between the two sides of the bridge
+        m_particles[0]->setMass(kBaseMass + kExtraMass * 0.5f);
+        m_particles[1]->setMass(kBaseMass + kExtraMass * 0.5f);
+    }
+
+private:
+    static constexpr unsigned kParticleCount{12};
+    static constexpr unsigned kRodCount{6};
+    static constexpr unsigned kCableCount{10};
+    static constexpr unsigned kAnchoredCableCount{12};
+    static constexpr real     kBaseMass{1.0f};
+    static constexpr real     kExtraMass{10.0f};
+};
+
+/*!
+ * @brief Same setup as physics-mass-spring-cube: every particle is connected to every other one with a spring.
+ */
+class MassSpringCubeScenario : public ParticleWorldScenario
+{
+public:
+    MassSpringCubeScenario() : ParticleWorldScenario{"mass-spring-cube", kResolution * kResolution * kResolution * 10}
+    {
+        const vec3 center_position = vec3(0.0f, 2.5f, 0.0f);
+        const vec3 half_cube_size  = vec3(kCubeSize * 0.5f);
+        const real scale           = kCubeSize / real(kResolution);
+
+        for(unsigned i = 0; i < kResolution; ++i)
+        {
+            for(unsigned j = 0; j < kResolution; ++j)
+            {
+                for(unsigned k = 0; k < kResolution; ++k)
+                {
+                    const vec3 position = center_position + vec3(real(i), real(j), real(k)) * scale - half_cube_size;
+                    addParticle(position, 1.0f, 0.05f, {0.0f, -1.0f, 0.0f});
+                }
+            }
+        }
+
+        for(size_t i = 0; i < m_particles.size(); ++i)
+        {
+            for(size_t j = 0; j < m_particles.size(); ++j)
+            {
+                if(i == j)
+                {
+                    continue;
+                }
+
+                const real rest_length = (m_particles[i]->getPosition() - m_particles[j]->getPosition()).magnitude();
+                m_world.getForceRegistry().add(
+                    m_particles[i],
+                    std::make_shared<ParticleSpringForceGenerator>(m_particles[j], kSpringStiffness, rest_length));
+            }
+        }
+
+        addGroundContacts();
+    }
+
+private:
+    static constexpr unsigned kResolution{5};
+    static constexpr real     kCubeSize{1.0f};
+    static constexpr real     kSpringStiffness{2.0f};
+};
+
+/*!
+ * @brief Same setup as physics-mass-spring-rope: a chain of cables anchored at both ends.
+ */
+class MassSpringRopeScenario : public ParticleWorldScenario
+{
+public:
+    MassSpringRopeScenario() : ParticleWorldScenario{"mass-spring-rope", kParticleCount * 10}
+    {
+        const vec3 center_position = vec3(0.0f, 5.0f, 0.0f);
+        const vec3 half_rope_size  = vec3(5.0f, 0.0f, 0.0f);
+
+        for(unsigned i = 0; i < kParticleCount; ++i)
+        {
+            addParticle(center_position + vec3(real(i), 0.0f, 0.0f) * kCableLength - half_rope_size,
+                        10.0f,
+                        0.00001f,
+                        {0.0f, -9.8f, 0.0f});
+        }
+
+        // the first and the last particle are the anchors
+        m_particles.front()->setAcceleration({0.0f});
+        m_particles.back()->setAcceleration({0.0f});
+        addAnchoredCable(1, 0);
+        addAnchoredCable(kParticleCount - 2, kParticleCount - 1);
+
+        for(unsigned i = 2; i < kParticleCount - 2; ++i)
+        {
+            addCable(i - 1, i);
+            addCable(i, i + 1);
+        }
+    }
+
+private:
+    void addAnchoredCable(const unsigned& particle, const unsigned& anchor)
+    {
+        std::shared_ptr<AnchoredParticleCable> cable = std::make_shared<AnchoredParticleCable>();
+        cable->m_particle                            = m_particles[particle];
+        cable->m_anchor                              = m_particles[anchor]->getPosition();
+        cable->m_max_length                          = kCableLength;
+        cable->m_restitution                         = kRestitution;
+        m_world.getContactGenerators().push_back(cable);
+    }
+
+    void addCable(const unsigned& a, const unsigned& b)
+    {
+        std::shared_ptr<ParticleCable> cable = std::make_shared<ParticleCable>();
+        cable->m_particles[0]                = m_particles[a];
+        cable->m_particles[1]                = m_particles[b];
+        cable->m_max_length                  = kCableLength;
+        cable->m_restitution                 = kRestitution;
+        m_world.getContactGenerators().push_back(cable);
+    }
+
+private:
+    static constexpr unsigned kParticleCount{25};
+    static constexpr real     kCableLength{0.5f};
+    static constexpr real     kRestitution{0.25f};
+};
+
+/*!
+ * @brief Scenes simulated by a mass aggregate system (physics-mass-aggregate-rope, -cloth and -cube).
+ */
+class MassAggregateScenario : public BenchmarkScenario
+{
+public:
+    MassAggregateScenario(const std::string& name, std::unique_ptr<MassAggregateSystem> system)
+        : BenchmarkScenario{name}
+        , m_system{std::move(system)}
+    {
+    }
+
+    virtual size_t getBodyCount() const noexcept override { return m_system->getParticleCount(); }
+
+    virtual void step(const float& dt) noexcept override { m_system->update(dt); }
+
+    virtual const PhysicsStepStats& getLastStepStats() const noexcept override
+    {
+        return m_system->getLastStepStats();
+    }
+
+private:
+    std::unique_ptr<MassAggregateSystem> m_system;
+};
+
+std::unique_ptr<BenchmarkScenario> createMassAggregateRopeScenario()
+{
+    MassAggregateBodySpecification specification{};
+    specification.mass              = 1.0f;
+    specification.scale             = {3.0f, 0.0f, 0.0f};
+    specification.resolution        = {60, 1, 1};
+    specification.center_position   = {0.0f, 1.5f, 0.0f};
+    specification.damping           = 0.00005f;
+    specification.spring_flexion    = {.stiffness_coefficient = 2500.0f, .damping_coefficient = 35.0f};
+    specification.spring_torsion    = {.stiffness_coefficient = 2500.0f, .damping_coefficient = 35.0f};
+    specification.spring_structural = {.stiffness_coefficient = 3500.0f, .damping_coefficient = 35.0f};
+
+    return std::make_unique<MassAggregateScenario>("mass-aggregate-rope",
+                                                   std::make_unique<MassAggregateCurve>(specification));
+}
+
+std::unique_ptr<BenchmarkScenario> createMassAggregateVolumeScenario(const std::string& name,
+                                                                     const real&        spring_stiffness,
+                                                                     const real&        structural_stiffness,
+                                                                     const real&        spring_damping)
+{
+    MassAggregateBodySpecification specification{};
+    specification.mass              = 0.75f;
+    specification.scale             = {2.0f, 1.0f, 1.0f};
+    specification.resolution        = {20, 10, 10};
+    specification.center_position   = {0.0f, 7.0f, 0.0f};
+    specification.damping           = 0.005f;
+    specification.spring_shear      = {.stiffness_coefficient = spring_stiffness, .damping_coefficient = spring_damping};
+    specification.spring_flexion    = {.stiffness_coefficient = spring_stiffness, .damping_coefficient = spring_damping};
+    specification.spring_structural = {.stiffness_coefficient = structural_stiffness,
+                                       .damping_coefficient   = spring_damping};
+
+    return std::make_unique<MassAggregateScenario>(name, std::make_unique<MassAggregateVolume>(specification));
+}
+
+/*!
+ * @brief The scene of the rigid body sandbox, scaled up: a grid of bouncing spheres dropped on the platform sphere.
+ */
+class RigidBodySpheresScenario : public BenchmarkScenario
+{
+public:
+    RigidBodySpheresScenario() : BenchmarkScenario{"rigid-body-spheres"}
+    {
+        m_bodies.reserve(kGridSize * kGridSize + 1);
+        m_geometries.reserve(kGridSize * kGridSize + 1);
+
+        // platform sphere
+        addSphere(PhxVec3(0.0f, -60.0f, 0.0f), 70.0f, 0.0f, 1.0f);
+
+        for(unsigned i = 0; i < kGridSize; ++i)
+        {
+            for(unsigned j = 0; j < kGridSize; ++j)
+            {
+                const PhxVec3 position(PhxReal(i) * 3.0f - PhxReal(kGridSize) * 1.5f,
+                                       20.0f + PhxReal((i + j) % 4) * 3.0f,
+                                       PhxReal(j) * 3.0f - PhxReal(kGridSize) * 1.5f);
+                addSphere(position, 1.0f, 1.0f, 0.75f);
+            }
+        }
+    }
+
+    virtual size_t getBodyCount() const noexcept override { return m_bodies.size(); }
+
+    virtual void step(const float& dt) noexcept override
+    {
+        m_world.startFrame();
+        m_world.runPhysics(dt);
+    }
+
+    virtual const PhysicsStepStats& getLastStepStats() const noexcept override { return m_world.getLastStepStats(); }
+
+private:
+    void addSphere(const PhxVec3& position, const PhxReal& radius, const PhxReal& mass, const PhxReal& elasticity)
+    {
+        PhxRigidBody& rb = m_bodies.emplace_back();
+        rb.setMass(mass);
+        rb.setCenterOfMass({0.0f, 0.0f, 0.0f});
+        rb.setDamping(0.8f, 0.08f);
+        rb.enableDamping(false);
+        rb.setPosition(position);
+        rb.setVelocity(PhxVec3(0.0f, 0.0f, 0.0f));
+        rb.setRotation(PhxVec3(0.0f, 0.0f, 0.0f));
+        rb.setOrientation(1.0f, 0.0f, 0.0f, 0.0f);
+        rb.setAcceleration(PhxVec3(0.0f, -9.81f, 0.0f));
+        rb.setElasticity(elasticity);
+        rb.setFriction(0.5f);
+        rb.setAwake();
+        rb.setCanSleep(false);
+
+        const PhxReal moment_of_inertia = 0.4f * mass * radius * radius; // I = 2/5 * m * r^2
+        PhxMat3       tensor{};
+        tensor[0] = {moment_of_inertia, 0.0f, 0.0f};
+        tensor[1] = {0.0f, moment_of_inertia, 0.0f};
+        tensor[2] = {0.0f, 0.0f, moment_of_inertia};
+        rb.setInertiaTensor(tensor);
+        rb.calculateDerivedData();
+        m_world.addRigidBody(&rb);
+
+        PhxSphereGeometry& geometry = m_geometries.emplace_back();
+        geometry.m_radius           = radius;
+        geometry.m_rigid_body       = &rb;
+        geometry.updateGeometry();
+        m_world.addGeometry(&geometry);
+    }
+
+private:
+    static constexpr unsigned kGridSize{8};
+
+    PhysicsWorld m_world;
+
+    // the world keeps pointers into these, their capacity is reserved upfront
+    std::vector<PhxRigidBody>      m_bodies;
+    std::vector<PhxSphereGeometry> m_geometries;
+};
+
+std::vector<std::unique_ptr<BenchmarkScenario>> createBenchmarkScenarios()
+{
+    std::vector<std::unique_ptr<BenchmarkScenario>> scenarios;
+    scenarios.push_back(std::make_unique<RopeBridgeScenario>());
+    scenarios.push_back(std::make_unique<MassSpringCubeScenario>());
+    scenarios.push_back(std::make_unique<MassSpringRopeScenario>());
+    scenarios.push_back(createMassAggregateRopeScenario());
+    scenarios.push_back(createMassAggregateVolumeScenario("mass-aggregate-cloth", 1000.0f, 2000.0f, 1.0f));
+    scenarios.push_back(createMassAggregateVolumeScenario("mass-aggregate-cube", 3500.0f, 5500.0f, 0.5f));
+    scenarios.push_back(std::make_unique<RigidBodySpheresScenario>());
+    return scenarios;
+}
+
+} // namespace sputnik::demos
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <physics/physics_step_stats.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace sputnik::demos
+{
+
+using sputnik::physics::PhysicsStepStats;
+
+/*!
+ * @brief A physics scene of one of the interactive demos, built through the same engine APIs but without a window or
+ * any rendering resources.
+ */
+class BenchmarkScenario
+{
+public:
+    BenchmarkScenario(const std::string& name) : m_name{name} {}
+
+    virtual ~BenchmarkScenario() = default;
+
+    const std::string& getName() const noexcept { return m_name; }
+
+    /*!
+     * @brief Number of simulated bodies (particles or rigid bodies), used to normalize the throughput.
+     */
+    virtual size_t getBodyCount() const noexcept = 0;
+
+    /*!
+     * @brief Advances the scene by one fixed step.
+     */
+    virtual void step(const float& dt) noexcept = 0;
+
+    /*!
+     * @brief Per stage timings of the last step, as reported by the underlying world.
+     */
+    virtual const PhysicsStepStats& getLastStepStats() const noexcept = 0;
+
+private:
+    std::string m_name;
+};
+
+/*!
+ * @brief Creates all the benchmark scenarios, freshly initialized.
+ */
+std::vector<std::unique_ptr<BenchmarkScenario>> createBenchmarkScenarios();
+
+} // namespace sputnik::demos
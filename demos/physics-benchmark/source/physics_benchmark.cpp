@@ -0,0 +1,235 @@
+#include "benchmark_scenarios.hpp"
+
+#include <core/logging/logging_core.h>
+
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace sputnik::demos
+{
+
+struct BenchmarkOptions
+{
+    unsigned    steps{1000};
+    unsigned    warmup_steps{60};
+    float       dt{1.0f / 60.0f};
+    std::string scenario_filter; // empty runs all the scenarios
+    std::string output_path;     // empty writes to stdout
+};
+
+/*!
+ * @brief Accumulated timings of one stage over all measured steps.
+ */
+struct StageSummary
+{
+    double total_seconds{0.0};
+    double max_seconds{0.0};
+
+    void add(const double& seconds)
+    {
+        total_seconds += seconds;
+        max_seconds = std::max(max_seconds, seconds);
+    }
+};
+
+struct ScenarioResult
+{
+    std::string name;
+    size_t      body_count{0};
+    unsigned    steps{0};
+
+    // force, integrate, contact generation, contact resolution, broadphase
+    std::array<StageSummary, 5> stages;
+    std::vector<double>         step_seconds;
+    uint64_t                    contact_count{0};
+};
+
+static constexpr std::array<const char*, 5> kStageNames{"force",
+                                                        "integrate",
+                                                        "contact_generation",
+                                                        "contact_resolution",
+                                                        "broadphase"};
+
+ScenarioResult runScenario(BenchmarkScenario& scenario, const BenchmarkOptions& options)
+{
+    for(unsigned i = 0; i < options.warmup_steps; ++i)
+    {
+        scenario.step(options.dt);
+    }
+
+    ScenarioResult result;
+    result.name       = scenario.getName();
+    result.body_count = scenario.getBodyCount();
+    result.steps      = options.steps;
+    result.step_seconds.reserve(options.steps);
+
+    for(unsigned i = 0; i < options.steps; ++i)
+    {
+        scenario.step(options.dt);
+
+        const PhysicsStepStats& stats = scenario.getLastStepStats();
+        result.stages[0].add(stats.force_seconds);
+        result.stages[1].add(stats.integrate_seconds);
+        result.stages[2].add(stats.contact_generation_seconds);
+        result.stages[3].add(stats.contact_resolution_seconds);
+        result.stages[4].add(stats.broadphase_seconds);
+        result.step_seconds.push_back(stats.getTotalSeconds());
+        result.contact_count += stats.contact_count;
+    }
+
+    return result;
+}
+
+double percentile(std::vector<double> values, const double& fraction)
+{
+    if(values.empty())
+    {
+        return 0.0;
+    }
+    const size_t index = std::min(values.size() - 1, size_t(fraction * double(values.size())));
+    std::nth_element(values.begin(), values.begin() + index, values.end());
+    return values[index];
+}
+
+void writeResults(std::FILE* file, const BenchmarkOptions& options, const std::vector<ScenarioResult>& results)
+{
+    std::fprintf(file, "{\n");
+    std::fprintf(file, "  \"steps\": %u,\n", options.steps);
+    std::fprintf(file, "  \"warmup_steps\": %u,\n", options.warmup_steps);
+    std::fprintf(file, "  \"dt\": %.9g,\n", options.dt);
+    std::fprintf(file, "  \"scenarios\": [");
+
+    for(size_t i = 0; i < results.size(); ++i)
+    {
+        const ScenarioResult& result = results[i];
+
+        double total_seconds = 0.0;
+        for(const double& seconds : result.step_seconds)
+        {
+            total_seconds += seconds;
+        }
+        const double steps_per_second = total_seconds > 0.0 ? double(result.steps) / total_seconds : 0.0;
+
+        std::fprintf(file, "%s\n    {\n", i == 0 ? "" : ",");
+        std::fprintf(file, "      \"name\": \"%s\",\n", result.name.c_str());
+        std::fprintf(file, "      \"bodies\": %zu,\n", result.body_count);
+        std::fprintf(file, "      \"total_ms\": %.6f,\n", total_seconds * 1e3);
+        std::fprintf(file, "      \"step_mean_us\": %.3f,\n", total_seconds * 1e6 / std::max(result.steps, 1u));
+        std::fprintf(file, "      \"step_p50_us\": %.3f,\n", percentile(result.step_seconds, 0.50) * 1e6);
+        std::fprintf(file, "      \"step_p95_us\": %.3f,\n", percentile(result.step_seconds, 0.95) * 1e6);
+        std::fprintf(file, "      \"steps_per_second\": %.3f,\n", steps_per_second);
+        std::fprintf(file, "      \"body_steps_per_second\": %.3f,\n", steps_per_second * double(result.body_count));
+        std::fprintf(file,
+                     "      \"contacts_per_step\": %.3f,\n",
+                     double(result.contact_count) / std::max(result.steps, 1u));
+        std::fprintf(file, "      \"stages\": {");
+        for(size_t stage = 0; stage < result.stages.size(); ++stage)
+        {
+            const StageSummary& summary = result.stages[stage];
+            std::fprintf(file,
+                         "%s\n        \"%s\": {\"total_ms\": %.6f, \"mean_us\": %.3f, \"max_us\": %.3f}",
+                         stage == 0 ? "" : ",",
+                         kStageNames[stage],
+                         summary.total_seconds * 1e3,
+                         summary.total_seconds * 1e6 / std::max(result.steps, 1u),
+                         summary.max_seconds * 1e6);
+        }
+        std::fprintf(file, "\n      }\n    }");
+    }
+
+    std::fprintf(file, "\n  ]\n}\n");
+}
+
+bool parseOptions(int argc, char** argv, BenchmarkOptions& options)
+{
+    for(int i = 1; i < argc; ++i)
+    {
+        const std::string_view argument = argv[i];
+        const bool             has_value = i + 1 < argc;
+
+        if(argument == "--steps" && has_value)
+        {
+            options.steps = unsigned(std::strtoul(argv[++i], nullptr, 10));
+        }
+        else if(argument == "--warmup" && has_value)
+        {
+            options.warmup_steps = unsigned(std::strtoul(argv[++i], nullptr, 10));
+        }
+        else if(argument == "--dt" && has_value)
+        {
+            options.dt = std::strtof(argv[++i], nullptr);
+        }
+        else if(argument == "--scenario" && has_value)
+        {
+            options.scenario_filter = argv[++i];
+        }
+        else if(argument == "--output" && has_value)
+        {
+            options.output_path = argv[++i];
+        }
+        else
+        {
+            return false;
+        }
+    }
+
+    return options.steps > 0 && options.dt > 0.0f;
+}
+
+} // namespace sputnik::demos
+
+int main(int argc, char** argv)
+{
+    using namespace sputnik::demos;
+
+    BenchmarkOptions options;
+    if(!parseOptions(argc, argv, options))
+    {
+        std::fprintf(stderr,
+                     "usage: %s [--steps N] [--warmup N] [--dt SECONDS] [--scenario NAME] [--output FILE]\n",
+                     argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    // the simulation code logs through the engine loggers; keep stdout clean for the report
+    sputnik::core::Logger::Init();
+    sputnik::core::Logger::GetEngineLogger()->set_level(spdlog::level::err);
+    sputnik::core::Logger::GetApplicationLogger()->set_level(spdlog::level::err);
+
+    std::vector<ScenarioResult> results;
+    for(const auto& scenario : createBenchmarkScenarios())
+    {
+        if(!options.scenario_filter.empty() && scenario->getName() != options.scenario_filter)
+        {
+            continue;
+        }
+        results.push_back(runScenario(*scenario, options));
+    }
+
+    if(results.empty())
+    {
+        std::fprintf(stderr, "no scenario named '%s'\n", options.scenario_filter.c_str());
+        return EXIT_FAILURE;
+    }
+
+    std::FILE* file = options.output_path.empty() ? stdout : std::fopen(options.output_path.c_str(), "w");
+    if(!file)
+    {
+        std::fprintf(stderr, "failed to open '%s' for writing\n", options.output_path.c_str());
+        return EXIT_FAILURE;
+    }
+
+    writeResults(file, options, results);
+
+    if(file != stdout)
+    {
+        std::fclose(file);
+    }
+
+    return EXIT_SUCCESS;
+}
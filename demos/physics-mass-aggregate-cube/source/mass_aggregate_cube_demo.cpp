@@ -4,6 +4,7 @@
 // #include <graphics/glcore/uniform.h>
 #include <graphics/glcore/gl_buffer.h>
 #include <graphics/api/color_material.h>
+#include <graphics/api/asset_manager.h>
 #include <core/systems/render_system.h>
 #include <editor/editor.hpp>
 
@@ -38,40 +39,9 @@ MassAggregateCubeDemoLayer::MassAggregateCubeDemoLayer(const std::string& name)
     m_shear_spring       = m_mass_spring_volume->getShearSprings();
     m_bend_spring        = m_mass_spring_volume->getBendSprings();
 
-    u64 instanced_buffer_size = m_cube_specification.resolution.x * m_cube_specification.resolution.y *
-                                m_cube_specification.resolution.z * 2 * sizeof(mat4);
-    m_instanced_buffer = std::make_shared<OglBuffer>(instanced_buffer_size);
+    AssetManager* asset_manager = AssetManager::getInstance();
 
-    // A temporary solution for instanced rendering the paritcles
-    m_sphere          = Model::LoadModel("../../data/assets/hatch_sphere/scene.gltf");
-    auto vertex_array = m_sphere->getVertexArray();
-    vertex_array->addVertexBuffer(
-        *m_instanced_buffer.get(),
-        {.binding_index = 3, .stride = 2 * sizeof(mat4)},
-        {{.name = "model[0]", .location = 3, .type = VertexAttributeType::Float4, .normalized = false, .divisor = 1},
-         {.name = "model[1]", .location = 4, .type = VertexAttributeType::Float4, .normalized = false, .divisor = 1},
-         {.name = "model[2]", .location = 5, .type = VertexAttributeType::Float4, .normalized = false, .divisor = 1},
-         {.name = "model[3]", .location = 6, .type = VertexAttributeType::Float4, .normalized = false, .divisor = 1},
-         {.name       = "normal_matrix[0]",
-          .location   = 7,
-          .type       = VertexAttributeType::Float4,
-          .normalized = false,
-          .divisor    = 1},
-         {.name       = "normal_matrix[1]",
-          .location   = 8,
-          .type       = VertexAttributeType::Float4,
-          .normalized = false,
-          .divisor    = 1},
-         {.name       = "normal_matrix[2]",
-          .location   = 9,
-          .type       = VertexAttributeType::Float4,
-          .normalized = false,
-          .divisor    = 1},
-         {.name       = "normal_matrix[3]",
-          .location   = 10,
-          .type       = VertexAttributeType::Float4,
-          .normalized = false,
-          .divisor    = 1}});
+    m_sphere = asset_manager->wait(asset_manager->loadModel("../../data/assets/hatch_sphere/scene.gltf"));
 }
 
 MassAggregateCubeDemoLayer::~MassAggregateCubeDemoLayer() {}
@@ -147,22 +117,11 @@ void MassAggregateCubeDemoLayer::OnUpdate(const core::TimeStep& time_step)
                     mat4 model{};
                     model = model.translate(position);
                     model = model.scale(vec3(0.0004f));
-
-                    // (Transpose of inverse of the model matrix)
-                    mat4 normal_matrix = model;
-                    normal_matrix      = normal_matrix.inverted().transpose();
-
                     matrices.push_back(model);
-                    matrices.push_back(normal_matrix);
                 }
             }
         }
-        m_instanced_buffer->setData(matrices.data(), matrices.size() * sizeof(mat4));
-        material_blue_shine.shader_name = "blinn_phong_instanced";
-        m_sphere->drawInstanced(material_emerald,
-                                (u32)(m_cube_specification.resolution.x * m_cube_specification.resolution.y *
-                                      m_cube_specification.resolution.z));
-        matrices.clear();
+        m_sphere->drawInstanced(material_emerald, matrices);
     }
 
     std::vector<vec4> lines;
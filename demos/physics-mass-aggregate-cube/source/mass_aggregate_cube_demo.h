@@ -51,7 +51,6 @@ private:
     vec3                                 m_grid_size;
     MassAggregateBodySpecification       m_cube_specification;
     std::shared_ptr<MassAggregateVolume> m_mass_spring_volume;
-    std::shared_ptr<OglBuffer>           m_instanced_buffer;
 
     bool                 m_render_particles          = true;
     bool                 m_render_structural_springs = false;
@@ -1,6 +1,7 @@
 #include "mass_aggregate_rope_demo.h"
 
 #include <graphics/api/color_material.h>
+#include <graphics/api/asset_manager.h>
 #include <core/systems/render_system.h>
 
 #include <core/logging/logging_core.h>
@@ -28,7 +29,8 @@ MassAggregateRopeDemoLayer::~MassAggregateRopeDemoLayer() {}
 
 void MassAggregateRopeDemoLayer::OnAttach()
 {
-    m_sphere = Model::LoadModel("../../data/assets/sphere.gltf");
+    AssetManager* asset_manager = AssetManager::getInstance();
+    m_sphere                    = asset_manager->wait(asset_manager->loadModel("../../data/assets/sphere.gltf"));
 
     auto  render_system = core::systems::RenderSystem::getInstance();
     auto& light         = render_system->getLight();
@@ -59,7 +59,6 @@ private:
     vec3                                m_grid_size;
     MassAggregateBodySpecification      m_cube_specification;
     std::shared_ptr<MassAggregateCurve> m_mass_spring_curve;
-    std::shared_ptr<OglBuffer>          m_instanced_buffer;
 
     std::vector<vec3> m_positions;
     std::vector<u32>  m_indices;
@@ -1,6 +1,7 @@
 #include "mass_spring_cube_demo.h"
 
 #include <graphics/api/color_material.h>
+#include <graphics/api/asset_manager.h>
 #include <core/systems/render_system.h>
 
 #include <core/logging/logging_core.h>
@@ -25,7 +26,8 @@ MassSpringCubeDemoLayer::~MassSpringCubeDemoLayer() {}
 
 void MassSpringCubeDemoLayer::OnAttach()
 {
-    m_sphere = Model::LoadModel("../../data/assets/sphere.gltf");
+    AssetManager* asset_manager = AssetManager::getInstance();
+    m_sphere                    = asset_manager->wait(asset_manager->loadModel("../../data/assets/sphere.gltf"));
 
     m_physics_system = core::systems::PhysicsSystem::getInstance();
     m_render_system  = core::systems::RenderSystem::getInstance();
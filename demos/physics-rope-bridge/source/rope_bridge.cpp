@@ -3,6 +3,7 @@
 // #include <graphics/api/renderer.h>
 // #include <graphics/glcore/uniform.h>
 #include <graphics/api/color_material.h>
+#include <graphics/api/asset_manager.h>
 #include <core/systems/render_system.h>
 
 #include <core/logging/logging_core.h>
@@ -49,7 +50,8 @@ RopeBridgeDemoLayer::~RopeBridgeDemoLayer() {}
 void RopeBridgeDemoLayer::OnAttach()
 {
 
-    m_sphere = Model::LoadModel("../../data/assets/sphere.gltf");
+    AssetManager* asset_manager = AssetManager::getInstance();
+    m_sphere                    = asset_manager->wait(asset_manager->loadModel("../../data/assets/sphere.gltf"));
 
     auto  render_system = core::systems::RenderSystem::getInstance();
     auto& light         = render_system->getLight();
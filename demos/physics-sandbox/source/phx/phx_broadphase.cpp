@@ -0,0 +1,148 @@
+#include "phx_broadphase.hpp"
+#include "rigidbody/phx_rb_geometry.hpp"
+
+#include <algorithm>
+
+namespace phx
+{
+
+void PhxBroadphaseTree::build(const PhxArray<rb::PhxGeometry*>& geometries) noexcept
+{
+    m_geometries = geometries;
+    m_nodes_used = 0;
+
+    const PhxUint num_primitives = static_cast<PhxUint>(m_geometries.size());
+    if(num_primitives == 0)
+    {
+        m_nodes.clear();
+        return;
+    }
+
+    // A binary tree has 2n - 1 nodes where n is the number of leaf nodes.
+    m_nodes.resize(static_cast<size_t>(num_primitives) * 2 - 1);
+    m_primitive_indices.resize(num_primitives);
+    m_primitive_bounds.resize(num_primitives);
+    m_primitive_centroids.resize(num_primitives);
+
+    for(PhxUint i = 0; i < num_primitives; ++i)
+    {
+        m_primitive_indices[i]   = i;
+        m_primitive_bounds[i]    = m_geometries[i]->computeAABB();
+        m_primitive_centroids[i] = m_geometries[i]->getTransform()[3];
+    }
+
+    auto& root_node          = m_nodes[m_nodes_used++];
+    root_node.idx            = 0;
+    root_node.num_primitives = num_primitives;
+
+    updateBounds(0);
+    subdivide(0, 1);
+}
+
+void PhxBroadphaseTree::clear() noexcept
+{
+    m_nodes.clear();
+    m_geometries.clear();
+    m_nodes_used = 0;
+}
+
+bool PhxBroadphaseTree::empty() const noexcept
+{
+    return m_nodes_used == 0;
+}
+
+const PhxArray<PhxBvhNode>& PhxBroadphaseTree::getNodes() const noexcept
+{
+    return m_nodes;
+}
+
+const PhxIndexArray& PhxBroadphaseTree::getPrimitiveIndices() const noexcept
+{
+    return m_primitive_indices;
+}
+
+const PhxArray<PhxAABB>& PhxBroadphaseTree::getPrimitiveBounds() const noexcept
+{
+    return m_primitive_bounds;
+}
+
+const PhxArray<rb::PhxGeometry*>& PhxBroadphaseTree::getGeometries() const noexcept
+{
+    return m_geometries;
+}
+
+void PhxBroadphaseTree::updateBounds(const PhxIndex& node_idx) noexcept
+{
+    auto& node    = m_nodes[node_idx];
+    node.aabb.min = PhxVec3(kPhxFloatMax);
+    node.aabb.max = PhxVec3(-kPhxFloatMax);
+
+    for(PhxUint first = node.idx, i = 0; i < node.num_primitives; ++i)
+    {
+        const auto& bounds = m_primitive_bounds[m_primitive_indices[first + i]];
+        node.aabb.min      = phxMin(node.aabb.min, bounds.min);
+        node.aabb.max      = phxMax(node.aabb.max, bounds.max);
+    }
+}
+
+void PhxBroadphaseTree::subdivide(const PhxIndex& node_idx, const PhxUint& depth) noexcept
+{
+    auto& node = m_nodes[node_idx];
+    if(node.num_primitives <= 2 || depth >= kPhxMaxBroadphaseDepth)
+    {
+        return;
+    }
+
+    // Split along the longest axis of the centroid bounds. Unbounded geometries (half spaces) would otherwise make
+    // every split degenerate.
+    PhxVec3 centroid_min(kPhxFloatMax);
+    PhxVec3 centroid_max(-kPhxFloatMax);
+    for(PhxUint i = node.idx; i < node.idx + node.num_primitives; ++i)
+    {
+        centroid_min = phxMin(centroid_min, m_primitive_centroids[m_primitive_indices[i]]);
+        centroid_max = phxMax(centroid_max, m_primitive_centroids[m_primitive_indices[i]]);
+    }
+
+    const PhxVec3 extent = centroid_max - centroid_min;
+    PhxUint       axis   = 0;
+    if(extent.y > extent.x)
+    {
+        axis = 1;
+    }
+    if(extent.z > extent[axis])
+    {
+        axis = 2;
+    }
+
+    // Median split, keeps the tree balanced so the depth stays logarithmic in the number of geometries.
+    const PhxUint first  = node.idx;
+    const PhxUint middle = first + node.num_primitives / 2;
+    std::nth_element(m_primitive_indices.begin() + first,
+                     m_primitive_indices.begin() + middle,
+                     m_primitive_indices.begin() + first + node.num_primitives,
+                     [this, axis](const PhxIndex& a, const PhxIndex& b)
+                     { return m_primitive_centroids[a][axis] < m_primitive_centroids[b][axis]; });
+
+    const PhxUint left_child_idx  = m_nodes_used++;
+    const PhxUint right_child_idx = m_nodes_used++;
+
+    auto& left_node  = m_nodes[left_child_idx];
+    auto& right_node = m_nodes[right_child_idx];
+
+    left_node.idx             = first;
+    left_node.num_primitives  = middle - first;
+    right_node.idx            = middle;
+    right_node.num_primitives = node.num_primitives - left_node.num_primitives;
+
+    // Update the parent node.
+    node.idx            = left_child_idx;
+    node.num_primitives = 0; // Not a leaf node.
+
+    updateBounds(left_child_idx);
+    updateBounds(right_child_idx);
+
+    subdivide(left_child_idx, depth + 1);
+    subdivide(right_child_idx, depth + 1);
+}
+
+} // namespace phx
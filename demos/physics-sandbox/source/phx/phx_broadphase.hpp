@@ -0,0 +1,61 @@
+#ifndef PHX_BROADPHASE_HPP
+#define PHX_BROADPHASE_HPP
+
+#include "phx_geometry.hpp"
+
+namespace phx
+{
+
+namespace rb
+{
+class PhxGeometry;
+} // namespace rb
+
+/*!
+ * @brief Maximum depth of the broadphase tree. Traversals use a fixed size stack of this many entries, so they neither
+ * allocate nor share any state and can run concurrently.
+ */
+static constexpr PhxUint kPhxMaxBroadphaseDepth = 64;
+
+/*!
+ * @brief Bounding volume hierarchy over the world space bounds of the geometries in a physics world. It's rebuilt once
+ * per step and is read only in between, which makes it safe to traverse from any number of threads.
+ */
+class PhxBroadphaseTree
+{
+public:
+    PhxBroadphaseTree() = default;
+
+    /*!
+     * @brief Rebuilds the tree from the current transforms of the given geometries. Storage is reused between builds.
+     */
+    void build(const PhxArray<rb::PhxGeometry*>& geometries) noexcept;
+
+    void clear() noexcept;
+
+    bool empty() const noexcept;
+
+    const PhxArray<PhxBvhNode>& getNodes() const noexcept;
+
+    const PhxIndexArray& getPrimitiveIndices() const noexcept;
+
+    const PhxArray<PhxAABB>& getPrimitiveBounds() const noexcept;
+
+    const PhxArray<rb::PhxGeometry*>& getGeometries() const noexcept;
+
+private:
+    void updateBounds(const PhxIndex& node_idx) noexcept;
+    void subdivide(const PhxIndex& node_idx, const PhxUint& depth) noexcept;
+
+private:
+    PhxArray<PhxBvhNode>       m_nodes;
+    PhxIndexArray              m_primitive_indices; // Indices to the geometries (and their bounds).
+    PhxArray<PhxAABB>          m_primitive_bounds;
+    PhxVec3Array               m_primitive_centroids;
+    PhxArray<rb::PhxGeometry*> m_geometries;
+    PhxUint                    m_nodes_used = 0;
+};
+
+} // namespace phx
+
+#endif // !PHX_BROADPHASE_HPP
@@ -242,6 +242,37 @@ bool raycastAABB(const PhxRay& ray, const PhxAABB& aabb, std::vector<PhxRaycastR
     return true;
 }
 
+PhxVec3 phxInverseDirection(const PhxVec3& direction)
+{
+    PhxVec3 inv_direction;
+    for(int i = 0; i < 3; ++i)
+    {
+        inv_direction[i] = CMP_FLOAT_EQ(direction[i], 0.0f) ? std::copysign(kPhxFloatMax, direction[i])
+                                                             : 1.0f / direction[i];
+    }
+    return inv_direction;
+}
+
+bool raycastAABB(const PhxRay& ray, const PhxVec3& inv_direction, const PhxAABB& aabb, PhxReal& t_out)
+{
+    const PhxVec3 t0 = (aabb.min - ray.origin) * inv_direction;
+    const PhxVec3 t1 = (aabb.max - ray.origin) * inv_direction;
+
+    const PhxVec3 t_near = phxMin(t0, t1);
+    const PhxVec3 t_far  = phxMax(t0, t1);
+
+    const PhxReal t_min = std::max(std::max(t_near.x, t_near.y), std::max(t_near.z, 0.0f));
+    const PhxReal t_max = std::min(std::min(t_far.x, t_far.y), std::min(t_far.z, ray.t));
+
+    if(t_min > t_max)
+    {
+        return false;
+    }
+
+    t_out = t_min;
+    return true;
+}
+
 static bool isUnique(const std::vector<PhxRaycastResult>& results, const PhxRaycastResult& result)
 {
     for(const auto& r : results)
@@ -269,6 +300,7 @@ bool phxRaycast(const PhxRay&                  ray,
     const auto& primitive_indices = bvh->getPrimitiveIndices();
     const auto& triangles         = triangle_mesh.getTriangles();
     bool        hit_found         = false;
+    PhxVec3     inv_direction     = phxInverseDirection(ray.direction);
 
     std::stack<PhxBvhNode> nodes_to_visit;
     nodes_to_visit.push(bvh_nodes[0]);
@@ -341,13 +373,12 @@ bool phxRaycast(const PhxRay&                  ray,
         else
         {
             // Push the child nodes to the stack, only if the ray intersects the AABB of the child nodes.
-            std::vector<phx::PhxRaycastResult> results_1;
-            if(raycastAABB(ray, bvh_nodes[static_cast<size_t>(node.idx)].aabb, results_1))
+            PhxReal t_entry = 0.0f;
+            if(raycastAABB(ray, inv_direction, bvh_nodes[static_cast<size_t>(node.idx)].aabb, t_entry))
             {
                 nodes_to_visit.push(bvh_nodes[static_cast<size_t>(node.idx)]); // Left child
             }
-            std::vector<phx::PhxRaycastResult> results_2;
-            if(raycastAABB(ray, bvh_nodes[static_cast<size_t>(node.idx) + 1].aabb, results_2))
+            if(raycastAABB(ray, inv_direction, bvh_nodes[static_cast<size_t>(node.idx) + 1].aabb, t_entry))
             {
                 nodes_to_visit.push(bvh_nodes[static_cast<size_t>(node.idx) + 1]); // Right child
             }
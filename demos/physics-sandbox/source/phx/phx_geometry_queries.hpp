@@ -41,6 +41,24 @@ bool raycastTriangleBarycentric(const PhxRay& ray, const PhxTriangle& triangle,
 
 bool raycastAABB(const PhxRay& ray, const PhxAABB& aabb, std::vector<PhxRaycastResult>& out_results);
 
+/*!
+ * @brief Slab test between a ray and an AABB that doesn't allocate. Intended for tree traversals where only the entry
+ * distance is of interest.
+ *
+ * @param ray The ray, ray.t is used as the maximum distance along the ray
+ * @param inv_direction Component-wise reciprocal of the ray direction
+ * @param aabb The box to test against
+ * @param t_out Entry distance along the ray (zero if the ray starts inside the box)
+ * @return True, if the ray hits the box within [0, ray.t], false otherwise.
+ */
+bool raycastAABB(const PhxRay& ray, const PhxVec3& inv_direction, const PhxAABB& aabb, PhxReal& t_out);
+
+/*!
+ * @brief Component-wise reciprocal of a ray direction. Zero components are replaced by a large finite value so that
+ * the slab test stays well defined.
+ */
+PhxVec3 phxInverseDirection(const PhxVec3& direction);
+
 bool phxRaycast(const PhxRay&                  ray,
                 const PhxTriangleMesh&         triangle_mesh,
                 std::vector<PhxRaycastResult>& out_results,
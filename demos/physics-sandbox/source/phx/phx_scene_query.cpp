@@ -0,0 +1,548 @@
+#include "phx_scene_query.hpp"
+#include "phx_geometry_queries.hpp"
+#include "rigidbody/phx_rb_geometry.hpp"
+
+namespace phx
+{
+
+using rb::PhxBoxGeometry;
+using rb::PhxGeometry;
+using rb::PhxGeometryType;
+using rb::PhxHalfSpaceGeometry;
+using rb::PhxSphereGeometry;
+using rb::PhxTriangleMeshGeometry;
+
+static constexpr PhxUint kPhxTraversalStackSize = 2 * kPhxMaxBroadphaseDepth;
+
+/////////////////////////////// Tree traversal ///////////////////////////////////
+
+/*!
+ * @brief Depth first traversal of a BVH. Nodes rejected by node_test are skipped along with their subtrees, visit_leaf
+ * is called for every primitive index of the accepted leaves.
+ *
+ * The stack lives on the call stack and is large enough for the broadphase tree, whose depth is bounded. Mesh BVHs
+ * have no depth bound, the nodes that don't fit spill into a heap allocated stack so that no subtree is dropped.
+ */
+template <typename NodeTest, typename LeafVisitor>
+static void traverseBvh(const PhxArray<PhxBvhNode>& nodes,
+                        const PhxIndexArray&        primitive_indices,
+                        NodeTest&&                  node_test,
+                        LeafVisitor&&               visit_leaf)
+{
+    if(nodes.empty())
+    {
+        return;
+    }
+
+    PhxIndex      stack[kPhxTraversalStackSize];
+    PhxUint       stack_size = 0;
+    PhxIndexArray overflow;
+    stack[stack_size++] = 0;
+
+    auto push = [&](const PhxIndex& node_idx)
+    {
+        if(stack_size < kPhxTraversalStackSize)
+        {
+            stack[stack_size++] = node_idx;
+        }
+        else
+        {
+            overflow.push_back(node_idx);
+        }
+    };
+
+    while(stack_size > 0 || !overflow.empty())
+    {
+        PhxIndex node_idx = 0;
+        if(!overflow.empty())
+        {
+            node_idx = overflow.back();
+            overflow.pop_back();
+        }
+        else
+        {
+            node_idx = stack[--stack_size];
+        }
+
+        const PhxBvhNode& node = nodes[node_idx];
+        if(!node_test(node.aabb))
+        {
+            continue;
+        }
+
+        if(node.isLeaf())
+        {
+            for(PhxUint i = node.idx; i < node.idx + node.num_primitives; ++i)
+            {
+                visit_leaf(primitive_indices[i]);
+            }
+        }
+        else
+        {
+            push(node.idx + 1); // Right child
+            push(node.idx);     // Left child
+        }
+    }
+}
+
+static bool overlapSphereAABB(const PhxVec3& center, const PhxReal& radius, const PhxAABB& aabb)
+{
+    const PhxVec3 closest = phx_clamp(center, aabb.min, aabb.max);
+    return phx_magnitude_sq(closest - center) <= radius * radius;
+}
+
+static PhxAABB inflateAABB(const PhxAABB& aabb, const PhxReal& amount)
+{
+    return {aabb.min - PhxVec3(amount), aabb.max + PhxVec3(amount)};
+}
+
+/////////////////////////////// Ray narrowphase ///////////////////////////////////
+
+static bool raycastSphere(const PhxRay&  ray,
+                          const PhxVec3& center,
+                          const PhxReal& radius,
+                          PhxReal&       t_out,
+                          PhxVec3&       normal_out)
+{
+    const PhxVec3 m = ray.origin - center;
+    const PhxReal b = phx_dot(m, ray.direction);
+    const PhxReal c = phx_dot(m, m) - radius * radius;
+
+    // Ray starts outside the sphere and points away from it.
+    if(c > 0.0f && b > 0.0f)
+    {
+        return false;
+    }
+
+    const PhxReal discriminant = b * b - c;
+    if(discriminant < 0.0f)
+    {
+        return false;
+    }
+
+    // A ray starting inside the sphere hits it at t = 0.
+    const PhxReal t = std::max(-b - std::sqrt(discriminant), 0.0f);
+    if(t > ray.t)
+    {
+        return false;
+    }
+
+    t_out      = t;
+    normal_out = t > 0.0f ? phx_normalize(ray.origin + ray.direction * t - center) : -ray.direction;
+    return true;
+}
+
+static bool raycastBox(const PhxRay&         ray,
+                       const PhxBoxGeometry* box,
+                       const PhxVec3&        half_extents,
+                       PhxReal&              t_out,
+                       PhxVec3&              normal_out)
+{
+    const PhxVec3 delta = ray.origin - PhxVec3(box->getTransform()[3]);
+
+    PhxReal t_min      = 0.0f;
+    PhxReal t_max      = ray.t;
+    int     entry_axis = -1;
+    PhxReal entry_sign = 1.0f;
+
+    // Slab test in the local frame of the box.
+    for(unsigned int i = 0; i < 3; ++i)
+    {
+        const PhxVec3 axis         = phx_normalize(box->getAxis(i));
+        const PhxReal local_origin = phx_dot(delta, axis);
+        const PhxReal local_dir    = phx_dot(ray.direction, axis);
+
+        if(std::abs(local_dir) < kPhxEpsilon)
+        {
+            if(std::abs(local_origin) > half_extents[i])
+            {
+                return false;
+            }
+            continue;
+        }
+
+        const PhxReal inv_dir = 1.0f / local_dir;
+        PhxReal       t0      = (-half_extents[i] - local_origin) * inv_dir;
+        PhxReal       t1      = (half_extents[i] - local_origin) * inv_dir;
+        if(t0 > t1)
+        {
+            std::swap(t0, t1);
+        }
+
+        if(t0 > t_min)
+        {
+            t_min      = t0;
+            entry_axis = static_cast<int>(i);
+            entry_sign = local_dir > 0.0f ? -1.0f : 1.0f;
+        }
+        t_max = std::min(t_max, t1);
+
+        if(t_min > t_max)
+        {
+            return false;
+        }
+    }
+
+    t_out      = t_min;
+    normal_out = entry_axis >= 0 ? phx_normalize(box->getAxis(entry_axis)) * entry_sign : -ray.direction;
+    return true;
+}
+
+static bool raycastHalfSpace(const PhxRay&  ray,
+                             const PhxVec3& normal,
+                             const PhxReal& distance,
+                             PhxReal&       t_out,
+                             PhxVec3&       normal_out)
+{
+    // The solid side of the half space is behind the plane.
+    const PhxReal origin_distance = phx_dot(normal, ray.origin) - distance;
+    if(origin_distance <= 0.0f)
+    {
+        t_out      = 0.0f;
+        normal_out = normal;
+        return true;
+    }
+
+    const PhxReal nd = phx_dot(ray.direction, normal);
+    if(nd >= 0.0f)
+    {
+        return false;
+    }
+
+    const PhxReal t = -origin_distance / nd;
+    if(t > ray.t)
+    {
+        return false;
+    }
+
+    t_out      = t;
+    normal_out = normal;
+    return true;
+}
+
+static bool raycastMesh(const PhxRay& ray, const PhxTriangleMesh& mesh, PhxReal& t_out, PhxVec3& normal_out)
+{
+    const auto&   triangles     = mesh.getTriangles();
+    const PhxVec3 inv_direction = phxInverseDirection(ray.direction);
+    PhxRay        clipped_ray   = ray;
+    bool          hit_found     = false;
+
+    auto test_triangle = [&](const PhxIndex& triangle_idx)
+    {
+        PhxRaycastResult result;
+        if(raycastTriangle(clipped_ray, triangles[triangle_idx], result) && result.t <= clipped_ray.t)
+        {
+            hit_found     = true;
+            clipped_ray.t = result.t;
+            normal_out    = result.normal;
+        }
+    };
+
+    const auto& bvh = mesh.getBvh();
+    if(bvh)
+    {
+        traverseBvh(
+            bvh->getNodes(),
+            bvh->getPrimitiveIndices(),
+            [&](const PhxAABB& aabb)
+            {
+                PhxReal t_entry = 0.0f;
+                return raycastAABB(clipped_ray, inv_direction, aabb, t_entry);
+            },
+            test_triangle);
+    }
+    else
+    {
+        for(PhxIndex i = 0; i < static_cast<PhxIndex>(triangles.size()); ++i)
+        {
+            test_triangle(i);
+        }
+    }
+
+    t_out = clipped_ray.t;
+    return hit_found;
+}
+
+/*!
+ * @brief Casts a ray against a single geometry, with all of its extents grown by the given radius. A zero radius gives
+ * an exact raycast, a positive radius a sphere sweep.
+ */
+static bool raycastGeometry(const PhxRay&      ray,
+                            const PhxGeometry* geometry,
+                            const PhxReal&     radius,
+                            PhxReal&           t_out,
+                            PhxVec3&           normal_out)
+{
+    switch(geometry->getType())
+    {
+    case PhxGeometryType::Sphere:
+    {
+        auto sphere = static_cast<const PhxSphereGeometry*>(geometry);
+        return raycastSphere(ray, sphere->getTransform()[3], sphere->m_radius + radius, t_out, normal_out);
+    }
+    case PhxGeometryType::Box:
+    {
+        auto box = static_cast<const PhxBoxGeometry*>(geometry);
+        return raycastBox(ray, box, box->m_half_extents + PhxVec3(radius), t_out, normal_out);
+    }
+    case PhxGeometryType::HalfSpace:
+    {
+        auto half_space = static_cast<const PhxHalfSpaceGeometry*>(geometry);
+        return raycastHalfSpace(ray, half_space->m_normal, half_space->m_distance + radius, t_out, normal_out);
+    }
+    case PhxGeometryType::TriangleMesh:
+    {
+        auto mesh_geometry = static_cast<const PhxTriangleMeshGeometry*>(geometry);
+        if(!mesh_geometry->m_mesh || radius > 0.0f)
+        {
+            return false;
+        }
+        return raycastMesh(ray, *mesh_geometry->m_mesh, t_out, normal_out);
+    }
+    default:
+        return false;
+    }
+}
+
+/////////////////////////////// Overlap narrowphase ///////////////////////////////////
+
+/*!
+ * @brief Closest point on a triangle to a point (Real-Time Collision Detection, Ericson, 5.1.5).
+ */
+static PhxVec3 closestPointOnTriangle(const PhxVec3& p, const PhxTriangle& triangle)
+{
+    const PhxVec3 ab = triangle.b - triangle.a;
+    const PhxVec3 ac = triangle.c - triangle.a;
+    const PhxVec3 ap = p - triangle.a;
+
+    const PhxReal d1 = phx_dot(ab, ap);
+    const PhxReal d2 = phx_dot(ac, ap);
+    if(d1 <= 0.0f && d2 <= 0.0f)
+    {
+        return triangle.a;
+    }
+
+    const PhxVec3 bp = p - triangle.b;
+    const PhxReal d3 = phx_dot(ab, bp);
+    const PhxReal d4 = phx_dot(ac, bp);
+    if(d3 >= 0.0f && d4 <= d3)
+    {
+        return triangle.b;
+    }
+
+    const PhxReal vc = d1 * d4 - d3 * d2;
+    if(vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f)
+    {
+        return triangle.a + ab * (d1 / (d1 - d3));
+    }
+
+    const PhxVec3 cp = p - triangle.c;
+    const PhxReal d5 = phx_dot(ab, cp);
+    const PhxReal d6 = phx_dot(ac, cp);
+    if(d6 >= 0.0f && d5 <= d6)
+    {
+        return triangle.c;
+    }
+
+    const PhxReal vb = d5 * d2 - d1 * d6;
+    if(vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f)
+    {
+        return triangle.a + ac * (d2 / (d2 - d6));
+    }
+
+    const PhxReal va = d3 * d6 - d5 * d4;
+    if(va <= 0.0f && (d4 - d3) >= 0.0f && (d5 - d6) >= 0.0f)
+    {
+        return triangle.b + (triangle.c - triangle.b) * ((d4 - d3) / ((d4 - d3) + (d5 - d6)));
+    }
+
+    const PhxReal denom = 1.0f / (va + vb + vc);
+    return triangle.a + ab * (vb * denom) + ac * (vc * denom);
+}
+
+static bool overlapMesh(const PhxSphereOverlap& sphere, const PhxTriangleMesh& mesh)
+{
+    const auto& triangles   = mesh.getTriangles();
+    const auto  radius_sq   = sphere.radius * sphere.radius;
+    bool        overlapping = false;
+
+    auto test_triangle = [&](const PhxIndex& triangle_idx)
+    {
+        const PhxVec3 closest = closestPointOnTriangle(sphere.center, triangles[triangle_idx]);
+        overlapping           = overlapping || phx_magnitude_sq(closest - sphere.center) <= radius_sq;
+    };
+
+    const auto& bvh = mesh.getBvh();
+    if(bvh)
+    {
+        traverseBvh(
+            bvh->getNodes(),
+            bvh->getPrimitiveIndices(),
+            [&](const PhxAABB& aabb) { return !overlapping && overlapSphereAABB(sphere.center, sphere.radius, aabb); },
+            test_triangle);
+    }
+    else
+    {
+        for(PhxIndex i = 0; i < static_cast<PhxIndex>(triangles.size()) && !overlapping; ++i)
+        {
+            test_triangle(i);
+        }
+    }
+
+    return overlapping;
+}
+
+static bool overlapGeometry(const PhxSphereOverlap& sphere, const PhxGeometry* geometry)
+{
+    switch(geometry->getType())
+    {
+    case PhxGeometryType::Sphere:
+    {
+        auto          other     = static_cast<const PhxSphereGeometry*>(geometry);
+        const PhxReal sum_radii = sphere.radius + other->m_radius;
+        return phx_magnitude_sq(PhxVec3(other->getTransform()[3]) - sphere.center) <= sum_radii * sum_radii;
+    }
+    case PhxGeometryType::Box:
+    {
+        // Clamp the sphere center into the box in the box's local frame.
+        auto          box     = static_cast<const PhxBoxGeometry*>(geometry);
+        const PhxVec3 center  = box->getTransform()[3];
+        const PhxVec3 delta   = sphere.center - center;
+        PhxVec3       closest = center;
+        for(unsigned int i = 0; i < 3; ++i)
+        {
+            const PhxVec3 axis = phx_normalize(box->getAxis(i));
+            closest += axis * phx_clamp(phx_dot(delta, axis), -box->m_half_extents[i], box->m_half_extents[i]);
+        }
+        return phx_magnitude_sq(closest - sphere.center) <= sphere.radius * sphere.radius;
+    }
+    case PhxGeometryType::HalfSpace:
+    {
+        auto half_space = static_cast<const PhxHalfSpaceGeometry*>(geometry);
+        return phx_dot(half_space->m_normal, sphere.center) - half_space->m_distance <= sphere.radius;
+    }
+    case PhxGeometryType::TriangleMesh:
+    {
+        auto mesh_geometry = static_cast<const PhxTriangleMeshGeometry*>(geometry);
+        return mesh_geometry->m_mesh && overlapMesh(sphere, *mesh_geometry->m_mesh);
+    }
+    default:
+        return false;
+    }
+}
+
+/////////////////////////////// Scene queries ///////////////////////////////////
+
+/*!
+ * @brief Shared implementation of raycasts and sphere sweeps: a sweep is a raycast against geometries grown by the
+ * sphere radius.
+ */
+static bool sceneCast(const PhxBroadphaseTree& tree,
+                      const PhxRay&            ray,
+                      const PhxReal&           radius,
+                      const PhxUint&           filter_mask,
+                      PhxSceneQueryHit&        out_hit)
+{
+    out_hit.reset();
+
+    const auto&   geometries    = tree.getGeometries();
+    const auto&   bounds        = tree.getPrimitiveBounds();
+    const PhxVec3 inv_direction = phxInverseDirection(ray.direction);
+    PhxRay        clipped_ray   = ray;
+
+    traverseBvh(
+        tree.getNodes(),
+        tree.getPrimitiveIndices(),
+        [&](const PhxAABB& aabb)
+        {
+            PhxReal t_entry = 0.0f;
+            return raycastAABB(clipped_ray, inv_direction, inflateAABB(aabb, radius), t_entry);
+        },
+        [&](const PhxIndex& primitive_idx)
+        {
+            PhxGeometry* geometry = geometries[primitive_idx];
+            if((geometry->m_query_layers & filter_mask) == 0)
+            {
+                return;
+            }
+
+            PhxReal t_entry = 0.0f;
+            if(!raycastAABB(clipped_ray, inv_direction, inflateAABB(bounds[primitive_idx], radius), t_entry))
+            {
+                return;
+            }
+
+            PhxReal t      = 0.0f;
+            PhxVec3 normal = PhxVec3(0.0f);
+            if(raycastGeometry(clipped_ray, geometry, radius, t, normal) && t <= clipped_ray.t)
+            {
+                clipped_ray.t    = t;
+                out_hit.geometry = geometry;
+                out_hit.t        = t;
+                out_hit.normal   = normal;
+            }
+        });
+
+    if(out_hit.hasHit())
+    {
+        // For a sweep the reported point is the contact point on the surface, not the center of the sphere.
+        out_hit.point = ray.origin + ray.direction * out_hit.t - out_hit.normal * radius;
+    }
+
+    return out_hit.hasHit();
+}
+
+bool phxSceneRaycast(const PhxBroadphaseTree& tree,
+                     const PhxRay&            ray,
+                     const PhxUint&           filter_mask,
+                     PhxSceneQueryHit&        out_hit)
+{
+    return sceneCast(tree, ray, 0.0f, filter_mask, out_hit);
+}
+
+bool phxSceneSweep(const PhxBroadphaseTree& tree,
+                   const PhxSphereSweep&    sweep,
+                   const PhxUint&           filter_mask,
+                   PhxSceneQueryHit&        out_hit)
+{
+    PhxRay ray;
+    ray.origin    = sweep.origin;
+    ray.direction = sweep.direction;
+    ray.t         = sweep.max_distance;
+    return sceneCast(tree, ray, sweep.radius, filter_mask, out_hit);
+}
+
+PhxUint phxSceneOverlap(const PhxBroadphaseTree& tree,
+                        const PhxSphereOverlap&  sphere,
+                        const PhxUint&           filter_mask,
+                        PhxOverlapBuffer&        out_buffer)
+{
+    out_buffer.count = 0;
+
+    const auto& geometries = tree.getGeometries();
+    const auto& bounds     = tree.getPrimitiveBounds();
+
+    traverseBvh(
+        tree.getNodes(),
+        tree.getPrimitiveIndices(),
+        [&](const PhxAABB& aabb)
+        { return out_buffer.count < out_buffer.capacity && overlapSphereAABB(sphere.center, sphere.radius, aabb); },
+        [&](const PhxIndex& primitive_idx)
+        {
+            PhxGeometry* geometry = geometries[primitive_idx];
+            if(out_buffer.count >= out_buffer.capacity || (geometry->m_query_layers & filter_mask) == 0 ||
+               !overlapSphereAABB(sphere.center, sphere.radius, bounds[primitive_idx]))
+            {
+                return;
+            }
+
+            if(overlapGeometry(sphere, geometry))
+            {
+                out_buffer.geometries[out_buffer.count++] = geometry;
+            }
+        });
+
+    return out_buffer.count;
+}
+
+} // namespace phx
@@ -0,0 +1,112 @@
+#ifndef PHX_SCENE_QUERY_HPP
+#define PHX_SCENE_QUERY_HPP
+
+#include "phx_geometry.hpp"
+#include "phx_broadphase.hpp"
+
+namespace phx
+{
+
+namespace rb
+{
+class PhxGeometry;
+} // namespace rb
+
+/*!
+ * @brief Filter mask that matches geometries on any layer.
+ */
+static constexpr PhxUint kPhxQueryAllLayers = 0xFFFFFFFFu;
+
+/*!
+ * @brief Result of a raycast or a sweep against the world. A miss is reported with a null geometry.
+ */
+struct PhxSceneQueryHit
+{
+    rb::PhxGeometry* geometry{nullptr};
+    PhxReal          t{kPhxFloatMax};
+    PhxPoint         point{0.0f};
+    PhxVec3          normal{0.0f, 0.0f, 1.0f};
+
+    inline bool hasHit() const { return geometry != nullptr; }
+
+    inline void reset()
+    {
+        geometry = nullptr;
+        t        = kPhxFloatMax;
+        point    = PhxVec3(0.0f);
+        normal   = PhxVec3(0.0f, 0.0f, 1.0f);
+    }
+};
+
+/*!
+ * @brief A sphere overlap query.
+ */
+struct PhxSphereOverlap
+{
+    PhxPoint center{0.0f};
+    PhxReal  radius{0.0f};
+};
+
+/*!
+ * @brief A sphere moved along a direction. The direction is expected to be normalized, the hit distance is measured
+ * along it.
+ */
+struct PhxSphereSweep
+{
+    PhxPoint origin{0.0f};
+    PhxVec3  direction{0.0f, 0.0f, 1.0f};
+    PhxReal  radius{0.0f};
+    PhxReal  max_distance{kPhxFloatMax};
+};
+
+/*!
+ * @brief Caller owned storage for the results of an overlap query. The query writes at most capacity geometries and
+ * reports how many it wrote in count; overlaps that don't fit are dropped.
+ */
+struct PhxOverlapBuffer
+{
+    rb::PhxGeometry** geometries{nullptr};
+    PhxUint           capacity{0};
+    PhxUint           count{0};
+};
+
+/*!
+ * @brief Finds the closest geometry hit by a ray. The ray direction is expected to be normalized and ray.t is used as
+ * the maximum distance.
+ *
+ * @param tree The broadphase tree of the world
+ * @param ray The ray to cast
+ * @param filter_mask Only geometries whose layers intersect the mask are considered
+ * @param out_hit The closest hit, reset on a miss
+ * @return True, if the ray hits a geometry, false otherwise.
+ */
+bool phxSceneRaycast(const PhxBroadphaseTree& tree,
+                     const PhxRay&            ray,
+                     const PhxUint&           filter_mask,
+                     PhxSceneQueryHit&        out_hit);
+
+/*!
+ * @brief Collects the geometries overlapping a sphere.
+ *
+ * @return Number of overlapping geometries written to the buffer.
+ */
+PhxUint phxSceneOverlap(const PhxBroadphaseTree& tree,
+                        const PhxSphereOverlap&  sphere,
+                        const PhxUint&           filter_mask,
+                        PhxOverlapBuffer&        out_buffer);
+
+/*!
+ * @brief Finds the first geometry hit by a sphere swept along a direction. Boxes are swept as boxes inflated by the
+ * sphere radius, which is slightly conservative at the edges and corners. Triangle meshes are not swept: a sweep never
+ * reports a hit against them, use a raycast or an overlap query for meshes.
+ *
+ * @return True, if the sphere hits a geometry, false otherwise.
+ */
+bool phxSceneSweep(const PhxBroadphaseTree& tree,
+                   const PhxSphereSweep&    sweep,
+                   const PhxUint&           filter_mask,
+                   PhxSceneQueryHit&        out_hit);
+
+} // namespace phx
+
+#endif // !PHX_SCENE_QUERY_HPP
@@ -32,8 +32,20 @@ PhxVec3 PhxGeometry::getAxis(unsigned int index) const
     return PhxVec3(column[0], column[1], column[2]);
 }
 
+PhxAABB PhxGeometry::computeAABB() const
+{
+    const PhxVec3 center = m_transform[3];
+    return {center, center};
+}
+
 PhxSphereGeometry::PhxSphereGeometry() : PhxGeometry(PhxGeometryType::Sphere) {}
 
+PhxAABB PhxSphereGeometry::computeAABB() const
+{
+    const PhxVec3 center = m_transform[3];
+    return {center - PhxVec3(m_radius), center + PhxVec3(m_radius)};
+}
+
 PhxHalfSpaceGeometry::PhxHalfSpaceGeometry()
     : PhxGeometry(PhxGeometryType::HalfSpace)
     , m_normal(0.0f, 1.0f, 0.0f)
@@ -41,8 +53,44 @@ PhxHalfSpaceGeometry::PhxHalfSpaceGeometry()
 {
 }
 
+PhxAABB PhxHalfSpaceGeometry::computeAABB() const
+{
+    // A half space is unbounded, it's always visited by the broadphase.
+    return {PhxVec3(-kPhxFloatMax), PhxVec3(kPhxFloatMax)};
+}
+
 PhxBoxGeometry::PhxBoxGeometry() : PhxGeometry(PhxGeometryType::Box) {}
 
+PhxAABB PhxBoxGeometry::computeAABB() const
+{
+    // Project the oriented box on the world axes: extent_i = sum_j |R_ij| * half_extent_j
+    const PhxVec3 center = m_transform[3];
+    PhxVec3       extent{0.0f};
+    for(unsigned int axis = 0; axis < 3; ++axis)
+    {
+        extent += phx_abs(getAxis(axis)) * m_half_extents[axis];
+    }
+    return {center - extent, center + extent};
+}
+
+PhxTriangleMeshGeometry::PhxTriangleMeshGeometry() : PhxGeometry(PhxGeometryType::TriangleMesh) {}
+
+PhxAABB PhxTriangleMeshGeometry::computeAABB() const
+{
+    if(!m_mesh || m_mesh->getTriangles().empty())
+    {
+        return PhxGeometry::computeAABB();
+    }
+
+    PhxAABB aabb{PhxVec3(kPhxFloatMax), PhxVec3(-kPhxFloatMax)};
+    for(const auto& triangle : m_mesh->getTriangles())
+    {
+        aabb.min = phxMin(aabb.min, phxMin(triangle.a, phxMin(triangle.b, triangle.c)));
+        aabb.max = phxMax(aabb.max, phxMax(triangle.a, phxMax(triangle.b, triangle.c)));
+    }
+    return aabb;
+}
+
 /////////////////////////////// Intersection methods ///////////////////////////////////
 
 bool phxIntersect(const PhxBoxGeometry& box1, const PhxBoxGeometry& box2)
@@ -74,6 +122,256 @@ bool phxIntersect(const PhxSphereGeometry* sphere1, const PhxSphereGeometry* sph
     return false;
 }
 
+////////////////////////////// Continuous collision methods ///////////////////////////
+
+static constexpr PhxUint kPhxMaxToiIterations = 32;
+static constexpr PhxReal kPhxToiTolerance     = 1.0e-3f;
+
+/*!
+ * @brief Separation of two geometries at some time during a sweep. The normal points from the first geometry towards
+ * the second one, the distance is negative while they overlap.
+ */
+struct PhxSeparation
+{
+    PhxReal distance{0.0f};
+    PhxVec3 normal{0.0f, 1.0f, 0.0f};
+    PhxVec3 point_on_a{0.0f};
+    PhxVec3 point_on_b{0.0f};
+};
+
+/*!
+ * @brief Predicts the world space position of a point attached to a rigid body after time t, assuming constant linear
+ * and angular velocity of the body.
+ */
+static PhxVec3 predictBodyPoint(const PhxRigidBody* body, const PhxVec3& point, const PhxReal& t)
+{
+    const PhxVec3 origin = body->getWorldPosition();
+    const PhxVec3 omega  = body->getAngularVelocity();
+
+    PhxVec3       offset = point - origin;
+    const PhxReal angle  = phx_magnitude(omega) * t;
+    if(angle > kPhxEpsilon)
+    {
+        offset = phxRotatePoint(glm::angleAxis(angle, phx_normalize(omega)), offset);
+    }
+    return origin + body->getLinerVelocity() * t + offset;
+}
+
+/*!
+ * @brief Predicts the world space direction of an axis attached to a rigid body after time t.
+ */
+static PhxVec3 predictBodyAxis(const PhxRigidBody* body, const PhxVec3& axis, const PhxReal& t)
+{
+    const PhxVec3 omega = body->getAngularVelocity();
+    const PhxReal angle = phx_magnitude(omega) * t;
+    return angle > kPhxEpsilon ? phxRotatePoint(glm::angleAxis(angle, phx_normalize(omega)), axis) : axis;
+}
+
+/*!
+ * @brief Upper bound on the speed of any point of a geometry due to the rotation of its body. reach is the distance
+ * from the body origin to the farthest point of the geometry.
+ */
+static PhxReal angularSpeedBound(const PhxGeometry* geometry, const PhxReal& reach)
+{
+    return phx_magnitude(geometry->m_rigid_body->getAngularVelocity()) * reach;
+}
+
+static PhxReal distanceFromBodyOrigin(const PhxGeometry* geometry)
+{
+    return phx_magnitude(PhxVec3(geometry->getTransform()[3]) - geometry->m_rigid_body->getWorldPosition());
+}
+
+/*!
+ * @brief Conservative advancement: the geometries are stepped forward by their separating distance divided by an
+ * upper bound on their approach speed, so they can never be stepped past each other.
+ *
+ * @param separation_at Computes the separation of the geometries at a time in [0, duration]
+ * @param velocity_b Linear velocity the second geometry moves with, zero for geometries that are treated as static
+ * @param angular_bound Upper bound on the approach speed caused by the rotation of both bodies
+ */
+template <typename SeparationFunction>
+static bool conservativeAdvancement(const PhxGeometry*   geometry_a,
+                                    const PhxGeometry*   geometry_b,
+                                    SeparationFunction&& separation_at,
+                                    const PhxVec3&       velocity_b,
+                                    const PhxReal&       angular_bound,
+                                    const PhxReal&       duration,
+                                    PhxReal&             toi_out,
+                                    PhxContact&          contact_out)
+{
+    const PhxVec3 relative_velocity = geometry_a->m_rigid_body->getLinerVelocity() - velocity_b;
+
+    PhxReal t = 0.0f;
+    for(PhxUint iteration = 0; iteration < kPhxMaxToiIterations; ++iteration)
+    {
+        const PhxSeparation separation = separation_at(t);
+
+        // Upper bound on the speed at which the geometries close in on each other along the separating axis.
+        const PhxReal normal_velocity = phx_dot(relative_velocity, separation.normal);
+        const PhxReal approach_bound  = normal_velocity + angular_bound;
+
+        if(separation.distance <= kPhxToiTolerance)
+        {
+            // Touching geometries that are already moving apart are left to the discrete contact resolution.
+            if(normal_velocity <= 0.0f)
+            {
+                return false;
+            }
+
+            toi_out                         = t;
+            contact_out.body_a              = geometry_a->m_rigid_body;
+            contact_out.body_b              = geometry_b->m_rigid_body;
+            contact_out.normal_world        = separation.normal;
+            contact_out.point_on_a_world    = separation.point_on_a;
+            contact_out.point_on_b_world    = separation.point_on_b;
+            contact_out.m_penetration_depth = separation.distance;
+            return true;
+        }
+
+        if(approach_bound <= kPhxEpsilon)
+        {
+            return false; // separating or resting
+        }
+
+        t += separation.distance / approach_bound;
+        if(t > duration)
+        {
+            return false;
+        }
+    }
+
+    return false;
+}
+
+bool phxTimeOfImpact(const PhxSphereGeometry* sphere1,
+                     const PhxSphereGeometry* sphere2,
+                     const PhxReal&           duration,
+                     PhxReal&                 toi_out,
+                     PhxContact&              contact_out)
+{
+    const PhxReal angular_bound = angularSpeedBound(sphere1, distanceFromBodyOrigin(sphere1)) +
+                                  angularSpeedBound(sphere2, distanceFromBodyOrigin(sphere2));
+
+    auto separation_at = [&](const PhxReal& t)
+    {
+        const PhxVec3 center1 = predictBodyPoint(sphere1->m_rigid_body, sphere1->getTransform()[3], t);
+        const PhxVec3 center2 = predictBodyPoint(sphere2->m_rigid_body, sphere2->getTransform()[3], t);
+        const PhxVec3 delta   = center2 - center1;
+        const PhxReal length  = phx_magnitude(delta);
+
+        PhxSeparation separation;
+        separation.distance   = length - sphere1->m_radius - sphere2->m_radius;
+        separation.normal     = length > kPhxEpsilon ? delta / length : PhxVec3(0.0f, 1.0f, 0.0f);
+        separation.point_on_a = center1 + separation.normal * sphere1->m_radius;
+        separation.point_on_b = center2 - separation.normal * sphere2->m_radius;
+        return separation;
+    };
+
+    return conservativeAdvancement(sphere1,
+                                   sphere2,
+                                   separation_at,
+                                   sphere2->m_rigid_body->getLinerVelocity(),
+                                   angular_bound,
+                                   duration,
+                                   toi_out,
+                                   contact_out);
+}
+
+bool phxTimeOfImpact(const PhxSphereGeometry* sphere,
+                     const PhxBoxGeometry*    box,
+                     const PhxReal&           duration,
+                     PhxReal&                 toi_out,
+                     PhxContact&              contact_out)
+{
+    // Every point of the box is within the distance of its center plus its half diagonal from the body origin.
+    const PhxReal box_reach     = distanceFromBodyOrigin(box) + phx_magnitude(box->m_half_extents);
+    const PhxReal angular_bound = angularSpeedBound(sphere, distanceFromBodyOrigin(sphere)) +
+                                  angularSpeedBound(box, box_reach);
+
+    auto separation_at = [&](const PhxReal& t)
+    {
+        const PhxVec3 center     = predictBodyPoint(sphere->m_rigid_body, sphere->getTransform()[3], t);
+        const PhxVec3 box_center = predictBodyPoint(box->m_rigid_body, box->getTransform()[3], t);
+        const PhxVec3 delta      = center - box_center;
+
+        // Clamp the sphere center into the box in the box's local frame. While the center is inside the box the
+        // closest face gives the normal.
+        PhxVec3 closest        = box_center;
+        PhxVec3 face_normal    = PhxVec3(0.0f, 1.0f, 0.0f);
+        PhxReal face_clearance = kPhxFloatMax;
+        for(unsigned int i = 0; i < 3; ++i)
+        {
+            const PhxVec3 axis  = predictBodyAxis(box->m_rigid_body, phx_normalize(box->getAxis(i)), t);
+            const PhxReal local = phx_dot(delta, axis);
+            closest += axis * phx_clamp(local, -box->m_half_extents[i], box->m_half_extents[i]);
+            if(box->m_half_extents[i] - std::abs(local) < face_clearance)
+            {
+                face_clearance = box->m_half_extents[i] - std::abs(local);
+                face_normal    = local >= 0.0f ? -axis : axis;
+            }
+        }
+
+        const PhxVec3 to_box = closest - center;
+        const PhxReal length = phx_magnitude(to_box);
+
+        PhxSeparation separation;
+        if(length > kPhxEpsilon)
+        {
+            separation.distance = length - sphere->m_radius;
+            separation.normal   = to_box / length;
+        }
+        else
+        {
+            separation.distance = -face_clearance - sphere->m_radius;
+            separation.normal   = face_normal;
+        }
+        separation.point_on_a = center + separation.normal * sphere->m_radius;
+        separation.point_on_b = closest;
+        return separation;
+    };
+
+    return conservativeAdvancement(sphere,
+                                   box,
+                                   separation_at,
+                                   box->m_rigid_body->getLinerVelocity(),
+                                   angular_bound,
+                                   duration,
+                                   toi_out,
+                                   contact_out);
+}
+
+bool phxTimeOfImpact(const PhxSphereGeometry*    sphere,
+                     const PhxHalfSpaceGeometry* half_space,
+                     const PhxReal&              duration,
+                     PhxReal&                    toi_out,
+                     PhxContact&                 contact_out)
+{
+    const PhxReal angular_bound = angularSpeedBound(sphere, distanceFromBodyOrigin(sphere));
+
+    auto separation_at = [&](const PhxReal& t)
+    {
+        // The solid side of the half space is behind the plane.
+        const PhxVec3 center = predictBodyPoint(sphere->m_rigid_body, sphere->getTransform()[3], t);
+        const PhxReal height = phx_dot(half_space->m_normal, center) - half_space->m_distance;
+
+        PhxSeparation separation;
+        separation.distance   = height - sphere->m_radius;
+        separation.normal     = -half_space->m_normal;
+        separation.point_on_a = center - half_space->m_normal * sphere->m_radius;
+        separation.point_on_b = center - half_space->m_normal * height;
+        return separation;
+    };
+
+    return conservativeAdvancement(sphere,
+                                   half_space,
+                                   separation_at,
+                                   PhxVec3(0.0f),
+                                   angular_bound,
+                                   duration,
+                                   toi_out,
+                                   contact_out);
+}
+
 ////////////////////////////// Collision methods //////////////////////////////////////
 
 unsigned int
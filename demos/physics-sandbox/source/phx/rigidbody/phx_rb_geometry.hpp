@@ -1,8 +1,11 @@
 #pragma once
 
 #include "../phx_types.hpp"
+#include "../phx_geometry.hpp"
 #include "phx_rb_contact.hpp"
 
+#include <memory>
+
 namespace phx::rb
 {
 
@@ -35,9 +38,16 @@ public:
 
     virtual PhxVec3 getAxis(unsigned int index) const;
 
+    /*!
+     * @brief Computes the world space bounds of the geometry from its current transform. Used to build the broadphase
+     * tree for scene queries.
+     */
+    virtual PhxAABB computeAABB() const;
+
 public:
     PhxRigidBody* m_rigid_body{nullptr}; // The rigid body to which this primitive is attached.
     PhxMat4       m_offset{1.0f};        // Offset of the primitive from the body's center of mass.
+    PhxUint       m_query_layers{1u};    // Layer bits matched against the filter mask of scene queries.
 
 protected:
     PhxMat4         m_transform{1.0f}; // Transformation matrix of the primitive.
@@ -59,6 +69,8 @@ class PhxHalfSpaceGeometry : public PhxGeometry
 public:
     PhxHalfSpaceGeometry();
 
+    virtual PhxAABB computeAABB() const override;
+
 public:
     PhxVec3 m_normal{0.0f, 1.0f, 0.0f}; // Normal of the plane.
     PhxReal m_distance{0.0f};           // Distance from the origin.
@@ -69,6 +81,8 @@ class PhxSphereGeometry : public PhxGeometry
 public:
     PhxSphereGeometry();
 
+    virtual PhxAABB computeAABB() const override;
+
 public:
     PhxReal m_radius{0.0f}; // Radius of the sphere.
 };
@@ -78,10 +92,27 @@ class PhxBoxGeometry : public PhxGeometry
 public:
     PhxBoxGeometry();
 
+    virtual PhxAABB computeAABB() const override;
+
 public:
     PhxVec3 m_half_extents{0.0f}; // Half extents of the box.
 };
 
+/*!
+ * @brief Wraps a triangle mesh so that it can take part in the world's scene queries. The triangles of the mesh are
+ * expected to be in world space already (e.g. a simulated cloth), hence the transform of the geometry is ignored.
+ */
+class PhxTriangleMeshGeometry : public PhxGeometry
+{
+public:
+    PhxTriangleMeshGeometry();
+
+    virtual PhxAABB computeAABB() const override;
+
+public:
+    std::shared_ptr<PhxTriangleMesh> m_mesh{nullptr};
+};
+
 /////////////////////////////// Intersection Tests /////////////////////////////////
 
 /*!
@@ -106,6 +137,48 @@ bool phxIntersect(const PhxBoxGeometry& box, const PhxHalfSpaceGeometry& half_sp
 
 bool phxIntersect(const PhxSphereGeometry* sphere1, const PhxSphereGeometry* sphere2, PhxContact& contact_out);
 
+////////////////////////////// Continuous Collision Tests ///////////////////////////
+
+// Only spheres are swept, against spheres, boxes and half spaces. There is no capsule shape yet; box-box pairs, hulls
+// and triangle meshes are only handled by the discrete tests.
+
+/*!
+ * @brief Computes the time of impact between two moving spheres using conservative advancement. The spheres are
+ * advanced along the linear and angular velocities of their rigid bodies and the separating distance is repeatedly
+ * divided by an upper bound on the approach speed, so the spheres can never be stepped past each other.
+ *
+ * @param sphere1 The first sphere shape
+ * @param sphere2 The second sphere shape
+ * @param duration The time interval to sweep over
+ * @param toi_out Time of impact in [0, duration], valid only if the function returns true
+ * @param contact_out Contact data at the time of impact (points are expressed at the time of impact)
+ * @return True, if the spheres come into contact within the given interval, false otherwise.
+ */
+bool phxTimeOfImpact(const PhxSphereGeometry* sphere1,
+                     const PhxSphereGeometry* sphere2,
+                     const PhxReal&           duration,
+                     PhxReal&                 toi_out,
+                     PhxContact&              contact_out);
+
+/*!
+ * @brief Computes the time of impact between a moving sphere and a moving box using conservative advancement, see the
+ * sphere-sphere overload. The contact normal points from the sphere towards the box.
+ */
+bool phxTimeOfImpact(const PhxSphereGeometry* sphere,
+                     const PhxBoxGeometry*    box,
+                     const PhxReal&           duration,
+                     PhxReal&                 toi_out,
+                     PhxContact&              contact_out);
+
+/*!
+ * @brief Computes the time of impact between a moving sphere and a half space. The half space is treated as static.
+ */
+bool phxTimeOfImpact(const PhxSphereGeometry*    sphere,
+                     const PhxHalfSpaceGeometry* half_space,
+                     const PhxReal&              duration,
+                     PhxReal&                    toi_out,
+                     PhxContact&                 contact_out);
+
 ////////////////////////////// Collision Tests ///////////////////////////////////
 
 struct PhxCollisionData
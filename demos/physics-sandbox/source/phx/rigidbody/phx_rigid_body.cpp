@@ -135,6 +135,43 @@ void PhxRigidBody::setFriction(const PhxReal& friction)
     m_friction = friction;
 }
 
+void PhxRigidBody::setBullet(bool is_bullet)
+{
+    m_is_bullet = is_bullet;
+}
+
+bool PhxRigidBody::isBullet() const
+{
+    return m_is_bullet;
+}
+
+PhxRigidBodyState PhxRigidBody::getState() const
+{
+    PhxRigidBodyState state;
+    state.position           = m_position_global;
+    state.orientation        = m_orientation_world;
+    state.linear_velocity    = m_linear_velocity_global;
+    state.angular_velocity   = m_angular_velocity_global;
+    state.accumulated_force  = m_accumulated_force;
+    state.accumulated_torque = m_accumulated_torque;
+    state.motion             = m_motion;
+    state.is_awake           = m_is_awake;
+    return state;
+}
+
+void PhxRigidBody::setState(const PhxRigidBodyState& state)
+{
+    m_position_global         = state.position;
+    m_orientation_world       = state.orientation;
+    m_linear_velocity_global  = state.linear_velocity;
+    m_angular_velocity_global = state.angular_velocity;
+    m_accumulated_force       = state.accumulated_force;
+    m_accumulated_torque      = state.accumulated_torque;
+    m_motion                  = state.motion;
+    m_is_awake                = state.is_awake;
+    calculateDerivedData();
+}
+
 void PhxRigidBody::addForce(const PhxVec3& force)
 {
     m_accumulated_force += force;
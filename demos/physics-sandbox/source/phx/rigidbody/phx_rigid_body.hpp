@@ -6,6 +6,22 @@
 namespace phx::rb
 {
 
+/*!
+ * @brief The dynamic state of a rigid body, i.e. everything that changes while simulating. Mass properties, material
+ * coefficients and flags are configuration and aren't part of it.
+ */
+struct PhxRigidBodyState
+{
+    PhxVec3 position;
+    PhxQuat orientation;
+    PhxVec3 linear_velocity;
+    PhxVec3 angular_velocity;
+    PhxVec3 accumulated_force;
+    PhxVec3 accumulated_torque;
+    PhxReal motion;
+    bool    is_awake;
+};
+
 class PhxRigidBody
 {
 
@@ -97,6 +113,25 @@ public:
 
     void setFriction(const PhxReal& friction);
 
+    /*!
+     * @brief Flags the rigid body as a bullet. Bullets are small, fast moving bodies for which the world performs
+     * continuous collision detection (time of impact substepping) instead of a single discrete overlap test per step.
+     * @param is_bullet True to enable continuous collision detection for this body.
+     */
+    void setBullet(bool is_bullet = true);
+
+    bool isBullet() const;
+
+    /*!
+     * @brief Captures the dynamic state of the body, see PhxRigidBodyState.
+     */
+    PhxRigidBodyState getState() const;
+
+    /*!
+     * @brief Restores a state captured with getState() and recalculates the derived data.
+     */
+    void setState(const PhxRigidBodyState& state);
+
     /*!
      * @brief Calculate internal data from rigid body state. This method must be called anytime rigibody's state is
      * modified directly. It is also called during integration.
@@ -264,6 +299,11 @@ protected:
     bool m_can_sleep{false};
 
     bool m_enable_damping{false};
+
+    /*!
+     * @brief Bodies flagged as bullets are swept against other geometries to prevent tunnelling.
+     */
+    bool m_is_bullet{false};
 };
 
 } // namespace phx::rb
@@ -2,6 +2,7 @@
 #include "phx/phx_math_utils.hpp"
 
 #include <editor/editor.hpp>
+#include <graphics/api/asset_manager.h>
 
 #include <glad/glad.h>
 
@@ -99,12 +100,15 @@ PhysicsRigidBodySandboxDemoLayer::~PhysicsRigidBodySandboxDemoLayer() {}
 
 void PhysicsRigidBodySandboxDemoLayer::OnAttach()
 {
-    m_box    = Model::LoadModel("../../data/assets/box/Box.gltf");
-    m_sphere = Model::LoadModel("../../data/assets/sphere.gltf");
+    AssetManager* asset_manager = AssetManager::getInstance();
+    m_box                       = asset_manager->wait(asset_manager->loadModel("../../data/assets/box/Box.gltf"));
+    m_sphere                    = asset_manager->wait(asset_manager->loadModel("../../data/assets/sphere.gltf"));
 
-    m_basketball              = Model::LoadModel("../../data/assets/tennis_ball/scene.gltf");
-    m_diff_basketball_texture = std::make_shared<OglTexture2D>("../../data/assets/uv.png", false);
-    m_cloth_diff_texture      = std::make_shared<OglTexture2D>("../../data/assets/fabric_basecolor.jpg", false);
+    m_basketball = asset_manager->wait(asset_manager->loadModel("../../data/assets/tennis_ball/scene.gltf"));
+
+    m_diff_basketball_texture = asset_manager->wait(asset_manager->loadTexture("../../data/assets/uv.png", false));
+    m_cloth_diff_texture =
+        asset_manager->wait(asset_manager->loadTexture("../../data/assets/fabric_basecolor.jpg", false));
 
     RenderSystem* render_system = RenderSystem::getInstance();
 
@@ -128,6 +132,7 @@ void PhysicsRigidBodySandboxDemoLayer::OnAttach()
         m_sphere_rb.setFriction(0.5f);
         m_sphere_rb.setAwake();
         m_sphere_rb.setCanSleep(false);
+        m_sphere_rb.setBullet(m_enable_ccd);
         // m_sphere_rb.setInertiaTensorWithHalfSizesAndMass(PhxVec3(2.0f, 1.0f, 1.0f), 2.5f);
         PhxReal moment_of_inertia = 0.4f * m_sphere_rb.getMass() * 1.00f * 1.00f; // I = 2/5 * m * r^2
         PhxMat3 tensor{};
@@ -253,9 +258,13 @@ void PhysicsRigidBodySandboxDemoLayer::OnUpdateUI(const core::TimeStep& time_ste
     {
         Editor::drawWidgetCheckbox("Simulate Physics", m_simulate_physics, 90.0f, "#simulate_physics");
         // Editor::drawWidgetCheckbox("Reset Simulation", m_reset_simulation, 90.0f, "#reset_simulation");
-        // Editor::drawWidgetCheckbox("Render BVH", m_draw_bvh, 90.0f, "#bvh");
+        Editor::drawWidgetCheckbox("Render BVH", m_draw_bvh, 90.0f, "#bvh");
         // Editor::drawWidgetCheckbox("Render Mesh", m_draw_mesh, 90.0f, "#mesh");
         Editor::drawWidgetCheckbox("Render Wireframe", m_draw_wireframe, 90.0f, "#polygon_mode");
+        if(Editor::drawWidgetCheckbox("Bullet (CCD)", m_enable_ccd, 90.0f, "#ccd"))
+        {
+            m_sphere_rb.setBullet(m_enable_ccd);
+        }
         // Editor::drawWidgetCheckbox("Render 3D Grid", m_draw_grid_points, 90.0f, "#3d_grid");
         // Editor::drawWidgetCheckbox("Render Mesh Grid Points", m_draw_mesh_grid_points, 90.0f, "#mesh_grid_points");
         // Editor::drawWidgetCheckbox("Render Surface Points", m_render_surface_points, 90.0f, "#surface_points");
@@ -269,7 +278,13 @@ void PhysicsRigidBodySandboxDemoLayer::OnUpdateUI(const core::TimeStep& time_ste
     ImGui::End();
 }
 
-void PhysicsRigidBodySandboxDemoLayer::drawAABB(const phx::PhxAABB& aabb, const mat4& model) {}
+void PhysicsRigidBodySandboxDemoLayer::drawAABB(const phx::PhxAABB& aabb, const mat4& model)
+{
+    graphics::core::BoundingBox box;
+    box.min = {aabb.min.x, aabb.min.y, aabb.min.z};
+    box.max = {aabb.max.x, aabb.max.y, aabb.max.z};
+    RenderSystem::getInstance()->getDebugDraw().addBox(box, model, {0.0f, 1.0f, 0.0f}, 1.5f);
+}
 
 void PhysicsRigidBodySandboxDemoLayer::setupRaycastTests() {}
 
@@ -331,6 +346,26 @@ void PhysicsRigidBodySandboxDemoLayer::debugDrawPhxGeometries()
 
         glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
     }
+
+    // the broadphase nodes are collected into the debug draw and rendered in one draw at the end of the frame
+    const phx::PhxBroadphaseTree& broadphase = m_phx_world.getBroadphaseTree();
+    if(m_draw_bvh && !broadphase.empty())
+    {
+        // only the nodes reachable from the root are valid, the node storage is reused between builds
+        const auto&          nodes = broadphase.getNodes();
+        std::vector<PhxUint> stack = {0};
+        while(!stack.empty())
+        {
+            const phx::PhxBvhNode& node = nodes[stack.back()];
+            stack.pop_back();
+            drawAABB(node.aabb, mat4{});
+            if(!node.isLeaf())
+            {
+                stack.push_back(node.idx);
+                stack.push_back(node.idx + 1);
+            }
+        }
+    }
 }
 
 mat4 PhysicsRigidBodySandboxDemoLayer::getRenderingMat4Transform(const PhxMat4& matrix) const
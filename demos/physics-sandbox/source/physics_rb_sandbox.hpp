@@ -72,6 +72,7 @@ private:
     double       m_total_time{0.0};
     bool         m_simulate_physics{false};
     bool         m_reset_simulation{false};
+    bool         m_enable_ccd{true};
 
     phx::rb::PhxRigidBody          m_box_rb;
     phx::rb::PhxRigidBody          m_sphere_rb;
@@ -4,6 +4,7 @@
 #include "phx/phx_utils.hpp"
 
 #include <editor/editor.hpp>
+#include <graphics/api/asset_manager.h>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glad/glad.h>
@@ -230,8 +231,8 @@ void PhysicsSandboxDemoLayer::setupToy()
 {
     // m_suzanne            = Model::LoadModel("../../data/assets/kuma_plushie.glb");
     m_suzanne = Model::LoadModel("../../data/assets/kuma_plushie/scene.gltf");
-    m_cloth_diff_texture =
-        std::make_shared<OglTexture2D>("../../data/assets/kuma_plushie/textures/bake_baseColor.png", false);
+    m_cloth_diff_texture = AssetManager::getInstance()->wait(
+        AssetManager::getInstance()->loadTexture("../../data/assets/kuma_plushie/textures/bake_baseColor.png", false));
 
     const auto& vertices = m_suzanne->getPositions();
     const auto& indices  = m_suzanne->getIndices();
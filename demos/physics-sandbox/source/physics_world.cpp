@@ -3,27 +3,84 @@
 #include "phx/phx_math_utils.hpp"
 
 #include "core/core.h"
+#include "physics/physics_snapshot.h"
+
+#include <algorithm>
+#include <execution>
+#include <ranges>
 
 namespace sputnik::physics
 {
 
+/*!
+ * @brief Sweeps a pair of geometries if the pair is supported by the continuous tests, the sphere always comes first.
+ */
+static bool sweepPair(const PhxGeometry* geometry1,
+                      const PhxGeometry* geometry2,
+                      const PhxReal&     duration,
+                      PhxReal&           toi_out,
+                      PhxContact&        contact_out)
+{
+    using phx::rb::PhxGeometryType;
+
+    if(geometry1->getType() != PhxGeometryType::Sphere)
+    {
+        std::swap(geometry1, geometry2);
+    }
+    if(geometry1->getType() != PhxGeometryType::Sphere)
+    {
+        return false;
+    }
+
+    auto sphere = static_cast<const phx::rb::PhxSphereGeometry*>(geometry1);
+    switch(geometry2->getType())
+    {
+    case PhxGeometryType::Sphere:
+        return phx::rb::phxTimeOfImpact(
+            sphere, static_cast<const phx::rb::PhxSphereGeometry*>(geometry2), duration, toi_out, contact_out);
+    case PhxGeometryType::Box:
+        return phx::rb::phxTimeOfImpact(
+            sphere, static_cast<const phx::rb::PhxBoxGeometry*>(geometry2), duration, toi_out, contact_out);
+    case PhxGeometryType::HalfSpace:
+        return phx::rb::phxTimeOfImpact(
+            sphere, static_cast<const phx::rb::PhxHalfSpaceGeometry*>(geometry2), duration, toi_out, contact_out);
+    default:
+        return false;
+    }
+}
+
 void PhysicsWorld::runPhysics(const PhxReal& duration)
 {
+    SPUTNIK_ASSERT(m_scene_query_scopes == 0, "Physics world stepped while scene queries are running!");
+
+    // A single timer is handed down through the step, every lap is accounted to a stage so the stages add up to the
+    // whole step
+    m_last_step_stats = {};
+    PhysicsStageTimer timer;
+
     // update forces
     m_force_registry.updateForces(duration);
+    m_last_step_stats.force_seconds += timer.lap();
 
     // integrate bodies
-    integrate(duration);
+    integrate(duration, timer);
+
+    // refresh the broadphase for the queries issued until the next step
+    updateSceneQueries();
+    m_last_step_stats.broadphase_seconds += timer.lap();
 }
 
 void PhysicsWorld::addRigidBody(PhxRigidBody* body)
 {
+    SPUTNIK_ASSERT(m_scene_query_scopes == 0, "Physics world modified while scene queries are running!");
     m_rigid_bodies.push_back(body);
 }
 
 void PhysicsWorld::addGeometry(PhxGeometry* geometry)
 {
+    SPUTNIK_ASSERT(m_scene_query_scopes == 0, "Physics world modified while scene queries are running!");
     m_geometries.push_back(geometry);
+    m_scene_queries_dirty = true;
 }
 
 void PhysicsWorld::addForceGenerator(PhxRigidBody* body, PhxRbForceGenerator* fgen)
@@ -50,6 +107,163 @@ Geometries::const_iterator PhysicsWorld::geometriesEnd() const
     return m_geometries.end();
 }
 
+void PhysicsWorld::updateSceneQueries()
+{
+    SPUTNIK_ASSERT(m_scene_query_scopes == 0, "Broadphase rebuilt while scene queries are running!");
+    m_broadphase_tree.build(m_geometries);
+    m_scene_queries_dirty = false;
+}
+
+void PhysicsWorld::beginSceneQueries()
+{
+    if(m_scene_queries_dirty && m_scene_query_scopes == 0)
+    {
+        updateSceneQueries();
+    }
+    ++m_scene_query_scopes;
+}
+
+void PhysicsWorld::endSceneQueries()
+{
+    SPUTNIK_ASSERT(m_scene_query_scopes > 0, "Unbalanced endSceneQueries() call!");
+    --m_scene_query_scopes;
+}
+
+PhxUint PhysicsWorld::raycast(const PhxRay*     rays,
+                              const PhxSize&    count,
+                              PhxSceneQueryHit* out_hits,
+                              const PhxUint&    filter_mask) const
+{
+    std::ranges::iota_view indexes((PhxSize)0, count);
+    return std::transform_reduce(std::execution::par_unseq,
+                                 indexes.begin(),
+                                 indexes.end(),
+                                 PhxUint(0),
+                                 std::plus<PhxUint>(),
+                                 [&](const PhxSize& index) -> PhxUint
+                                 {
+                                     const bool hit = phx::phxSceneRaycast(
+                                         m_broadphase_tree, rays[index], filter_mask, out_hits[index]);
+                                     return hit ? 1 : 0;
+                                 });
+}
+
+PhxUint PhysicsWorld::overlap(const PhxSphereOverlap* spheres,
+                              const PhxSize&          count,
+                              PhxOverlapBuffer*       out_buffers,
+                              const PhxUint&          filter_mask) const
+{
+    std::ranges::iota_view indexes((PhxSize)0, count);
+    return std::transform_reduce(std::execution::par_unseq,
+                                 indexes.begin(),
+                                 indexes.end(),
+                                 PhxUint(0),
+                                 std::plus<PhxUint>(),
+                                 [&](const PhxSize& index) -> PhxUint
+                                 {
+                                     return phx::phxSceneOverlap(
+                                         m_broadphase_tree, spheres[index], filter_mask, out_buffers[index]);
+                                 });
+}
+
+PhxUint PhysicsWorld::sweep(const PhxSphereSweep* sweeps,
+                            const PhxSize&        count,
+                            PhxSceneQueryHit*     out_hits,
+                            const PhxUint&        filter_mask) const
+{
+    std::ranges::iota_view indexes((PhxSize)0, count);
+    return std::transform_reduce(std::execution::par_unseq,
+                                 indexes.begin(),
+                                 indexes.end(),
+                                 PhxUint(0),
+                                 std::plus<PhxUint>(),
+                                 [&](const PhxSize& index) -> PhxUint
+                                 {
+                                     const bool hit = phx::phxSceneSweep(
+                                         m_broadphase_tree, sweeps[index], filter_mask, out_hits[index]);
+                                     return hit ? 1 : 0;
+                                 });
+}
+
+const PhxBroadphaseTree& PhysicsWorld::getBroadphaseTree() const
+{
+    return m_broadphase_tree;
+}
+
+const PhysicsStepStats& PhysicsWorld::getLastStepStats() const
+{
+    return m_last_step_stats;
+}
+
+std::vector<uint8_t> PhysicsWorld::saveSnapshot() const
+{
+    SnapshotWriter writer(SnapshotType::RigidBodyWorld);
+
+    // field by field, the padding of PhxRigidBodyState would make two snapshots of the same world differ
+    writer.write(static_cast<uint64_t>(m_rigid_bodies.size()));
+    for(const PhxRigidBody* rb : m_rigid_bodies)
+    {
+        const PhxRigidBodyState state = rb->getState();
+        writer.write(state.position);
+        writer.write(state.orientation);
+        writer.write(state.linear_velocity);
+        writer.write(state.angular_velocity);
+        writer.write(state.accumulated_force);
+        writer.write(state.accumulated_torque);
+        writer.write(state.motion);
+        writer.write(static_cast<uint8_t>(state.is_awake ? 1 : 0));
+    }
+
+    return writer.release();
+}
+
+bool PhysicsWorld::restoreSnapshot(const std::vector<uint8_t>& snapshot)
+{
+    SPUTNIK_ASSERT(m_scene_query_scopes == 0, "Physics world modified while scene queries are running!");
+
+    SnapshotReader reader(snapshot, SnapshotType::RigidBodyWorld);
+
+    uint64_t num_rigid_bodies{0};
+    reader.read(num_rigid_bodies);
+    if(!reader.isValid() || num_rigid_bodies != m_rigid_bodies.size())
+    {
+        return false;
+    }
+
+    // Decode everything first so that a truncated snapshot leaves the world untouched.
+    std::vector<PhxRigidBodyState> states(m_rigid_bodies.size());
+    for(auto& state : states)
+    {
+        uint8_t is_awake{0};
+        reader.read(state.position);
+        reader.read(state.orientation);
+        reader.read(state.linear_velocity);
+        reader.read(state.angular_velocity);
+        reader.read(state.accumulated_force);
+        reader.read(state.accumulated_torque);
+        reader.read(state.motion);
+        reader.read(is_awake);
+        state.is_awake = is_awake != 0;
+    }
+    if(!reader.isComplete())
+    {
+        return false;
+    }
+
+    for(size_t i = 0; i < m_rigid_bodies.size(); ++i)
+    {
+        m_rigid_bodies[i]->setState(states[i]);
+    }
+
+    for(auto itr = m_geometries.begin(); itr != m_geometries.end(); ++itr)
+    {
+        (*itr)->updateGeometry();
+    }
+    updateSceneQueries();
+
+    return true;
+}
+
 void PhysicsWorld::startFrame()
 {
     for(auto itr = m_rigid_bodies.begin(); itr != m_rigid_bodies.end(); ++itr)
@@ -59,7 +273,7 @@ void PhysicsWorld::startFrame()
     }
 }
 
-void PhysicsWorld::integrate(const PhxReal& duration)
+void PhysicsWorld::integrate(const PhxReal& duration, PhysicsStageTimer& timer)
 {
     // Integrate rigid bodies
     for(auto itr = m_rigid_bodies.begin(); itr != m_rigid_bodies.end(); ++itr)
@@ -69,8 +283,55 @@ void PhysicsWorld::integrate(const PhxReal& duration)
         PhxVec3                total_impluse = rb->getMass() * acceleration * duration;
         rb->applyLinearImpulse(total_impluse, duration);
     }
+    m_last_step_stats.force_seconds += timer.lap();
 
     // Detect collisions and resolve contacts
+    detectAndResolveContacts(duration, timer);
+
+    // Continuous collision detection for bullets. The step is split at each time of impact: all bodies are advanced to
+    // the impact, the contact is resolved and the rest of the step is swept again. Without any bullets in the world
+    // this reduces to a single advance over the whole step.
+    PhxReal remaining = duration;
+    for(PhxUint substep = 0; substep < kMaxToiSubsteps && remaining > phx::kPhxEpsilon; ++substep)
+    {
+        PhxReal    toi = 0.0f;
+        PhxContact contact;
+        const bool impact = findEarliestImpact(remaining, toi, contact);
+        m_last_step_stats.contact_generation_seconds += timer.lap();
+        if(!impact)
+        {
+            break;
+        }
+
+        // The contact is resolved at the impact, a substep that starts in contact still advances by the minimum
+        const PhxReal substep_duration = std::min(std::max(toi, duration * kMinToiSubstepFraction), remaining);
+        advanceBodies(toi);
+        m_last_step_stats.integrate_seconds += timer.lap();
+
+        resolveContact(contact, substep_duration);
+        m_last_step_stats.contact_resolution_seconds += timer.lap();
+        ++m_last_step_stats.contact_count;
+
+        if(substep_duration > toi)
+        {
+            advanceBodies(substep_duration - toi);
+            m_last_step_stats.integrate_seconds += timer.lap();
+        }
+        remaining -= substep_duration;
+    }
+
+    // Update positions
+    if(remaining > 0.0f)
+    {
+        advanceBodies(remaining);
+    }
+    m_last_step_stats.integrate_seconds += timer.lap();
+}
+
+void PhysicsWorld::detectAndResolveContacts(const PhxReal& duration, PhysicsStageTimer& timer)
+{
+    // The clock is only read around the resolution of actual contacts, the pair tests are far too cheap to be timed
+    // individually
     for(auto itr1 = m_geometries.begin(); itr1 != m_geometries.end(); ++itr1)
     {
         for(auto itr2 = itr1 + 1; itr2 != m_geometries.end(); ++itr2)
@@ -99,13 +360,59 @@ void PhysicsWorld::integrate(const PhxReal& duration)
                         // sphere_geom1->m_rigid_body->setVelocity({0.0f, 0.0f, 0.0f});
                         // sphere_geom2->m_rigid_body->setVelocity({0.0f, 0.0f, 0.0f});
 
+                        m_last_step_stats.contact_generation_seconds += timer.lap();
                         resolveContact(contact, duration);
+                        m_last_step_stats.contact_resolution_seconds += timer.lap();
+                        ++m_last_step_stats.contact_count;
                     }
                 }
             }
         }
     }
+    m_last_step_stats.contact_generation_seconds += timer.lap();
+}
+
+bool PhysicsWorld::findEarliestImpact(const PhxReal& duration, PhxReal& toi_out, PhxContact& contact_out) const
+{
+    bool found = false;
+    toi_out    = duration;
+
+    for(auto itr1 = m_geometries.begin(); itr1 != m_geometries.end(); ++itr1)
+    {
+        for(auto itr2 = itr1 + 1; itr2 != m_geometries.end(); ++itr2)
+        {
+            PhxGeometry* geometry1 = *itr1;
+            PhxGeometry* geometry2 = *itr2;
+
+            // Only pairs with at least one bullet are swept, everything else relies on the discrete test
+            if(!geometry1->m_rigid_body->isBullet() && !geometry2->m_rigid_body->isBullet())
+            {
+                continue;
+            }
+
+            // Skip pairs of two static bodies (bodies with infinite mass)
+            if(CMP_FLOAT_EQ(geometry1->m_rigid_body->getInverseMass(), 0.0f) &&
+               CMP_FLOAT_EQ(geometry2->m_rigid_body->getInverseMass(), 0.0f))
+            {
+                continue;
+            }
+
+            PhxReal    toi = 0.0f;
+            PhxContact contact;
+            if(sweepPair(geometry1, geometry2, toi_out, toi, contact) && (!found || toi < toi_out))
+            {
+                found       = true;
+                toi_out     = toi;
+                contact_out = contact;
+            }
+        }
+    }
 
+    return found;
+}
+
+void PhysicsWorld::advanceBodies(const PhxReal& duration)
+{
     // Update positions
     for(auto itr = m_rigid_bodies.begin(); itr != m_rigid_bodies.end(); ++itr)
     {
@@ -5,6 +5,13 @@
 #include "phx/rigidbody/phx_rb_force_generator.hpp"
 #include "phx/rigidbody/phx_rb_geometry.hpp"
 #include "phx/rigidbody/phx_rb_contact.hpp"
+#include "phx/phx_broadphase.hpp"
+#include "phx/phx_scene_query.hpp"
+
+#include "physics/physics_step_stats.h"
+
+#include <atomic>
+#include <cstdint>
 
 namespace sputnik::physics
 {
@@ -15,6 +22,16 @@ using phx::rb::PhxRbForceRegistry;
 using phx::rb::PhxRigidBody;
 using phx::rb::PhxContact;
 
+using phx::kPhxQueryAllLayers;
+using phx::PhxBroadphaseTree;
+using phx::PhxOverlapBuffer;
+using phx::PhxRay;
+using phx::PhxSceneQueryHit;
+using phx::PhxSphereOverlap;
+using phx::PhxSphereSweep;
+
+using phx::rb::PhxRigidBodyState;
+
 using RigidBodies = std::vector<PhxRigidBody*>;
 using Geometries  = std::vector<PhxGeometry*>;
 
@@ -36,15 +53,122 @@ public:
     Geometries::const_iterator  geometriesBegin() const;
     Geometries::const_iterator  geometriesEnd() const;
 
+    ////////// Scene queries //////////
+
+    /*!
+     * @brief Rebuilds the broadphase tree used by the scene queries. It's done at the end of every step; call it
+     * explicitly only after moving geometries outside of runPhysics().
+     */
+    void updateSceneQueries();
+
+    /*!
+     * @brief Enters the read only mode. Until the matching endSceneQueries() call the world must not be stepped or
+     * modified, while any number of threads may issue queries. Must be called from the thread that owns the world.
+     */
+    void beginSceneQueries();
+
+    void endSceneQueries();
+
+    /*!
+     * @brief Casts a batch of rays, finding the closest hit of each. Rays are processed in parallel.
+     * @param rays Normalized rays, ray.t is the maximum distance
+     * @param count Number of rays
+     * @param out_hits Caller owned buffer of at least count results, a miss leaves a reset result
+     * @param filter_mask Only geometries whose layers intersect the mask are considered
+     * @return Number of rays that hit a geometry.
+     */
+    PhxUint raycast(const PhxRay*     rays,
+                    const PhxSize&    count,
+                    PhxSceneQueryHit* out_hits,
+                    const PhxUint&    filter_mask = kPhxQueryAllLayers) const;
+
+    /*!
+     * @brief Collects the geometries overlapping each sphere of a batch. Spheres are processed in parallel.
+     * @param out_buffers Caller owned buffers, one per sphere
+     * @return Total number of overlaps written to the buffers.
+     */
+    PhxUint overlap(const PhxSphereOverlap* spheres,
+                    const PhxSize&          count,
+                    PhxOverlapBuffer*       out_buffers,
+                    const PhxUint&          filter_mask = kPhxQueryAllLayers) const;
+
+    /*!
+     * @brief Sweeps a batch of spheres, finding the first hit of each. Sweeps are processed in parallel.
+     * @return Number of sweeps that hit a geometry.
+     */
+    PhxUint sweep(const PhxSphereSweep* sweeps,
+                  const PhxSize&        count,
+                  PhxSceneQueryHit*     out_hits,
+                  const PhxUint&        filter_mask = kPhxQueryAllLayers) const;
+
+    const PhxBroadphaseTree& getBroadphaseTree() const;
+
+    /*!
+     * @brief Per stage timings of the last runPhysics() call. Gravity counts towards the force stage, time of impact
+     * sweeps towards contact generation.
+     */
+    const PhysicsStepStats& getLastStepStats() const;
+
+    ////////// Snapshots //////////
+
+    /*!
+     * @brief Captures the dynamic state of all rigid bodies. The simulation is single threaded and visits bodies and
+     * geometry pairs in insertion order, so stepping a restored world reproduces the original run bitwise.
+     */
+    std::vector<uint8_t> saveSnapshot() const;
+
+    /*!
+     * @brief Restores a snapshot taken with saveSnapshot(). The world must contain the same bodies, in the same order,
+     * as when the snapshot was taken.
+     * @return True on success. On failure the world is left untouched.
+     */
+    bool restoreSnapshot(const std::vector<uint8_t>& snapshot);
+
 protected:
-    void integrate(const PhxReal& duration);
+    void integrate(const PhxReal& duration, PhysicsStageTimer& timer);
+
+    /*!
+     * @brief Runs the discrete overlap test on every pair of geometries and resolves the detected contacts.
+     */
+    void detectAndResolveContacts(const PhxReal& duration, PhysicsStageTimer& timer);
+
+    /*!
+     * @brief Sweeps every pair of geometries that involves a bullet body over the given interval and returns the
+     * earliest time of impact. Spheres are swept against spheres, boxes and half spaces, other pairs are left to the
+     * discrete test (see phx::rb::phxTimeOfImpact()).
+     * @return True, if an impact happens within the interval, false otherwise.
+     */
+    bool findEarliestImpact(const PhxReal& duration, PhxReal& toi_out, PhxContact& contact_out) const;
+
+    /*!
+     * @brief Integrates positions and orientations of all bodies and updates the attached geometries.
+     */
+    void advanceBodies(const PhxReal& duration);
 
     void resolveContact(const PhxContact& contact, const PhxReal& dt);
 
 protected:
+    /*!
+     * @brief Upper limit on the number of time of impact substeps taken by the bullets in a single step. Once reached,
+     * the remainder of the step is integrated without further sweeps.
+     */
+    static constexpr PhxUint kMaxToiSubsteps = 8;
+
+    /*!
+     * @brief Smallest fraction of the step a time of impact substep advances the world by, so that contacts found at
+     * the start of a substep (e.g. a bullet resting on a box) can not use up the substeps without making progress.
+     */
+    static constexpr PhxReal kMinToiSubstepFraction = 1.0f / (4.0f * kMaxToiSubsteps);
+
     RigidBodies        m_rigid_bodies;
     Geometries         m_geometries;
     PhxRbForceRegistry m_force_registry;
+
+    PhxBroadphaseTree    m_broadphase_tree;
+    bool                 m_scene_queries_dirty{true};
+    std::atomic<PhxUint> m_scene_query_scopes{0};
+
+    PhysicsStepStats m_last_step_stats;
 };
 
 } // namespace sputnik::physics
@@ -10,6 +10,7 @@
 #include <imgui.h>
 #include <graphics/core/animation/rearrange_bones.h>
 #include <editor/editor_camera.h>
+#include <graphics/api/asset_manager.h>
 // #include <graphics/api/renderer.h>
 
 #include <glad/glad.h>
@@ -83,7 +84,8 @@ void VertexSkinningDemo::OnAttach()
 
     cgltf_data* gltf = sputnik::gltf::GltfLoader::LoadFile("../../data/assets/Woman.gltf");
     // m_diffuse_texture = std::make_shared<sputnik::graphics::glcore::Texture>("../../data/assets/Woman.png");
-    m_diffuse_texture = std::make_shared<OglTexture2D>("../../data/assets/Woman.png", false);
+    m_diffuse_texture = AssetManager::getInstance()->wait(
+        AssetManager::getInstance()->loadTexture("../../data/assets/Woman.png", false));
 
     // cgltf_data* gltf  = sputnik::gltf::GltfLoader::LoadFile("../../data/assets/Fox/Fox.gltf");
     // m_diffuse_texture = std::make_shared<sputnik::graphics::glcore::Texture>("../../data/assets/Fox/Texture.png");
@@ -138,7 +140,8 @@ void VertexSkinningDemo::OnAttach()
     // sputnik::gltf::GltfLoader::FreeFile(gltf);
 
     cgltf_data* gltf_static_mesh = sputnik::gltf::GltfLoader::LoadFile("../../data/assets/sphere.gltf");
-    m_static_mesh_texture        = std::make_shared<OglTexture2D>("../../data/assets/dq.png");
+    m_static_mesh_texture =
+        AssetManager::getInstance()->wait(AssetManager::getInstance()->loadTexture("../../data/assets/dq.png"));
     // cgltf_data* gltf_static_mesh = sputnik::gltf::GltfLoader::LoadFile("../../data/assets/IKCourse.gltf");
     m_static_meshes = sputnik::gltf::GltfLoader::LoadMeshes(gltf_static_mesh);
 
@@ -0,0 +1,145 @@
+#include "pch.h"
+#include "file_watcher.h"
+
+#if defined(__linux__)
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+namespace sputnik::core
+{
+
+std::string FileWatcher::normalizePath(const std::filesystem::path& path)
+{
+    return path.lexically_normal().generic_string();
+}
+
+#if defined(__linux__)
+
+FileWatcher::FileWatcher()
+{
+    m_inotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if(m_inotify < 0)
+    {
+        ENGINE_WARN("Could not initialize inotify, file changes are not reported.");
+    }
+}
+
+FileWatcher::~FileWatcher()
+{
+    if(m_inotify >= 0)
+    {
+        ::close(m_inotify);
+    }
+}
+
+void FileWatcher::watch(const std::string& path)
+{
+    const std::string file = normalizePath(path);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if(m_inotify < 0 || !m_files.insert(file).second)
+    {
+        return;
+    }
+
+    std::string directory = std::filesystem::path(file).parent_path().generic_string();
+    directory             = directory.empty() ? "." : directory;
+
+    // Reference: https://man7.org/linux/man-pages/man7/inotify.7.html
+    // watching a directory again returns the descriptor of its existing watch
+    const int descriptor = inotify_add_watch(m_inotify, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE);
+    if(descriptor < 0)
+    {
+        ENGINE_WARN("Could not watch {}, changes to {} are not reported.", directory, file);
+        return;
+    }
+    m_directories[descriptor] = directory;
+}
+
+std::vector<std::string> FileWatcher::waitForChanges(const u32& timeout_ms)
+{
+    std::vector<std::string> changes;
+    if(m_inotify < 0)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(timeout_ms));
+        return changes;
+    }
+
+    pollfd descriptor{m_inotify, POLLIN, 0};
+    if(poll(&descriptor, 1, (int)timeout_ms) <= 0)
+    {
+        return changes;
+    }
+
+    alignas(inotify_event) char buffer[4096];
+    std::lock_guard<std::mutex> lock(m_mutex);
+    ssize_t                     bytes = 0;
+    while((bytes = read(m_inotify, buffer, sizeof(buffer))) > 0)
+    {
+        for(const char* cursor = buffer; cursor < buffer + bytes;)
+        {
+            const inotify_event* event = (const inotify_event*)cursor;
+            cursor += sizeof(inotify_event) + event->len;
+
+            auto directory = m_directories.find(event->wd);
+            if(event->len == 0 || directory == m_directories.end())
+            {
+                continue;
+            }
+            std::string file = normalizePath(std::filesystem::path(directory->second) / event->name);
+            if(m_files.contains(file) && std::find(changes.begin(), changes.end(), file) == changes.end())
+            {
+                changes.push_back(std::move(file));
+            }
+        }
+    }
+    return changes;
+}
+
+#else
+
+FileWatcher::FileWatcher() {}
+
+FileWatcher::~FileWatcher() {}
+
+void FileWatcher::watch(const std::string& path)
+{
+    const std::string file = normalizePath(path);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if(m_files.insert(file).second)
+    {
+        std::error_code error;
+        m_write_times[file] = std::filesystem::last_write_time(file, error);
+    }
+}
+
+std::vector<std::string> FileWatcher::waitForChanges(const u32& timeout_ms)
+{
+    std::this_thread::sleep_for(std::chrono::milliseconds(timeout_ms));
+
+    std::vector<std::string>    changes;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for(auto& [file, write_time] : m_write_times)
+    {
+        // a file that is being replaced may briefly not exist, it is reported once it is back
+        std::error_code                       error;
+        const std::filesystem::file_time_type current_write_time = std::filesystem::last_write_time(file, error);
+        if(!error && current_write_time != write_time)
+        {
+            write_time = current_write_time;
+            changes.push_back(file);
+        }
+    }
+    return changes;
+}
+
+#endif
+
+} // namespace sputnik::core
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "core/core.h"
+
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace sputnik::core
+{
+
+/*!
+ * @brief Reports changes to a set of files.
+ *
+ * @details On Linux the directories of the files are watched with inotify. Editors often save by writing a new file
+ * and renaming it over the old one, which a watch on the file itself would miss. Elsewhere the modification times of
+ * the files are compared every time waitForChanges() is called.
+ *
+ * Paths are compared lexically normalized with forward slashes, waitForChanges() returns them in that form. watch()
+ * can be called while another thread waits for changes.
+ */
+class FileWatcher
+{
+public:
+    FileWatcher();
+    ~FileWatcher();
+
+    NON_COPYABLE(FileWatcher);
+
+    void watch(const std::string& path);
+
+    /*!
+     * @brief Blocks until a watched file changes or timeout_ms passed, and returns the files that changed, each once.
+     */
+    std::vector<std::string> waitForChanges(const u32& timeout_ms);
+
+    static std::string normalizePath(const std::filesystem::path& path);
+
+private:
+    std::mutex                      m_mutex;
+    std::unordered_set<std::string> m_files;
+
+#if defined(__linux__)
+    int                                  m_inotify{-1};
+    std::unordered_map<int, std::string> m_directories; // by watch descriptor
+#else
+    std::unordered_map<std::string, std::filesystem::file_time_type> m_write_times;
+#endif
+};
+
+} // namespace sputnik::core
@@ -0,0 +1,185 @@
+#include "pch.h"
+#include "mapped_file.h"
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <utility>
+
+namespace sputnik::core
+{
+
+MappedFile::MappedFile() {}
+
+MappedFile::~MappedFile()
+{
+    close();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+{
+    *this = std::move(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+{
+    if(this != &other)
+    {
+        close();
+        m_data = std::exchange(other.m_data, nullptr);
+        m_size = std::exchange(other.m_size, 0);
+        m_path = std::move(other.m_path);
+#if defined(_WIN32)
+        m_file    = std::exchange(other.m_file, nullptr);
+        m_mapping = std::exchange(other.m_mapping, nullptr);
+#endif
+    }
+    return *this;
+}
+
+#if defined(_WIN32)
+
+bool MappedFile::open(const std::string& path)
+{
+    close();
+
+    HANDLE file = CreateFileA(path.c_str(),
+                              GENERIC_READ,
+                              FILE_SHARE_READ,
+                              nullptr,
+                              OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
+                              nullptr);
+    if(file == INVALID_HANDLE_VALUE)
+    {
+        ENGINE_ERROR("Could not open {} for mapping.", path);
+        return false;
+    }
+
+    LARGE_INTEGER size{};
+    if(!GetFileSizeEx(file, &size) || size.QuadPart == 0)
+    {
+        ENGINE_ERROR("Could not map {}, the file is empty.", path);
+        CloseHandle(file);
+        return false;
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    void*  data    = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+    if(data == nullptr)
+    {
+        ENGINE_ERROR("Could not map {} (error {}).", path, (u32)GetLastError());
+        if(mapping)
+        {
+            CloseHandle(mapping);
+        }
+        CloseHandle(file);
+        return false;
+    }
+
+    m_file    = file;
+    m_mapping = mapping;
+    m_data    = (const u8*)data;
+    m_size    = (u64)size.QuadPart;
+    m_path    = path;
+    return true;
+}
+
+void MappedFile::close()
+{
+    if(m_data)
+    {
+        UnmapViewOfFile(m_data);
+        CloseHandle(m_mapping);
+        CloseHandle(m_file);
+    }
+    m_data    = nullptr;
+    m_size    = 0;
+    m_file    = nullptr;
+    m_mapping = nullptr;
+    m_path.clear();
+}
+
+#else
+
+bool MappedFile::open(const std::string& path)
+{
+    close();
+
+    const int file = ::open(path.c_str(), O_RDONLY);
+    if(file < 0)
+    {
+        ENGINE_ERROR("Could not open {} for mapping.", path);
+        return false;
+    }
+
+    struct stat status{};
+    if(fstat(file, &status) != 0 || status.st_size == 0)
+    {
+        ENGINE_ERROR("Could not map {}, the file is empty.", path);
+        ::close(file);
+        return false;
+    }
+
+    // the mapping keeps its own reference to the file
+    void* data = mmap(nullptr, (size_t)status.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+    ::close(file);
+    if(data == MAP_FAILED)
+    {
+        ENGINE_ERROR("Could not map {}.", path);
+        return false;
+    }
+
+    m_data = (const u8*)data;
+    m_size = (u64)status.st_size;
+    m_path = path;
+    return true;
+}
+
+void MappedFile::close()
+{
+    if(m_data)
+    {
+        munmap((void*)m_data, (size_t)m_size);
+    }
+    m_data = nullptr;
+    m_size = 0;
+    m_path.clear();
+}
+
+#endif
+
+bool MappedFile::isOpen() const
+{
+    return m_data != nullptr;
+}
+
+const u8* MappedFile::getData() const
+{
+    return m_data;
+}
+
+u64 MappedFile::getSize() const
+{
+    return m_size;
+}
+
+std::span<const u8> MappedFile::getBytes() const
+{
+    return {m_data, (size_t)m_size};
+}
+
+const std::string& MappedFile::getPath() const
+{
+    return m_path;
+}
+
+} // namespace sputnik::core
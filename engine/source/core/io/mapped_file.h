@@ -0,0 +1,52 @@
+#pragma once
+
+#include "core/core.h"
+
+#include <span>
+#include <string>
+
+namespace sputnik::core
+{
+
+/*!
+ * @brief Read only memory mapping of a whole file.
+ *
+ * @details The pages are brought in by the OS as they are touched, so the data can be handed to the GPU straight from
+ * the mapping without reading it into an intermediate buffer first. The mapping stays valid until the file is closed
+ * or the object is destroyed.
+ */
+class MappedFile
+{
+public:
+    MappedFile();
+    ~MappedFile();
+
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    NON_COPYABLE(MappedFile);
+
+    /*!
+     * @brief Maps the file at path, returns false (and logs) when it can not be opened. Empty files can not be mapped.
+     */
+    bool open(const std::string& path);
+    void close();
+
+    bool                isOpen() const;
+    const u8*           getData() const;
+    u64                 getSize() const;
+    std::span<const u8> getBytes() const;
+    const std::string&  getPath() const;
+
+private:
+    const u8*   m_data{nullptr};
+    u64         m_size{0};
+    std::string m_path;
+
+#if defined(_WIN32)
+    void* m_file{nullptr};
+    void* m_mapping{nullptr};
+#endif
+};
+
+} // namespace sputnik::core
@@ -0,0 +1,343 @@
+#include "pch.h"
+#include "import_profiler.h"
+#include "json_writer.h"
+#include "profiler.h"
+
+#include <imgui.h>
+
+#include <algorithm>
+#include <fstream>
+
+namespace sputnik::core
+{
+
+namespace
+{
+
+const char* kImportStageNames[] = {"Parse file",
+                                   "Load meshes",
+                                   "Load skeleton",
+                                   "Load animation clips",
+                                   "Cook meshes",
+                                   "Read cooked",
+                                   "Decode image",
+                                   "Upload"};
+
+static_assert(sizeof(kImportStageNames) / sizeof(kImportStageNames[0]) == (size_t)ImportStage::Count,
+              "Every import stage needs a name.");
+
+// the paths of the scopes open on every thread, an import never crosses threads
+thread_local std::vector<const std::string*> t_import_paths;
+
+double toMilliseconds(const u64& ns)
+{
+    return (double)ns * 1e-6;
+}
+
+double toKibibytes(const u64& bytes)
+{
+    return (double)bytes / 1024.0;
+}
+
+void writeJsonBytes(std::ofstream& stream, const u64& read, const u64& allocated, const u64& uploaded)
+{
+    stream << "\"bytes_read\":" << read << ",\"bytes_allocated\":" << allocated << ",\"bytes_uploaded\":" << uploaded;
+}
+
+} // namespace
+
+const char* getImportStageName(const ImportStage& stage)
+{
+    return kImportStageNames[(u32)stage];
+}
+
+u64 AssetImportReport::getBytesRead() const
+{
+    u64 bytes = 0;
+    for(const ImportStageStatistics& stage : stages)
+    {
+        bytes += stage.bytes_read;
+    }
+    return bytes;
+}
+
+u64 AssetImportReport::getBytesAllocated() const
+{
+    u64 bytes = 0;
+    for(const ImportStageStatistics& stage : stages)
+    {
+        bytes += stage.bytes_allocated;
+    }
+    return bytes;
+}
+
+u64 AssetImportReport::getBytesUploaded() const
+{
+    u64 bytes = 0;
+    for(const ImportStageStatistics& stage : stages)
+    {
+        bytes += stage.bytes_uploaded;
+    }
+    return bytes;
+}
+
+ImportProfiler* ImportProfiler::getInstance()
+{
+    static ImportProfiler instance;
+    return &instance;
+}
+
+void ImportProfiler::record(const std::string&           path,
+                            const ImportStage&           stage,
+                            const ImportStageStatistics& statistics,
+                            const bool&                  outermost)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    AssetImportReport&          report = m_reports[path];
+    report.path                        = path;
+
+    ImportStageStatistics& totals = report.stages[(u32)stage];
+    totals.wall_ns += statistics.wall_ns;
+    totals.bytes_read += statistics.bytes_read;
+    totals.bytes_allocated += statistics.bytes_allocated;
+    totals.bytes_uploaded += statistics.bytes_uploaded;
+    totals.calls += statistics.calls;
+    if(outermost)
+    {
+        report.total_ns += statistics.wall_ns;
+    }
+}
+
+std::vector<AssetImportReport> ImportProfiler::getReports() const
+{
+    std::vector<AssetImportReport> reports;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        reports.reserve(m_reports.size());
+        for(const auto& [path, report] : m_reports)
+        {
+            reports.push_back(report);
+        }
+    }
+    std::sort(reports.begin(),
+              reports.end(),
+              [](const AssetImportReport& a, const AssetImportReport& b) { return a.total_ns > b.total_ns; });
+    return reports;
+}
+
+void ImportProfiler::clear()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_reports.clear();
+}
+
+void ImportProfiler::logReport() const
+{
+    const std::vector<AssetImportReport> reports  = getReports();
+    u64                                  total_ns = 0;
+    for(const AssetImportReport& report : reports)
+    {
+        total_ns += report.total_ns;
+    }
+    ENGINE_INFO("Imported {} assets in {:.2f} ms", reports.size(), toMilliseconds(total_ns));
+
+    for(const AssetImportReport& report : reports)
+    {
+        ENGINE_INFO("{}: {:.2f} ms, {:.1f} KiB read, {:.1f} KiB allocated, {:.1f} KiB uploaded",
+                    report.path,
+                    toMilliseconds(report.total_ns),
+                    toKibibytes(report.getBytesRead()),
+                    toKibibytes(report.getBytesAllocated()),
+                    toKibibytes(report.getBytesUploaded()));
+        for(u32 stage = 0; stage < (u32)ImportStage::Count; ++stage)
+        {
+            const ImportStageStatistics& statistics = report.stages[stage];
+            if(statistics.calls == 0)
+            {
+                continue;
+            }
+            ENGINE_INFO("    {}: {:.2f} ms in {} calls, {:.1f} KiB read, {:.1f} KiB allocated, {:.1f} KiB uploaded",
+                        kImportStageNames[stage],
+                        toMilliseconds(statistics.wall_ns),
+                        statistics.calls,
+                        toKibibytes(statistics.bytes_read),
+                        toKibibytes(statistics.bytes_allocated),
+                        toKibibytes(statistics.bytes_uploaded));
+        }
+    }
+}
+
+bool ImportProfiler::writeJson(const std::string& path) const
+{
+    std::ofstream stream(path);
+    if(!stream)
+    {
+        return false;
+    }
+
+    const std::vector<AssetImportReport> reports = getReports();
+    stream << "{\"assets\":[";
+    for(size_t i = 0; i < reports.size(); ++i)
+    {
+        const AssetImportReport& report = reports[i];
+        stream << (i > 0 ? "," : "") << "{\"path\":";
+        writeJsonString(stream, report.path);
+        stream << ",\"ms\":" << toMilliseconds(report.total_ns) << ",";
+        writeJsonBytes(stream, report.getBytesRead(), report.getBytesAllocated(), report.getBytesUploaded());
+
+        stream << ",\"stages\":{";
+        bool first = true;
+        for(u32 stage = 0; stage < (u32)ImportStage::Count; ++stage)
+        {
+            const ImportStageStatistics& statistics = report.stages[stage];
+            if(statistics.calls == 0)
+            {
+                continue;
+            }
+            stream << (first ? "" : ",") << "\"" << kImportStageNames[stage]
+                   << "\":{\"ms\":" << toMilliseconds(statistics.wall_ns) << ",\"calls\":" << statistics.calls << ",";
+            writeJsonBytes(stream, statistics.bytes_read, statistics.bytes_allocated, statistics.bytes_uploaded);
+            stream << "}";
+            first = false;
+        }
+        stream << "}}";
+    }
+    stream << "]}\n";
+    return (bool)stream;
+}
+
+void ImportProfiler::drawUI()
+{
+    if(ImGui::Begin("Asset Imports"))
+    {
+        const std::vector<AssetImportReport> reports = getReports();
+
+        if(ImGui::Button("Log report"))
+        {
+            logReport();
+        }
+        ImGui::SameLine();
+        if(ImGui::Button("Write JSON"))
+        {
+            if(writeJson())
+            {
+                ENGINE_INFO("Import report of {} assets written to sputnik_imports.json", reports.size());
+            }
+            else
+            {
+                ENGINE_ERROR("Failed to write the import report to sputnik_imports.json");
+            }
+        }
+        ImGui::SameLine();
+        if(ImGui::Button("Clear"))
+        {
+            clear();
+        }
+
+        // sorted by import time, the slowest assets first, the stages of an asset are listed under it
+        ImGui::Separator();
+        ImGui::Columns(6, "imports");
+        for(const char* header : {"asset", "ms", "read KiB", "allocated KiB", "uploaded KiB", "calls"})
+        {
+            ImGui::Text("%s", header);
+            ImGui::NextColumn();
+        }
+        for(const AssetImportReport& report : reports)
+        {
+            const bool open = ImGui::TreeNode(report.path.c_str());
+            ImGui::NextColumn();
+            for(const double& value : {toMilliseconds(report.total_ns),
+                                       toKibibytes(report.getBytesRead()),
+                                       toKibibytes(report.getBytesAllocated()),
+                                       toKibibytes(report.getBytesUploaded())})
+            {
+                ImGui::Text("%.2f", value);
+                ImGui::NextColumn();
+            }
+            ImGui::NextColumn();
+            if(!open)
+            {
+                continue;
+            }
+
+            for(u32 stage = 0; stage < (u32)ImportStage::Count; ++stage)
+            {
+                const ImportStageStatistics& statistics = report.stages[stage];
+                if(statistics.calls == 0)
+                {
+                    continue;
+                }
+                ImGui::Text("%s", kImportStageNames[stage]);
+                ImGui::NextColumn();
+                for(const double& value : {toMilliseconds(statistics.wall_ns),
+                                           toKibibytes(statistics.bytes_read),
+                                           toKibibytes(statistics.bytes_allocated),
+                                           toKibibytes(statistics.bytes_uploaded)})
+                {
+                    ImGui::Text("%.2f", value);
+                    ImGui::NextColumn();
+                }
+                ImGui::Text("%u", statistics.calls);
+                ImGui::NextColumn();
+            }
+            ImGui::TreePop();
+        }
+        ImGui::Columns(1);
+    }
+    ImGui::End();
+}
+
+ImportScope::ImportScope(const std::string& path, const ImportStage& stage) : m_path(path), m_stage(stage)
+{
+    if(m_path.empty() && !t_import_paths.empty())
+    {
+        m_path = *t_import_paths.back();
+    }
+    if(!m_path.empty())
+    {
+        begin();
+    }
+}
+
+ImportScope::ImportScope(const ImportStage& stage) : ImportScope(std::string(), stage) {}
+
+ImportScope::~ImportScope()
+{
+    if(!m_active)
+    {
+        return;
+    }
+
+    m_statistics.wall_ns = Profiler::getInstance()->now() - m_start_ns;
+    m_statistics.calls   = 1;
+    Profiler::getInstance()->endScope();
+    t_import_paths.pop_back();
+    ImportProfiler::getInstance()->record(m_path, m_stage, m_statistics, m_outermost);
+}
+
+void ImportScope::addBytesRead(const u64& bytes)
+{
+    m_statistics.bytes_read += bytes;
+}
+
+void ImportScope::addBytesAllocated(const u64& bytes)
+{
+    m_statistics.bytes_allocated += bytes;
+}
+
+void ImportScope::addBytesUploaded(const u64& bytes)
+{
+    m_statistics.bytes_uploaded += bytes;
+}
+
+void ImportScope::begin()
+{
+    // an asset imported while importing another one, e.g. a texture of a model, has its own total
+    m_active    = true;
+    m_outermost = t_import_paths.empty() || *t_import_paths.back() != m_path;
+    t_import_paths.push_back(&m_path);
+    Profiler::getInstance()->beginScope(kImportStageNames[(u32)m_stage]);
+    m_start_ns = Profiler::getInstance()->now();
+}
+
+} // namespace sputnik::core
@@ -0,0 +1,122 @@
+#pragma once
+
+#include "core/core.h"
+
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace sputnik::core
+{
+
+/*!
+ * @brief Stages of an asset import. A stage can run inside another one, e.g. the GPU uploads of LoadMeshes.
+ */
+enum class ImportStage : u8
+{
+    ParseFile = 0,      // gltf::GltfLoader::LoadFile()
+    LoadMeshes,         // gltf::GltfLoader::LoadMeshes()
+    LoadSkeleton,       // gltf::GltfLoader::LoadSkeleton()
+    LoadAnimationClips, // gltf::GltfLoader::LoadAnimationClips()
+    CookMeshes,         // MeshCooker::cook()
+    ReadCooked,         // mapping and loading a cooked model
+    DecodeImage,        // stbi_load() and DDS parsing
+    Upload,             // buffer and texture uploads
+    Count
+};
+
+const char* getImportStageName(const ImportStage& stage);
+
+/*!
+ * @brief Totals of one stage of an asset import, over every time the stage ran for the asset.
+ */
+struct ImportStageStatistics
+{
+    u64 wall_ns{0};
+    u64 bytes_read{0};      // from disk
+    u64 bytes_allocated{0}; // CPU memory the stage allocated for the asset, scratch memory excluded
+    u64 bytes_uploaded{0};  // to the GPU
+    u32 calls{0};
+};
+
+struct AssetImportReport
+{
+    std::string           path;
+    ImportStageStatistics stages[(u32)ImportStage::Count];
+    u64                   total_ns{0}; // of the outermost stages, the stage times include the stages they ran
+
+    u64 getBytesRead() const;
+    u64 getBytesAllocated() const;
+    u64 getBytesUploaded() const;
+};
+
+/*!
+ * @brief Collects where the time and memory of asset imports go, per asset and per stage.
+ *
+ * @details Imports are instrumented with ImportScope. The report of every asset imported since the last clear() can
+ * be logged, written as JSON or browsed in the import panel. The stages also show up in the profiler as CPU scopes, so
+ * a Chrome trace captured while loading shows when they ran and on which thread.
+ */
+class ImportProfiler
+{
+public:
+    static ImportProfiler* getInstance();
+
+    NON_COPYABLE(ImportProfiler);
+
+    void record(const std::string&           path,
+                const ImportStage&           stage,
+                const ImportStageStatistics& statistics,
+                const bool&                  outermost);
+
+    /*!
+     * @brief The reports of the imported assets, the slowest first.
+     */
+    std::vector<AssetImportReport> getReports() const;
+    void                           clear();
+
+    void logReport() const;
+    bool writeJson(const std::string& path = "sputnik_imports.json") const;
+
+    void drawUI();
+
+private:
+    ImportProfiler() = default;
+
+    mutable std::mutex                                 m_mutex;
+    std::unordered_map<std::string, AssetImportReport> m_reports;
+};
+
+/*!
+ * @brief Times the enclosing block as a stage of the import of an asset and collects its byte counts.
+ *
+ * @details A scope constructed without a path, or with an empty one, belongs to the innermost scope open on the
+ * thread, which lets shared code such as mesh uploads report to whatever asset is being imported. Outside of an import
+ * it records nothing.
+ */
+class ImportScope
+{
+public:
+    ImportScope(const std::string& path, const ImportStage& stage);
+    explicit ImportScope(const ImportStage& stage);
+    ~ImportScope();
+
+    NON_COPYABLE(ImportScope);
+
+    void addBytesRead(const u64& bytes);
+    void addBytesAllocated(const u64& bytes);
+    void addBytesUploaded(const u64& bytes);
+
+private:
+    void begin();
+
+    std::string           m_path;
+    ImportStage           m_stage;
+    bool                  m_active{false};
+    bool                  m_outermost{false};
+    u64                   m_start_ns{0};
+    ImportStageStatistics m_statistics;
+};
+
+} // namespace sputnik::core
@@ -0,0 +1,30 @@
+#include "pch.h"
+#include "json_writer.h"
+
+namespace sputnik::core
+{
+
+void writeJsonString(std::ostream& stream, const std::string_view& text)
+{
+    constexpr char kHexDigits[] = "0123456789abcdef";
+
+    stream << '"';
+    for(const char& c : text)
+    {
+        const u8 byte = (u8)c;
+        if(byte < 0x20)
+        {
+            // control characters are not allowed in JSON strings
+            stream << "\\u00" << kHexDigits[byte >> 4] << kHexDigits[byte & 0xf];
+            continue;
+        }
+        if(c == '"' || c == '\\')
+        {
+            stream << '\\';
+        }
+        stream << c;
+    }
+    stream << '"';
+}
+
+} // namespace sputnik::core
@@ -0,0 +1,16 @@
+#pragma once
+
+#include "core/core.h"
+
+#include <ostream>
+#include <string_view>
+
+namespace sputnik::core
+{
+
+/*!
+ * @brief Writes text as a quoted JSON string, escaping quotes, backslashes and control characters.
+ */
+void writeJsonString(std::ostream& stream, const std::string_view& text);
+
+} // namespace sputnik::core
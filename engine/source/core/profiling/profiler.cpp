@@ -0,0 +1,282 @@
+#include "pch.h"
+#include "profiler.h"
+#include "json_writer.h"
+
+#include <imgui.h>
+
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+
+namespace sputnik::core
+{
+
+// Useful references:
+// https://docs.google.com/document/d/1CvAClvFfyA5R-PhYUmn5OOQtYMH4h6I0nSsKchNAySU (Trace Event Format)
+
+namespace
+{
+
+struct OpenScope
+{
+    const char* name;
+    u64         start_ns;
+};
+
+// every thread keeps the stack of its open scopes, scopes never cross threads
+thread_local std::vector<OpenScope> t_open_scopes;
+
+u32 getThreadIndex()
+{
+    static std::atomic<u32> thread_count{0};
+    thread_local const u32  thread_index = thread_count++;
+    return thread_index;
+}
+
+const char* kTrackNames[] = {"CPU", "GPU"};
+
+} // namespace
+
+Profiler* Profiler::getInstance()
+{
+    static Profiler instance;
+    return &instance;
+}
+
+Profiler::Profiler() : m_epoch(std::chrono::steady_clock::now()) {}
+
+u64 Profiler::now() const
+{
+    return (u64)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_epoch)
+        .count();
+}
+
+void Profiler::beginFrame()
+{
+    m_frame_start_ns = now();
+}
+
+void Profiler::endFrame()
+{
+    const u64 frame_end_ns = now();
+    record(ProfileTrack::Cpu, "Frame", m_frame_start_ns, frame_end_ns - m_frame_start_ns, getThreadIndex());
+
+    // a finished capture is moved out under the lock and written after it is released, the file is never written
+    // while recording threads wait for the lock
+    std::vector<TraceEvent> captured_events;
+    std::string             capture_path;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for(auto& track_scopes : m_scopes)
+        {
+            for(auto& [name, scope] : track_scopes)
+            {
+                scope.history[scope.head] = (float)((double)scope.frame_ns * 1e-6);
+                scope.head                = (scope.head + 1) % kHistoryLength;
+                scope.count               = std::min(scope.count + 1, kHistoryLength);
+
+                ProfileStatistics& statistics = scope.statistics;
+                statistics.last_ms            = (float)((double)scope.frame_ns * 1e-6);
+                statistics.calls              = scope.frame_calls;
+                statistics.min_ms             = scope.history[0];
+                statistics.max_ms             = scope.history[0];
+                float sum                     = 0.0f;
+                for(u32 i = 0; i < scope.count; ++i)
+                {
+                    statistics.min_ms = std::min(statistics.min_ms, scope.history[i]);
+                    statistics.max_ms = std::max(statistics.max_ms, scope.history[i]);
+                    sum += scope.history[i];
+                }
+                statistics.average_ms = sum / (float)scope.count;
+
+                scope.frame_ns    = 0;
+                scope.frame_calls = 0;
+            }
+        }
+
+        if(m_capture_frames_left > 0 && --m_capture_frames_left == 0)
+        {
+            captured_events.swap(m_trace_events);
+            capture_path = m_capture_path;
+        }
+    }
+
+    if(capture_path.empty())
+    {
+        return;
+    }
+    if(writeChromeTrace(capture_path, captured_events))
+    {
+        ENGINE_INFO("Profiler capture of {} events written to {}", captured_events.size(), capture_path);
+    }
+    else
+    {
+        ENGINE_ERROR("Failed to write the profiler capture to {}", capture_path);
+    }
+}
+
+void Profiler::beginScope(const char* name)
+{
+    t_open_scopes.push_back({name, now()});
+}
+
+void Profiler::endScope()
+{
+    SPUTNIK_ASSERT(!t_open_scopes.empty(), "Profiler scope closed without being opened.");
+    const OpenScope scope = t_open_scopes.back();
+    t_open_scopes.pop_back();
+    record(ProfileTrack::Cpu, scope.name, scope.start_ns, now() - scope.start_ns, getThreadIndex());
+}
+
+void Profiler::addGpuSample(const char* name, const u64& start_ns, const u64& elapsed_ns)
+{
+    record(ProfileTrack::Gpu, name, start_ns, elapsed_ns, 0);
+}
+
+void Profiler::startCapture(const u32& frame_count, const std::string& path)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_trace_events.clear();
+    m_capture_frames_left = frame_count;
+    m_capture_path        = path;
+}
+
+bool Profiler::isCapturing() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_capture_frames_left > 0;
+}
+
+const ProfileStatistics* Profiler::getStatistics(const ProfileTrack& track, const std::string_view& name) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const auto                  scope = m_scopes[(u32)track].find(name);
+    return scope != m_scopes[(u32)track].end() ? &scope->second.statistics : nullptr;
+}
+
+void Profiler::record(const ProfileTrack& track,
+                      const char*         name,
+                      const u64&          start_ns,
+                      const u64&          duration_ns,
+                      const u32&          thread)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Scope&                      scope = m_scopes[(u32)track][name];
+    scope.frame_ns += duration_ns;
+    ++scope.frame_calls;
+
+    if(m_capture_frames_left > 0)
+    {
+        m_trace_events.push_back({name, start_ns, duration_ns, thread, track});
+    }
+}
+
+bool Profiler::writeChromeTrace(const std::string& path, const std::vector<TraceEvent>& events)
+{
+    std::ofstream stream(path);
+    if(!stream)
+    {
+        return false;
+    }
+
+    // the CPU and GPU tracks are separate processes of the trace, the threads of the CPU track are numbered in the
+    // order they first recorded a scope
+    stream << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    for(u32 track = 0; track < (u32)ProfileTrack::Count; ++track)
+    {
+        stream << (track > 0 ? "," : "") << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" << track
+               << ",\"args\":{\"name\":\"" << kTrackNames[track] << "\"}}";
+    }
+    for(const TraceEvent& event : events)
+    {
+        stream << ",{\"name\":";
+        writeJsonString(stream, event.name);
+        stream << ",\"cat\":\"" << kTrackNames[(u32)event.track] << "\",\"ph\":\"X\",\"pid\":" << (u32)event.track
+               << ",\"tid\":" << event.thread << ",\"ts\":" << (double)event.start_ns * 1e-3
+               << ",\"dur\":" << (double)event.duration_ns * 1e-3 << "}";
+    }
+    stream << "]}\n";
+    return (bool)stream;
+}
+
+void Profiler::drawUI()
+{
+    if(ImGui::Begin("Profiler"))
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        const auto frame = m_scopes[(u32)ProfileTrack::Cpu].find("Frame");
+        if(frame != m_scopes[(u32)ProfileTrack::Cpu].end())
+        {
+            const Scope& scope = frame->second;
+            ImGui::Text("Frame: %.2f ms (%.2f avg, %.2f max)",
+                        scope.statistics.last_ms,
+                        scope.statistics.average_ms,
+                        scope.statistics.max_ms);
+            ImGui::PlotLines("##frame_times",
+                             scope.history,
+                             (int)kHistoryLength,
+                             (int)scope.head,
+                             nullptr,
+                             0.0f,
+                             scope.statistics.max_ms * 1.25f,
+                             ImVec2(0.0f, 60.0f));
+        }
+
+        if(m_capture_frames_left > 0)
+        {
+            ImGui::Text("Capturing, %u frames left", m_capture_frames_left);
+        }
+        else
+        {
+            ImGui::DragInt("##capture_frames", &m_ui_capture_frames, 1.0f, 1, 1000);
+            ImGui::SameLine();
+            if(ImGui::Button("Capture Chrome trace"))
+            {
+                m_trace_events.clear();
+                m_capture_frames_left = (u32)m_ui_capture_frames;
+                m_capture_path        = "sputnik_trace.json";
+            }
+        }
+
+        for(u32 track = 0; track < (u32)ProfileTrack::Count; ++track)
+        {
+            // sorted by average time, the most expensive scopes first
+            std::vector<std::pair<std::string_view, const ProfileStatistics*>> rows;
+            for(const auto& [name, scope] : m_scopes[track])
+            {
+                rows.push_back({name, &scope.statistics});
+            }
+            std::sort(rows.begin(),
+                      rows.end(),
+                      [](const auto& a, const auto& b) { return a.second->average_ms > b.second->average_ms; });
+
+            ImGui::Separator();
+            ImGui::Columns(6, kTrackNames[track]);
+            ImGui::Text("%s", kTrackNames[track]);
+            ImGui::NextColumn();
+            for(const char* header : {"last", "avg", "min", "max", "calls"})
+            {
+                ImGui::Text("%s", header);
+                ImGui::NextColumn();
+            }
+            for(const auto& [name, statistics] : rows)
+            {
+                ImGui::Text("%.*s", (int)name.size(), name.data());
+                ImGui::NextColumn();
+                for(const float& value :
+                    {statistics->last_ms, statistics->average_ms, statistics->min_ms, statistics->max_ms})
+                {
+                    ImGui::Text("%.3f", value);
+                    ImGui::NextColumn();
+                }
+                ImGui::Text("%u", statistics->calls);
+                ImGui::NextColumn();
+            }
+            ImGui::Columns(1);
+        }
+    }
+    ImGui::End();
+}
+
+} // namespace sputnik::core
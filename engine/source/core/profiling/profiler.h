@@ -0,0 +1,144 @@
+#pragma once
+
+#include "core/core.h"
+
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace sputnik::core
+{
+
+/*!
+ * @brief Rolling statistics of a profiled scope over the last Profiler::kHistoryLength frames, in milliseconds. A
+ * scope that runs several times in a frame contributes the sum of its runs.
+ */
+struct ProfileStatistics
+{
+    float last_ms{0.0f};
+    float average_ms{0.0f};
+    float min_ms{0.0f};
+    float max_ms{0.0f};
+    u32   calls{0}; // runs during the last frame
+};
+
+enum class ProfileTrack : u8
+{
+    Cpu = 0,
+    Gpu,
+    Count
+};
+
+/*!
+ * @brief Frame profiler for CPU scopes and GPU passes.
+ *
+ * @details CPU scopes are timed with the steady clock and can be opened on any thread, they nest per thread. GPU
+ * times are measured by the renderer with timer queries and reported here once the results are available. Every scope
+ * keeps rolling statistics over the last kHistoryLength frames, shown in the profiler panel.
+ *
+ * A capture records every scope of the next frames and writes them as a Chrome trace (chrome://tracing, Perfetto).
+ * GL_TIME_ELAPSED queries only measure durations, GPU events are placed in the trace at the time their pass was issued
+ * on the CPU.
+ *
+ * Scope names are not copied, they must outlive the profiler (string literals, __FUNCTION__).
+ */
+class Profiler
+{
+public:
+    static constexpr u32 kHistoryLength        = 120;
+    static constexpr u32 kDefaultCaptureFrames = 60;
+
+    static Profiler* getInstance();
+
+    NON_COPYABLE(Profiler);
+
+    void beginFrame();
+    void endFrame();
+
+    void beginScope(const char* name);
+    void endScope();
+
+    /*!
+     * @brief Adds the GPU time of a pass. start_ns is the profiler time the pass was issued at.
+     */
+    void addGpuSample(const char* name, const u64& start_ns, const u64& elapsed_ns);
+
+    /*!
+     * @brief Nanoseconds since the profiler was created.
+     */
+    u64 now() const;
+
+    /*!
+     * @brief Records the next frame_count frames and writes them to path as a Chrome trace once they are done.
+     */
+    void startCapture(const u32& frame_count = kDefaultCaptureFrames, const std::string& path = "sputnik_trace.json");
+    bool isCapturing() const;
+
+    const ProfileStatistics* getStatistics(const ProfileTrack& track, const std::string_view& name) const;
+
+    void drawUI();
+
+private:
+    Profiler();
+
+    struct Scope
+    {
+        float             history[kHistoryLength]{};
+        u32               head{0};
+        u32               count{0};
+        u64               frame_ns{0};
+        u32               frame_calls{0};
+        ProfileStatistics statistics;
+    };
+
+    struct TraceEvent
+    {
+        const char*  name;
+        u64          start_ns;
+        u64          duration_ns;
+        u32          thread;
+        ProfileTrack track;
+    };
+
+    void record(const ProfileTrack& track,
+                const char*         name,
+                const u64&          start_ns,
+                const u64&          duration_ns,
+                const u32&          thread);
+    static bool writeChromeTrace(const std::string& path, const std::vector<TraceEvent>& events);
+
+    const std::chrono::steady_clock::time_point m_epoch;
+
+    mutable std::mutex                          m_mutex;
+    std::unordered_map<std::string_view, Scope> m_scopes[(u32)ProfileTrack::Count];
+    u64                                         m_frame_start_ns{0};
+
+    std::vector<TraceEvent> m_trace_events;
+    u32                     m_capture_frames_left{0};
+    std::string             m_capture_path;
+    int                     m_ui_capture_frames{kDefaultCaptureFrames};
+};
+
+/*!
+ * @brief Times the enclosing block as a CPU scope.
+ */
+class ProfileScope
+{
+public:
+    explicit ProfileScope(const char* name) { Profiler::getInstance()->beginScope(name); }
+    ~ProfileScope() { Profiler::getInstance()->endScope(); }
+
+    NON_COPYABLE(ProfileScope);
+};
+
+} // namespace sputnik::core
+
+#define SPUTNIK_PROFILE_CONCAT_IMPL(a, b) a##b
+#define SPUTNIK_PROFILE_CONCAT(a, b)      SPUTNIK_PROFILE_CONCAT_IMPL(a, b)
+
+#define SPUTNIK_PROFILE_SCOPE(name) \
+    ::sputnik::core::ProfileScope SPUTNIK_PROFILE_CONCAT(profile_scope_, __LINE__)(name)
+#define SPUTNIK_PROFILE_FUNCTION() SPUTNIK_PROFILE_SCOPE(__FUNCTION__)
@@ -2,6 +2,9 @@
 #include "render_system.h"
 #include "graphics/glcore/gl_renderer.h"
 #include "editor/editor.hpp"
+#include "core/profiling/import_profiler.h"
+#include "core/profiling/profiler.h"
+#include "graphics/api/asset_manager.h"
 
 #include <GLFW/glfw3.h>
 
@@ -190,6 +193,9 @@ void core::systems::RenderSystem::drawUI()
     ImGui::End();
 
     m_ogl_renderer->drawUI();
+    core::Profiler::getInstance()->drawUI();
+    core::ImportProfiler::getInstance()->drawUI();
+    graphics::api::AssetManager::getInstance()->drawUI();
 }
 
 Light& RenderSystem::getLight()
@@ -228,34 +234,116 @@ void RenderSystem::setCameraType(CameraType type)
 
 ////////////////////////////////////////// Drawing API //////////////////////////////////////////
 
-void RenderSystem::drawTriangles(const u64& vertex_count, const Material& material, const mat4& model)
+void RenderSystem::drawTriangles(const u64&         vertex_count,
+                                 const Material&    material,
+                                 const mat4&        model,
+                                 const BoundingBox& bounds)
 {
-    m_ogl_renderer->drawTriangles(vertex_count, material, model);
+    m_ogl_renderer->drawTriangles(vertex_count, material, model, bounds);
 }
 
-void RenderSystem::drawTrianglesIndexed(const u64& index_count, const Material& material, const mat4& model)
+void RenderSystem::drawTrianglesIndexed(const OglVertexArray& vertex_array,
+                                        const u64&            index_count,
+                                        const Material&       material,
+                                        const mat4&           model,
+                                        const BoundingBox&    bounds)
 {
-    m_ogl_renderer->drawTrianglesIndexed(index_count, material, model);
+    m_ogl_renderer->drawTrianglesIndexed(vertex_array, index_count, material, model, bounds);
 }
 
-void RenderSystem::drawTrianglesIndexed(const u64&                  vertex_count,
+void RenderSystem::drawTrianglesIndexed(const OglVertexArray&       vertex_array,
+                                        const u64&                  index_count,
                                         const Material&             material,
                                         const mat4&                 model,
                                         const std::vector<Matrix4>& skin_transformations)
 {
-    m_ogl_renderer->drawTrianglesIndexed(vertex_count, material, model, skin_transformations);
+    m_ogl_renderer->drawTrianglesIndexed(vertex_array, index_count, material, model, skin_transformations);
 }
 
-void RenderSystem::drawTrianglesInstanced(const u64& vertex_count, const Material& material, const u32& instance_count)
+void RenderSystem::drawTrianglesInstanced(const u64&                   vertex_count,
+                                          const Material&              material,
+                                          const std::span<const mat4>& models,
+                                          const std::span<const vec4>& colors)
 {
-    m_ogl_renderer->drawTrianglesInstanced(vertex_count, instance_count, material);
+    m_ogl_renderer->drawTrianglesInstanced(vertex_count, material, models, colors);
 }
 
-void RenderSystem::drawTrianglesIndexedInstanced(const u64&      index_count,
-                                                 const Material& material,
-                                                 const u32&      instance_count)
+void RenderSystem::drawTrianglesIndexedInstanced(const OglVertexArray&        vertex_array,
+                                                 const u64&                   index_count,
+                                                 const Material&              material,
+                                                 const std::span<const mat4>& models,
+                                                 const std::span<const vec4>& colors)
 {
-    m_ogl_renderer->drawTrianglesIndexedInstanced(index_count, instance_count, material);
+    m_ogl_renderer->drawTrianglesIndexedInstanced(vertex_array, index_count, material, models, colors);
+}
+
+void RenderSystem::submitTriangles(const OglVertexArray& vertex_array,
+                                   const u64&            element_count,
+                                   const bool&           indexed,
+                                   const Material&       material,
+                                   const mat4&           model,
+                                   const BoundingBox&    bounds,
+                                   const DrawLods&       lods)
+{
+    m_ogl_renderer->submitTriangles(vertex_array, element_count, indexed, material, model, bounds, lods);
+}
+
+void RenderSystem::submitTriangles(const OglVertexArray&       vertex_array,
+                                   const u64&                  index_count,
+                                   const Material&             material,
+                                   const mat4&                 model,
+                                   const std::vector<Matrix4>& skin_transformations,
+                                   const DrawLods&             lods)
+{
+    m_ogl_renderer->submitTriangles(vertex_array, index_count, material, model, skin_transformations, lods);
+}
+
+void RenderSystem::submitTrianglesInstanced(const OglVertexArray&        vertex_array,
+                                            const u64&                   element_count,
+                                            const bool&                  indexed,
+                                            const Material&              material,
+                                            const std::span<const mat4>& models,
+                                            const std::span<const vec4>& colors)
+{
+    m_ogl_renderer->submitTrianglesInstanced(vertex_array, element_count, indexed, material, models, colors);
+}
+
+u32 RenderSystem::addStaticMesh(const std::vector<ramanujan::Vector3>& positions,
+                                const std::vector<ramanujan::Vector3>& normals,
+                                const std::vector<ramanujan::Vector2>& uvs,
+                                const std::vector<u32>&                indices)
+{
+    return m_ogl_renderer->addStaticMesh(positions, normals, uvs, indices);
+}
+
+void RenderSystem::drawStaticMesh(const u32& mesh_id, const Material& material, const mat4& model)
+{
+    m_ogl_renderer->drawStaticMesh(mesh_id, material, model);
+}
+
+u32 RenderSystem::addStaticInstance(const u32& mesh_id, const Material& material, const mat4& model)
+{
+    return m_ogl_renderer->addStaticInstance(mesh_id, material, model);
+}
+
+void RenderSystem::setStaticInstanceTransform(const u32& instance_id, const mat4& model)
+{
+    m_ogl_renderer->setStaticInstanceTransform(instance_id, model);
+}
+
+void RenderSystem::removeStaticInstance(const u32& instance_id)
+{
+    m_ogl_renderer->removeStaticInstance(instance_id);
+}
+
+void RenderSystem::flush()
+{
+    m_ogl_renderer->flush();
+}
+
+DebugDrawList& RenderSystem::getDebugDraw()
+{
+    return m_ogl_renderer->getDebugDraw();
 }
 
 void RenderSystem::drawDebugLines(const std::vector<vec4>& vertices, const vec3& color, const float& line_width)
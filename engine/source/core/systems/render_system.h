@@ -9,16 +9,22 @@
 #include "graphics/window/window.h"
 #include "graphics/api/color_material.h"
 #include "graphics/glcore/gl_framebuffer.h"
+#include "graphics/glcore/gl_render_queue.h"
+#include "graphics/core/geometry/bounds.h"
+#include "graphics/core/debug_draw.h"
 
 #include <vector.hpp>
 #include <matrix.hpp>
 #include <glm/glm.hpp>
 
+#include <span>
+
 struct GLFWwindow;
 
 namespace sputnik::graphics::gl
 {
 class OglRenderer;
+class OglVertexArray;
 }
 
 namespace sputnik::graphics::window
@@ -34,6 +40,8 @@ using namespace sputnik::graphics::gl;
 using namespace sputnik::graphics::api;
 using namespace sputnik::graphics::window;
 using namespace ramanujan::experimental;
+using sputnik::graphics::core::BoundingBox;
+using sputnik::graphics::core::DebugDrawList;
 
 enum class RenderSystemType
 {
@@ -100,17 +108,70 @@ public:
     void setCameraType(CameraType type);
 
     // Drawing API
-    void drawTriangles(const u64& vertex_count, const Material& material, const mat4& model);
-    void drawTrianglesIndexed(const u64& vertex_count, const Material& material, const mat4& model);
-    void drawTrianglesIndexed(const u64&                  vertex_count,
+    void drawTriangles(const u64&         vertex_count,
+                       const Material&    material,
+                       const mat4&        model,
+                       const BoundingBox& bounds = {});
+    void drawTrianglesIndexed(const OglVertexArray& vertex_array,
+                              const u64&            index_count,
+                              const Material&       material,
+                              const mat4&           model,
+                              const BoundingBox&    bounds = {});
+    void drawTrianglesIndexed(const OglVertexArray&       vertex_array,
+                              const u64&                  index_count,
                               const Material&             material,
                               const mat4&                 model,
                               const std::vector<Matrix4>& skin_transformations);
-    void drawTrianglesInstanced(const u64& vertex_count, const Material& material, const u32& instance_count);
-    void drawTrianglesIndexedInstanced(const u64& index_count, const Material& material, const u32& instance_count);
+    void drawTrianglesInstanced(const u64&                   vertex_count,
+                                const Material&              material,
+                                const std::span<const mat4>& models,
+                                const std::span<const vec4>& colors = {});
+    void drawTrianglesIndexedInstanced(const OglVertexArray&        vertex_array,
+                                       const u64&                   index_count,
+                                       const Material&              material,
+                                       const std::span<const mat4>& models,
+                                       const std::span<const vec4>& colors = {});
+
+    // Thread safe drawing API, the vertex array is passed explicitly (see OglRenderer::submitTriangles)
+    void submitTriangles(const OglVertexArray& vertex_array,
+                         const u64&            element_count,
+                         const bool&           indexed,
+                         const Material&       material,
+                         const mat4&           model,
+                         const BoundingBox&    bounds = {},
+                         const DrawLods&       lods   = {});
+    void submitTriangles(const OglVertexArray&       vertex_array,
+                         const u64&                  index_count,
+                         const Material&             material,
+                         const mat4&                 model,
+                         const std::vector<Matrix4>& skin_transformations,
+                         const DrawLods&             lods = {});
+    void submitTrianglesInstanced(const OglVertexArray&        vertex_array,
+                                  const u64&                   element_count,
+                                  const bool&                  indexed,
+                                  const Material&              material,
+                                  const std::span<const mat4>& models,
+                                  const std::span<const vec4>& colors = {});
+
     void drawDebugLines(const std::vector<vec4>& vertices, const vec3& color, const float& line_width = 2.5f);
     void drawDebugPoints(const std::vector<vec4>& vertices, const vec3& color, const float& point_size = 2.5f);
 
+    // Static geometry, drawn with multi draw indirect
+    u32  addStaticMesh(const std::vector<ramanujan::Vector3>& positions,
+                       const std::vector<ramanujan::Vector3>& normals,
+                       const std::vector<ramanujan::Vector2>& uvs,
+                       const std::vector<u32>&                indices);
+    void drawStaticMesh(const u32& mesh_id, const Material& material, const mat4& model);
+    u32  addStaticInstance(const u32& mesh_id, const Material& material, const mat4& model);
+    void setStaticInstanceTransform(const u32& instance_id, const mat4& model);
+    void removeStaticInstance(const u32& instance_id);
+
+    // Submits the triangle draws recorded during the frame, sorted by render state
+    void flush();
+
+    // Debug geometry, batched and drawn at the end of the frame. Can be filled from any thread.
+    DebugDrawList& getDebugDraw();
+
     void drawDebugLines(const std::vector<vec4>& vertices,
                         const vec3&              color,
                         const mat4&              model      = {},
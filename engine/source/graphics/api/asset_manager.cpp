@@ -0,0 +1,793 @@
+#include "pch.h"
+#include "asset_manager.h"
+#include "model.h"
+#include "core/io/mapped_file.h"
+#include "core/profiling/import_profiler.h"
+#include "core/profiling/profiler.h"
+#include "graphics/core/geometry/cooked_mesh.h"
+#include "graphics/core/geometry/mesh_cooker.h"
+#include "graphics/glcore/dds_image.h"
+#include "graphics/glcore/gl_ring_buffer.h"
+#include "graphics/glcore/gl_texture.h"
+
+#include <imgui.h>
+#include <stb_image.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+
+namespace sputnik::graphics::api
+{
+
+using namespace sputnik::graphics::gl;
+
+/*!
+ * @brief A decoded asset waiting for its GL upload. upload() does one slice of the work and returns true once the
+ * asset is done (or failed).
+ */
+class PendingAssetUpload
+{
+public:
+    explicit PendingAssetUpload(std::shared_ptr<AssetSlotBase> slot) : m_slot(std::move(slot)) {}
+    virtual ~PendingAssetUpload() = default;
+
+    virtual bool upload(OglRingBuffer& staging, u64& staging_bytes_left) = 0;
+
+    /*!
+     * @brief The bytes the content hash of the slot was computed from, mapped until the upload is done.
+     */
+    virtual std::span<const u8> getContent() const = 0;
+
+    const std::shared_ptr<AssetSlotBase>& getSlot() const
+    {
+        return m_slot;
+    }
+
+    /*!
+     * @brief A resident asset with byte for byte the same content, found by the worker, nullptr when there is none.
+     */
+    void setSameContent(std::shared_ptr<AssetSlotBase> resident)
+    {
+        m_same_content = std::move(resident);
+    }
+
+    const std::shared_ptr<AssetSlotBase>& getSameContent() const
+    {
+        return m_same_content;
+    }
+
+protected:
+    std::shared_ptr<AssetSlotBase> m_slot;
+    std::shared_ptr<AssetSlotBase> m_same_content;
+};
+
+namespace
+{
+
+constexpr const char* kStateNames[] = {"Loading", "Uploading", "Ready", "Failed"};
+
+u64 hashContent(const std::span<const u8>& bytes)
+{
+    // FNV-1a over 64 bit words with a shift after every word, so that the high bits also reach the low ones
+    constexpr u64 kPrime = 1099511628211ull;
+
+    u64    hash = 14695981039346656037ull;
+    size_t i    = 0;
+    for(; i + sizeof(u64) <= bytes.size(); i += sizeof(u64))
+    {
+        u64 word;
+        std::memcpy(&word, bytes.data() + i, sizeof(u64));
+        hash = (hash ^ word) * kPrime;
+        hash ^= hash >> 29;
+    }
+    for(; i < bytes.size(); ++i)
+    {
+        hash = (hash ^ bytes[i]) * kPrime;
+    }
+    return hash ^ bytes.size();
+}
+
+u64 getContentKey(const AssetSlotBase& slot)
+{
+    return slot.content_hash ^ ((u64)slot.type + 1) * 0x9e3779b97f4a7c15ull;
+}
+
+bool hasSameContent(const PendingAssetUpload& upload, const AssetSlotBase& resident)
+{
+    // equal hashes only make a match likely, the bytes decide
+    const AssetSlotBase&      slot    = *upload.getSlot();
+    const std::span<const u8> content = upload.getContent();
+    if(resident.type != slot.type || resident.content_hash != slot.content_hash)
+    {
+        return false;
+    }
+
+    sputnik::core::MappedFile file;
+    return file.open(resident.content_path) && file.getSize() == content.size() &&
+           std::memcmp(file.getData(), content.data(), content.size()) == 0;
+}
+
+std::string makeCacheKey(const std::string& path)
+{
+    std::error_code       error;
+    std::filesystem::path normalised = std::filesystem::weakly_canonical(path, error);
+    if(error)
+    {
+        normalised = std::filesystem::path(path).lexically_normal();
+    }
+
+    std::string key = normalised.generic_string();
+#if defined(_WIN32)
+    std::transform(key.begin(), key.end(), key.begin(), [](const unsigned char c) { return (char)std::tolower(c); });
+#endif
+    return key;
+}
+
+class TextureUpload : public PendingAssetUpload
+{
+public:
+    explicit TextureUpload(std::shared_ptr<AssetSlot<OglTexture2D>> slot)
+        : PendingAssetUpload(slot)
+        , m_texture_slot(slot)
+    {
+    }
+
+    ~TextureUpload()
+    {
+        stbi_image_free(m_pixels);
+    }
+
+    bool decode(const bool& flip_vertically)
+    {
+        SPUTNIK_PROFILE_SCOPE("Decode texture");
+        sputnik::core::ImportScope import_scope(m_slot->path, sputnik::core::ImportStage::DecodeImage);
+
+        if(!m_file.open(m_slot->path))
+        {
+            return false;
+        }
+        m_slot->content_hash = hashContent(m_file.getBytes()) ^ (u64)flip_vertically;
+        m_slot->content_path = m_slot->path;
+        import_scope.addBytesRead(m_file.getSize());
+
+        // block compressed chains are uploaded straight from the mapping, they are never flipped
+        if(DdsImage::isDdsFile(m_slot->path))
+        {
+            if(!m_dds.parse(m_file.getBytes(), m_slot->path))
+            {
+                return false;
+            }
+            m_width  = m_dds.getWidth();
+            m_height = m_dds.getHeight();
+            m_format = m_dds.getFormat();
+            for(u32 level = 0; level < m_dds.getLevelCount(); ++level)
+            {
+                m_levels.push_back(m_dds.getLevel(level));
+            }
+            return true;
+        }
+
+        int width    = 0;
+        int height   = 0;
+        int channels = 0;
+        stbi_set_flip_vertically_on_load_thread(flip_vertically);
+        m_pixels = stbi_load_from_memory(m_file.getData(), (int)m_file.getSize(), &width, &height, &channels, 0);
+        if(m_pixels == nullptr || channels < 1 || channels > 4)
+        {
+            ENGINE_ERROR("Failed to decode texture {}: {}", m_slot->path, stbi_failure_reason());
+            return false;
+        }
+
+        constexpr TextureFormat kFormats[] = {TextureFormat::R8,
+                                              TextureFormat::RG8,
+                                              TextureFormat::RGB8,
+                                              TextureFormat::RGBA8};
+        m_width            = (u32)width;
+        m_height           = (u32)height;
+        m_format           = kFormats[channels - 1];
+        m_generate_mipmaps = true;
+        m_levels.push_back({m_pixels, (u64)width * height * channels});
+        import_scope.addBytesAllocated(m_levels.back().size());
+        return true;
+    }
+
+    bool upload(OglRingBuffer& staging, u64& staging_bytes_left) override
+    {
+        sputnik::core::ImportScope import_scope(m_slot->path, sputnik::core::ImportStage::Upload);
+        if(m_texture == nullptr && !createTexture())
+        {
+            m_texture_slot->resolve(nullptr);
+            return true;
+        }
+
+        // a row is a row of pixels, or a row of 4x4 blocks for compressed formats
+        const u32 level_width  = std::max(m_width >> m_level, 1u);
+        const u32 level_height = std::max(m_height >> m_level, 1u);
+        const u32 row_height   = isCompressedFormat(m_format) ? 4 : 1;
+        const u64 row_bytes    = getTextureLevelBytes(m_format, level_width, row_height);
+        const u32 rows_left    = (level_height - m_next_row + row_height - 1) / row_height;
+
+        // the first slice of a frame always gets at least one row, later slices only what is left of the staging
+        // budget
+        const bool first_slice = staging_bytes_left == AssetManager::kStagingBytesPerFrame;
+        const u32  rows        = std::min(rows_left, (u32)(staging_bytes_left / row_bytes));
+        if(rows == 0 && !first_slice)
+        {
+            staging_bytes_left = 0;
+            return false;
+        }
+
+        const u32            row_count  = std::max(rows, 1u);
+        const u64            bytes      = row_count * row_bytes;
+        const u8*            source     = m_levels[m_level].data() + (u64)(m_next_row / row_height) * row_bytes;
+        const RingAllocation allocation = staging.upload(source, bytes);
+        const u32            pixel_rows = std::min(row_count * row_height, level_height - m_next_row);
+        m_texture->setRowsFromBuffer(allocation.buffer_id, allocation.offset, m_next_row, pixel_rows, m_level);
+        import_scope.addBytesUploaded(bytes);
+        m_next_row += pixel_rows;
+        staging_bytes_left -= std::min(staging_bytes_left, bytes);
+
+        if(m_next_row == level_height)
+        {
+            m_next_row = 0;
+            ++m_level;
+        }
+        if(m_level < m_levels.size())
+        {
+            return false;
+        }
+
+        if(m_generate_mipmaps)
+        {
+            m_texture->generateMipmaps();
+        }
+        for(u32 level = 0; level < m_texture->getMipLevelCount(); ++level)
+        {
+            m_slot->vram_bytes +=
+                getTextureLevelBytes(m_format, std::max(m_width >> level, 1u), std::max(m_height >> level, 1u));
+        }
+        m_file.close();
+        m_texture_slot->resolve(m_texture);
+        return true;
+    }
+
+    std::span<const u8> getContent() const override
+    {
+        return m_file.getBytes();
+    }
+
+private:
+    bool createTexture()
+    {
+        if(isCompressedFormat(m_format) && !isTextureFormatSupported(m_format))
+        {
+            // rare enough (S3TC on drivers without the extension) that decoding on the GL thread is acceptable
+            ENGINE_WARN("{} is not supported by the driver, {} is decoded on the CPU.", m_format, m_slot->path);
+            for(u32 level = 0; level < m_levels.size(); ++level)
+            {
+                m_decoded_levels.push_back(decodeBlocks(m_format,
+                                                        m_levels[level],
+                                                        std::max(m_width >> level, 1u),
+                                                        std::max(m_height >> level, 1u)));
+                if(m_decoded_levels.back().empty())
+                {
+                    ENGINE_ERROR("Failed to decode texture {}.", m_slot->path);
+                    return false;
+                }
+                m_levels[level] = m_decoded_levels.back();
+            }
+            m_format = TextureFormat::RGBA8;
+        }
+
+        TextureSpecification specification;
+        specification.width          = m_width;
+        specification.height         = m_height;
+        specification.texture_format = m_format;
+        specification.min_filter     = TextureFilter::LinearMipmapLinear;
+        specification.mip_levels     = m_generate_mipmaps ? 0 : (u32)m_levels.size();
+        m_texture                    = std::make_shared<OglTexture2D>(specification);
+        return true;
+    }
+
+    std::shared_ptr<AssetSlot<OglTexture2D>> m_texture_slot;
+    std::shared_ptr<OglTexture2D>            m_texture;
+    sputnik::core::MappedFile                m_file;
+    DdsImage                                 m_dds;
+    u8*                                      m_pixels{nullptr};
+    std::vector<std::vector<u8>>             m_decoded_levels;
+    std::vector<std::span<const u8>>         m_levels; // the source of every level to upload
+    u32                                      m_width{0};
+    u32                                      m_height{0};
+    TextureFormat                            m_format{TextureFormat::RGBA8};
+    bool                                     m_generate_mipmaps{false};
+    u32                                      m_level{0};
+    u32                                      m_next_row{0};
+};
+
+class ModelUpload : public PendingAssetUpload
+{
+public:
+    explicit ModelUpload(std::shared_ptr<AssetSlot<Model>> slot) : PendingAssetUpload(slot), m_model_slot(slot) {}
+
+    bool open()
+    {
+        SPUTNIK_PROFILE_SCOPE("Open cooked model");
+        sputnik::core::ImportScope import_scope(m_slot->path, sputnik::core::ImportStage::ReadCooked);
+        if(!core::MeshCooker::openCooked(m_slot->path, m_file))
+        {
+            return false;
+        }
+        m_slot->content_hash = hashContent(m_file.getBytes());
+        m_slot->content_path = m_file.getPath();
+        import_scope.addBytesRead(m_file.getBytes().size());
+        return true;
+    }
+
+    bool upload(OglRingBuffer& staging, u64& staging_bytes_left) override
+    {
+        // the meshes are created straight from the mapping of the cooked file, they do not need the staging buffer
+        if(m_model == nullptr)
+        {
+            m_model = std::make_shared<Model>();
+        }
+        if(m_next_mesh < m_file.getMeshCount())
+        {
+            // the meshes keep a full precision CPU copy of their streams next to the GPU buffers, which may be
+            // packed, the mesh reports its own uploads
+            sputnik::core::ImportScope import_scope(m_slot->path, sputnik::core::ImportStage::ReadCooked);
+            const MeshStreams          streams   = m_file.getStreams(m_next_mesh);
+            const u64                  cpu_bytes = Mesh::getCpuBytes(streams);
+            m_slot->vram_bytes += Mesh::getGpuVertexBytes(streams) + streams.indices.size_bytes() +
+                                  streams.short_indices.size_bytes();
+            m_slot->ram_bytes += cpu_bytes;
+            import_scope.addBytesAllocated(cpu_bytes);
+            m_model->loadCookedMesh(m_file, m_next_mesh++);
+        }
+
+        if(m_next_mesh < m_file.getMeshCount())
+        {
+            return false;
+        }
+        m_file.close();
+        m_model_slot->resolve(m_model);
+        return true;
+    }
+
+    std::span<const u8> getContent() const override
+    {
+        return m_file.getBytes();
+    }
+
+private:
+    std::shared_ptr<AssetSlot<Model>> m_model_slot;
+    core::CookedMeshFile              m_file;
+    std::shared_ptr<Model>            m_model;
+    u32                               m_next_mesh{0};
+};
+
+} // namespace
+
+AssetManager* AssetManager::getInstance()
+{
+    static AssetManager instance;
+    return &instance;
+}
+
+AssetManager::AssetManager() {}
+
+AssetManager::~AssetManager()
+{
+    shutdown();
+}
+
+void AssetManager::shutdown()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_job_mutex);
+        m_stopping = true;
+        m_jobs.clear();
+    }
+    m_job_condition.notify_all();
+    for(std::thread& worker : m_workers)
+    {
+        worker.join();
+    }
+    m_workers.clear();
+
+    // the workers are gone, the queues are only touched by this thread from here on
+    {
+        std::lock_guard<std::mutex> lock(m_decoded_mutex);
+        m_decoded.clear();
+    }
+    m_uploads.clear();
+    {
+        std::lock_guard<std::mutex> lock(m_cache_mutex);
+        for(auto& [key, entry] : m_entries)
+        {
+            entry.slot->cancel();
+        }
+        m_entries.clear();
+        m_content_index.clear();
+    }
+    m_pending_count = 0;
+    m_staging.reset();
+}
+
+AssetHandle<OglTexture2D> AssetManager::loadTexture(const std::string& path, const bool& flip_vertically)
+{
+    const std::string key = makeCacheKey(path) + (flip_vertically ? "|flip" : "");
+
+    std::lock_guard<std::mutex> lock(m_cache_mutex);
+    if(auto cached = findCached<OglTexture2D>(key))
+    {
+        return AssetHandle<OglTexture2D>(cached);
+    }
+
+    auto slot      = std::make_shared<AssetSlot<OglTexture2D>>(path, AssetType::Texture);
+    m_entries[key] = {slot, m_frame};
+    enqueueJob(
+        [this, slot, flip_vertically]()
+        {
+            auto upload = std::make_unique<TextureUpload>(slot);
+            if(!upload->decode(flip_vertically))
+            {
+                slot->resolve(nullptr);
+                --m_pending_count;
+                return;
+            }
+            findSameContent(*upload);
+            enqueueUpload(std::move(upload));
+        });
+    return AssetHandle<OglTexture2D>(slot);
+}
+
+AssetHandle<Model> AssetManager::loadModel(const std::string& path)
+{
+    const std::string key = makeCacheKey(path);
+
+    std::lock_guard<std::mutex> lock(m_cache_mutex);
+    if(auto cached = findCached<Model>(key))
+    {
+        return AssetHandle<Model>(cached);
+    }
+
+    auto slot      = std::make_shared<AssetSlot<Model>>(path, AssetType::Model);
+    m_entries[key] = {slot, m_frame};
+    enqueueJob(
+        [this, slot]()
+        {
+            auto upload = std::make_unique<ModelUpload>(slot);
+            if(!upload->open())
+            {
+                ENGINE_ERROR("Failed to load model {}, it could not be cooked.", slot->path);
+                slot->resolve(nullptr);
+                --m_pending_count;
+                return;
+            }
+            findSameContent(*upload);
+            enqueueUpload(std::move(upload));
+        });
+    return AssetHandle<Model>(slot);
+}
+
+void AssetManager::update()
+{
+    SPUTNIK_PROFILE_FUNCTION();
+
+    std::deque<std::unique_ptr<PendingAssetUpload>> decoded;
+    {
+        std::lock_guard<std::mutex> lock(m_decoded_mutex);
+        std::swap(decoded, m_decoded);
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_cache_mutex);
+        ++m_frame;
+        for(auto& upload : decoded)
+        {
+            // content the worker found resident under another path is shared instead of being uploaded again
+            const std::shared_ptr<AssetSlotBase>& other = upload->getSameContent();
+            if(other && other->state.load(std::memory_order_acquire) == AssetState::Ready)
+            {
+                upload->getSlot()->share(*other);
+                ++m_deduplicated;
+                --m_pending_count;
+                continue;
+            }
+            m_uploads.push_back(std::move(upload));
+        }
+    }
+
+    if(!m_uploads.empty())
+    {
+        if(m_staging == nullptr)
+        {
+            // headroom for the alignment of the staging allocations, so that the buffer does not grow
+            m_staging = std::make_unique<OglRingBuffer>(kStagingBytesPerFrame + 64 * 1024);
+        }
+        m_staging->beginFrame();
+
+        const auto start              = std::chrono::steady_clock::now();
+        u64        staging_bytes_left = kStagingBytesPerFrame;
+        do
+        {
+            if(m_uploads.front()->upload(*m_staging, staging_bytes_left))
+            {
+                const std::shared_ptr<AssetSlotBase>& slot = m_uploads.front()->getSlot();
+                {
+                    std::lock_guard<std::mutex> lock(m_cache_mutex);
+                    m_content_index[getContentKey(*slot)] = slot;
+                }
+                m_uploads.pop_front();
+                --m_pending_count;
+            }
+        } while(!m_uploads.empty() && staging_bytes_left > 0 &&
+                std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count() <
+                    m_upload_budget_ms);
+
+        m_staging->endFrame();
+    }
+
+    evict();
+}
+
+void AssetManager::setUploadBudget(const float& milliseconds)
+{
+    m_upload_budget_ms = std::max(milliseconds, 0.0f);
+}
+
+float AssetManager::getUploadBudget() const
+{
+    return m_upload_budget_ms;
+}
+
+void AssetManager::setMemoryBudget(const u64& vram_bytes, const u64& ram_bytes)
+{
+    std::lock_guard<std::mutex> lock(m_cache_mutex);
+    m_vram_budget = vram_bytes;
+    m_ram_budget  = ram_bytes;
+}
+
+u32 AssetManager::getPendingCount() const
+{
+    return m_pending_count;
+}
+
+AssetResidency AssetManager::getResidency() const
+{
+    std::lock_guard<std::mutex> lock(m_cache_mutex);
+    return computeResidency(countCacheReferences());
+}
+
+void AssetManager::drawUI()
+{
+    if(ImGui::Begin("Assets"))
+    {
+        std::lock_guard<std::mutex> lock(m_cache_mutex);
+
+        const CacheReferences cache_references = countCacheReferences();
+        const AssetResidency  residency        = computeResidency(cache_references);
+        ImGui::Text("VRAM: %.1f / %.1f MB",
+                    (double)residency.vram_bytes / (1024.0 * 1024.0),
+                    (double)m_vram_budget / (1024.0 * 1024.0));
+        ImGui::Text("RAM: %.1f / %.1f MB",
+                    (double)residency.ram_bytes / (1024.0 * 1024.0),
+                    (double)m_ram_budget / (1024.0 * 1024.0));
+        ImGui::Text("Assets: %u (%u referenced), %u pending",
+                    residency.asset_count,
+                    residency.referenced_count,
+                    m_pending_count.load());
+        ImGui::Text("Cache hits: %u, deduplicated: %u, evicted: %u", m_cache_hits, m_deduplicated, m_evicted);
+
+        ImGui::Separator();
+        ImGui::Columns(6, "assets");
+        for(const char* header : {"path", "state", "handles", "VRAM KB", "RAM KB", "last used"})
+        {
+            ImGui::Text("%s", header);
+            ImGui::NextColumn();
+        }
+        for(const auto& [key, entry] : m_entries)
+        {
+            const AssetSlotBase& slot = *entry.slot;
+            ImGui::Text("%s", slot.path.c_str());
+            ImGui::NextColumn();
+            ImGui::Text("%s", kStateNames[(u32)slot.state.load(std::memory_order_acquire)]);
+            ImGui::NextColumn();
+            ImGui::Text("%ld", entry.slot.use_count() - 1);
+            ImGui::NextColumn();
+            ImGui::Text("%.1f", (double)slot.vram_bytes / 1024.0);
+            ImGui::NextColumn();
+            ImGui::Text("%.1f", (double)slot.ram_bytes / 1024.0);
+            ImGui::NextColumn();
+            ImGui::Text("%llu", (unsigned long long)(m_frame - entry.last_used_frame));
+            ImGui::NextColumn();
+        }
+        ImGui::Columns(1);
+    }
+    ImGui::End();
+}
+
+template <typename T>
+std::shared_ptr<AssetSlot<T>> AssetManager::findCached(const std::string& key)
+{
+    const auto cached = m_entries.find(key);
+    if(cached == m_entries.end())
+    {
+        return nullptr;
+    }
+
+    // a failed request is retried, the file may have been fixed in the meantime
+    if(cached->second.slot->state.load(std::memory_order_acquire) == AssetState::Failed)
+    {
+        m_entries.erase(cached);
+        return nullptr;
+    }
+
+    cached->second.last_used_frame = m_frame;
+    ++m_cache_hits;
+    return std::static_pointer_cast<AssetSlot<T>>(cached->second.slot);
+}
+
+AssetManager::CacheReferences AssetManager::countCacheReferences() const
+{
+    CacheReferences cache_references;
+    for(const auto& [key, entry] : m_entries)
+    {
+        if(const void* asset = entry.slot->getAsset())
+        {
+            ++cache_references[asset];
+        }
+    }
+    return cache_references;
+}
+
+AssetResidency AssetManager::computeResidency(const CacheReferences& cache_references) const
+{
+    AssetResidency           residency;
+    std::vector<const void*> counted;
+    for(const auto& [key, entry] : m_entries)
+    {
+        const void* asset = entry.slot->getAsset();
+        if(asset == nullptr || std::find(counted.begin(), counted.end(), asset) != counted.end())
+        {
+            continue;
+        }
+        counted.push_back(asset);
+
+        residency.vram_bytes += entry.slot->vram_bytes;
+        residency.ram_bytes += entry.slot->ram_bytes;
+        ++residency.asset_count;
+        residency.referenced_count += isReferenced(entry, cache_references) ? 1 : 0;
+    }
+    return residency;
+}
+
+bool AssetManager::isReferenced(const CacheEntry& entry, const CacheReferences& cache_references) const
+{
+    // the cache holds one reference to every slot and one to the asset of every slot that resolved with it
+    if(entry.slot.use_count() > 1)
+    {
+        return true;
+    }
+    const auto cached = cache_references.find(entry.slot->getAsset());
+    return cached != cache_references.end() && entry.slot->getAssetUseCount() > cached->second;
+}
+
+void AssetManager::evict()
+{
+    std::lock_guard<std::mutex> lock(m_cache_mutex);
+
+    std::erase_if(m_content_index, [](const auto& resident) { return resident.second.expired(); });
+
+    CacheReferences cache_references = countCacheReferences();
+    AssetResidency  residency        = computeResidency(cache_references);
+    if(residency.vram_bytes <= m_vram_budget && residency.ram_bytes <= m_ram_budget)
+    {
+        return;
+    }
+
+    // least recently requested first, assets in flight are never evicted
+    std::vector<decltype(m_entries)::iterator> candidates;
+    for(auto entry = m_entries.begin(); entry != m_entries.end(); ++entry)
+    {
+        if(entry->second.slot->state.load(std::memory_order_acquire) == AssetState::Ready &&
+           !isReferenced(entry->second, cache_references))
+        {
+            candidates.push_back(entry);
+        }
+    }
+    std::sort(candidates.begin(),
+              candidates.end(),
+              [](const auto& a, const auto& b) { return a->second.last_used_frame < b->second.last_used_frame; });
+
+    for(const auto& candidate : candidates)
+    {
+        if(residency.vram_bytes <= m_vram_budget && residency.ram_bytes <= m_ram_budget)
+        {
+            break;
+        }
+
+        // an asset shared by several entries is only freed with the last of them
+        const AssetSlotBase& slot = *candidate->second.slot;
+        if(--cache_references[slot.getAsset()] == 0)
+        {
+            residency.vram_bytes -= slot.vram_bytes;
+            residency.ram_bytes -= slot.ram_bytes;
+        }
+        m_entries.erase(candidate);
+        ++m_evicted;
+    }
+}
+
+void AssetManager::startWorkers()
+{
+    // decoding is CPU bound, leave cores for the main and render work
+    const u32 worker_count = std::clamp(std::thread::hardware_concurrency() / 2, 1u, 4u);
+    for(u32 i = 0; i < worker_count; ++i)
+    {
+        m_workers.emplace_back(&AssetManager::runWorker, this);
+    }
+}
+
+void AssetManager::runWorker()
+{
+    while(true)
+    {
+        std::function<void()> job;
+        {
+            std::unique_lock<std::mutex> lock(m_job_mutex);
+            m_job_condition.wait(lock, [this]() { return m_stopping || !m_jobs.empty(); });
+            if(m_stopping)
+            {
+                return;
+            }
+            job = std::move(m_jobs.front());
+            m_jobs.pop_front();
+        }
+        job();
+    }
+}
+
+void AssetManager::enqueueJob(std::function<void()> job)
+{
+    ++m_pending_count;
+    {
+        std::lock_guard<std::mutex> lock(m_job_mutex);
+        SPUTNIK_ASSERT(!m_stopping, "Asset requested after the asset manager was shut down.");
+        if(m_workers.empty())
+        {
+            startWorkers();
+        }
+        m_jobs.push_back(std::move(job));
+    }
+    m_job_condition.notify_one();
+}
+
+void AssetManager::findSameContent(PendingAssetUpload& upload)
+{
+    std::shared_ptr<AssetSlotBase> resident;
+    {
+        std::lock_guard<std::mutex> lock(m_cache_mutex);
+        const auto                  found = m_content_index.find(getContentKey(*upload.getSlot()));
+        if(found != m_content_index.end())
+        {
+            resident = found->second.lock();
+        }
+    }
+
+    // outside of the lock, mapping the file of the resident asset may have to read all of it from disk
+    if(resident && resident->state.load(std::memory_order_acquire) == AssetState::Ready &&
+       hasSameContent(upload, *resident))
+    {
+        upload.setSameContent(std::move(resident));
+    }
+}
+
+void AssetManager::enqueueUpload(std::unique_ptr<PendingAssetUpload> upload)
+{
+    std::lock_guard<std::mutex> lock(m_decoded_mutex);
+    m_decoded.push_back(std::move(upload));
+}
+
+} // namespace sputnik::graphics::api
@@ -0,0 +1,309 @@
+#pragma once
+
+#include "core/core.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace sputnik::graphics::gl
+{
+class OglTexture2D;
+class OglRingBuffer;
+} // namespace sputnik::graphics::gl
+
+namespace sputnik::graphics::api
+{
+
+class Model;
+class PendingAssetUpload;
+
+enum class AssetType : u8
+{
+    Texture = 0,
+    Model
+};
+
+enum class AssetState : u8
+{
+    Loading = 0, // read and decoded on a worker thread
+    Uploading,   // waiting for (or in the middle of) its GL upload
+    Ready,
+    Failed
+};
+
+/*!
+ * @brief The shared state of a requested asset, owned by the cache and by the handles to it.
+ */
+class AssetSlotBase
+{
+public:
+    AssetSlotBase(const std::string& asset_path, const AssetType& asset_type)
+        : path(asset_path)
+        , type(asset_type)
+        , future(promise.get_future().share())
+    {
+    }
+    virtual ~AssetSlotBase() = default;
+
+    NON_COPYABLE(AssetSlotBase);
+
+    virtual const void* getAsset() const         = 0;
+    virtual long        getAssetUseCount() const = 0;
+
+    /*!
+     * @brief Resolves the slot with the asset of another slot of the same type, used for assets whose content has
+     * already been loaded from another path.
+     */
+    virtual void share(const AssetSlotBase& other) = 0;
+
+    /*!
+     * @brief Fails a slot that is still loading or uploading, so that nothing waits on its future forever.
+     */
+    void cancel()
+    {
+        const AssetState current = state.load(std::memory_order_acquire);
+        if(current == AssetState::Loading || current == AssetState::Uploading)
+        {
+            setResolved(false);
+        }
+    }
+
+    const std::string        path;
+    const AssetType          type;
+    std::atomic<AssetState>  state{AssetState::Loading};
+    std::promise<void>       promise;
+    std::shared_future<void> future;
+
+    // written before the slot is handed to the GL thread (content) or before it is resolved (memory)
+    u64         content_hash{0};
+    std::string content_path; // the file the content hash was computed from, the cooked file of a model
+    u64         vram_bytes{0};
+    u64         ram_bytes{0};
+
+protected:
+    void setResolved(const bool& ready)
+    {
+        state.store(ready ? AssetState::Ready : AssetState::Failed, std::memory_order_release);
+        promise.set_value();
+    }
+};
+
+template <typename T>
+class AssetSlot : public AssetSlotBase
+{
+public:
+    using AssetSlotBase::AssetSlotBase;
+
+    std::shared_ptr<T> asset; // written before state becomes Ready
+
+    void resolve(std::shared_ptr<T> loaded_asset)
+    {
+        asset = std::move(loaded_asset);
+        setResolved(asset != nullptr);
+    }
+
+    const void* getAsset() const override { return asset.get(); }
+    long        getAssetUseCount() const override { return asset.use_count(); }
+
+    void share(const AssetSlotBase& other) override
+    {
+        SPUTNIK_ASSERT(other.type == type, "Assets can only be shared between slots of the same type.");
+        vram_bytes = other.vram_bytes;
+        ram_bytes  = other.ram_bytes;
+        resolve(static_cast<const AssetSlot<T>&>(other).asset);
+    }
+};
+
+/*!
+ * @brief Shared handle to an asset that is loaded in the background. It is cheap to copy and can be polled every
+ * frame, get() returns nullptr until the asset is ready. The cache does not evict an asset while handles to it (or
+ * references to the asset itself) are alive.
+ */
+template <typename T>
+class AssetHandle
+{
+public:
+    AssetHandle() = default;
+    explicit AssetHandle(std::shared_ptr<AssetSlot<T>> slot) : m_slot(std::move(slot)) {}
+
+    bool isValid() const { return m_slot != nullptr; }
+    bool isReady() const { return getState() == AssetState::Ready; }
+
+    AssetState getState() const
+    {
+        return m_slot ? m_slot->state.load(std::memory_order_acquire) : AssetState::Failed;
+    }
+
+    std::shared_ptr<T> get() const { return isReady() ? m_slot->asset : nullptr; }
+
+    const std::string& getPath() const { return m_slot->path; }
+
+    /*!
+     * @brief Becomes ready once the asset has been uploaded (or failed). The upload happens in AssetManager::update()
+     * on the GL thread, so the GL thread must never wait on the future.
+     */
+    std::shared_future<void> getFuture() const { return m_slot->future; }
+
+private:
+    std::shared_ptr<AssetSlot<T>> m_slot;
+};
+
+/*!
+ * @brief Memory held by the assets resident in the cache. Assets shared by several paths are counted once.
+ */
+struct AssetResidency
+{
+    u64 vram_bytes{0};
+    u64 ram_bytes{0};
+    u32 asset_count{0};
+    u32 referenced_count{0}; // assets with handles or references outside the cache
+};
+
+/*!
+ * @brief Loads textures and models without stalling the frame and caches them.
+ *
+ * @details Files are read and decoded by a pool of worker threads (stb_image for textures, the cooked mesh path for
+ * models, see MeshCooker). The GL work is done by update() on the GL thread, which spends at most the upload budget per
+ * frame on it: textures are copied into a persistently mapped staging buffer and uploaded from it as a pixel unpack
+ * buffer, a few rows at a time, and the meshes of a model are uploaded one per step. A slice that was started is
+ * always finished, so the budget can be exceeded by one slice.
+ *
+ * Textures get a full mip chain. Images decoded by stb_image have it generated once level 0 is uploaded, .dds files
+ * upload their block compressed levels straight from the file mapping (see DdsImage).
+ *
+ * Requests are cached by normalised path (and load options), requesting a cached asset returns a handle to the same
+ * asset. The workers also hash the content of every file: an asset whose content is already resident under another
+ * path shares that asset instead of being uploaded again, once the bytes of both files compare equal. Assets that are
+ * no longer referenced stay cached until the cache exceeds its VRAM or RAM budget, then the least recently requested
+ * ones are evicted.
+ *
+ * Cached models are shared by everyone who requests them. Code that modifies a model (CPU skinning, making it static)
+ * must load its own copy with Model::LoadModel().
+ */
+class AssetManager
+{
+public:
+    static constexpr float kDefaultUploadBudgetMs = 2.0f;
+    static constexpr u64   kStagingBytesPerFrame  = 4 * 1024 * 1024;
+    static constexpr u64   kDefaultVramBudget     = 1024ull * 1024 * 1024;
+    static constexpr u64   kDefaultRamBudget      = 512ull * 1024 * 1024;
+
+    static AssetManager* getInstance();
+
+    ~AssetManager();
+
+    NON_COPYABLE(AssetManager);
+
+    /*!
+     * @brief Stops the workers, fails the requests that are still in flight and releases the GL objects of the cache
+     * and of the staging buffer. Must be called on the GL thread before the context is destroyed, the singleton
+     * itself only goes away after that. Assets still referenced through handles are released by their owners.
+     */
+    void shutdown();
+
+    AssetHandle<gl::OglTexture2D> loadTexture(const std::string& path, const bool& flip_vertically = false);
+    AssetHandle<Model>            loadModel(const std::string& path);
+
+    /*!
+     * @brief Blocks until the asset of the handle is ready (or failed) and returns it, nullptr on failure. It runs
+     * update() itself while it waits, so it must be called on the GL thread. Meant for setup code that can't go on
+     * without the asset, frames should poll the handle instead.
+     */
+    template <typename T>
+    std::shared_ptr<T> wait(const AssetHandle<T>& handle);
+
+    /*!
+     * @brief Uploads decoded assets within the upload budget and evicts unreferenced assets while the cache is over its
+     * budget. Called once per frame on the GL thread.
+     */
+    void update();
+
+    void  setUploadBudget(const float& milliseconds);
+    float getUploadBudget() const;
+    void  setMemoryBudget(const u64& vram_bytes, const u64& ram_bytes);
+
+    /*!
+     * @brief Assets that have been requested and are not ready (or failed) yet.
+     */
+    u32            getPendingCount() const;
+    AssetResidency getResidency() const;
+
+    void drawUI();
+
+private:
+    AssetManager();
+
+    struct CacheEntry
+    {
+        std::shared_ptr<AssetSlotBase> slot;
+        u64                            last_used_frame{0};
+    };
+
+    template <typename T>
+    std::shared_ptr<AssetSlot<T>> findCached(const std::string& key);
+
+    // number of cache entries that hold each asset, several entries share an asset when their content is the same
+    using CacheReferences = std::unordered_map<const void*, long>;
+
+    CacheReferences countCacheReferences() const;
+    AssetResidency  computeResidency(const CacheReferences& cache_references) const;
+    bool            isReferenced(const CacheEntry& entry, const CacheReferences& cache_references) const;
+    void            evict();
+
+    void startWorkers();
+    void runWorker();
+    void enqueueJob(std::function<void()> job);
+
+    /*!
+     * @brief Called on the worker that decoded the upload: looks the content up among the resident assets and compares
+     * the bytes on a hash match, so that update() only has to share the asset.
+     */
+    void findSameContent(PendingAssetUpload& upload);
+    void enqueueUpload(std::unique_ptr<PendingAssetUpload> upload);
+
+    std::vector<std::thread>          m_workers;
+    std::mutex                        m_job_mutex;
+    std::condition_variable           m_job_condition;
+    std::deque<std::function<void()>> m_jobs;
+    bool                              m_stopping{false};
+
+    std::mutex                                      m_decoded_mutex;
+    std::deque<std::unique_ptr<PendingAssetUpload>> m_decoded; // filled by the workers
+    std::deque<std::unique_ptr<PendingAssetUpload>> m_uploads; // GL thread only
+
+    std::unique_ptr<gl::OglRingBuffer> m_staging;
+    float                              m_upload_budget_ms{kDefaultUploadBudgetMs};
+    std::atomic<u32>                   m_pending_count{0};
+
+    mutable std::mutex                                    m_cache_mutex;
+    std::unordered_map<std::string, CacheEntry>           m_entries;       // by cache key
+    std::unordered_map<u64, std::weak_ptr<AssetSlotBase>> m_content_index; // ready assets by content hash
+    u64                                                   m_frame{0};
+    u64                                                   m_vram_budget{kDefaultVramBudget};
+    u64                                                   m_ram_budget{kDefaultRamBudget};
+    u32                                                   m_cache_hits{0};
+    u32                                                   m_deduplicated{0};
+    u32                                                   m_evicted{0};
+};
+
+template <typename T>
+std::shared_ptr<T> AssetManager::wait(const AssetHandle<T>& handle)
+{
+    while(handle.getState() == AssetState::Loading || handle.getState() == AssetState::Uploading)
+    {
+        update();
+        std::this_thread::yield();
+    }
+    return handle.get();
+}
+
+} // namespace sputnik::graphics::api
@@ -2,6 +2,10 @@
 
 #include "model.h"
 #include "graphics/glcore/gltf_loader.h"
+#include "graphics/core/geometry/cooked_mesh.h"
+#include "graphics/core/geometry/mesh_cooker.h"
+#include "core/systems/render_system.h"
+#include "core/profiling/import_profiler.h"
 
 namespace sputnik::graphics::api
 {
@@ -36,30 +40,97 @@ void Model::Draw()
     }
 }
 
-void Model::draw(const Material& material, const mat4& model)
+void Model::draw(const Material& material, const mat4& model, LodHistory* lod_history)
 {
-    for(auto& mesh : m_meshes)
+    if(lod_history)
+    {
+        lod_history->resize(m_meshes.size(), 0);
+    }
+    for(size_t i = 0; i < m_meshes.size(); ++i)
     {
-        mesh.draw(material, model);
+        m_meshes[i].draw(material, model, lod_history ? &(*lod_history)[i] : nullptr);
     }
 }
 
-void Model::draw(const Material& material, const mat4& model, const std::vector<Matrix4>& skin_transformations)
+void Model::draw(const Material&             material,
+                 const mat4&                 model,
+                 const std::vector<Matrix4>& skin_transformations,
+                 LodHistory*                 lod_history)
+{
+    if(lod_history)
+    {
+        lod_history->resize(m_meshes.size(), 0);
+    }
+    for(size_t i = 0; i < m_meshes.size(); ++i)
+    {
+        m_meshes[i].draw(material, model, skin_transformations, lod_history ? &(*lod_history)[i] : nullptr);
+    }
+}
+
+void Model::drawInstanced(const Material&              material,
+                          const std::span<const mat4>& models,
+                          const std::span<const vec4>& colors)
 {
     for(auto& mesh : m_meshes)
     {
-        mesh.draw(material, model, skin_transformations);
+        mesh.drawInstanced(material, models, colors);
     }
 }
 
-void Model::drawInstanced(const Material& material, const u32& num_instances)
+void Model::makeStatic()
 {
+    if(isStatic())
+    {
+        return;
+    }
+
+    auto render_system = sputnik::core::systems::RenderSystem::getInstance();
     for(auto& mesh : m_meshes)
     {
-        mesh.drawInstanced(material, num_instances);
+        m_static_mesh_ids.push_back(
+            render_system->addStaticMesh(mesh.GetPosition(), mesh.GetNormal(), mesh.GetTexCoord(), mesh.GetIndices()));
     }
 }
 
+void Model::drawStatic(const Material& material, const mat4& model)
+{
+    SPUTNIK_ASSERT(isStatic(), "Model has not been made static.");
+
+    auto render_system = sputnik::core::systems::RenderSystem::getInstance();
+    for(const u32& mesh_id : m_static_mesh_ids)
+    {
+        render_system->drawStaticMesh(mesh_id, material, model);
+    }
+}
+
+std::vector<u32> Model::addStaticInstance(const Material& material, const mat4& model)
+{
+    SPUTNIK_ASSERT(isStatic(), "Model has not been made static.");
+
+    auto             render_system = sputnik::core::systems::RenderSystem::getInstance();
+    std::vector<u32> instance_ids;
+    for(const u32& mesh_id : m_static_mesh_ids)
+    {
+        instance_ids.push_back(render_system->addStaticInstance(mesh_id, material, model));
+    }
+    return instance_ids;
+}
+
+BoundingBox Model::getBounds() const
+{
+    BoundingBox bounds;
+    for(const auto& mesh : m_meshes)
+    {
+        bounds.merge(mesh.getBounds());
+    }
+    return bounds;
+}
+
+bool Model::isStatic() const
+{
+    return !m_static_mesh_ids.empty();
+}
+
 void Model::update(const std::vector<ramanujan::Matrix4>& pose_palette, const bool& cpu_skin)
 {
     for(auto& mesh : m_meshes)
@@ -70,6 +141,23 @@ void Model::update(const std::vector<ramanujan::Matrix4>& pose_palette, const bo
 
 std::shared_ptr<Model> Model::LoadModel(const std::string& path)
 {
+    {
+        sputnik::core::ImportScope import_scope(path, sputnik::core::ImportStage::ReadCooked);
+        CookedMeshFile             cooked_file;
+        if(MeshCooker::openCooked(path, cooked_file))
+        {
+            import_scope.addBytesRead(cooked_file.getBytes().size());
+            auto model = std::make_shared<Model>();
+            for(u32 i = 0; i < cooked_file.getMeshCount(); ++i)
+            {
+                import_scope.addBytesAllocated(Mesh::getCpuBytes(cooked_file.getStreams(i)));
+                model->loadCookedMesh(cooked_file, i);
+            }
+            return model;
+        }
+    }
+
+    ENGINE_WARN("Loading {} without its cooked mesh.", path);
     auto        model     = std::make_shared<Model>();
     cgltf_data* gltf_data = sputnik::gltf::GltfLoader::LoadFile(path.c_str());
     model->m_meshes       = sputnik::gltf::GltfLoader::LoadMeshes(gltf_data);
@@ -77,6 +165,36 @@ std::shared_ptr<Model> Model::LoadModel(const std::string& path)
     return model;
 }
 
+std::shared_ptr<Model> Model::LoadCookedModel(const std::string& path)
+{
+    sputnik::core::ImportScope import_scope(path, sputnik::core::ImportStage::ReadCooked);
+    CookedMeshFile             file;
+    if(!file.open(path))
+    {
+        return nullptr;
+    }
+    import_scope.addBytesRead(file.getBytes().size());
+
+    auto model = std::make_shared<Model>();
+    for(u32 i = 0; i < file.getMeshCount(); ++i)
+    {
+        import_scope.addBytesAllocated(Mesh::getCpuBytes(file.getStreams(i)));
+        model->loadCookedMesh(file, i);
+    }
+    return model;
+}
+
+void Model::loadCookedMesh(const CookedMeshFile& file, const u32& mesh)
+{
+    SPUTNIK_ASSERT(!isStatic(), "Meshes can not be added to a static model.");
+
+    if(m_meshes.size() < file.getMeshCount())
+    {
+        m_meshes.resize(file.getMeshCount());
+    }
+    m_meshes[mesh].initialize(file.getStreams(mesh), file.getBounds(mesh));
+}
+
 std::shared_ptr<OglVertexArray> Model::getVertexArray() const
 {
     return m_meshes[0].getVertexArray();
@@ -8,6 +8,12 @@
 #include <string>
 #include <vector>
 #include <memory>
+#include <span>
+
+namespace sputnik::graphics::core
+{
+class CookedMeshFile;
+} // namespace sputnik::graphics::core
 
 namespace sputnik::graphics::api
 {
@@ -27,14 +33,62 @@ public:
     //           const bool&             weights = true);
 
     void Draw();
-    void draw(const Material& material, const mat4& model = {});
-    void draw(const Material& material, const mat4& model, const std::vector<Matrix4>& skin_transformations);
-    void drawInstanced(const Material& material, const u32& num_instances);
+
+    /*!
+     * @brief Submits every mesh, with the level of detail its projected error calls for. lod_history is kept by the
+     * caller per drawn instance (see LodHistory), without it the levels are selected without hysteresis.
+     */
+    void draw(const Material& material, const mat4& model = {}, LodHistory* lod_history = nullptr);
+    void draw(const Material&             material,
+              const mat4&                 model,
+              const std::vector<Matrix4>& skin_transformations,
+              LodHistory*                 lod_history = nullptr);
+
+    /*!
+     * @brief Draws one instance of every mesh per model, colors is either empty or holds one color per model. The
+     * renderer streams the transforms to the GPU and derives the normal matrices from them.
+     */
+    void drawInstanced(const Material&              material,
+                       const std::span<const mat4>& models,
+                       const std::span<const vec4>& colors = {});
+
+    /*!
+     * @brief Copies the meshes into the static geometry of the renderer. Static models are drawn with drawStatic(), they
+     * are batched into multi draw indirect calls and can not be skinned or have their buffers updated.
+     */
+    void makeStatic();
+    void drawStatic(const Material& material, const mat4& model = {});
+    bool isStatic() const;
+
+    /*!
+     * @brief Places a copy of the static model in the scene, it is drawn every frame while it is visible until its
+     * instances are removed from the render system. Returns one instance per mesh.
+     */
+    std::vector<u32> addStaticInstance(const Material& material, const mat4& model = {});
+
+    BoundingBox getBounds() const;
 
     void update(const std::vector<ramanujan::Matrix4>& pose_palette, const bool& cpu_skin = false);
 
+    /*!
+     * @brief Loads the meshes of a glTF file. The cooked mesh next to it is loaded instead when it is up to date, it is
+     * cooked first when it is missing or older than the glTF file (see MeshCooker).
+     */
     static std::shared_ptr<Model> LoadModel(const std::string& path);
 
+    /*!
+     * @brief Loads a cooked mesh file, the GPU buffers are filled straight from its mapping. Returns nullptr when the
+     * file is missing or not a valid cooked mesh.
+     */
+    static std::shared_ptr<Model> LoadCookedModel(const std::string& path);
+
+    /*!
+     * @brief Uploads one mesh of an open cooked mesh file, so that the meshes of a model can be uploaded over several
+     * frames. The model has all the meshes of the file once the first one is loaded, the others stay empty until they
+     * are loaded.
+     */
+    void loadCookedMesh(const CookedMeshFile& file, const u32& mesh);
+
     std::shared_ptr<OglVertexArray> getVertexArray() const;
 
     const std::vector<ramanujan::Vector3>& getPositions();
@@ -47,5 +101,6 @@ public:
 protected:
     // Write now we expect a single mesh per model
     std::vector<Mesh> m_meshes;
+    std::vector<u32>  m_static_mesh_ids;
 };
 } // namespace sputnik::graphics::api
@@ -0,0 +1,183 @@
+#include "pch.h"
+#include "debug_draw.h"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+namespace sputnik::graphics::core
+{
+
+namespace
+{
+
+constexpr float kPi = 3.14159265358979f;
+
+void transformPoint(const float* model, const float& x, const float& y, const float& z, float* out)
+{
+    // column major, m[column * 4 + row]
+    for(u32 row = 0; row < 3; ++row)
+    {
+        out[row] = model ? model[row] * x + model[4 + row] * y + model[8 + row] * z + model[12 + row]
+                         : (row == 0 ? x : row == 1 ? y : z);
+    }
+}
+
+DebugPrimitive makePrimitive(const float* start, const float* end, const vec3& color, const float& width)
+{
+    DebugPrimitive primitive{};
+    for(u32 i = 0; i < 3; ++i)
+    {
+        primitive.start[i] = start[i];
+        primitive.end[i]   = end[i];
+    }
+    primitive.width    = width;
+    primitive.color[0] = color.x;
+    primitive.color[1] = color.y;
+    primitive.color[2] = color.z;
+    primitive.color[3] = 1.0f;
+    return primitive;
+}
+
+} // namespace
+
+DebugDrawList::DebugDrawList() {}
+
+void DebugDrawList::addLine(const vec3& start, const vec3& end, const vec3& color, const float& width)
+{
+    const float                 a[3] = {start.x, start.y, start.z};
+    const float                 b[3] = {end.x, end.y, end.z};
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_primitives.push_back(makePrimitive(a, b, color, width));
+}
+
+void DebugDrawList::addPoint(const vec3& position, const vec3& color, const float& size)
+{
+    const float                 p[3] = {position.x, position.y, position.z};
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_primitives.push_back(makePrimitive(p, p, color, size));
+}
+
+void DebugDrawList::addLines(const std::vector<vec4>& vertices, const vec3& color, const float& width)
+{
+    addVertices(vertices, color, nullptr, width, true);
+}
+
+void DebugDrawList::addLines(const std::vector<vec4>& vertices,
+                             const vec3&              color,
+                             const mat4&              model,
+                             const float&             width)
+{
+    addVertices(vertices, color, model.m, width, true);
+}
+
+void DebugDrawList::addPoints(const std::vector<vec4>& vertices, const vec3& color, const float& size)
+{
+    addVertices(vertices, color, nullptr, size, false);
+}
+
+void DebugDrawList::addPoints(const std::vector<vec4>& vertices,
+                              const vec3&              color,
+                              const mat4&              model,
+                              const float&             size)
+{
+    addVertices(vertices, color, model.m, size, false);
+}
+
+void DebugDrawList::addBox(const BoundingBox& box, const vec3& color, const float& width)
+{
+    addBox(box, mat4{}, color, width);
+}
+
+void DebugDrawList::addBox(const BoundingBox& box, const mat4& model, const vec3& color, const float& width)
+{
+    if(!box.isValid())
+    {
+        return;
+    }
+
+    // corner i has the max coordinate on axis a where bit a of i is set
+    float corners[8][3];
+    for(u32 i = 0; i < 8; ++i)
+    {
+        transformPoint(model.m,
+                       i & 1 ? box.max.x : box.min.x,
+                       i & 2 ? box.max.y : box.min.y,
+                       i & 4 ? box.max.z : box.min.z,
+                       corners[i]);
+    }
+
+    // the edges connect the corners that differ in a single bit
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for(u32 i = 0; i < 8; ++i)
+    {
+        for(u32 bit = 1; bit < 8; bit <<= 1)
+        {
+            if((i & bit) == 0)
+            {
+                m_primitives.push_back(makePrimitive(corners[i], corners[i | bit], color, width));
+            }
+        }
+    }
+}
+
+void DebugDrawList::addSphere(const vec3&  center,
+                              const float& radius,
+                              const vec3&  color,
+                              const float& width,
+                              const u32&   segments)
+{
+    SPUTNIK_ASSERT(segments >= 3, "A debug sphere needs at least three segments per circle.");
+
+    const float                 c[3] = {center.x, center.y, center.z};
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for(u32 axis = 0; axis < 3; ++axis)
+    {
+        // the circle spans the two axes other than axis
+        const u32 u = (axis + 1) % 3;
+        const u32 v = (axis + 2) % 3;
+
+        float previous[3] = {c[0], c[1], c[2]};
+        previous[u] += radius;
+        for(u32 segment = 1; segment <= segments; ++segment)
+        {
+            const float angle   = 2.0f * kPi * (float)segment / (float)segments;
+            float       next[3] = {c[0], c[1], c[2]};
+            next[u] += radius * std::cos(angle);
+            next[v] += radius * std::sin(angle);
+            m_primitives.push_back(makePrimitive(previous, next, color, width));
+            std::copy(next, next + 3, previous);
+        }
+    }
+}
+
+void DebugDrawList::collect(std::vector<DebugPrimitive>& primitives)
+{
+    primitives.clear();
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::swap(primitives, m_primitives);
+}
+
+void DebugDrawList::addVertices(const std::vector<vec4>& vertices,
+                                const vec3&              color,
+                                const float*             model,
+                                const float&             width,
+                                const bool&              lines)
+{
+    // a trailing vertex without a partner is dropped, like GL_LINES does
+    const size_t                step = lines ? 2 : 1;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for(size_t i = 0; i + step <= vertices.size(); i += step)
+    {
+        const vec4& a = vertices[i];
+        const vec4& b = vertices[i + step - 1];
+
+        float start[3];
+        float end[3];
+        transformPoint(model, a.x, a.y, a.z, start);
+        transformPoint(model, b.x, b.y, b.z, end);
+        m_primitives.push_back(makePrimitive(start, end, color, width));
+    }
+}
+
+} // namespace sputnik::graphics::core
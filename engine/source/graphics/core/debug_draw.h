@@ -0,0 +1,85 @@
+#pragma once
+
+#include "core/core.h"
+#include "bounds.h"
+
+#include <vector.hpp>
+#include <matrix.hpp>
+
+#include <mutex>
+#include <vector>
+
+namespace sputnik::graphics::core
+{
+
+using namespace ramanujan::experimental;
+
+/*!
+ * @brief A line segment of the debug draw, points are segments of zero length. Matches the DebugPrimitive struct of
+ * debug_draw.vert (std430).
+ */
+struct DebugPrimitive
+{
+    float start[3];
+    float width; // pixels, the line width or the point size
+    float end[3];
+    float padding;
+    float color[4];
+};
+
+/*!
+ * @brief Collects the debug geometry of a frame so that the renderer can draw all of it with a single instanced draw.
+ *
+ * @details Everything is reduced to screen space line segments with a color and a width, boxes and spheres are
+ * expanded into their edges when they are added. The add functions can be called from any thread, each call takes the
+ * lock once.
+ */
+class DebugDrawList
+{
+public:
+    static constexpr float kDefaultWidth          = 2.5f;
+    static constexpr u32   kDefaultSphereSegments = 24;
+
+    DebugDrawList();
+
+    void addLine(const vec3& start, const vec3& end, const vec3& color, const float& width = kDefaultWidth);
+    void addPoint(const vec3& position, const vec3& color, const float& size = kDefaultWidth);
+
+    /*!
+     * @brief Adds the line list (pairs of vertices) or points, optionally transformed by model.
+     */
+    void addLines(const std::vector<vec4>& vertices, const vec3& color, const float& width = kDefaultWidth);
+    void addLines(const std::vector<vec4>& vertices, const vec3& color, const mat4& model, const float& width);
+    void addPoints(const std::vector<vec4>& vertices, const vec3& color, const float& size = kDefaultWidth);
+    void addPoints(const std::vector<vec4>& vertices, const vec3& color, const mat4& model, const float& size);
+
+    void addBox(const BoundingBox& box, const vec3& color, const float& width = kDefaultWidth);
+    void addBox(const BoundingBox& box, const mat4& model, const vec3& color, const float& width = kDefaultWidth);
+
+    /*!
+     * @brief Adds the three great circles of the sphere that are aligned with the coordinate planes.
+     */
+    void addSphere(const vec3&  center,
+                   const float& radius,
+                   const vec3&  color,
+                   const float& width    = kDefaultWidth,
+                   const u32&   segments = kDefaultSphereSegments);
+
+    /*!
+     * @brief Swaps the primitives collected so far into primitives and starts collecting into its old storage, so that
+     * neither side allocates once the frames have warmed up.
+     */
+    void collect(std::vector<DebugPrimitive>& primitives);
+
+private:
+    void addVertices(const std::vector<vec4>& vertices,
+                     const vec3&              color,
+                     const float*             model,
+                     const float&             width,
+                     const bool&              lines);
+
+    std::mutex                  m_mutex;
+    std::vector<DebugPrimitive> m_primitives;
+};
+
+} // namespace sputnik::graphics::core
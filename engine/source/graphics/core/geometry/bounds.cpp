@@ -0,0 +1,214 @@
+#include "pch.h"
+#include "bounds.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(_M_X64) || defined(__SSE2__)
+#define SPUTNIK_FRUSTUM_SSE 1
+#include <xmmintrin.h>
+#endif
+
+namespace sputnik::graphics::core
+{
+
+BoundingBox BoundingBox::fromPoints(const std::vector<ramanujan::Vector3>& points)
+{
+    BoundingBox box;
+    for(const ramanujan::Vector3& point : points)
+    {
+        box.min.x = std::min(box.min.x, point.x);
+        box.min.y = std::min(box.min.y, point.y);
+        box.min.z = std::min(box.min.z, point.z);
+        box.max.x = std::max(box.max.x, point.x);
+        box.max.y = std::max(box.max.y, point.y);
+        box.max.z = std::max(box.max.z, point.z);
+    }
+    return box;
+}
+
+bool BoundingBox::isValid() const
+{
+    return min.x <= max.x && min.y <= max.y && min.z <= max.z;
+}
+
+vec3 BoundingBox::center() const
+{
+    return vec3{(min.x + max.x) * 0.5f, (min.y + max.y) * 0.5f, (min.z + max.z) * 0.5f};
+}
+
+vec3 BoundingBox::extents() const
+{
+    return vec3{(max.x - min.x) * 0.5f, (max.y - min.y) * 0.5f, (max.z - min.z) * 0.5f};
+}
+
+float BoundingBox::surfaceArea() const
+{
+    const float dx = max.x - min.x;
+    const float dy = max.y - min.y;
+    const float dz = max.z - min.z;
+    return 2.0f * (dx * dy + dy * dz + dz * dx);
+}
+
+bool BoundingBox::contains(const BoundingBox& other) const
+{
+    return min.x <= other.min.x && min.y <= other.min.y && min.z <= other.min.z && other.max.x <= max.x &&
+           other.max.y <= max.y && other.max.z <= max.z;
+}
+
+void BoundingBox::merge(const BoundingBox& other)
+{
+    min.x = std::min(min.x, other.min.x);
+    min.y = std::min(min.y, other.min.y);
+    min.z = std::min(min.z, other.min.z);
+    max.x = std::max(max.x, other.max.x);
+    max.y = std::max(max.y, other.max.y);
+    max.z = std::max(max.z, other.max.z);
+}
+
+void BoundingBox::expand(const float& margin)
+{
+    min.x -= margin;
+    min.y -= margin;
+    min.z -= margin;
+    max.x += margin;
+    max.y += margin;
+    max.z += margin;
+}
+
+BoundingBox BoundingBox::transformed(const mat4& transform) const
+{
+    if(!isValid())
+    {
+        return *this;
+    }
+
+    // The transformed center plus the extents projected onto the absolute value of the rotation/scale part (Arvo).
+    // The matrix is column major, m[column * 4 + row].
+    const float* m = transform.m;
+    const vec3   c = center();
+    const vec3   e = extents();
+
+    float new_center[3];
+    float new_extents[3];
+    for(u32 row = 0; row < 3; ++row)
+    {
+        new_center[row]  = m[row] * c.x + m[4 + row] * c.y + m[8 + row] * c.z + m[12 + row];
+        new_extents[row] = std::abs(m[row]) * e.x + std::abs(m[4 + row]) * e.y + std::abs(m[8 + row]) * e.z;
+    }
+
+    BoundingBox result;
+    result.min = vec3{new_center[0] - new_extents[0], new_center[1] - new_extents[1], new_center[2] - new_extents[2]};
+    result.max = vec3{new_center[0] + new_extents[0], new_center[1] + new_extents[1], new_center[2] + new_extents[2]};
+    return result;
+}
+
+BoundingBox merge(const BoundingBox& a, const BoundingBox& b)
+{
+    BoundingBox result = a;
+    result.merge(b);
+    return result;
+}
+
+Frustum::Frustum()
+{
+    // every plane accepts everything until the frustum is extracted from a matrix
+    for(u32 i = 0; i < kPlaneCount; ++i)
+    {
+        m_x[i] = 0.0f;
+        m_y[i] = 0.0f;
+        m_z[i] = 0.0f;
+        m_w[i] = 1.0f;
+    }
+}
+
+Frustum Frustum::fromMatrix(const float* view_projection, const bool& clip_near)
+{
+    // Gribb/Hartmann: the planes are sums and differences of the fourth row with the other rows of the matrix.
+    const float* m       = view_projection;
+    const auto   element = [m](const u32& row, const u32& column) { return m[column * 4 + row]; };
+
+    Frustum frustum;
+    u32     plane = 0;
+    for(u32 axis = 0; axis < 3; ++axis)
+    {
+        for(const float sign : {1.0f, -1.0f})
+        {
+            if(axis == 2 && sign > 0.0f && !clip_near)
+            {
+                continue;
+            }
+            frustum.m_x[plane] = element(3, 0) + sign * element(axis, 0);
+            frustum.m_y[plane] = element(3, 1) + sign * element(axis, 1);
+            frustum.m_z[plane] = element(3, 2) + sign * element(axis, 2);
+            frustum.m_w[plane] = element(3, 3) + sign * element(axis, 3);
+            ++plane;
+        }
+    }
+    return frustum;
+}
+
+bool Frustum::intersects(const BoundingBox& box) const
+{
+    return classify(box) != FrustumTest::Outside;
+}
+
+FrustumTest Frustum::classify(const BoundingBox& box) const
+{
+    if(!box.isValid())
+    {
+        return FrustumTest::Intersecting;
+    }
+
+    // The box is outside once it is completely behind a plane (distance of the center plus the projected radius is
+    // negative) and inside when it is completely in front of all the planes.
+    const vec3 c = box.center();
+    const vec3 e = box.extents();
+
+#if SPUTNIK_FRUSTUM_SSE
+    const __m128 cx        = _mm_set1_ps(c.x);
+    const __m128 cy        = _mm_set1_ps(c.y);
+    const __m128 cz        = _mm_set1_ps(c.z);
+    const __m128 ex        = _mm_set1_ps(e.x);
+    const __m128 ey        = _mm_set1_ps(e.y);
+    const __m128 ez        = _mm_set1_ps(e.z);
+    const __m128 sign_mask = _mm_set1_ps(-0.0f);
+
+    int outside      = 0;
+    int intersecting = 0;
+    for(u32 i = 0; i < kPlaneCount; i += 4)
+    {
+        const __m128 px = _mm_load_ps(m_x + i);
+        const __m128 py = _mm_load_ps(m_y + i);
+        const __m128 pz = _mm_load_ps(m_z + i);
+        const __m128 pw = _mm_load_ps(m_w + i);
+
+        const __m128 distance =
+            _mm_add_ps(_mm_add_ps(_mm_mul_ps(px, cx), _mm_mul_ps(py, cy)), _mm_add_ps(_mm_mul_ps(pz, cz), pw));
+        const __m128 radius = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_andnot_ps(sign_mask, px), ex),
+                                                    _mm_mul_ps(_mm_andnot_ps(sign_mask, py), ey)),
+                                         _mm_mul_ps(_mm_andnot_ps(sign_mask, pz), ez));
+
+        outside |= _mm_movemask_ps(_mm_cmplt_ps(_mm_add_ps(distance, radius), _mm_setzero_ps()));
+        intersecting |= _mm_movemask_ps(_mm_cmplt_ps(_mm_sub_ps(distance, radius), _mm_setzero_ps()));
+    }
+#else
+    bool outside      = false;
+    bool intersecting = false;
+    for(u32 i = 0; i < kPlaneCount; ++i)
+    {
+        const float distance = m_x[i] * c.x + m_y[i] * c.y + m_z[i] * c.z + m_w[i];
+        const float radius   = std::abs(m_x[i]) * e.x + std::abs(m_y[i]) * e.y + std::abs(m_z[i]) * e.z;
+        outside |= distance + radius < 0.0f;
+        intersecting |= distance - radius < 0.0f;
+    }
+#endif
+
+    if(outside)
+    {
+        return FrustumTest::Outside;
+    }
+    return intersecting ? FrustumTest::Intersecting : FrustumTest::Inside;
+}
+
+} // namespace sputnik::graphics::core
@@ -0,0 +1,85 @@
+#pragma once
+
+#include "core/core.h"
+
+#include <vector.hpp>
+#include <matrix.hpp>
+#include <vector3.h>
+
+#include <vector>
+
+namespace sputnik::graphics::core
+{
+
+using namespace ramanujan::experimental;
+
+/*!
+ * @brief Axis aligned bounding box stored as its minimum and maximum corners. A default constructed box is empty and
+ * is treated as unbounded by the culling code, so geometry without bounds is never culled.
+ */
+struct BoundingBox
+{
+    vec3 min{kEmptyMin, kEmptyMin, kEmptyMin};
+    vec3 max{kEmptyMax, kEmptyMax, kEmptyMax};
+
+    static constexpr float kEmptyMin = 3.402823466e+38f;
+    static constexpr float kEmptyMax = -3.402823466e+38f;
+
+    static BoundingBox fromPoints(const std::vector<ramanujan::Vector3>& points);
+
+    bool isValid() const;
+    vec3 center() const;
+    vec3 extents() const; // half size
+    float surfaceArea() const;
+
+    bool contains(const BoundingBox& other) const;
+    void merge(const BoundingBox& other);
+    void expand(const float& margin);
+
+    /*!
+     * @brief Bounds of this box after it has been transformed by the (affine) matrix.
+     */
+    BoundingBox transformed(const mat4& transform) const;
+};
+
+BoundingBox merge(const BoundingBox& a, const BoundingBox& b);
+
+enum class FrustumTest : u8
+{
+    Outside = 0,
+    Intersecting,
+    Inside
+};
+
+/*!
+ * @brief The clip planes of a view projection matrix, used to cull bounding boxes.
+ *
+ * @details The planes are kept in structure of arrays form, padded to eight planes that accept everything, so that a
+ * box is tested against four planes at once with SSE. The planes are not normalized, the sign tests do not need it.
+ */
+class Frustum
+{
+public:
+    Frustum();
+
+    /*!
+     * @brief Extracts the planes of an OpenGL style (column major, -w <= z <= w) view projection matrix.
+     *
+     * @param clip_near Whether the near plane culls. Shadow casters in front of the near plane of a cascade still
+     * cast shadows (they are depth clamped), so the shadow frusta leave it open.
+     */
+    static Frustum fromMatrix(const float* view_projection, const bool& clip_near = true);
+
+    bool        intersects(const BoundingBox& box) const;
+    FrustumTest classify(const BoundingBox& box) const;
+
+private:
+    static constexpr u32 kPlaneCount = 8;
+
+    alignas(16) float m_x[kPlaneCount];
+    alignas(16) float m_y[kPlaneCount];
+    alignas(16) float m_z[kPlaneCount];
+    alignas(16) float m_w[kPlaneCount];
+};
+
+} // namespace sputnik::graphics::core
@@ -0,0 +1,330 @@
+#include "pch.h"
+#include "bvh.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace sputnik::graphics::core
+{
+
+DynamicBvh::DynamicBvh() {}
+
+u32 DynamicBvh::insert(const BoundingBox& bounds, const u32& user_data)
+{
+    SPUTNIK_ASSERT(bounds.isValid(), "Bounding volume hierarchy leaves need valid bounds.");
+
+    const u32 leaf          = allocateNode();
+    m_nodes[leaf].bounds    = bounds;
+    m_nodes[leaf].user_data = user_data;
+    m_nodes[leaf].height    = 0;
+    m_nodes[leaf].bounds.expand(kFatMargin);
+    insertLeaf(leaf);
+    ++m_leaf_count;
+    return leaf;
+}
+
+void DynamicBvh::remove(const u32& proxy)
+{
+    SPUTNIK_ASSERT(proxy < m_nodes.size() && m_nodes[proxy].isLeaf(), "Invalid bounding volume hierarchy proxy.");
+
+    removeLeaf(proxy);
+    freeNode(proxy);
+    --m_leaf_count;
+}
+
+bool DynamicBvh::update(const u32& proxy, const BoundingBox& bounds)
+{
+    SPUTNIK_ASSERT(proxy < m_nodes.size() && m_nodes[proxy].isLeaf(), "Invalid bounding volume hierarchy proxy.");
+
+    if(m_nodes[proxy].bounds.contains(bounds))
+    {
+        return false;
+    }
+
+    removeLeaf(proxy);
+    m_nodes[proxy].bounds = bounds;
+    m_nodes[proxy].bounds.expand(kFatMargin);
+    insertLeaf(proxy);
+    return true;
+}
+
+void DynamicBvh::query(const Frustum& frustum, std::vector<u32>& user_data) const
+{
+    if(m_root == kNullNode)
+    {
+        return;
+    }
+
+    // (node, whether an ancestor is completely inside the frustum)
+    std::vector<std::pair<u32, bool>> stack;
+    stack.reserve(64);
+    stack.push_back({m_root, false});
+    while(!stack.empty())
+    {
+        const auto [index, inside] = stack.back();
+        stack.pop_back();
+
+        const Node& node        = m_nodes[index];
+        bool        node_inside = inside;
+        if(!inside)
+        {
+            const FrustumTest test = frustum.classify(node.bounds);
+            if(test == FrustumTest::Outside)
+            {
+                continue;
+            }
+            node_inside = test == FrustumTest::Inside;
+        }
+
+        if(node.isLeaf())
+        {
+            user_data.push_back(node.user_data);
+        }
+        else
+        {
+            stack.push_back({node.child1, node_inside});
+            stack.push_back({node.child2, node_inside});
+        }
+    }
+}
+
+const BoundingBox& DynamicBvh::getFatBounds(const u32& proxy) const
+{
+    return m_nodes[proxy].bounds;
+}
+
+u32 DynamicBvh::getUserData(const u32& proxy) const
+{
+    return m_nodes[proxy].user_data;
+}
+
+u32 DynamicBvh::getHeight() const
+{
+    return m_root == kNullNode ? 0 : (u32)m_nodes[m_root].height;
+}
+
+u32 DynamicBvh::getLeafCount() const
+{
+    return m_leaf_count;
+}
+
+void DynamicBvh::clear()
+{
+    m_nodes.clear();
+    m_root       = kNullNode;
+    m_free_list  = kNullNode;
+    m_leaf_count = 0;
+}
+
+u32 DynamicBvh::allocateNode()
+{
+    if(m_free_list == kNullNode)
+    {
+        m_nodes.push_back({});
+        return (u32)m_nodes.size() - 1;
+    }
+
+    const u32 node = m_free_list;
+    m_free_list    = m_nodes[node].parent;
+    m_nodes[node]  = {};
+    return node;
+}
+
+void DynamicBvh::freeNode(const u32& node)
+{
+    m_nodes[node]        = {};
+    m_nodes[node].parent = m_free_list;
+    m_free_list          = node;
+}
+
+void DynamicBvh::insertLeaf(const u32& leaf)
+{
+    if(m_root == kNullNode)
+    {
+        m_root               = leaf;
+        m_nodes[leaf].parent = kNullNode;
+        return;
+    }
+
+    // Walk down to the best sibling. Pairing the leaf with a node costs the area of their union, every ancestor grows
+    // by the area the leaf adds to it (the inheritance cost).
+    const BoundingBox leaf_bounds = m_nodes[leaf].bounds;
+    u32               index       = m_root;
+    while(!m_nodes[index].isLeaf())
+    {
+        const Node& node = m_nodes[index];
+
+        const float area          = node.bounds.surfaceArea();
+        const float combined_area = merge(node.bounds, leaf_bounds).surfaceArea();
+
+        const float cost             = 2.0f * combined_area;
+        const float inheritance_cost = 2.0f * (combined_area - area);
+
+        const auto child_cost = [&](const u32& child)
+        {
+            const BoundingBox& child_bounds = m_nodes[child].bounds;
+            const float        new_area     = merge(child_bounds, leaf_bounds).surfaceArea();
+            if(m_nodes[child].isLeaf())
+            {
+                return new_area + inheritance_cost;
+            }
+            return new_area - child_bounds.surfaceArea() + inheritance_cost;
+        };
+        const float cost1 = child_cost(node.child1);
+        const float cost2 = child_cost(node.child2);
+
+        if(cost < cost1 && cost < cost2)
+        {
+            break;
+        }
+        index = cost1 < cost2 ? node.child1 : node.child2;
+    }
+
+    const u32 sibling    = index;
+    const u32 old_parent = m_nodes[sibling].parent;
+    const u32 new_parent = allocateNode();
+
+    m_nodes[new_parent].parent = old_parent;
+    m_nodes[new_parent].bounds = merge(leaf_bounds, m_nodes[sibling].bounds);
+    m_nodes[new_parent].height = m_nodes[sibling].height + 1;
+    m_nodes[new_parent].child1 = sibling;
+    m_nodes[new_parent].child2 = leaf;
+    m_nodes[sibling].parent    = new_parent;
+    m_nodes[leaf].parent       = new_parent;
+
+    if(old_parent == kNullNode)
+    {
+        m_root = new_parent;
+    }
+    else if(m_nodes[old_parent].child1 == sibling)
+    {
+        m_nodes[old_parent].child1 = new_parent;
+    }
+    else
+    {
+        m_nodes[old_parent].child2 = new_parent;
+    }
+
+    // refit and rebalance the ancestors
+    index = m_nodes[leaf].parent;
+    while(index != kNullNode)
+    {
+        index = balance(index);
+
+        Node& node  = m_nodes[index];
+        node.height = 1 + std::max(m_nodes[node.child1].height, m_nodes[node.child2].height);
+        node.bounds = merge(m_nodes[node.child1].bounds, m_nodes[node.child2].bounds);
+        index       = node.parent;
+    }
+}
+
+void DynamicBvh::removeLeaf(const u32& leaf)
+{
+    if(leaf == m_root)
+    {
+        m_root = kNullNode;
+        return;
+    }
+
+    const u32 parent       = m_nodes[leaf].parent;
+    const u32 grand_parent = m_nodes[parent].parent;
+    const u32 sibling      = m_nodes[parent].child1 == leaf ? m_nodes[parent].child2 : m_nodes[parent].child1;
+
+    freeNode(parent);
+    if(grand_parent == kNullNode)
+    {
+        m_root                  = sibling;
+        m_nodes[sibling].parent = kNullNode;
+        return;
+    }
+
+    // the sibling takes the place of the parent
+    if(m_nodes[grand_parent].child1 == parent)
+    {
+        m_nodes[grand_parent].child1 = sibling;
+    }
+    else
+    {
+        m_nodes[grand_parent].child2 = sibling;
+    }
+    m_nodes[sibling].parent = grand_parent;
+
+    u32 index = grand_parent;
+    while(index != kNullNode)
+    {
+        index = balance(index);
+
+        Node& node  = m_nodes[index];
+        node.height = 1 + std::max(m_nodes[node.child1].height, m_nodes[node.child2].height);
+        node.bounds = merge(m_nodes[node.child1].bounds, m_nodes[node.child2].bounds);
+        index       = node.parent;
+    }
+}
+
+u32 DynamicBvh::balance(const u32& a)
+{
+    // Rotates the taller child of a up if the heights of the children of a differ by more than one. Returns the index
+    // of the node that took the place of a.
+    if(m_nodes[a].isLeaf() || m_nodes[a].height < 2)
+    {
+        return a;
+    }
+
+    const u32 b = m_nodes[a].child1;
+    const u32 c = m_nodes[a].child2;
+
+    const i32 difference = m_nodes[c].height - m_nodes[b].height;
+    if(difference > 1 || difference < -1)
+    {
+        // up is the taller child, down the other one
+        const bool rotate_c = difference > 1;
+        const u32  up       = rotate_c ? c : b;
+        const u32  down     = rotate_c ? b : c;
+        const u32  f        = m_nodes[up].child1;
+        const u32  g        = m_nodes[up].child2;
+
+        // up takes the place of a, a becomes a child of up
+        m_nodes[up].child1 = a;
+        m_nodes[up].parent = m_nodes[a].parent;
+        m_nodes[a].parent  = up;
+
+        const u32 up_parent = m_nodes[up].parent;
+        if(up_parent == kNullNode)
+        {
+            m_root = up;
+        }
+        else if(m_nodes[up_parent].child1 == a)
+        {
+            m_nodes[up_parent].child1 = up;
+        }
+        else
+        {
+            m_nodes[up_parent].child2 = up;
+        }
+
+        // the taller grandchild stays with up, the shorter one replaces up under a
+        const u32 keep  = m_nodes[f].height > m_nodes[g].height ? f : g;
+        const u32 moved = keep == f ? g : f;
+
+        m_nodes[up].child2    = keep;
+        m_nodes[moved].parent = a;
+        if(rotate_c)
+        {
+            m_nodes[a].child2 = moved;
+        }
+        else
+        {
+            m_nodes[a].child1 = moved;
+        }
+
+        m_nodes[a].bounds  = merge(m_nodes[down].bounds, m_nodes[moved].bounds);
+        m_nodes[a].height  = 1 + std::max(m_nodes[down].height, m_nodes[moved].height);
+        m_nodes[up].bounds = merge(m_nodes[a].bounds, m_nodes[keep].bounds);
+        m_nodes[up].height = 1 + std::max(m_nodes[a].height, m_nodes[keep].height);
+        return up;
+    }
+
+    return a;
+}
+
+} // namespace sputnik::graphics::core
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "core/core.h"
+#include "bounds.h"
+
+#include <vector>
+
+namespace sputnik::graphics::core
+{
+
+/*!
+ * @brief A dynamic bounding volume hierarchy over renderables, used to cull whole subtrees against a frustum.
+ *
+ * @details Leaves store a fattened copy of the bounds of their renderable so that small movements do not touch the
+ * tree. Leaves are inserted next to the sibling that increases the surface area of the tree the least and the tree is
+ * kept balanced with rotations on the way back up, in the spirit of the dynamic tree of Box2D.
+ */
+class DynamicBvh
+{
+public:
+    static constexpr u32   kNullNode  = ~0u;
+    static constexpr float kFatMargin = 0.1f;
+
+    DynamicBvh();
+
+    /*!
+     * @brief Inserts a leaf and returns its proxy id, user_data is handed back by the queries.
+     */
+    u32  insert(const BoundingBox& bounds, const u32& user_data);
+    void remove(const u32& proxy);
+
+    /*!
+     * @brief Moves a leaf to new bounds. The leaf is only reinserted when the bounds leave its fat bounds.
+     *
+     * @return Whether the tree changed.
+     */
+    bool update(const u32& proxy, const BoundingBox& bounds);
+
+    /*!
+     * @brief Appends the user data of every leaf that intersects the frustum. Subtrees completely inside the frustum
+     * are accepted without testing their leaves.
+     */
+    void query(const Frustum& frustum, std::vector<u32>& user_data) const;
+
+    const BoundingBox& getFatBounds(const u32& proxy) const;
+    u32                getUserData(const u32& proxy) const;
+    u32                getHeight() const;
+    u32                getLeafCount() const;
+
+    void clear();
+
+private:
+    struct Node
+    {
+        BoundingBox bounds;
+        u32         parent{kNullNode}; // next free node while the node is on the free list
+        u32         child1{kNullNode};
+        u32         child2{kNullNode};
+        i32         height{-1}; // leaves are at height 0, free nodes at -1
+        u32         user_data{0};
+
+        bool isLeaf() const { return child1 == kNullNode; }
+    };
+
+    u32  allocateNode();
+    void freeNode(const u32& node);
+    void insertLeaf(const u32& leaf);
+    void removeLeaf(const u32& leaf);
+    u32  balance(const u32& node);
+
+    std::vector<Node> m_nodes;
+    u32               m_root{kNullNode};
+    u32               m_free_list{kNullNode};
+    u32               m_leaf_count{0};
+};
+
+} // namespace sputnik::graphics::core
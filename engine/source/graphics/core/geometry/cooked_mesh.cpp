@@ -0,0 +1,161 @@
+#include "pch.h"
+#include "cooked_mesh.h"
+
+#include <algorithm>
+
+namespace sputnik::graphics::core
+{
+
+template <typename T>
+static bool indicesInRange(const u8* data, const CookedStreamRange& range, const u32& vertex_count)
+{
+    const T* indices = (const T*)(data + range.offset);
+    return std::all_of(
+        indices, indices + range.bytes / sizeof(T), [&vertex_count](const T& index) { return index < vertex_count; });
+}
+
+CookedMeshFile::CookedMeshFile() {}
+
+bool CookedMeshFile::open(const std::string& path)
+{
+    close();
+    if(!m_file.open(path))
+    {
+        return false;
+    }
+
+    m_header  = (const CookedMeshHeader*)m_file.getData();
+    m_entries = (const CookedMeshEntry*)(m_file.getData() + sizeof(CookedMeshHeader));
+    if(!validate())
+    {
+        ENGINE_WARN("{} is not a valid version {} cooked mesh.", path, kCookedMeshVersion);
+        close();
+        return false;
+    }
+    return true;
+}
+
+void CookedMeshFile::close()
+{
+    m_file.close();
+    m_header  = nullptr;
+    m_entries = nullptr;
+}
+
+u32 CookedMeshFile::getMeshCount() const
+{
+    return m_header ? m_header->mesh_count : 0;
+}
+
+std::span<const u8> CookedMeshFile::getBytes() const
+{
+    return m_file.getBytes();
+}
+
+const std::string& CookedMeshFile::getPath() const
+{
+    return m_file.getPath();
+}
+
+MeshStreams CookedMeshFile::getStreams(const u32& mesh) const
+{
+    SPUTNIK_ASSERT(mesh < getMeshCount(), "Cooked mesh index out of range.");
+
+    MeshStreams streams;
+    streams.positions  = getStream<ramanujan::Vector3>(mesh, CookedStream::Position);
+    streams.normals    = getStream<ramanujan::Vector3>(mesh, CookedStream::Normal);
+    streams.uvs        = getStream<ramanujan::Vector2>(mesh, CookedStream::TexCoord);
+    streams.weights    = getStream<ramanujan::Vector4>(mesh, CookedStream::Weights);
+    streams.influences = getStream<ramanujan::IVector4>(mesh, CookedStream::Joints);
+    if(getCookedIndexStride(m_entries[mesh].vertex_count) == sizeof(u16))
+    {
+        streams.short_indices = getStream<u16>(mesh, CookedStream::Indices);
+    }
+    else
+    {
+        streams.indices = getStream<u32>(mesh, CookedStream::Indices);
+    }
+    streams.lods = {m_entries[mesh].lods, m_entries[mesh].lod_count};
+    return streams;
+}
+
+BoundingBox CookedMeshFile::getBounds(const u32& mesh) const
+{
+    SPUTNIK_ASSERT(mesh < getMeshCount(), "Cooked mesh index out of range.");
+
+    const CookedMeshEntry& entry = m_entries[mesh];
+    BoundingBox            bounds;
+    bounds.min = {entry.bounds_min[0], entry.bounds_min[1], entry.bounds_min[2]};
+    bounds.max = {entry.bounds_max[0], entry.bounds_max[1], entry.bounds_max[2]};
+    return bounds;
+}
+
+bool CookedMeshFile::validate() const
+{
+    const u64 size = m_file.getSize();
+    if(size < sizeof(CookedMeshHeader) || m_header->magic != kCookedMeshMagic ||
+       m_header->version != kCookedMeshVersion ||
+       (size - sizeof(CookedMeshHeader)) / sizeof(CookedMeshEntry) < m_header->mesh_count)
+    {
+        return false;
+    }
+
+    // every stream must lie within the file, be aligned and hold one element per vertex (or index)
+    for(u32 mesh = 0; mesh < m_header->mesh_count; ++mesh)
+    {
+        const CookedMeshEntry& entry = m_entries[mesh];
+        for(u32 stream = 0; stream < (u32)CookedStream::Count; ++stream)
+        {
+            const CookedStreamRange& range = entry.streams[stream];
+            if(range.bytes == 0)
+            {
+                continue;
+            }
+
+            const bool is_index = stream == (u32)CookedStream::Indices;
+            const u64  count    = is_index ? entry.index_count : entry.vertex_count;
+            const u64  stride   = is_index ? getCookedIndexStride(entry.vertex_count) : kCookedStreamStrides[stream];
+            if(range.offset % kCookedStreamAlignment != 0 || range.offset > size || range.bytes > size - range.offset ||
+               range.bytes != count * stride)
+            {
+                return false;
+            }
+        }
+
+        // a corrupt index would make the GPU read past the vertex buffers
+        const CookedStreamRange& indices       = entry.streams[(u32)CookedStream::Indices];
+        const bool               short_indices = getCookedIndexStride(entry.vertex_count) == sizeof(u16);
+        if(short_indices ? !indicesInRange<u16>(m_file.getData(), indices, entry.vertex_count)
+                         : !indicesInRange<u32>(m_file.getData(), indices, entry.vertex_count))
+        {
+            return false;
+        }
+
+        // the levels are ranges of the index stream, the first one is the full mesh
+        if(entry.lod_count == 0 || entry.lod_count > kMaxMeshLods || entry.lods[0].first_index != 0)
+        {
+            return false;
+        }
+        for(u32 lod = 0; lod < entry.lod_count; ++lod)
+        {
+            if(entry.lods[lod].first_index > entry.index_count ||
+               entry.lods[lod].index_count > entry.index_count - entry.lods[lod].first_index)
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+template <typename T>
+std::span<const T> CookedMeshFile::getStream(const u32& mesh, const CookedStream& stream) const
+{
+    static_assert(alignof(T) <= kCookedStreamAlignment, "Stream elements must not need more than the file alignment.");
+
+    const CookedStreamRange& range = m_entries[mesh].streams[(u32)stream];
+    SPUTNIK_ASSERT(range.bytes % sizeof(T) == 0, "Cooked stream element size mismatch.");
+    return {(const T*)(m_file.getData() + range.offset), (size_t)(range.bytes / sizeof(T))};
+}
+
+} // namespace sputnik::graphics::core
@@ -0,0 +1,119 @@
+#pragma once
+
+#include "core/core.h"
+#include "core/io/mapped_file.h"
+#include "mesh.h"
+#include "mesh_lod.h"
+
+#include <string>
+
+namespace sputnik::graphics::core
+{
+
+// A cooked mesh file holds the meshes of a model in the layout the renderer uploads them in:
+//
+//   CookedMeshHeader
+//   CookedMeshEntry[mesh_count]
+//   stream data, every stream starts at a multiple of kCookedStreamAlignment
+//
+// The streams are tightly packed arrays, one per vertex attribute plus the indices. Normals are normalized and the
+// joint indices refer to the nodes of the source file, like the glTF loader produces them. The indices are 16 bit for
+// meshes with at most kCookedShortIndexLimit vertices and 32 bit otherwise.
+//
+// Every mesh is indexed, welded and ordered for the post-transform vertex cache and for vertex fetch (see
+// MeshOptimizer). The index stream holds the levels of detail of the mesh one after the other, the full mesh first,
+// every level is a range of it that indexes the same vertices.
+
+enum class CookedStream : u32
+{
+    Position = 0,
+    Normal,
+    TexCoord,
+    Weights,
+    Joints,
+    Indices,
+    Count
+};
+
+constexpr u32 kCookedMeshMagic       = 0x48534d53; // "SMSH"
+constexpr u32 kCookedMeshVersion     = 3;
+constexpr u64 kCookedStreamAlignment = 16;
+constexpr u64 kCookedShortIndexLimit = 65536;
+
+// bytes per element of every stream, the index stride depends on the vertex count (see getCookedIndexStride())
+constexpr u64 kCookedStreamStrides[(u32)CookedStream::Count] = {12, 12, 8, 16, 16, 4};
+
+constexpr u64 getCookedIndexStride(const u64& vertex_count)
+{
+    return vertex_count <= kCookedShortIndexLimit ? 2 : 4;
+}
+
+struct CookedMeshHeader
+{
+    u32 magic;
+    u32 version;
+    u32 mesh_count;
+    u32 flags; // reserved
+};
+
+struct CookedStreamRange
+{
+    u64 offset; // from the start of the file
+    u64 bytes;  // 0 when the mesh does not have the stream
+};
+
+struct CookedMeshEntry
+{
+    u32               vertex_count;
+    u32               index_count; // of all the levels of detail
+    float             bounds_min[3];
+    float             bounds_max[3];
+    CookedStreamRange streams[(u32)CookedStream::Count];
+    u32               lod_count;
+    MeshLod           lods[kMaxMeshLods];
+    u32               reserved;
+};
+
+static_assert(sizeof(CookedMeshHeader) == 16, "The cooked mesh header layout is part of the file format.");
+static_assert(sizeof(CookedMeshEntry) == 184, "The cooked mesh entry layout is part of the file format.");
+
+/*!
+ * @brief A memory mapped cooked mesh file. The streams of its meshes point into the mapping, they stay valid while the
+ * file is open.
+ */
+class CookedMeshFile
+{
+public:
+    static constexpr const char* kExtension = ".smesh";
+
+    CookedMeshFile();
+
+    /*!
+     * @brief Maps the file and validates its header and stream ranges, returns false (and logs) for missing, truncated
+     * or outdated files.
+     */
+    bool open(const std::string& path);
+    void close();
+
+    u32         getMeshCount() const;
+    MeshStreams getStreams(const u32& mesh) const;
+    BoundingBox getBounds(const u32& mesh) const;
+
+    /*!
+     * @brief The whole mapped file, header included.
+     */
+    std::span<const u8> getBytes() const;
+    const std::string&  getPath() const;
+
+private:
+    bool validate() const;
+
+    template <typename T>
+    std::span<const T> getStream(const u32& mesh, const CookedStream& stream) const;
+
+    sputnik::core::MappedFile m_file;
+    const CookedMeshHeader*   m_header{nullptr};
+    const CookedMeshEntry*    m_entries{nullptr};
+};
+
+} // namespace sputnik::graphics::core
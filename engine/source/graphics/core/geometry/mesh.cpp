@@ -1,9 +1,11 @@
 #include "pch.h"
 #include "mesh.h"
+#include "vertex_quantization.h"
 #include <graphics/glcore/gl_buffer.h>
 #include <graphics/glcore/gl_vertex_array.h>
 #include <graphics/glcore/gl_renderer.h>
 #include <core/systems/render_system.h>
+#include <core/profiling/import_profiler.h>
 
 namespace sputnik::graphics::core
 {
@@ -34,6 +36,9 @@ Mesh& Mesh::operator=(Mesh&& other) noexcept
         m_weights          = std::move(other.m_weights);
         m_influences       = std::move(other.m_influences);
         m_indices          = std::move(other.m_indices);
+        m_lods             = std::move(other.m_lods);
+        m_bounds           = other.m_bounds;
+        m_vertex_format    = other.m_vertex_format;
     }
     return *this;
 }
@@ -70,8 +75,24 @@ std::vector<unsigned int>& Mesh::GetIndices()
     return m_indices;
 }
 
+void Mesh::computeBounds()
+{
+    m_bounds = BoundingBox::fromPoints(m_position);
+}
+
+const BoundingBox& Mesh::getBounds() const
+{
+    return m_bounds;
+}
+
 void Mesh::CpuSkin(const Skeleton& skeleton, const Pose& pose)
 {
+    if(m_vertex_format != VertexFormat::Full)
+    {
+        ENGINE_ERROR("Packed meshes can not be skinned on the CPU, load it with the Full vertex format.");
+        return;
+    }
+
     size_t num_vertices = m_position.size();
     if(num_vertices == 0)
     {
@@ -131,6 +152,12 @@ void Mesh::CpuSkin(const Skeleton& skeleton, const Pose& pose)
 
 void Mesh::CpuSkin(const std::vector<ramanujan::Matrix4>& skin_transform)
 {
+    if(m_vertex_format != VertexFormat::Full)
+    {
+        ENGINE_ERROR("Packed meshes can not be skinned on the CPU, load it with the Full vertex format.");
+        return;
+    }
+
     size_t num_vertices = m_position.size();
     if(num_vertices == 0)
     {
@@ -173,8 +200,34 @@ void Mesh::CpuSkin(const std::vector<ramanujan::Matrix4>& skin_transform)
 
 void Mesh::ResetOpenglBuffersToBindPose()
 {
+    if(m_vertex_format == VertexFormat::Packed)
+    {
+        // packed relative to the bounds the vertex array decodes with
+        PackedVertexStreams packed =
+            VertexQuantization::pack({m_position, m_normal, m_uv, m_weights, m_influences}, m_bounds);
+        if(!packed.positions.empty())
+        {
+            m_position_buffer->setData(packed.positions.data(), packed.positions.size() * sizeof(u16));
+        }
+        if(!packed.normals.empty())
+        {
+            m_normal_buffer->setData(packed.normals.data(), packed.normals.size() * sizeof(i16));
+        }
+        if(!packed.uvs.empty())
+        {
+            m_uv_buffer->setData(packed.uvs.data(), packed.uvs.size() * sizeof(u16));
+        }
+        if(!packed.weights.empty())
+        {
+            m_weight_buffer->setData(packed.weights.data(), packed.weights.size());
+        }
+        if(!packed.joints.empty())
+        {
+            m_influence_buffer->setData(packed.joints.data(), packed.joints.size());
+        }
+    }
     // Update data for the buffers here
-    if(m_position.size() > 0)
+    else if(m_position.size() > 0)
     {
         m_position_buffer->setData(&m_position[0], m_position.size() * sizeof(ramanujan::Vector3));
     }
@@ -194,7 +247,12 @@ void Mesh::ResetOpenglBuffersToBindPose()
     {
         m_influence_buffer->setData(&m_influences[0], (u64)m_influences.size() * sizeof(ramanujan::IVector4));
     }
-    if(m_indices.size() > 0)
+    if(m_indices.size() > 0 && m_vertex_array->getIndexType() == IndexType::UnsignedShort)
+    {
+        const std::vector<u16> short_indices(m_indices.begin(), m_indices.end());
+        m_index_buffer->setData((void*)short_indices.data(), short_indices.size() * sizeof(u16));
+    }
+    else if(m_indices.size() > 0)
     {
         m_index_buffer->setData(&m_indices[0], m_indices.size() * sizeof(unsigned int));
     }
@@ -205,7 +263,7 @@ void Mesh::Draw()
     m_vertex_array->bind();
     if(m_indices.size() > 0)
     {
-        OglRenderer::drawElements((u64)m_indices.size(), DrawMode::TRIANGLES);
+        OglRenderer::drawElements((u64)m_indices.size(), DrawMode::TRIANGLES, m_vertex_array->getIndexType());
         // glcore::Renderer::DrawElements((u64)m_indices.size(), glcore::DrawMode::TRIANGLES);
     }
     else
@@ -216,49 +274,55 @@ void Mesh::Draw()
     m_vertex_array->unbind();
 }
 
-void Mesh::draw(const Material& material, const mat4& model)
+// The draws below pass the vertex array to the render system instead of binding it, so meshes can be drawn from any
+// thread.
+void Mesh::draw(const Material& material, const mat4& model, u8* lod_history)
 {
-    auto render_system = sputnik::core::systems::RenderSystem::getInstance();
-    m_vertex_array->bind();
+    auto           render_system = sputnik::core::systems::RenderSystem::getInstance();
+    const DrawLods lods{m_lods, m_bounds, lod_history};
     if(m_indices.size() > 0)
     {
-        render_system->drawTrianglesIndexed((u64)m_indices.size(), material, model);
+        render_system->submitTriangles(*m_vertex_array, (u64)m_indices.size(), true, material, model, m_bounds, lods);
     }
     else
     {
-        render_system->drawTriangles((u64)m_position.size(), material, model);
+        render_system->submitTriangles(*m_vertex_array, (u64)m_position.size(), false, material, model, m_bounds);
     }
-    m_vertex_array->unbind();
 }
 
-void Mesh::draw(const Material& material, const mat4& model, const std::vector<Matrix4>& skin_transformations)
+void Mesh::draw(const Material&             material,
+                const mat4&                 model,
+                const std::vector<Matrix4>& skin_transformations,
+                u8*                         lod_history)
 {
-    auto render_system = sputnik::core::systems::RenderSystem::getInstance();
-    m_vertex_array->bind();
+    // the levels of detail of skinned meshes are selected by their bind pose bounds
+    auto           render_system = sputnik::core::systems::RenderSystem::getInstance();
+    const DrawLods lods{m_lods, m_bounds, lod_history};
     if(m_indices.size() > 0)
     {
-        render_system->drawTrianglesIndexed((u64)m_indices.size(), material, model, skin_transformations);
+        render_system->submitTriangles(
+            *m_vertex_array, (u64)m_indices.size(), material, model, skin_transformations, lods);
     }
     else
     {
-        render_system->drawTriangles((u64)m_position.size(), material, model);
+        render_system->submitTriangles(*m_vertex_array, (u64)m_position.size(), false, material, model);
     }
-    m_vertex_array->unbind();
 }
 
-void Mesh::drawInstanced(const Material& material, const u32& num_instances)
+void Mesh::drawInstanced(const Material&              material,
+                         const std::span<const mat4>& models,
+                         const std::span<const vec4>& colors)
 {
     auto render_system = sputnik::core::systems::RenderSystem::getInstance();
-    m_vertex_array->bind();
     if(m_indices.size() > 0)
     {
-        render_system->drawTrianglesIndexedInstanced((u64)m_indices.size(), material, num_instances);
+        render_system->submitTrianglesInstanced(*m_vertex_array, (u64)m_indices.size(), true, material, models, colors);
     }
     else
     {
-        render_system->drawTrianglesInstanced((u64)m_position.size(), material, num_instances);
+        render_system->submitTrianglesInstanced(
+            *m_vertex_array, (u64)m_position.size(), false, material, models, colors);
     }
-    m_vertex_array->unbind();
 }
 
 void Mesh::DrawInstanced(unsigned int num_instances)
@@ -266,7 +330,8 @@ void Mesh::DrawInstanced(unsigned int num_instances)
     m_vertex_array->bind();
     if(m_indices.size() > 0)
     {
-        OglRenderer::drawElementsInstanced((u64)m_indices.size(), num_instances, DrawMode::TRIANGLES);
+        OglRenderer::drawElementsInstanced(
+            (u64)m_indices.size(), num_instances, DrawMode::TRIANGLES, m_vertex_array->getIndexType());
         // glcore::Renderer::DrawElementsInstanced((u64)m_indices.size(), num_instances, glcore::DrawMode::TRIANGLES);
     }
     else
@@ -281,59 +346,173 @@ void Mesh::DrawInstanced(unsigned int num_instances)
 
 void Mesh::initializeGpuBuffers()
 {
-    m_vertex_array = std::make_shared<OglVertexArray>();
+    createGpuBuffers({m_position, m_normal, m_uv, m_weights, m_influences, m_indices});
+}
 
-    if(m_position.size() > 0)
+void Mesh::initialize(const MeshStreams& streams, const BoundingBox& bounds)
+{
+    m_position.assign(streams.positions.begin(), streams.positions.end());
+    m_normal.assign(streams.normals.begin(), streams.normals.end());
+    m_uv.assign(streams.uvs.begin(), streams.uvs.end());
+    m_weights.assign(streams.weights.begin(), streams.weights.end());
+    m_influences.assign(streams.influences.begin(), streams.influences.end());
+    // the CPU copy (and the element count of the draws) only covers the full mesh, the first level
+    const size_t index_count = std::max(streams.indices.size(), streams.short_indices.size());
+    const size_t full_count  = streams.lods.empty() ? index_count : streams.lods[0].index_count;
+    if(!streams.short_indices.empty())
     {
-        m_position_buffer = std::make_shared<OglBuffer>(&m_position[0], m_position.size() * sizeof(ramanujan::Vector3));
+        m_indices.assign(streams.short_indices.begin(), streams.short_indices.begin() + full_count);
+    }
+    else
+    {
+        m_indices.assign(streams.indices.begin(), streams.indices.begin() + full_count);
+    }
+    m_lods.assign(streams.lods.begin(), streams.lods.end());
+    m_bounds = bounds;
+
+    createGpuBuffers(streams);
+}
+
+void Mesh::createGpuBuffers(const MeshStreams& streams)
+{
+    sputnik::core::ImportScope import_scope(sputnik::core::ImportStage::Upload);
+
+    m_vertex_array  = std::make_shared<OglVertexArray>();
+    m_vertex_format = m_default_vertex_format;
+    if(m_vertex_format == VertexFormat::Packed && !VertexQuantization::canPack(streams))
+    {
+        ENGINE_WARN("The joint indices of a mesh do not fit in 8 bits, it is uploaded at full precision.");
+        m_vertex_format = VertexFormat::Full;
+    }
+    import_scope.addBytesUploaded(VertexQuantization::getVertexBytes(streams, m_vertex_format == VertexFormat::Packed) +
+                                  streams.indices.size_bytes() + streams.short_indices.size_bytes());
+
+    if(m_vertex_format == VertexFormat::Packed)
+    {
+        createPackedVertexBuffers(streams);
+    }
+    else
+    {
+        createVertexBuffers(streams);
+    }
+
+    // OglBuffer does not write through the pointer, the casts only drop the const
+    if(!streams.short_indices.empty())
+    {
+        m_index_buffer =
+            std::make_shared<OglBuffer>((void*)streams.short_indices.data(), streams.short_indices.size_bytes());
+        m_vertex_array->setIndexBuffer(*m_index_buffer.get(), IndexType::UnsignedShort);
+    }
+    else if(!streams.indices.empty())
+    {
+        m_index_buffer = std::make_shared<OglBuffer>((void*)streams.indices.data(), streams.indices.size_bytes());
+        m_vertex_array->setIndexBuffer(*m_index_buffer.get());
+    }
+}
+
+void Mesh::createVertexBuffers(const MeshStreams& streams)
+{
+    if(!streams.positions.empty())
+    {
+        m_position_buffer =
+            std::make_shared<OglBuffer>((void*)streams.positions.data(), streams.positions.size_bytes());
         m_vertex_array->addVertexBuffer(
             *m_position_buffer.get(),
             {.binding_index = 0, .stride = 12}, // 3 * sizeof(float)
             {{.name = "position", .location = 0, .type = VertexAttributeType::Float3, .normalized = false}});
     }
 
-    if(m_normal.size() > 0)
+    if(!streams.normals.empty())
     {
-        m_normal_buffer = std::make_shared<OglBuffer>(&m_normal[0], m_normal.size() * sizeof(ramanujan::Vector3));
+        m_normal_buffer = std::make_shared<OglBuffer>((void*)streams.normals.data(), streams.normals.size_bytes());
         m_vertex_array->addVertexBuffer(
             *m_normal_buffer.get(),
             {.binding_index = 1, .stride = 12}, // 3 * sizeof(float)
             {{.name = "normal", .location = 1, .type = VertexAttributeType::Float3, .normalized = false}});
     }
 
-    if(m_uv.size() > 0)
+    if(!streams.uvs.empty())
     {
-        m_uv_buffer = std::make_shared<OglBuffer>(&m_uv[0], m_uv.size() * sizeof(ramanujan::Vector2));
+        m_uv_buffer = std::make_shared<OglBuffer>((void*)streams.uvs.data(), streams.uvs.size_bytes());
         m_vertex_array->addVertexBuffer(
             *m_uv_buffer.get(),
             {.binding_index = 2, .stride = 8}, // 2 * sizeof(float)
             {{.name = "uv", .location = 2, .type = VertexAttributeType::Float2, .normalized = false}});
     }
 
-    if(m_weights.size() > 0)
+    if(!streams.weights.empty())
     {
-        m_weight_buffer =
-            std::make_shared<OglBuffer>(&m_weights[0], (u64)m_weights.size() * sizeof(ramanujan::Vector4));
+        m_weight_buffer = std::make_shared<OglBuffer>((void*)streams.weights.data(), streams.weights.size_bytes());
         m_vertex_array->addVertexBuffer(
             *m_weight_buffer.get(),
             {.binding_index = 3, .stride = 16}, // 4 * sizeof(float)
             {{.name = "weights", .location = 3, .type = VertexAttributeType::Float4, .normalized = false}});
     }
 
-    if(m_influences.size() > 0)
+    if(!streams.influences.empty())
     {
         m_influence_buffer =
-            std::make_shared<OglBuffer>(&m_influences[0], (u64)m_influences.size() * sizeof(ramanujan::IVector4));
+            std::make_shared<OglBuffer>((void*)streams.influences.data(), streams.influences.size_bytes());
         m_vertex_array->addVertexBuffer(
             *m_influence_buffer.get(),
             {.binding_index = 4, .stride = 16}, // 4 * sizeof(int)
             {{.name = "joints", .location = 4, .type = VertexAttributeType::Int4, .normalized = false}});
     }
+}
 
-    if(m_indices.size() > 0)
+void Mesh::createPackedVertexBuffers(const MeshStreams& streams)
+{
+    // the streams keep their bindings and locations, only their formats change
+    if(!m_bounds.isValid())
     {
-        m_index_buffer = std::make_shared<OglBuffer>(&m_indices[0], m_indices.size() * sizeof(unsigned int));
-        m_vertex_array->setIndexBuffer(*m_index_buffer.get());
+        computeBounds();
+    }
+    PackedVertexStreams packed = VertexQuantization::pack(streams, m_bounds);
+    m_vertex_array->setVertexDecode(VertexQuantization::getDecode(m_bounds));
+
+    if(!packed.positions.empty())
+    {
+        m_position_buffer = std::make_shared<OglBuffer>(packed.positions.data(), packed.positions.size() * sizeof(u16));
+        m_vertex_array->addVertexBuffer(
+            *m_position_buffer.get(),
+            {.binding_index = 0, .stride = 8}, // 4 * sizeof(u16)
+            {{.name = "position", .location = 0, .type = VertexAttributeType::UShort4, .normalized = true}});
+    }
+
+    if(!packed.normals.empty())
+    {
+        m_normal_buffer = std::make_shared<OglBuffer>(packed.normals.data(), packed.normals.size() * sizeof(i16));
+        m_vertex_array->addVertexBuffer(
+            *m_normal_buffer.get(),
+            {.binding_index = 1, .stride = 4}, // 2 * sizeof(i16)
+            {{.name = "normal", .location = 1, .type = VertexAttributeType::Short2, .normalized = true}});
+    }
+
+    if(!packed.uvs.empty())
+    {
+        m_uv_buffer = std::make_shared<OglBuffer>(packed.uvs.data(), packed.uvs.size() * sizeof(u16));
+        m_vertex_array->addVertexBuffer(
+            *m_uv_buffer.get(),
+            {.binding_index = 2, .stride = 4}, // 2 * sizeof(half)
+            {{.name = "uv", .location = 2, .type = VertexAttributeType::Half2, .normalized = false}});
+    }
+
+    if(!packed.weights.empty())
+    {
+        m_weight_buffer = std::make_shared<OglBuffer>(packed.weights.data(), packed.weights.size());
+        m_vertex_array->addVertexBuffer(
+            *m_weight_buffer.get(),
+            {.binding_index = 3, .stride = 4}, // 4 * sizeof(u8)
+            {{.name = "weights", .location = 3, .type = VertexAttributeType::UByte4, .normalized = true}});
+    }
+
+    if(!packed.joints.empty())
+    {
+        m_influence_buffer = std::make_shared<OglBuffer>(packed.joints.data(), packed.joints.size());
+        m_vertex_array->addVertexBuffer(
+            *m_influence_buffer.get(),
+            {.binding_index = 4, .stride = 4}, // 4 * sizeof(u8)
+            {{.name = "joints", .location = 4, .type = VertexAttributeType::UByteInt4, .normalized = false}});
     }
 }
 
@@ -342,13 +521,57 @@ std::shared_ptr<OglVertexArray> Mesh::getVertexArray() const
     return m_vertex_array;
 }
 
+const std::vector<MeshLod>& Mesh::getLods() const
+{
+    return m_lods;
+}
+
+const VertexFormat& Mesh::getVertexFormat() const
+{
+    return m_vertex_format;
+}
+
+void Mesh::setDefaultVertexFormat(const VertexFormat& format)
+{
+    m_default_vertex_format = format;
+}
+
+const VertexFormat& Mesh::getDefaultVertexFormat()
+{
+    return m_default_vertex_format;
+}
+
+u64 Mesh::getGpuVertexBytes(const MeshStreams& streams)
+{
+    const bool packed = m_default_vertex_format == VertexFormat::Packed && VertexQuantization::canPack(streams);
+    return VertexQuantization::getVertexBytes(streams, packed);
+}
+
+u64 Mesh::getCpuBytes(const MeshStreams& streams)
+{
+    const u64 index_count = streams.lods.empty() ? streams.indices.size() + streams.short_indices.size()
+                                                 : streams.lods[0].index_count;
+    return VertexQuantization::getVertexBytes(streams, false) + index_count * sizeof(u32);
+}
+
 void Mesh::updatePositionBuffer(void* data, const u64& byte)
 {
+    if(m_vertex_format != VertexFormat::Full)
+    {
+        // the packed buffer has a different layout, writing the full precision data into it would corrupt it
+        ENGINE_ERROR("The position buffer of a packed mesh can not be updated, load it with the Full vertex format.");
+        return;
+    }
     m_position_buffer->setData(data, byte);
 }
 
 void Mesh::updateNormalBuffer(void* data, const u64& byte)
 {
+    if(m_vertex_format != VertexFormat::Full)
+    {
+        ENGINE_ERROR("The normal buffer of a packed mesh can not be updated, load it with the Full vertex format.");
+        return;
+    }
     m_normal_buffer->setData(data, byte);
 }
 
@@ -3,6 +3,8 @@
 #include "pch.h"
 #include "graphics/core/animation/skeleton.h"
 #include "graphics/api/color_material.h"
+#include "graphics/core/geometry/bounds.h"
+#include "graphics/core/geometry/mesh_lod.h"
 
 #include <vector2.h>
 #include <vector3.h>
@@ -10,6 +12,7 @@
 #include <matrix4.h>
 
 #include <memory>
+#include <span>
 
 namespace sputnik::graphics::gl
 {
@@ -23,6 +26,30 @@ namespace sputnik::graphics::core
 using namespace sputnik::graphics::gl;
 using namespace sputnik::graphics::api;
 
+/*!
+ * @brief Non owning view of the vertex streams of a mesh. Every stream that is not empty has one element per vertex.
+ */
+struct MeshStreams
+{
+    std::span<const ramanujan::Vector3>  positions;
+    std::span<const ramanujan::Vector3>  normals;
+    std::span<const ramanujan::Vector2>  uvs;
+    std::span<const ramanujan::Vector4>  weights;
+    std::span<const ramanujan::IVector4> influences;
+    std::span<const u32>                 indices;
+    std::span<const u16>                 short_indices; // used instead of indices, uploaded as 16 bit indices
+    std::span<const MeshLod>             lods;          // ranges of the indices, empty for a single level
+};
+
+/*!
+ * @brief Layouts the vertex streams of a mesh are uploaded in. The CPU copies always keep full precision.
+ */
+enum class VertexFormat : u8
+{
+    Full = 0, // float positions, normals, uvs and weights, 32 bit joint indices
+    Packed    // quantized streams, see PackedVertexStreams
+};
+
 /**
  * This is a naive implementation of a mesh construct. It is not production ready.
  */
@@ -48,33 +75,85 @@ public:
     std::vector<ramanujan::IVector4>& GetInfluences();
     std::vector<unsigned int>&        GetIndices();
 
+    /*!
+     * @brief Recomputes the bounds of the mesh from its (bind pose) positions. Called by the loader once the mesh has
+     * been read.
+     */
+    void               computeBounds();
+    const BoundingBox& getBounds() const;
+
     void CpuSkin(const Skeleton& skeleton, const Pose& pose);
     void CpuSkin(const std::vector<ramanujan::Matrix4>& skin_transform);
     void ResetOpenglBuffersToBindPose();
     // void Bind(int position_slot, int normal_slot, int uv_slot, int weight_slot, int influence_slot);
 
     void Draw();
-    void draw(const Material& material, const mat4& model);
-    void draw(const Material& material, const mat4& model, const std::vector<Matrix4>& skin_transformations);
-    void drawInstanced(const Material& material, const u32& num_instances);
+
+    /*!
+     * @brief Submits the mesh, with the level of detail its projected error calls for when it has several.
+     * lod_history holds the level the instance was drawn with last (see DrawLods), it may be nullptr.
+     */
+    void draw(const Material& material, const mat4& model, u8* lod_history = nullptr);
+    void draw(const Material&             material,
+              const mat4&                 model,
+              const std::vector<Matrix4>& skin_transformations,
+              u8*                         lod_history = nullptr);
+    void drawInstanced(const Material&              material,
+                       const std::span<const mat4>& models,
+                       const std::span<const vec4>& colors = {});
     void DrawInstanced(unsigned int num_instances);
     // void Unbind(int position_slot, int normal_slot, int uv_slot, int weight_slot, int influence_slot);
 
     void initializeGpuBuffers();
 
+    /*!
+     * @brief Initializes the mesh from streams it does not own, e.g. a memory mapped cooked mesh. The GPU buffers are
+     * created straight from the streams, the CPU copies (used by skinning, static batching and physics) are filled with
+     * one bulk copy per stream.
+     */
+    void initialize(const MeshStreams& streams, const BoundingBox& bounds);
+
     std::shared_ptr<OglVertexArray> getVertexArray() const;
+    const std::vector<MeshLod>&     getLods() const;
+    const VertexFormat&             getVertexFormat() const;
+
+    /*!
+     * @brief Layout the meshes that are uploaded from now on use. Meshes whose joint indices do not fit the packed
+     * layout are uploaded at full precision. Packed meshes can not be skinned on the CPU or have their buffers updated.
+     */
+    static void                setDefaultVertexFormat(const VertexFormat& format);
+    static const VertexFormat& getDefaultVertexFormat();
+
+    /*!
+     * @brief Size of the vertex buffers the streams are uploaded to with the default layout.
+     */
+    static u64 getGpuVertexBytes(const MeshStreams& streams);
+
+    /*!
+     * @brief Size of the CPU copies of the streams, at full precision and with the 32 bit indices of the full mesh.
+     */
+    static u64 getCpuBytes(const MeshStreams& streams);
 
     void updatePositionBuffer(void* data, const u64& byte);
     void updateNormalBuffer(void* data, const u64& byte);
 
 protected:
+    void createGpuBuffers(const MeshStreams& streams);
+    void createVertexBuffers(const MeshStreams& streams);
+    void createPackedVertexBuffers(const MeshStreams& streams);
+
     // cpu data
     std::vector<ramanujan::Vector3>  m_position;
     std::vector<ramanujan::Vector3>  m_normal;
     std::vector<ramanujan::Vector2>  m_uv;
     std::vector<ramanujan::Vector4>  m_weights;
     std::vector<ramanujan::IVector4> m_influences;
-    std::vector<unsigned int>        m_indices;
+    std::vector<unsigned int>        m_indices; // of the full mesh, the coarser levels are only on the GPU
+    std::vector<MeshLod>             m_lods;    // empty for meshes with a single level
+    BoundingBox                      m_bounds;
+    VertexFormat                     m_vertex_format{VertexFormat::Full};
+
+    inline static VertexFormat m_default_vertex_format = VertexFormat::Full;
 
     // vertex buffers : gpu data
     // std::shared_ptr<glcore::VertexAttribute<ramanujan::Vector3>>  m_position_attribute;
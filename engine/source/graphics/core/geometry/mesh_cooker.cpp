@@ -0,0 +1,447 @@
+#include "pch.h"
+#include "mesh_cooker.h"
+#include "cooked_mesh.h"
+#include "mesh_optimizer.h"
+#include "graphics/glcore/gltf_loader.h"
+#include "core/profiling/import_profiler.h"
+
+#include <vector2.h>
+#include <vector3.h>
+#include <vector4.h>
+
+#include <algorithm>
+#include <array>
+#include <filesystem>
+#include <numeric>
+
+namespace sputnik::graphics::core
+{
+
+namespace
+{
+
+static_assert(sizeof(ramanujan::Vector3) == kCookedStreamStrides[(u32)CookedStream::Position]);
+static_assert(sizeof(ramanujan::Vector2) == kCookedStreamStrides[(u32)CookedStream::TexCoord]);
+static_assert(sizeof(ramanujan::Vector4) == kCookedStreamStrides[(u32)CookedStream::Weights]);
+static_assert(sizeof(ramanujan::IVector4) == kCookedStreamStrides[(u32)CookedStream::Joints]);
+
+// every level of detail aims for half the triangles of the previous one, levels that do not get below
+// kLodMinReduction of it are not worth their memory and end the chain
+constexpr float kLodReduction    = 0.5f;
+constexpr float kLodMinReduction = 0.8f;
+
+// the simplification stops once the surface would move by more than this fraction of the size of the mesh
+constexpr float kLodMaxRelativeError = 0.1f;
+
+struct MeshData
+{
+    std::vector<ramanujan::Vector3>  positions;
+    std::vector<ramanujan::Vector3>  normals;
+    std::vector<ramanujan::Vector2>  uvs;
+    std::vector<ramanujan::Vector4>  weights;
+    std::vector<ramanujan::IVector4> influences;
+    std::vector<u32>                 indices;
+    std::vector<u16>                 short_indices; // written instead of indices when the vertex count allows
+    std::vector<MeshLod>             lods;          // ranges of indices, the levels are stored one after the other
+
+    std::array<std::span<const std::byte>, (u32)CookedStream::Count> getStreamBytes() const
+    {
+        const bool is_short = getCookedIndexStride(positions.size()) == sizeof(u16);
+        return {std::as_bytes(std::span(positions)),
+                std::as_bytes(std::span(normals)),
+                std::as_bytes(std::span(uvs)),
+                std::as_bytes(std::span(weights)),
+                std::as_bytes(std::span(influences)),
+                is_short ? std::as_bytes(std::span(short_indices)) : std::as_bytes(std::span(indices))};
+    }
+};
+
+struct CookStatistics
+{
+    u64   source_vertices{0};
+    u64   cooked_vertices{0};
+    u64   triangles{0};
+    u64   lod_triangles{0}; // of the coarsest level of every mesh
+    float source_misses{0.0f};
+    float cooked_misses{0.0f};
+};
+
+u64 alignUp(const u64& offset)
+{
+    return (offset + kCookedStreamAlignment - 1) / kCookedStreamAlignment * kCookedStreamAlignment;
+}
+
+/*!
+ * @brief Reads the whole accessor with one call into out, whose elements are float vectors of the accessor's size.
+ */
+template <typename T>
+bool unpackFloats(const cgltf_accessor& accessor, std::vector<T>& out)
+{
+    if(cgltf_num_components(accessor.type) * sizeof(float) != sizeof(T))
+    {
+        return false;
+    }
+    out.resize(accessor.count);
+    cgltf_accessor_unpack_floats(&accessor, (cgltf_float*)out.data(), accessor.count * sizeof(T) / sizeof(float));
+    return true;
+}
+
+bool readAttribute(MeshData& mesh, const cgltf_attribute& attribute, const cgltf_data& data, const cgltf_skin* skin)
+{
+    const cgltf_accessor& accessor = *attribute.data;
+    switch(attribute.type)
+    {
+    case cgltf_attribute_type_position:
+        return unpackFloats(accessor, mesh.positions);
+    case cgltf_attribute_type_normal:
+    {
+        if(!unpackFloats(accessor, mesh.normals))
+        {
+            return false;
+        }
+        for(ramanujan::Vector3& normal : mesh.normals)
+        {
+            if(ramanujan::LengthSq(normal) < ramanujan::Constants::EPSILON)
+            {
+                normal = ramanujan::Vector3(0.0f, 0.0f, 1.0f);
+            }
+            normal = ramanujan::Normalized(normal);
+        }
+        return true;
+    }
+    case cgltf_attribute_type_texcoord:
+        // the meshes have a single uv channel
+        return attribute.index != 0 || unpackFloats(accessor, mesh.uvs);
+    case cgltf_attribute_type_weights:
+        return unpackFloats(accessor, mesh.weights);
+    case cgltf_attribute_type_joints:
+    {
+        std::vector<ramanujan::Vector4> joints;
+        if(!unpackFloats(accessor, joints))
+        {
+            return false;
+        }
+
+        // the skin's joint indices are replaced by the indices of the joint nodes, like the glTF loader does
+        const auto toNodeIndex = [&](const float& joint) -> int
+        {
+            const size_t index = (size_t)(joint + 0.5f);
+            return skin && index < skin->joints_count ? std::max(0, (int)(skin->joints[index] - data.nodes)) : 0;
+        };
+        mesh.influences.resize(joints.size());
+        for(size_t i = 0; i < joints.size(); ++i)
+        {
+            mesh.influences[i] = ramanujan::IVector4(toNodeIndex(joints[i].x),
+                                                     toNodeIndex(joints[i].y),
+                                                     toNodeIndex(joints[i].z),
+                                                     toNodeIndex(joints[i].w));
+        }
+        return true;
+    }
+    default:
+        return true;
+    }
+}
+
+/*!
+ * @brief Drops the vertex streams whose size does not match the positions, the cooked format needs one element per
+ * vertex in every stream.
+ */
+template <typename T>
+void dropMismatchedStream(std::vector<T>& stream, const MeshData& mesh, const char* name, const std::string& path)
+{
+    if(!stream.empty() && stream.size() != mesh.positions.size())
+    {
+        ENGINE_WARN("{}: dropped the {} stream of a mesh, it has {} elements for {} vertices.",
+                    path,
+                    name,
+                    stream.size(),
+                    mesh.positions.size());
+        stream.clear();
+    }
+}
+
+/*!
+ * @brief Appends the simplified levels of detail of the mesh to its indices. Every level is simplified from the full
+ * mesh, so its error is measured against the full mesh.
+ */
+void generateLods(MeshData& mesh)
+{
+    const u32   full_index_count = (u32)mesh.indices.size();
+    const vec3  extents          = BoundingBox::fromPoints(mesh.positions).extents();
+    const float size             = 2.0f * std::max({extents.x, extents.y, extents.z});
+    const float max_error        = kLodMaxRelativeError * size;
+
+    // the simplifier reads three floats per vertex
+    const std::span<const float> positions((const float*)mesh.positions.data(), mesh.positions.size() * 3);
+
+    u32 previous_index_count = full_index_count;
+    while(mesh.lods.size() < kMaxMeshLods)
+    {
+        const u32        target_index_count = u32(previous_index_count * kLodReduction) / 3 * 3;
+        float            error              = 0.0f;
+        std::vector<u32> lod_indices        = MeshOptimizer::simplify(
+            std::span(mesh.indices).first(full_index_count), positions, target_index_count, max_error, error);
+        if(lod_indices.empty() || (float)lod_indices.size() > (float)previous_index_count * kLodMinReduction)
+        {
+            break;
+        }
+
+        MeshOptimizer::optimizeVertexCache(lod_indices, (u32)mesh.positions.size());
+        mesh.lods.push_back({(u32)mesh.indices.size(), (u32)lod_indices.size(), error});
+        mesh.indices.insert(mesh.indices.end(), lod_indices.begin(), lod_indices.end());
+        previous_index_count = (u32)lod_indices.size();
+    }
+}
+
+/*!
+ * @brief Welds the vertices that are equal in every stream, orders the triangles for the vertex cache and the vertices
+ * for fetch, generates the levels of detail, then narrows the indices to 16 bits when the vertex count allows.
+ */
+void optimizeMesh(MeshData& mesh, CookStatistics& statistics)
+{
+    u32 vertex_count = (u32)mesh.positions.size();
+    if(mesh.indices.empty())
+    {
+        mesh.indices.resize(vertex_count);
+        std::iota(mesh.indices.begin(), mesh.indices.end(), 0u);
+    }
+
+    // only triangle lists whose indices are all in range are reordered, anything else is cooked as it is
+    const bool is_triangle_list = mesh.indices.size() % 3 == 0 &&
+                                  std::all_of(mesh.indices.begin(),
+                                              mesh.indices.end(),
+                                              [&](const u32& index) { return index < vertex_count; });
+    if(vertex_count > 0 && is_triangle_list)
+    {
+        const u64 triangles = mesh.indices.size() / 3;
+        statistics.source_vertices += vertex_count;
+        statistics.triangles += triangles;
+        statistics.source_misses += MeshOptimizer::computeAcmr(mesh.indices, vertex_count) * (float)triangles;
+
+        const auto       streams = mesh.getStreamBytes();
+        std::vector<u32> remap;
+        vertex_count = MeshOptimizer::generateWeldRemap(std::span(streams).first((u32)CookedStream::Indices),
+                                                        vertex_count,
+                                                        remap);
+        MeshOptimizer::remapIndices(mesh.indices, remap);
+        MeshOptimizer::optimizeVertexCache(mesh.indices, vertex_count);
+
+        // welding numbers the vertices in order of appearance, so the remaps are applied to the streams together
+        std::vector<u32> fetch_remap;
+        const u32        used_count = MeshOptimizer::generateFetchRemap(mesh.indices, vertex_count, fetch_remap);
+        MeshOptimizer::remapIndices(mesh.indices, fetch_remap);
+        for(u32& target : remap)
+        {
+            target = fetch_remap[target];
+        }
+        MeshOptimizer::remapVertices(mesh.positions, remap, used_count);
+        MeshOptimizer::remapVertices(mesh.normals, remap, used_count);
+        MeshOptimizer::remapVertices(mesh.uvs, remap, used_count);
+        MeshOptimizer::remapVertices(mesh.weights, remap, used_count);
+        MeshOptimizer::remapVertices(mesh.influences, remap, used_count);
+
+        statistics.cooked_vertices += used_count;
+        statistics.cooked_misses += MeshOptimizer::computeAcmr(mesh.indices, used_count) * (float)triangles;
+    }
+
+    mesh.lods = {{0, (u32)mesh.indices.size(), 0.0f}};
+    if(vertex_count > 0 && is_triangle_list)
+    {
+        generateLods(mesh);
+        statistics.lod_triangles += mesh.lods.back().index_count / 3;
+    }
+
+    if(getCookedIndexStride(mesh.positions.size()) == sizeof(u16))
+    {
+        mesh.short_indices.assign(mesh.indices.begin(), mesh.indices.end());
+    }
+}
+
+bool writeCookedFile(const std::string& path, const std::vector<MeshData>& meshes)
+{
+    CookedMeshHeader             header{kCookedMeshMagic, kCookedMeshVersion, (u32)meshes.size(), 0};
+    std::vector<CookedMeshEntry> entries(meshes.size());
+
+    u64 offset = alignUp(sizeof(CookedMeshHeader) + entries.size() * sizeof(CookedMeshEntry));
+    for(size_t i = 0; i < meshes.size(); ++i)
+    {
+        const MeshData&   mesh   = meshes[i];
+        const BoundingBox bounds = BoundingBox::fromPoints(mesh.positions);
+        CookedMeshEntry&  entry  = entries[i];
+
+        entry               = {};
+        entry.vertex_count  = (u32)mesh.positions.size();
+        entry.index_count   = (u32)mesh.indices.size();
+        entry.bounds_min[0] = bounds.min.x;
+        entry.bounds_min[1] = bounds.min.y;
+        entry.bounds_min[2] = bounds.min.z;
+        entry.bounds_max[0] = bounds.max.x;
+        entry.bounds_max[1] = bounds.max.y;
+        entry.bounds_max[2] = bounds.max.z;
+        entry.lod_count     = (u32)mesh.lods.size();
+        std::copy(mesh.lods.begin(), mesh.lods.end(), entry.lods);
+
+        const auto streams = mesh.getStreamBytes();
+        for(u32 stream = 0; stream < (u32)CookedStream::Count; ++stream)
+        {
+            const u64 bytes       = streams[stream].size();
+            entry.streams[stream] = {bytes > 0 ? offset : 0, bytes};
+            offset                = alignUp(offset + bytes);
+        }
+    }
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if(!file)
+    {
+        return false;
+    }
+
+    const char padding[kCookedStreamAlignment] = {};
+    file.write((const char*)&header, sizeof(header));
+    file.write((const char*)entries.data(), (std::streamsize)(entries.size() * sizeof(CookedMeshEntry)));
+    for(size_t i = 0; i < meshes.size(); ++i)
+    {
+        const auto streams = meshes[i].getStreamBytes();
+        for(u32 stream = 0; stream < (u32)CookedStream::Count; ++stream)
+        {
+            const CookedStreamRange& range = entries[i].streams[stream];
+            if(range.bytes == 0)
+            {
+                continue;
+            }
+            file.write(padding, (std::streamsize)(range.offset - (u64)file.tellp()));
+            file.write((const char*)streams[stream].data(), (std::streamsize)range.bytes);
+        }
+    }
+    return (bool)file;
+}
+
+} // namespace
+
+bool MeshCooker::cook(const std::string& source_path, const std::string& cooked_path)
+{
+    sputnik::core::ImportScope import_scope(source_path, sputnik::core::ImportStage::CookMeshes);
+
+    cgltf_data* data = sputnik::gltf::GltfLoader::LoadFile(source_path.c_str());
+    if(data == nullptr)
+    {
+        ENGINE_ERROR("Could not cook {}, the glTF file could not be loaded.", source_path);
+        return false;
+    }
+
+    std::vector<MeshData> meshes;
+    CookStatistics        statistics;
+    for(size_t i = 0; i < data->nodes_count; ++i)
+    {
+        const cgltf_node& node = data->nodes[i];
+        if(node.mesh == nullptr)
+        {
+            continue;
+        }
+
+        for(size_t j = 0; j < node.mesh->primitives_count; ++j)
+        {
+            const cgltf_primitive& primitive = node.mesh->primitives[j];
+            if(primitive.type != cgltf_primitive_type_triangles)
+            {
+                // the optimizer and the levels of detail expect triangle lists, strips and fans are not cooked
+                ENGINE_WARN("{}: skipped a primitive of the mesh {}, only triangle lists are cooked.",
+                            source_path,
+                            node.mesh->name ? node.mesh->name : "");
+                continue;
+            }
+
+            MeshData& mesh = meshes.emplace_back();
+            for(size_t k = 0; k < primitive.attributes_count; ++k)
+            {
+                if(!readAttribute(mesh, primitive.attributes[k], *data, node.skin))
+                {
+                    ENGINE_WARN("{}: skipped the attribute {} of a mesh, its type is not supported.",
+                                source_path,
+                                primitive.attributes[k].name);
+                }
+            }
+
+            if(primitive.indices)
+            {
+                mesh.indices.resize(primitive.indices->count);
+                for(size_t k = 0; k < mesh.indices.size(); ++k)
+                {
+                    mesh.indices[k] = (u32)cgltf_accessor_read_index(primitive.indices, k);
+                }
+            }
+
+            dropMismatchedStream(mesh.normals, mesh, "normal", source_path);
+            dropMismatchedStream(mesh.uvs, mesh, "uv", source_path);
+            dropMismatchedStream(mesh.weights, mesh, "weight", source_path);
+            dropMismatchedStream(mesh.influences, mesh, "joint", source_path);
+            optimizeMesh(mesh, statistics);
+        }
+    }
+    sputnik::gltf::GltfLoader::FreeFile(data);
+
+    const std::string temporary_path = cooked_path + ".tmp";
+    std::error_code   error;
+    if(!writeCookedFile(temporary_path, meshes))
+    {
+        ENGINE_ERROR("Could not write the cooked mesh {}.", temporary_path);
+        std::filesystem::remove(temporary_path, error);
+        return false;
+    }
+    std::filesystem::rename(temporary_path, cooked_path, error);
+    if(error)
+    {
+        ENGINE_ERROR("Could not replace {}: {}", cooked_path, error.message());
+        std::filesystem::remove(temporary_path, error);
+        return false;
+    }
+
+    const float triangles = (float)std::max<u64>(statistics.triangles, 1);
+    ENGINE_INFO("Cooked {} meshes of {} into {}, {} vertices welded to {}, ACMR {:.2f} -> {:.2f}, {} triangles "
+                "down to {} in the coarsest levels of detail",
+                meshes.size(),
+                source_path,
+                cooked_path,
+                statistics.source_vertices,
+                statistics.cooked_vertices,
+                statistics.source_misses / triangles,
+                statistics.cooked_misses / triangles,
+                statistics.triangles,
+                statistics.lod_triangles);
+    return true;
+}
+
+std::string MeshCooker::getCookedPath(const std::string& source_path)
+{
+    return std::filesystem::path(source_path).replace_extension(CookedMeshFile::kExtension).string();
+}
+
+bool MeshCooker::isUpToDate(const std::string& source_path, const std::string& cooked_path)
+{
+    std::error_code error;
+    const auto      cooked_time = std::filesystem::last_write_time(cooked_path, error);
+    if(error)
+    {
+        return false;
+    }
+    const auto source_time = std::filesystem::last_write_time(source_path, error);
+    return !error && cooked_time >= source_time;
+}
+
+bool MeshCooker::openCooked(const std::string& source_path, CookedMeshFile& file)
+{
+    const std::string cooked_path = getCookedPath(source_path);
+    if(cooked_path == source_path)
+    {
+        return file.open(source_path);
+    }
+
+    if(isUpToDate(source_path, cooked_path) && file.open(cooked_path))
+    {
+        return true;
+    }
+    return cook(source_path, cooked_path) && file.open(cooked_path);
+}
+
+} // namespace sputnik::graphics::core
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "core/core.h"
+
+#include <string>
+
+namespace sputnik::graphics::core
+{
+
+class CookedMeshFile;
+
+/*!
+ * @brief Converts the meshes of a glTF file into a cooked mesh file (see cooked_mesh.h).
+ *
+ * @details The meshes are written in the order GltfLoader::LoadMeshes() produces them, one per primitive of every node
+ * that has a mesh. Unindexed primitives are indexed, then every triangle list is welded and reordered for the vertex
+ * cache and vertex fetch (see MeshOptimizer). Cooking does not need a GL context, it is run by the mesh-cooker tool and
+ * by Model::LoadModel() for models that have not been cooked yet.
+ */
+class MeshCooker
+{
+public:
+    NON_INSTATIABLE(MeshCooker)
+
+    /*!
+     * @brief Cooks source_path into cooked_path, returns false (and logs) when the source can not be loaded or the
+     * output can not be written. The output is written to a temporary file first, so a failed cook never leaves a
+     * truncated file behind.
+     */
+    static bool cook(const std::string& source_path, const std::string& cooked_path);
+
+    /*!
+     * @brief The path of the cooked mesh of a source file: the source path with its extension replaced.
+     */
+    static std::string getCookedPath(const std::string& source_path);
+
+    /*!
+     * @brief True when the cooked file exists and is not older than the source file.
+     */
+    static bool isUpToDate(const std::string& source_path, const std::string& cooked_path);
+
+    /*!
+     * @brief Opens the cooked mesh of source_path, cooking it first when it is missing, older than the source or
+     * written by an older cooker. A path to a cooked mesh is opened as is.
+     */
+    static bool openCooked(const std::string& source_path, CookedMeshFile& file);
+};
+
+} // namespace sputnik::graphics::core
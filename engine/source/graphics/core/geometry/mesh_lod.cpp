@@ -0,0 +1,46 @@
+#include "pch.h"
+#include "mesh_lod.h"
+
+#include <algorithm>
+
+namespace sputnik::graphics::core
+{
+
+u32 selectLod(const std::span<const MeshLod>& lods,
+              const float&                    pixels_per_unit,
+              const u32&                      current_lod,
+              const LodSettings&              settings)
+{
+    if(lods.size() <= 1 || !settings.enabled)
+    {
+        return 0;
+    }
+
+    const u32 coarsest = u32(lods.size() - 1);
+    if(settings.forced_lod >= 0)
+    {
+        return std::min((u32)settings.forced_lod, coarsest);
+    }
+
+    const auto projected_error = [&](const u32& lod) { return lods[lod].error * pixels_per_unit; };
+
+    // a finer level is drawn once the current one is visibly too coarse, the coarsest level within the threshold
+    u32 lod = std::min(current_lod, coarsest);
+    if(projected_error(lod) > settings.max_pixel_error * (1.0f + settings.hysteresis))
+    {
+        while(lod > 0 && projected_error(lod) > settings.max_pixel_error)
+        {
+            --lod;
+        }
+        return lod;
+    }
+
+    // a coarser level is drawn once its error is well below the threshold
+    while(lod < coarsest && projected_error(lod + 1) <= settings.max_pixel_error * (1.0f - settings.hysteresis))
+    {
+        ++lod;
+    }
+    return lod;
+}
+
+} // namespace sputnik::graphics::core
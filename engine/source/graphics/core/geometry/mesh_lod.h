@@ -0,0 +1,50 @@
+#pragma once
+
+#include "core/core.h"
+
+#include <span>
+#include <vector>
+
+namespace sputnik::graphics::core
+{
+
+constexpr u32 kMaxMeshLods = 4;
+
+/*!
+ * @brief A level of detail of a mesh, a range of its index buffer. All the levels share the vertices of the mesh, level
+ * 0 is the full mesh and starts at the first index.
+ */
+struct MeshLod
+{
+    u32   first_index;
+    u32   index_count;
+    float error; // object space distance the level deviates from the full mesh by
+};
+
+static_assert(sizeof(MeshLod) == 12, "MeshLod is stored in cooked mesh files.");
+
+/*!
+ * @brief The levels a model instance was drawn with last, one per mesh. Kept by the code that draws the instance so
+ * that the level selection can apply hysteresis.
+ */
+using LodHistory = std::vector<u8>;
+
+struct LodSettings
+{
+    bool  enabled{true};
+    float max_pixel_error{1.0f}; // the coarsest level whose error projects to at most this many pixels is drawn
+    float hysteresis{0.25f};     // fraction of max_pixel_error the error has to cross before the level changes
+    i32   forced_lod{-1};        // draws every mesh with this level (or its coarsest one) when it is not negative
+};
+
+/*!
+ * @brief Selects the level to draw a mesh with. pixels_per_unit is the size in pixels an object space unit of the
+ * mesh projects to at its distance from the camera. The level only changes once the projected error of the current
+ * level leaves the band of max_pixel_error +- hysteresis, so draws near a threshold do not flip every frame.
+ */
+u32 selectLod(const std::span<const MeshLod>& lods,
+              const float&                    pixels_per_unit,
+              const u32&                      current_lod,
+              const LodSettings&              settings);
+
+} // namespace sputnik::graphics::core
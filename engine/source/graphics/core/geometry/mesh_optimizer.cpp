@@ -0,0 +1,606 @@
+#include "pch.h"
+#include "mesh_optimizer.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstring>
+#include <queue>
+#include <unordered_map>
+
+// Useful references:
+// https://tomforsyth1000.github.io/papers/fast_vert_cache_opt.html (Linear-Speed Vertex Cache Optimisation)
+// https://www.cs.cmu.edu/~garland/Papers/quadrics.pdf (Surface Simplification Using Quadric Error Metrics)
+
+namespace sputnik::graphics::core
+{
+
+namespace
+{
+
+constexpr float kCacheDecayPower   = 1.5f;
+constexpr float kLastTriangleScore = 0.75f;
+constexpr float kValenceBoostScale = 2.0f;
+constexpr float kValenceBoostPower = 0.5f;
+
+float getVertexScore(const i32& cache_position, const u32& remaining_triangles)
+{
+    if(remaining_triangles == 0)
+    {
+        return -1.0f;
+    }
+
+    float score = 0.0f;
+    if(cache_position >= 0)
+    {
+        // the vertices of the last triangle get a fixed score, so that the next triangle does not simply reuse two of
+        // them, the rest decays with the position in the cache
+        const float decay = 1.0f - (float)(cache_position - 3) / (float)(MeshOptimizer::kCacheSize - 3);
+        score             = cache_position < 3 ? kLastTriangleScore : std::pow(decay, kCacheDecayPower);
+    }
+
+    // vertices with few triangles left are preferred, so that they leave the working set early
+    return score + kValenceBoostScale * std::pow((float)remaining_triangles, -kValenceBoostPower);
+}
+
+/*!
+ * @brief Sum of the squared distances to a set of planes, weighted by the areas of the triangles they come from. The
+ * symmetric 4x4 matrix is stored as its upper triangle.
+ */
+struct Quadric
+{
+    double coefficients[10]{};
+    double weight{0.0};
+
+    void addPlane(const double (&plane)[4], const double& plane_weight)
+    {
+        u32 coefficient = 0;
+        for(u32 row = 0; row < 4; ++row)
+        {
+            for(u32 column = row; column < 4; ++column)
+            {
+                coefficients[coefficient++] += plane[row] * plane[column] * plane_weight;
+            }
+        }
+        weight += plane_weight;
+    }
+
+    void add(const Quadric& other)
+    {
+        for(u32 coefficient = 0; coefficient < 10; ++coefficient)
+        {
+            coefficients[coefficient] += other.coefficients[coefficient];
+        }
+        weight += other.weight;
+    }
+
+    double evaluate(const float* point) const
+    {
+        const double vector[4]   = {point[0], point[1], point[2], 1.0};
+        double       sum         = 0.0;
+        u32          coefficient = 0;
+        for(u32 row = 0; row < 4; ++row)
+        {
+            for(u32 column = row; column < 4; ++column)
+            {
+                sum += (row == column ? 1.0 : 2.0) * coefficients[coefficient++] * vector[row] * vector[column];
+            }
+        }
+        return sum;
+    }
+};
+
+struct Collapse
+{
+    float cost;
+    u32   from;
+    u32   to;
+    u32   from_version;
+    u32   to_version;
+
+    bool operator>(const Collapse& other) const
+    {
+        return cost > other.cost;
+    }
+};
+
+void computeNormal(const float* a, const float* b, const float* c, double (&normal)[3])
+{
+    const double ab[3] = {b[0] - a[0], b[1] - a[1], b[2] - a[2]};
+    const double ac[3] = {c[0] - a[0], c[1] - a[1], c[2] - a[2]};
+    normal[0]          = ab[1] * ac[2] - ab[2] * ac[1];
+    normal[1]          = ab[2] * ac[0] - ab[0] * ac[2];
+    normal[2]          = ab[0] * ac[1] - ab[1] * ac[0];
+}
+
+} // namespace
+
+u32 MeshOptimizer::generateWeldRemap(const std::span<const std::span<const std::byte>>& streams,
+                                     const u32&                                        vertex_count,
+                                     std::vector<u32>&                                 remap)
+{
+    std::vector<size_t> strides;
+    for(const std::span<const std::byte>& stream : streams)
+    {
+        SPUTNIK_ASSERT(stream.size() % std::max(vertex_count, 1u) == 0, "A vertex stream has a partial element.");
+        strides.push_back(vertex_count > 0 ? stream.size() / vertex_count : 0);
+    }
+
+    const auto hashVertex = [&](const u32& vertex)
+    {
+        u64 hash = 14695981039346656037ull;
+        for(size_t stream = 0; stream < streams.size(); ++stream)
+        {
+            const std::byte* element = streams[stream].data() + vertex * strides[stream];
+            for(size_t i = 0; i < strides[stream]; ++i)
+            {
+                hash = (hash ^ (u64)element[i]) * 1099511628211ull;
+            }
+        }
+        return hash;
+    };
+    const auto isEqual = [&](const u32& a, const u32& b)
+    {
+        for(size_t stream = 0; stream < streams.size(); ++stream)
+        {
+            const std::byte* data = streams[stream].data();
+            if(std::memcmp(data + a * strides[stream], data + b * strides[stream], strides[stream]) != 0)
+            {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    // open addressing with linear probing, the table is kept at most half full
+    const size_t     table_size = std::bit_ceil(std::max<size_t>((size_t)vertex_count * 2, 16));
+    std::vector<u32> table(table_size, kUnused);
+    u32              unique_count = 0;
+    remap.assign(vertex_count, kUnused);
+    for(u32 vertex = 0; vertex < vertex_count; ++vertex)
+    {
+        size_t slot = hashVertex(vertex) & (table_size - 1);
+        while(table[slot] != kUnused && !isEqual(table[slot], vertex))
+        {
+            slot = (slot + 1) & (table_size - 1);
+        }
+
+        if(table[slot] == kUnused)
+        {
+            table[slot]   = vertex;
+            remap[vertex] = unique_count++;
+        }
+        else
+        {
+            remap[vertex] = remap[table[slot]];
+        }
+    }
+    return unique_count;
+}
+
+void MeshOptimizer::optimizeVertexCache(const std::span<u32>& indices, const u32& vertex_count)
+{
+    SPUTNIK_ASSERT(indices.size() % 3 == 0, "The vertex cache optimization needs a triangle list.");
+
+    const u32 triangle_count = (u32)(indices.size() / 3);
+    if(triangle_count == 0)
+    {
+        return;
+    }
+
+    // the triangles that use every vertex, the ones that are not emitted yet are kept at the front of each list
+    std::vector<u32> remaining(vertex_count, 0);
+    for(const u32& index : indices)
+    {
+        ++remaining[index];
+    }
+    std::vector<u32> first_triangle(vertex_count + 1, 0);
+    for(u32 vertex = 0; vertex < vertex_count; ++vertex)
+    {
+        first_triangle[vertex + 1] = first_triangle[vertex] + remaining[vertex];
+    }
+    std::vector<u32> vertex_triangles(indices.size());
+    std::vector<u32> fill(first_triangle.begin(), first_triangle.end() - 1);
+    for(u32 triangle = 0; triangle < triangle_count; ++triangle)
+    {
+        for(u32 corner = 0; corner < 3; ++corner)
+        {
+            vertex_triangles[fill[indices[triangle * 3 + corner]]++] = triangle;
+        }
+    }
+
+    std::vector<i32>   cache_positions(vertex_count, -1);
+    std::vector<float> vertex_scores(vertex_count);
+    for(u32 vertex = 0; vertex < vertex_count; ++vertex)
+    {
+        vertex_scores[vertex] = getVertexScore(-1, remaining[vertex]);
+    }
+
+    std::vector<float> triangle_scores(triangle_count);
+    std::vector<bool>  emitted(triangle_count, false);
+    u32                best_triangle = 0;
+    for(u32 triangle = 0; triangle < triangle_count; ++triangle)
+    {
+        const u32* corners        = &indices[triangle * 3];
+        triangle_scores[triangle] = vertex_scores[corners[0]] + vertex_scores[corners[1]] + vertex_scores[corners[2]];
+        if(triangle_scores[triangle] > triangle_scores[best_triangle])
+        {
+            best_triangle = triangle;
+        }
+    }
+
+    std::vector<u32> output;
+    output.reserve(indices.size());
+    u32 cache[kCacheSize + 3];
+    u32 cache_count    = 0;
+    u32 next_unvisited = 0;
+    while(output.size() < indices.size())
+    {
+        const u32* triangle   = &indices[best_triangle * 3];
+        const u32  corners[3] = {triangle[0], triangle[1], triangle[2]};
+        emitted[best_triangle] = true;
+        output.insert(output.end(), corners, corners + 3);
+
+        for(const u32& vertex : corners)
+        {
+            u32* triangles        = &vertex_triangles[first_triangle[vertex]];
+            u32* emitted_triangle = std::find(triangles, triangles + remaining[vertex], best_triangle);
+            std::swap(*emitted_triangle, triangles[--remaining[vertex]]);
+        }
+
+        // the triangle's vertices move to the front of the cache, the ones pushed past its end are evicted
+        u32 new_cache[kCacheSize + 3];
+        u32 new_cache_count = 0;
+        for(const u32& vertex : corners)
+        {
+            if(std::find(new_cache, new_cache + new_cache_count, vertex) == new_cache + new_cache_count)
+            {
+                new_cache[new_cache_count++] = vertex;
+            }
+        }
+        for(u32 i = 0; i < cache_count; ++i)
+        {
+            if(std::find(corners, corners + 3, cache[i]) == corners + 3)
+            {
+                new_cache[new_cache_count++] = cache[i];
+            }
+        }
+
+        for(u32 i = 0; i < new_cache_count; ++i)
+        {
+            const u32   vertex    = new_cache[i];
+            const float old_score = vertex_scores[vertex];
+            cache_positions[vertex] = i < kCacheSize ? (i32)i : -1;
+            vertex_scores[vertex]   = getVertexScore(cache_positions[vertex], remaining[vertex]);
+
+            const u32* triangles = &vertex_triangles[first_triangle[vertex]];
+            for(u32 j = 0; j < remaining[vertex]; ++j)
+            {
+                triangle_scores[triangles[j]] += vertex_scores[vertex] - old_score;
+            }
+        }
+        cache_count = std::min(new_cache_count, kCacheSize);
+        std::copy(new_cache, new_cache + cache_count, cache);
+
+        // the next triangle is the best one that uses a cached vertex, or the next unvisited one when the cached
+        // vertices have no triangles left
+        float best_score = -1.0f;
+        for(u32 i = 0; i < cache_count; ++i)
+        {
+            const u32* triangles = &vertex_triangles[first_triangle[cache[i]]];
+            for(u32 j = 0; j < remaining[cache[i]]; ++j)
+            {
+                if(triangle_scores[triangles[j]] > best_score)
+                {
+                    best_score    = triangle_scores[triangles[j]];
+                    best_triangle = triangles[j];
+                }
+            }
+        }
+        if(best_score < 0.0f)
+        {
+            while(next_unvisited < triangle_count && emitted[next_unvisited])
+            {
+                ++next_unvisited;
+            }
+            best_triangle = next_unvisited;
+        }
+    }
+
+    std::copy(output.begin(), output.end(), indices.begin());
+}
+
+u32 MeshOptimizer::generateFetchRemap(const std::span<const u32>& indices,
+                                      const u32&                  vertex_count,
+                                      std::vector<u32>&           remap)
+{
+    u32 used_count = 0;
+    remap.assign(vertex_count, kUnused);
+    for(const u32& index : indices)
+    {
+        if(remap[index] == kUnused)
+        {
+            remap[index] = used_count++;
+        }
+    }
+    return used_count;
+}
+
+void MeshOptimizer::remapIndices(const std::span<u32>& indices, const std::vector<u32>& remap)
+{
+    for(u32& index : indices)
+    {
+        index = remap[index];
+    }
+}
+
+std::vector<u32> MeshOptimizer::simplify(const std::span<const u32>&   indices,
+                                         const std::span<const float>& positions,
+                                         const u32&                    target_index_count,
+                                         const float&                  max_error,
+                                         float&                        error)
+{
+    SPUTNIK_ASSERT(indices.size() % 3 == 0, "Simplification needs a triangle list.");
+
+    const u32        vertex_count   = (u32)(positions.size() / 3);
+    const u32        triangle_count = (u32)(indices.size() / 3);
+    std::vector<u32> triangles(indices.begin(), indices.end());
+    error = 0.0f;
+
+    // vertices that share a position lie on an attribute seam, the open borders are found on the welded positions
+    std::vector<u32> position_ids;
+    const u32        position_count = generateWeldRemap(
+        std::vector<std::span<const std::byte>>{std::as_bytes(positions)}, vertex_count, position_ids);
+    std::vector<u32> vertices_per_position(position_count, 0);
+    for(const u32& position_id : position_ids)
+    {
+        ++vertices_per_position[position_id];
+    }
+
+    std::unordered_map<u64, u32> edge_triangles;
+    const auto edgeKey = [&](const u32& a, const u32& b)
+    {
+        const u64 id_a = position_ids[a];
+        const u64 id_b = position_ids[b];
+        return std::min(id_a, id_b) << 32 | std::max(id_a, id_b);
+    };
+    for(u32 triangle = 0; triangle < triangle_count; ++triangle)
+    {
+        for(u32 corner = 0; corner < 3; ++corner)
+        {
+            ++edge_triangles[edgeKey(triangles[triangle * 3 + corner], triangles[triangle * 3 + (corner + 1) % 3])];
+        }
+    }
+
+    std::vector<bool> locked(vertex_count, false);
+    for(u32 vertex = 0; vertex < vertex_count; ++vertex)
+    {
+        locked[vertex] = vertices_per_position[position_ids[vertex]] > 1;
+    }
+    for(u32 triangle = 0; triangle < triangle_count; ++triangle)
+    {
+        for(u32 corner = 0; corner < 3; ++corner)
+        {
+            const u32 a = triangles[triangle * 3 + corner];
+            const u32 b = triangles[triangle * 3 + (corner + 1) % 3];
+            if(edge_triangles[edgeKey(a, b)] != 2)
+            {
+                locked[a] = true;
+                locked[b] = true;
+            }
+        }
+    }
+
+    // the quadric of a vertex holds the planes of the triangles around it
+    std::vector<Quadric>          quadrics(vertex_count);
+    std::vector<std::vector<u32>> vertex_triangles(vertex_count);
+    for(u32 triangle = 0; triangle < triangle_count; ++triangle)
+    {
+        const u32* corners = &triangles[triangle * 3];
+        double     normal[3];
+        computeNormal(&positions[corners[0] * 3], &positions[corners[1] * 3], &positions[corners[2] * 3], normal);
+
+        const double length = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+        if(length > 0.0)
+        {
+            const float* point    = &positions[corners[0] * 3];
+            double       plane[4] = {normal[0] / length, normal[1] / length, normal[2] / length, 0.0};
+            plane[3]              = -(plane[0] * point[0] + plane[1] * point[1] + plane[2] * point[2]);
+            for(u32 corner = 0; corner < 3; ++corner)
+            {
+                quadrics[corners[corner]].addPlane(plane, length * 0.5);
+            }
+        }
+        for(u32 corner = 0; corner < 3; ++corner)
+        {
+            vertex_triangles[corners[corner]].push_back(triangle);
+        }
+    }
+
+    // the error of a collapse is the area weighted root mean square distance of the kept vertex to the planes of both
+    const auto collapseError = [&](const u32& from, const u32& to)
+    {
+        Quadric quadric = quadrics[from];
+        quadric.add(quadrics[to]);
+        if(quadric.weight <= 0.0)
+        {
+            return 0.0f;
+        }
+        return (float)std::sqrt(std::max(0.0, quadric.evaluate(&positions[to * 3]) / quadric.weight));
+    };
+
+    std::vector<u32> versions(vertex_count, 0);
+    std::priority_queue<Collapse, std::vector<Collapse>, std::greater<Collapse>> collapses;
+    const auto pushCollapses = [&](const u32& triangle)
+    {
+        for(u32 corner = 0; corner < 3; ++corner)
+        {
+            const u32 from = triangles[triangle * 3 + corner];
+            const u32 to   = triangles[triangle * 3 + (corner + 1) % 3];
+            if(!locked[from])
+            {
+                collapses.push({collapseError(from, to), from, to, versions[from], versions[to]});
+            }
+            if(!locked[to])
+            {
+                collapses.push({collapseError(to, from), to, from, versions[to], versions[from]});
+            }
+        }
+    };
+    for(u32 triangle = 0; triangle < triangle_count; ++triangle)
+    {
+        pushCollapses(triangle);
+    }
+
+    std::vector<bool> removed_triangles(triangle_count, false);
+    std::vector<bool> removed_vertices(vertex_count, false);
+    std::vector<u32>  from_neighbours;
+    std::vector<u32>  to_neighbours;
+    const auto        collectNeighbours = [&](const u32& vertex, std::vector<u32>& neighbours)
+    {
+        neighbours.clear();
+        for(const u32& triangle : vertex_triangles[vertex])
+        {
+            for(u32 corner = 0; !removed_triangles[triangle] && corner < 3; ++corner)
+            {
+                if(triangles[triangle * 3 + corner] != vertex)
+                {
+                    neighbours.push_back(triangles[triangle * 3 + corner]);
+                }
+            }
+        }
+        std::sort(neighbours.begin(), neighbours.end());
+        neighbours.erase(std::unique(neighbours.begin(), neighbours.end()), neighbours.end());
+    };
+
+    u64 index_count = indices.size();
+    while(index_count > target_index_count && !collapses.empty())
+    {
+        const Collapse collapse = collapses.top();
+        collapses.pop();
+        if(removed_vertices[collapse.from] || removed_vertices[collapse.to])
+        {
+            continue;
+        }
+        if(collapse.from_version != versions[collapse.from] || collapse.to_version != versions[collapse.to])
+        {
+            // the quadrics changed since the collapse was queued
+            collapses.push({collapseError(collapse.from, collapse.to),
+                            collapse.from,
+                            collapse.to,
+                            versions[collapse.from],
+                            versions[collapse.to]});
+            continue;
+        }
+        if(collapse.cost > max_error)
+        {
+            break;
+        }
+
+        // the vertices must still share an edge, and only the two triangles on it may share both of them, otherwise
+        // the collapse would fold the surface onto itself
+        collectNeighbours(collapse.from, from_neighbours);
+        collectNeighbours(collapse.to, to_neighbours);
+        std::vector<u32> shared_neighbours;
+        std::set_intersection(from_neighbours.begin(),
+                              from_neighbours.end(),
+                              to_neighbours.begin(),
+                              to_neighbours.end(),
+                              std::back_inserter(shared_neighbours));
+        if(!std::binary_search(from_neighbours.begin(), from_neighbours.end(), collapse.to) ||
+           shared_neighbours.size() > 2)
+        {
+            continue;
+        }
+
+        // no remaining triangle may flip or degenerate when its corner moves onto the kept vertex
+        bool flips = false;
+        for(const u32& triangle : vertex_triangles[collapse.from])
+        {
+            const u32* corners = &triangles[triangle * 3];
+            if(removed_triangles[triangle] || std::find(corners, corners + 3, collapse.to) != corners + 3)
+            {
+                continue;
+            }
+
+            const float* points[3] = {
+                &positions[corners[0] * 3], &positions[corners[1] * 3], &positions[corners[2] * 3]};
+            double before[3];
+            computeNormal(points[0], points[1], points[2], before);
+            *std::find(points, points + 3, &positions[collapse.from * 3]) = &positions[collapse.to * 3];
+            double after[3];
+            computeNormal(points[0], points[1], points[2], after);
+            if(before[0] * after[0] + before[1] * after[1] + before[2] * after[2] <= 0.0)
+            {
+                flips = true;
+                break;
+            }
+        }
+        if(flips)
+        {
+            continue;
+        }
+
+        for(const u32& triangle : vertex_triangles[collapse.from])
+        {
+            u32* corners = &triangles[triangle * 3];
+            if(removed_triangles[triangle])
+            {
+                continue;
+            }
+            if(std::find(corners, corners + 3, collapse.to) != corners + 3)
+            {
+                removed_triangles[triangle] = true;
+                index_count -= 3;
+                continue;
+            }
+            *std::find(corners, corners + 3, collapse.from) = collapse.to;
+            vertex_triangles[collapse.to].push_back(triangle);
+        }
+        quadrics[collapse.to].add(quadrics[collapse.from]);
+        removed_vertices[collapse.from] = true;
+        ++versions[collapse.to];
+        error = std::max(error, collapse.cost);
+
+        for(const u32& triangle : vertex_triangles[collapse.to])
+        {
+            if(!removed_triangles[triangle])
+            {
+                pushCollapses(triangle);
+            }
+        }
+    }
+
+    std::vector<u32> simplified;
+    simplified.reserve(index_count);
+    for(u32 triangle = 0; triangle < triangle_count; ++triangle)
+    {
+        if(!removed_triangles[triangle])
+        {
+            simplified.insert(simplified.end(), &triangles[triangle * 3], &triangles[triangle * 3] + 3);
+        }
+    }
+    return simplified;
+}
+
+float MeshOptimizer::computeAcmr(const std::span<const u32>& indices, const u32& vertex_count, const u32& cache_size)
+{
+    if(indices.size() < 3)
+    {
+        return 0.0f;
+    }
+
+    // a vertex is in the FIFO while fewer than cache_size misses happened since it was added
+    std::vector<u64> added_at(vertex_count, 0);
+    u64              misses = 0;
+    for(const u32& index : indices)
+    {
+        if(added_at[index] == 0 || misses + 1 - added_at[index] >= cache_size)
+        {
+            added_at[index] = ++misses;
+        }
+    }
+    return (float)misses / (float)(indices.size() / 3);
+}
+
+} // namespace sputnik::graphics::core
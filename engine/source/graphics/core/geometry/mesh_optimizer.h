@@ -0,0 +1,94 @@
+#pragma once
+
+#include "core/core.h"
+
+#include <cstddef>
+#include <span>
+#include <vector>
+
+namespace sputnik::graphics::core
+{
+
+/*!
+ * @brief Cook time optimizations of indexed triangle lists.
+ *
+ * @details A mesh is described by its vertex streams as raw bytes, one element per vertex in every stream that is not
+ * empty, and by 32 bit indices. Welding and fetch ordering produce a remap table from old to new vertex indices, which
+ * is applied to the indices with remapIndices() and to every stream with remapVertices().
+ */
+class MeshOptimizer
+{
+public:
+    NON_INSTATIABLE(MeshOptimizer)
+
+    static constexpr u32 kUnused = ~0u;
+
+    // size of the LRU cache the triangle order is optimized for, larger than the FIFO caches of most GPUs
+    static constexpr u32 kCacheSize = 32;
+
+    /*!
+     * @brief Maps every vertex to the first vertex that is bitwise equal in every stream. The unique vertices are
+     * numbered in the order they first appear, returns their count.
+     */
+    static u32 generateWeldRemap(const std::span<const std::span<const std::byte>>& streams,
+                                 const u32&                                        vertex_count,
+                                 std::vector<u32>&                                 remap);
+
+    /*!
+     * @brief Reorders the triangles for the post-transform vertex cache, with Tom Forsyth's linear-speed vertex cache
+     * optimization.
+     */
+    static void optimizeVertexCache(const std::span<u32>& indices, const u32& vertex_count);
+
+    /*!
+     * @brief Numbers the vertices in the order the indices first use them, so that vertex fetch walks the streams
+     * forward. Unused vertices are mapped to kUnused, returns the count of used vertices.
+     */
+    static u32 generateFetchRemap(const std::span<const u32>& indices,
+                                  const u32&                  vertex_count,
+                                  std::vector<u32>&           remap);
+
+    static void remapIndices(const std::span<u32>& indices, const std::vector<u32>& remap);
+
+    /*!
+     * @brief Simplifies a triangle list with quadric error metric edge collapses (Garland and Heckbert) until at most
+     * target_index_count indices are left or the next collapse would move the surface by more than max_error.
+     *
+     * @details Vertices are never moved, every collapse merges a vertex into one of its neighbours, so the result
+     * indexes the vertices of the input. Vertices on open borders and on attribute seams (several vertices at one
+     * position) are kept, which keeps the silhouette and the uv layout intact. error is set to the largest error of
+     * the collapses, an object space distance. positions holds three floats per vertex.
+     */
+    static std::vector<u32> simplify(const std::span<const u32>&   indices,
+                                     const std::span<const float>& positions,
+                                     const u32&                    target_index_count,
+                                     const float&                  max_error,
+                                     float&                        error);
+
+    template <typename T>
+    static void remapVertices(std::vector<T>& stream, const std::vector<u32>& remap, const u32& remapped_count)
+    {
+        if(stream.empty())
+        {
+            return;
+        }
+
+        std::vector<T> remapped(remapped_count);
+        for(size_t vertex = 0; vertex < remap.size(); ++vertex)
+        {
+            if(remap[vertex] != kUnused)
+            {
+                remapped[remap[vertex]] = stream[vertex];
+            }
+        }
+        stream.swap(remapped);
+    }
+
+    /*!
+     * @brief Average cache miss ratio, the vertices transformed per triangle with a FIFO cache of cache_size entries.
+     * 0.5 is the ideal for a regular grid, 3 means no reuse at all.
+     */
+    static float computeAcmr(const std::span<const u32>& indices, const u32& vertex_count, const u32& cache_size = 16);
+};
+
+} // namespace sputnik::graphics::core
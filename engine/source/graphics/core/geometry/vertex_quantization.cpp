@@ -0,0 +1,197 @@
+#include "pch.h"
+#include "vertex_quantization.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+namespace sputnik::graphics::core
+{
+
+namespace
+{
+
+float signNotZero(const float& value)
+{
+    return value >= 0.0f ? 1.0f : -1.0f;
+}
+
+u16 quantizeUnorm16(const float& value)
+{
+    return (u16)std::lround(std::clamp(value, 0.0f, 1.0f) * 65535.0f);
+}
+
+i16 quantizeSnorm16(const float& value)
+{
+    return (i16)std::lround(std::clamp(value, -1.0f, 1.0f) * 32767.0f);
+}
+
+// position = min + extent * unorm, flat axes are decoded to their minimum
+float getInverseExtent(const float& min, const float& max)
+{
+    return max > min ? 1.0f / (max - min) : 0.0f;
+}
+
+} // namespace
+
+bool VertexQuantization::canPack(const MeshStreams& streams)
+{
+    for(const ramanujan::IVector4& joints : streams.influences)
+    {
+        if(std::min({joints.x, joints.y, joints.z, joints.w}) < 0 ||
+           std::max({joints.x, joints.y, joints.z, joints.w}) > kMaxPackedJoint)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+PackedVertexStreams VertexQuantization::pack(const MeshStreams& streams, const BoundingBox& bounds)
+{
+    SPUTNIK_ASSERT(canPack(streams), "The joint indices of the mesh do not fit in 8 bits.");
+
+    PackedVertexStreams packed;
+
+    packed.positions.resize(streams.positions.size() * 4);
+    const vec3 inverse_extent = {getInverseExtent(bounds.min.x, bounds.max.x),
+                                 getInverseExtent(bounds.min.y, bounds.max.y),
+                                 getInverseExtent(bounds.min.z, bounds.max.z)};
+    for(size_t vertex = 0; vertex < streams.positions.size(); ++vertex)
+    {
+        const ramanujan::Vector3& position        = streams.positions[vertex];
+        u16*                      packed_position = &packed.positions[vertex * 4];
+
+        packed_position[0] = quantizeUnorm16((position.x - bounds.min.x) * inverse_extent.x);
+        packed_position[1] = quantizeUnorm16((position.y - bounds.min.y) * inverse_extent.y);
+        packed_position[2] = quantizeUnorm16((position.z - bounds.min.z) * inverse_extent.z);
+        packed_position[3] = 0;
+    }
+
+    packed.normals.resize(streams.normals.size() * 2);
+    for(size_t vertex = 0; vertex < streams.normals.size(); ++vertex)
+    {
+        encodeOctahedral(streams.normals[vertex], packed.normals[vertex * 2], packed.normals[vertex * 2 + 1]);
+    }
+
+    packed.uvs.resize(streams.uvs.size() * 2);
+    for(size_t vertex = 0; vertex < streams.uvs.size(); ++vertex)
+    {
+        packed.uvs[vertex * 2]     = floatToHalf(streams.uvs[vertex].x);
+        packed.uvs[vertex * 2 + 1] = floatToHalf(streams.uvs[vertex].y);
+    }
+
+    // the weights are renormalized, the rounding error goes to the largest one so that they still sum up to one
+    packed.weights.resize(streams.weights.size() * 4);
+    for(size_t vertex = 0; vertex < streams.weights.size(); ++vertex)
+    {
+        const ramanujan::Vector4& weight        = streams.weights[vertex];
+        const float               weights[4]    = {weight.x, weight.y, weight.z, weight.w};
+        const float               sum           = weights[0] + weights[1] + weights[2] + weights[3];
+        u8*                       packed_weight = &packed.weights[vertex * 4];
+        if(sum <= 0.0f)
+        {
+            packed_weight[0] = 255;
+            packed_weight[1] = packed_weight[2] = packed_weight[3] = 0;
+            continue;
+        }
+
+        i32 quantized[4];
+        i32 total   = 0;
+        u32 largest = 0;
+        for(u32 c = 0; c < 4; ++c)
+        {
+            quantized[c] = (i32)std::lround(std::max(weights[c], 0.0f) / sum * 255.0f);
+            total += quantized[c];
+            largest = weights[c] > weights[largest] ? c : largest;
+        }
+        quantized[largest] += 255 - total;
+        for(u32 c = 0; c < 4; ++c)
+        {
+            packed_weight[c] = (u8)std::clamp(quantized[c], 0, 255);
+        }
+    }
+
+    packed.joints.resize(streams.influences.size() * 4);
+    for(size_t vertex = 0; vertex < streams.influences.size(); ++vertex)
+    {
+        const ramanujan::IVector4& joints = streams.influences[vertex];
+
+        packed.joints[vertex * 4]     = (u8)joints.x;
+        packed.joints[vertex * 4 + 1] = (u8)joints.y;
+        packed.joints[vertex * 4 + 2] = (u8)joints.z;
+        packed.joints[vertex * 4 + 3] = (u8)joints.w;
+    }
+    return packed;
+}
+
+VertexDecode VertexQuantization::getDecode(const BoundingBox& bounds)
+{
+    VertexDecode decode;
+    decode.position_scale =
+        vec3{bounds.max.x - bounds.min.x, bounds.max.y - bounds.min.y, bounds.max.z - bounds.min.z};
+    decode.position_offset    = bounds.min;
+    decode.octahedral_normals = true;
+    return decode;
+}
+
+u64 VertexQuantization::getVertexBytes(const MeshStreams& streams, const bool& packed)
+{
+    if(!packed)
+    {
+        return streams.positions.size_bytes() + streams.normals.size_bytes() + streams.uvs.size_bytes() +
+               streams.weights.size_bytes() + streams.influences.size_bytes();
+    }
+    return streams.positions.size() * 4 * sizeof(u16) + streams.normals.size() * 2 * sizeof(i16) +
+           streams.uvs.size() * 2 * sizeof(u16) + streams.weights.size() * 4 + streams.influences.size() * 4;
+}
+
+u16 VertexQuantization::floatToHalf(const float& value)
+{
+    const u32 bits      = std::bit_cast<u32>(value);
+    const u32 sign      = (bits >> 16) & 0x8000;
+    const u32 magnitude = bits & 0x7fffffff;
+
+    if(magnitude > 0x7f800000)
+    {
+        return u16(sign | 0x7e00); // NaN
+    }
+    if(magnitude >= 0x477ff000)
+    {
+        return u16(sign | 0x7bff); // rounds to 65520 or more, saturate to 65504
+    }
+    if(magnitude < 0x38800000)
+    {
+        // below the smallest normal half (2^-14), a denormal in units of 2^-24, rounded to nearest even
+        return u16(sign | (u32)std::nearbyint(std::bit_cast<float>(magnitude) * 16777216.0f));
+    }
+
+    // rebias the exponent from 127 to 15 and round the mantissa from 23 to 10 bits, to nearest even
+    const u32 rebiased = magnitude - 0x38000000;
+    return u16(sign | ((rebiased + 0x0fff + ((rebiased >> 13) & 1)) >> 13));
+}
+
+void VertexQuantization::encodeOctahedral(const ramanujan::Vector3& normal, i16& x, i16& y)
+{
+    const float length = std::abs(normal.x) + std::abs(normal.y) + std::abs(normal.z);
+    if(length <= 0.0f)
+    {
+        x = y = 0;
+        return;
+    }
+
+    float u = normal.x / length;
+    float v = normal.y / length;
+    if(normal.z < 0.0f)
+    {
+        // the lower half is folded over the diagonals
+        const float folded_u = (1.0f - std::abs(v)) * signNotZero(u);
+        const float folded_v = (1.0f - std::abs(u)) * signNotZero(v);
+        u                    = folded_u;
+        v                    = folded_v;
+    }
+    x = quantizeSnorm16(u);
+    y = quantizeSnorm16(v);
+}
+
+} // namespace sputnik::graphics::core
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "core/core.h"
+#include "bounds.h"
+#include "mesh.h"
+#include "graphics/glcore/gl_vertex_array.h"
+
+#include <vector>
+
+namespace sputnik::graphics::core
+{
+
+/*!
+ * @brief The packed vertex streams of a mesh, in the layout the GPU reads them in. A skinned vertex takes 24 bytes
+ * instead of the 64 bytes of the full precision streams.
+ *
+ * positions : 4 x unorm16 relative to the bounds of the mesh, the fourth component pads the vertex to 8 bytes
+ * normals   : 2 x snorm16, octahedral encoding
+ * uvs       : 2 x half float
+ * weights   : 4 x unorm8, they sum up to 255
+ * joints    : 4 x u8
+ */
+struct PackedVertexStreams
+{
+    std::vector<u16> positions;
+    std::vector<i16> normals;
+    std::vector<u16> uvs;
+    std::vector<u8>  weights;
+    std::vector<u8>  joints;
+};
+
+/*!
+ * @brief Quantizes the vertex streams of a mesh into the packed layout. The shaders decode them with
+ * vertex_decode.glsl, the decode of a mesh is returned by getDecode().
+ */
+class VertexQuantization
+{
+public:
+    NON_INSTATIABLE(VertexQuantization)
+
+    static constexpr i32 kMaxPackedJoint = 255;
+
+    /*!
+     * @brief Whether the streams fit the packed layout, their joint indices must fit in 8 bits.
+     */
+    static bool canPack(const MeshStreams& streams);
+
+    /*!
+     * @brief Packs every stream that is not empty, bounds must hold all the positions.
+     */
+    static PackedVertexStreams pack(const MeshStreams& streams, const BoundingBox& bounds);
+
+    static VertexDecode getDecode(const BoundingBox& bounds);
+
+    /*!
+     * @brief Size of the GPU vertex buffers of the streams, packed or at full precision.
+     */
+    static u64 getVertexBytes(const MeshStreams& streams, const bool& packed);
+
+    /*!
+     * @brief Rounds to the nearest half float, values out of its range saturate to the largest finite half.
+     */
+    static u16 floatToHalf(const float& value);
+
+    /*!
+     * @brief Maps a unit vector onto the octahedron and unfolds it to the [-1, 1] square, as snorm16 coordinates.
+     */
+    static void encodeOctahedral(const ramanujan::Vector3& normal, i16& x, i16& y);
+};
+
+} // namespace sputnik::graphics::core
@@ -0,0 +1,332 @@
+#include "pch.h"
+#include "dds_image.h"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+
+// Useful references:
+// https://learn.microsoft.com/en-us/windows/win32/direct3ddds/dds-header
+// https://learn.microsoft.com/en-us/windows/win32/direct3d10/d3d10-graphics-programming-guide-resources-block-compression
+
+namespace sputnik::graphics::gl
+{
+
+namespace
+{
+
+constexpr u32 makeFourCC(const char (&code)[5])
+{
+    return (u32)code[0] | (u32)code[1] << 8 | (u32)code[2] << 16 | (u32)code[3] << 24;
+}
+
+struct DdsPixelFormat
+{
+    u32 size;
+    u32 flags;
+    u32 four_cc;
+    u32 rgb_bit_count;
+    u32 masks[4];
+};
+
+struct DdsHeader
+{
+    u32            size;
+    u32            flags;
+    u32            height;
+    u32            width;
+    u32            pitch_or_linear_size;
+    u32            depth;
+    u32            mip_map_count;
+    u32            reserved[11];
+    DdsPixelFormat pixel_format;
+    u32            caps[4];
+    u32            reserved2;
+};
+
+struct DdsHeaderDx10
+{
+    u32 dxgi_format;
+    u32 resource_dimension;
+    u32 misc_flag;
+    u32 array_size;
+    u32 misc_flags2;
+};
+
+static_assert(sizeof(DdsHeader) == 124, "The DDS header layout is part of the file format.");
+static_assert(sizeof(DdsHeaderDx10) == 20, "The DDS DX10 header layout is part of the file format.");
+
+constexpr u32 kDdsMagic             = makeFourCC("DDS ");
+constexpr u32 kDdsFlagMipMapCount   = 0x20000;
+constexpr u32 kDdsPixelFormatFourCC = 0x4;
+constexpr u32 kDdsCaps2Cubemap      = 0x200;
+constexpr u32 kDdsCaps2Volume       = 0x200000;
+constexpr u32 kDx10MiscCubemap      = 0x4;
+constexpr u32 kDx10Texture2D        = 3;
+
+TextureFormat getFourCCFormat(const u32& four_cc)
+{
+    switch(four_cc)
+    {
+    case makeFourCC("DXT1"):
+        return TextureFormat::BC1;
+    case makeFourCC("DXT5"):
+        return TextureFormat::BC3;
+    case makeFourCC("ATI2"):
+    case makeFourCC("BC5U"):
+        return TextureFormat::BC5;
+    default:
+        break;
+    }
+    return TextureFormat::Invalid;
+}
+
+TextureFormat getDxgiFormat(const u32& dxgi_format)
+{
+    switch(dxgi_format)
+    {
+    case 71: // DXGI_FORMAT_BC1_UNORM
+    case 72: // DXGI_FORMAT_BC1_UNORM_SRGB
+        return TextureFormat::BC1;
+    case 77: // DXGI_FORMAT_BC3_UNORM
+    case 78: // DXGI_FORMAT_BC3_UNORM_SRGB
+        return TextureFormat::BC3;
+    case 83: // DXGI_FORMAT_BC5_UNORM
+        return TextureFormat::BC5;
+    case 98: // DXGI_FORMAT_BC7_UNORM
+    case 99: // DXGI_FORMAT_BC7_UNORM_SRGB
+        return TextureFormat::BC7;
+    default:
+        break;
+    }
+    return TextureFormat::Invalid;
+}
+
+void decodeColorBlock(const u8* block, const bool& allow_transparent, u8* out, const u32& out_stride)
+{
+    u16 endpoints[2];
+    u32 indices;
+    std::memcpy(endpoints, block, sizeof(endpoints));
+    std::memcpy(&indices, block + 4, sizeof(indices));
+
+    // RGB565 endpoints, the bits are replicated into the low bits of the 8 bit channels
+    u8 palette[4][4];
+    for(u32 i = 0; i < 2; ++i)
+    {
+        const u32 r   = (endpoints[i] >> 11) & 0x1f;
+        const u32 g   = (endpoints[i] >> 5) & 0x3f;
+        const u32 b   = endpoints[i] & 0x1f;
+        palette[i][0] = (u8)(r << 3 | r >> 2);
+        palette[i][1] = (u8)(g << 2 | g >> 4);
+        palette[i][2] = (u8)(b << 3 | b >> 2);
+        palette[i][3] = 255;
+    }
+    // BC1 switches to three colors and transparent black when the endpoints are not in descending order, the color
+    // block of BC3 always interpolates four colors
+    const bool four_colors = !allow_transparent || endpoints[0] > endpoints[1];
+    for(u32 c = 0; c < 3; ++c)
+    {
+        palette[2][c] = four_colors ? (u8)((2 * palette[0][c] + palette[1][c]) / 3)
+                                    : (u8)((palette[0][c] + palette[1][c]) / 2);
+        palette[3][c] = four_colors ? (u8)((palette[0][c] + 2 * palette[1][c]) / 3) : 0;
+    }
+    palette[2][3] = 255;
+    palette[3][3] = four_colors ? 255 : 0;
+
+    for(u32 texel = 0; texel < 16; ++texel)
+    {
+        const u8* color = palette[(indices >> (2 * texel)) & 0x3];
+        std::memcpy(out + (texel / 4) * out_stride + (texel % 4) * 4, color, 4);
+    }
+}
+
+void decodeChannelBlock(const u8* block, u8* out, const u32& out_stride)
+{
+    // BC4, two 8 bit endpoints followed by 16 three bit indices
+    u8 palette[8] = {block[0], block[1]};
+    for(u32 i = 1; i < 7; ++i)
+    {
+        palette[i + 1] = block[0] > block[1] ? (u8)(((7 - i) * block[0] + i * block[1]) / 7)
+                         : i < 5             ? (u8)(((5 - i) * block[0] + i * block[1]) / 5)
+                         : i == 5            ? 0
+                                             : 255;
+    }
+
+    u64 indices = 0;
+    std::memcpy(&indices, block + 2, 6);
+    for(u32 texel = 0; texel < 16; ++texel)
+    {
+        out[(texel / 4) * out_stride + (texel % 4) * 4] = palette[(indices >> (3 * texel)) & 0x7];
+    }
+}
+
+} // namespace
+
+bool DdsImage::isDdsFile(const std::string& path)
+{
+    std::string extension = std::filesystem::path(path).extension().string();
+    std::transform(extension.begin(),
+                   extension.end(),
+                   extension.begin(),
+                   [](const unsigned char c) { return (char)std::tolower(c); });
+    return extension == kExtension;
+}
+
+bool DdsImage::parse(const std::span<const u8>& file, const std::string& path)
+{
+    m_levels.clear();
+
+    u32       magic = 0;
+    DdsHeader header{};
+    if(file.size() < sizeof(magic) + sizeof(header))
+    {
+        ENGINE_ERROR("DDS file {} is truncated.", path);
+        return false;
+    }
+    std::memcpy(&magic, file.data(), sizeof(magic));
+    std::memcpy(&header, file.data() + sizeof(magic), sizeof(header));
+    if(magic != kDdsMagic || header.size != sizeof(DdsHeader))
+    {
+        ENGINE_ERROR("{} is not a DDS file.", path);
+        return false;
+    }
+    if((header.caps[1] & (kDdsCaps2Cubemap | kDdsCaps2Volume)) != 0)
+    {
+        ENGINE_ERROR("DDS file {} is not a 2D texture.", path);
+        return false;
+    }
+
+    u64 offset = sizeof(magic) + sizeof(header);
+    m_format   = TextureFormat::Invalid;
+    if((header.pixel_format.flags & kDdsPixelFormatFourCC) != 0 && header.pixel_format.four_cc == makeFourCC("DX10"))
+    {
+        DdsHeaderDx10 header_dx10{};
+        if(file.size() < offset + sizeof(header_dx10))
+        {
+            ENGINE_ERROR("DDS file {} is truncated.", path);
+            return false;
+        }
+        std::memcpy(&header_dx10, file.data() + offset, sizeof(header_dx10));
+        offset += sizeof(header_dx10);
+        if(header_dx10.resource_dimension != kDx10Texture2D || header_dx10.array_size > 1 ||
+           (header_dx10.misc_flag & kDx10MiscCubemap) != 0)
+        {
+            ENGINE_ERROR("DDS file {} is not a 2D texture.", path);
+            return false;
+        }
+        m_format = getDxgiFormat(header_dx10.dxgi_format);
+    }
+    else if((header.pixel_format.flags & kDdsPixelFormatFourCC) != 0)
+    {
+        m_format = getFourCCFormat(header.pixel_format.four_cc);
+    }
+    if(m_format == TextureFormat::Invalid || header.width == 0 || header.height == 0)
+    {
+        ENGINE_ERROR("DDS file {} is not in a supported format (BC1, BC3, BC5, BC7).", path);
+        return false;
+    }
+
+    m_width               = header.width;
+    m_height              = header.height;
+    const u32 level_count = (header.flags & kDdsFlagMipMapCount) != 0 ? std::max(header.mip_map_count, 1u) : 1u;
+    const u32 max_levels  = getFullMipLevelCount(m_width, m_height);
+    for(u32 level = 0; level < std::min(level_count, max_levels); ++level)
+    {
+        const u64 bytes =
+            getTextureLevelBytes(m_format, std::max(m_width >> level, 1u), std::max(m_height >> level, 1u));
+        if(file.size() < offset + bytes)
+        {
+            ENGINE_ERROR("DDS file {} is truncated.", path);
+            m_levels.clear();
+            return false;
+        }
+        m_levels.push_back(file.subspan(offset, bytes));
+        offset += bytes;
+    }
+    return true;
+}
+
+TextureFormat DdsImage::getFormat() const
+{
+    return m_format;
+}
+
+u32 DdsImage::getWidth() const
+{
+    return m_width;
+}
+
+u32 DdsImage::getHeight() const
+{
+    return m_height;
+}
+
+u32 DdsImage::getLevelCount() const
+{
+    return (u32)m_levels.size();
+}
+
+std::span<const u8> DdsImage::getLevel(const u32& level) const
+{
+    SPUTNIK_ASSERT(level < m_levels.size(), "DDS level out of range.");
+    return m_levels[level];
+}
+
+std::vector<u8> decodeBlocks(const TextureFormat&       format,
+                             const std::span<const u8>& blocks,
+                             const u32&                 width,
+                             const u32&                 height)
+{
+    if(format != TextureFormat::BC1 && format != TextureFormat::BC3 && format != TextureFormat::BC5)
+    {
+        return {};
+    }
+    SPUTNIK_ASSERT(blocks.size() >= getTextureLevelBytes(format, width, height), "Not enough blocks for the level.");
+
+    // decoded into whole blocks first, the padding of partial blocks is cropped when the rows are copied out
+    const u32       blocks_x     = (width + 3) / 4;
+    const u32       blocks_y     = (height + 3) / 4;
+    const u32       block_bytes  = format == TextureFormat::BC1 ? 8 : 16;
+    const u32       padded_pitch = blocks_x * 4 * 4;
+    std::vector<u8> padded((u64)padded_pitch * blocks_y * 4);
+    for(u32 y = 0; y < blocks_y; ++y)
+    {
+        for(u32 x = 0; x < blocks_x; ++x)
+        {
+            const u8* block = blocks.data() + ((u64)y * blocks_x + x) * block_bytes;
+            u8*       out   = padded.data() + (u64)y * 4 * padded_pitch + x * 4 * 4;
+            switch(format)
+            {
+            case TextureFormat::BC1:
+                decodeColorBlock(block, true, out, padded_pitch);
+                break;
+            case TextureFormat::BC3:
+                decodeColorBlock(block + 8, false, out, padded_pitch);
+                decodeChannelBlock(block, out + 3, padded_pitch);
+                break;
+            default:
+                for(u32 row = 0; row < 4; ++row)
+                {
+                    for(u32 column = 0; column < 4; ++column)
+                    {
+                        u8* texel = out + row * padded_pitch + column * 4;
+                        texel[2]  = 0;
+                        texel[3]  = 255;
+                    }
+                }
+                decodeChannelBlock(block, out, padded_pitch);
+                decodeChannelBlock(block + 8, out + 1, padded_pitch);
+                break;
+            }
+        }
+    }
+
+    std::vector<u8> pixels((u64)width * height * 4);
+    for(u32 row = 0; row < height; ++row)
+    {
+        std::memcpy(pixels.data() + (u64)row * width * 4, padded.data() + (u64)row * padded_pitch, (u64)width * 4);
+    }
+    return pixels;
+}
+
+} // namespace sputnik::graphics::gl
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "core/core.h"
+#include "gl_texture.h"
+
+#include <span>
+#include <string>
+#include <vector>
+
+namespace sputnik::graphics::gl
+{
+
+/*!
+ * @brief The block compressed mip chain of a DDS file, as written by texconv, compressonator and most DCC exporters.
+ *
+ * @details Only 2D textures in the BC1, BC3, BC5 and BC7 formats are read, both from legacy (DXT1, DXT5, ATI2) and
+ * DX10 headers. sRGB variants are read as their UNORM format. The levels point into the bytes passed to parse(), which
+ * must outlive the image.
+ */
+class DdsImage
+{
+public:
+    static constexpr const char* kExtension = ".dds";
+
+    static bool isDdsFile(const std::string& path);
+
+    /*!
+     * @brief Parses the header and validates the level sizes against the file size, returns false (and logs) for
+     * unsupported or truncated files.
+     */
+    bool parse(const std::span<const u8>& file, const std::string& path);
+
+    TextureFormat       getFormat() const;
+    u32                 getWidth() const;
+    u32                 getHeight() const;
+    u32                 getLevelCount() const;
+    std::span<const u8> getLevel(const u32& level) const;
+
+private:
+    TextureFormat                    m_format{TextureFormat::Invalid};
+    u32                              m_width{0};
+    u32                              m_height{0};
+    std::vector<std::span<const u8>> m_levels;
+};
+
+/*!
+ * @brief Decodes a level of BC1, BC3 or BC5 blocks to RGBA8, for drivers without support for the format. BC5 is
+ * decoded to red and green with blue 0 and alpha 255. BC7 is core since GL 4.2 and is never decoded, an empty vector
+ * is returned for it.
+ */
+std::vector<u8> decodeBlocks(const TextureFormat&       format,
+                             const std::span<const u8>& blocks,
+                             const u32&                 width,
+                             const u32&                 height);
+
+} // namespace sputnik::graphics::gl
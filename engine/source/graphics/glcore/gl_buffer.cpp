@@ -139,11 +139,31 @@ void OglBuffer::setData(void* data, u64 bytes)
     // glNamedBufferSubData(m_id, 0, bytes, data);
 }
 
+void* OglBuffer::map(const u64& offset, const u64& bytes, const u32& access_flags)
+{
+    // Reference: https://registry.khronos.org/OpenGL-Refpages/gl4/html/glMapBufferRange.xhtml
+    SPUTNIK_ASSERT(m_id != 0, "Buffer is not initialized.");
+    void* mapped = glMapNamedBufferRange(m_id, (GLintptr)offset, (GLsizeiptr)bytes, access_flags);
+    SPUTNIK_ASSERT(mapped != nullptr, "Failed to map the buffer.");
+    return mapped;
+}
+
+void OglBuffer::unmap()
+{
+    SPUTNIK_ASSERT(m_id != 0, "Buffer is not initialized.");
+    glUnmapNamedBuffer(m_id);
+}
+
 const u32& OglBuffer::getId() const
 {
     return m_id;
 }
 
+const u64& OglBuffer::getSize() const
+{
+    return m_bytes;
+}
+
 void OglBuffer::bind(const BufferBindTarget& bind_target)
 {
     // Reference: https://registry.khronos.org/OpenGL-Refpages/gl4/html/glBindBuffer.xhtml
@@ -94,7 +94,19 @@ public:
      */
     void setData(void* data, u64 bytes);
 
+    /*!
+     * @brief Maps a range of the buffer into client memory. Persistent mappings require the storage to have been
+     * created with the same kMapPersistentBit/kMapCoherentBit flags.
+     *
+     * @param offset
+     * @param bytes
+     * @param access_flags Combination of kMapReadBit, kMapWriteBit, kMapPersistentBit and kMapCoherentBit.
+     */
+    void* map(const u64& offset, const u64& bytes, const u32& access_flags);
+    void  unmap();
+
     const u32& getId() const;
+    const u64& getSize() const;
 
     void bind(const BufferBindTarget& bind_target);
     void bind(const BufferBindTarget& bind_target, const u32& bind_index);
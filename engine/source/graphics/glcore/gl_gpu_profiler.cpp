@@ -0,0 +1,89 @@
+#include "pch.h"
+
+#include "gl_gpu_profiler.h"
+
+#include <glad/glad.h>
+
+namespace sputnik::graphics::gl
+{
+
+// Useful references:
+// https://www.khronos.org/opengl/wiki/Query_Object#Timer_queries
+
+OglGpuProfiler::OglGpuProfiler()
+{
+    for(QueryFrame& frame : m_frames)
+    {
+        glGenQueries(kMaxScopes, frame.queries);
+    }
+}
+
+OglGpuProfiler::~OglGpuProfiler()
+{
+    for(QueryFrame& frame : m_frames)
+    {
+        glDeleteQueries(kMaxScopes, frame.queries);
+    }
+}
+
+void OglGpuProfiler::beginFrame()
+{
+    SPUTNIK_ASSERT(!m_scope_open, "A GPU profiler scope is still open at the end of the frame.");
+
+    m_frame = (m_frame + 1) % kFrameCount;
+
+    QueryFrame& frame    = m_frames[m_frame];
+    auto        profiler = sputnik::core::Profiler::getInstance();
+    for(u32 scope = 0; scope < frame.count; ++scope)
+    {
+        GLint available = GL_FALSE;
+        glGetQueryObjectiv(frame.queries[scope], GL_QUERY_RESULT_AVAILABLE, &available);
+        if(available == GL_FALSE)
+        {
+            ++m_dropped_samples;
+            continue;
+        }
+
+        GLuint64 elapsed_ns = 0;
+        glGetQueryObjectui64v(frame.queries[scope], GL_QUERY_RESULT, &elapsed_ns);
+        profiler->addGpuSample(frame.names[scope], frame.start_ns[scope], (u64)elapsed_ns);
+    }
+    frame.count = 0;
+}
+
+void OglGpuProfiler::beginScope(const char* name)
+{
+    SPUTNIK_ASSERT(!m_scope_open, "GPU profiler scopes can not be nested.");
+    m_scope_open = true;
+
+    QueryFrame& frame = m_frames[m_frame];
+    m_scope_recorded  = frame.count < kMaxScopes;
+    if(!m_scope_recorded)
+    {
+        ++m_dropped_samples;
+        return;
+    }
+
+    frame.names[frame.count]    = name;
+    frame.start_ns[frame.count] = sputnik::core::Profiler::getInstance()->now();
+    glBeginQuery(GL_TIME_ELAPSED, frame.queries[frame.count]);
+}
+
+void OglGpuProfiler::endScope()
+{
+    SPUTNIK_ASSERT(m_scope_open, "GPU profiler scope closed without being opened.");
+    m_scope_open = false;
+
+    if(m_scope_recorded)
+    {
+        glEndQuery(GL_TIME_ELAPSED);
+        ++m_frames[m_frame].count;
+    }
+}
+
+u32 OglGpuProfiler::getDroppedSampleCount() const
+{
+    return m_dropped_samples;
+}
+
+} // namespace sputnik::graphics::gl
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "core/core.h"
+#include "core/profiling/profiler.h"
+
+namespace sputnik::graphics::gl
+{
+
+/*!
+ * @brief Measures the GPU time of render passes with GL_TIME_ELAPSED queries and reports it to the profiler.
+ *
+ * @details The queries are double buffered: the results of a frame are read back when its query set is reused two
+ * frames later. A result that is still not available then is dropped instead of waiting for it, so the profiler never
+ * stalls the pipeline. Elapsed time queries can not be nested, GPU scopes must not overlap.
+ */
+class OglGpuProfiler
+{
+public:
+    static constexpr u32 kFrameCount = 2;
+    static constexpr u32 kMaxScopes  = 32; // per frame
+
+    OglGpuProfiler();
+    ~OglGpuProfiler();
+
+    NON_COPYABLE(OglGpuProfiler);
+
+    /*!
+     * @brief Reads back the results of the frame that used the query set of this frame.
+     */
+    void beginFrame();
+
+    void beginScope(const char* name);
+    void endScope();
+
+    u32 getDroppedSampleCount() const;
+
+private:
+    struct QueryFrame
+    {
+        u32         queries[kMaxScopes]{};
+        const char* names[kMaxScopes]{};
+        u64         start_ns[kMaxScopes]{};
+        u32         count{0};
+    };
+
+    QueryFrame m_frames[kFrameCount];
+    u32        m_frame{0};
+    bool       m_scope_open{false};
+    bool       m_scope_recorded{false}; // false when the scope did not get a query
+    u32        m_dropped_samples{0};
+};
+
+/*!
+ * @brief Times the enclosing block as a CPU scope and as a GPU pass.
+ */
+class OglGpuScope
+{
+public:
+    OglGpuScope(OglGpuProfiler& profiler, const char* name) : m_cpu_scope(name), m_profiler(profiler)
+    {
+        m_profiler.beginScope(name);
+    }
+    ~OglGpuScope() { m_profiler.endScope(); }
+
+    NON_COPYABLE(OglGpuScope);
+
+private:
+    sputnik::core::ProfileScope m_cpu_scope;
+    OglGpuProfiler&             m_profiler;
+};
+
+} // namespace sputnik::graphics::gl
@@ -0,0 +1,171 @@
+#include "pch.h"
+#include "gl_program_cache.h"
+
+#include <glad/glad.h>
+
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+namespace sputnik::graphics::gl
+{
+
+namespace
+{
+
+constexpr u32 kProgramBinaryMagic   = 0x42475053; // "SPGB"
+constexpr u32 kProgramBinaryVersion = 1;
+
+struct ProgramBinaryHeader
+{
+    u32 magic;
+    u32 version;
+    u64 key;
+    u32 format; // of glGetProgramBinary
+    u32 bytes;
+};
+
+static_assert(sizeof(ProgramBinaryHeader) == 24, "The program binary header layout is part of the file format.");
+
+// FNV-1a, the key only has to tell programs apart, it is not exposed to untrusted input
+void hashBytes(u64& hash, const void* data, const size_t& bytes)
+{
+    constexpr u64 kPrime = 1099511628211ull;
+    const u8*     bytes_ = (const u8*)data;
+    for(size_t i = 0; i < bytes; ++i)
+    {
+        hash = (hash ^ bytes_[i]) * kPrime;
+    }
+}
+
+void hashString(u64& hash, const char* text)
+{
+    // the terminator separates consecutive strings
+    hashBytes(hash, text ? text : "", text ? std::strlen(text) + 1 : 1);
+}
+
+} // namespace
+
+void OglProgramCache::setDirectory(const std::string& directory)
+{
+    m_directory = directory;
+}
+
+const std::string& OglProgramCache::getDirectory()
+{
+    return m_directory;
+}
+
+u64 OglProgramCache::computeKey(const std::span<const u32>& stage_types, const std::span<const std::string>& sources)
+{
+    SPUTNIK_ASSERT(stage_types.size() == sources.size(), "Expected one source per shader stage.");
+
+    u64 hash = 14695981039346656037ull;
+    hashString(hash, (const char*)glGetString(GL_VENDOR));
+    hashString(hash, (const char*)glGetString(GL_RENDERER));
+    hashString(hash, (const char*)glGetString(GL_VERSION));
+    for(size_t stage = 0; stage < sources.size(); ++stage)
+    {
+        hashBytes(hash, &stage_types[stage], sizeof(u32));
+        hashString(hash, sources[stage].c_str());
+    }
+    return hash;
+}
+
+bool OglProgramCache::load(const u32& program, const u64& key)
+{
+    if(!isEnabled())
+    {
+        return false;
+    }
+
+    std::ifstream file(getPath(key), std::ios::binary);
+    if(!file)
+    {
+        return false;
+    }
+
+    ProgramBinaryHeader header{};
+    file.read((char*)&header, sizeof(header));
+    if(!file || header.magic != kProgramBinaryMagic || header.version != kProgramBinaryVersion || header.key != key)
+    {
+        return false;
+    }
+    std::vector<char> binary(header.bytes);
+    file.read(binary.data(), (std::streamsize)binary.size());
+    if(!file)
+    {
+        return false;
+    }
+
+    // Reference: https://registry.khronos.org/OpenGL-Refpages/gl4/html/glProgramBinary.xhtml
+    glProgramBinary(program, (GLenum)header.format, binary.data(), (GLsizei)binary.size());
+    GLint success = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    if(success != GL_TRUE)
+    {
+        ENGINE_INFO("The driver rejected the program binary {}, the program is compiled again.", getPath(key));
+    }
+    return success == GL_TRUE;
+}
+
+void OglProgramCache::store(const u32& program, const u64& key)
+{
+    if(!isEnabled())
+    {
+        return;
+    }
+
+    // Reference: https://registry.khronos.org/OpenGL-Refpages/gl4/html/glGetProgramBinary.xhtml
+    GLint bytes = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &bytes);
+    if(bytes <= 0)
+    {
+        return;
+    }
+    std::vector<char> binary((size_t)bytes);
+    GLenum            format = 0;
+    glGetProgramBinary(program, bytes, &bytes, &format, binary.data());
+
+    std::error_code error;
+    std::filesystem::create_directories(m_directory, error);
+
+    // written next to the final file and renamed, so that an interrupted write never leaves a truncated binary
+    const std::string path           = getPath(key);
+    const std::string temporary_path = path + ".tmp";
+    {
+        const ProgramBinaryHeader header{kProgramBinaryMagic, kProgramBinaryVersion, key, (u32)format, (u32)bytes};
+        std::ofstream             file(temporary_path, std::ios::binary | std::ios::trunc);
+        file.write((const char*)&header, sizeof(header));
+        file.write(binary.data(), bytes);
+        if(!file)
+        {
+            ENGINE_WARN("Could not write the program binary {}.", temporary_path);
+            return;
+        }
+    }
+    std::filesystem::rename(temporary_path, path, error);
+    if(error)
+    {
+        ENGINE_WARN("Could not replace the program binary {}: {}", path, error.message());
+        std::filesystem::remove(temporary_path, error);
+    }
+}
+
+bool OglProgramCache::isEnabled()
+{
+    GLint format_count = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &format_count);
+    return format_count > 0;
+}
+
+std::string OglProgramCache::getPath(const u64& key)
+{
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx", (unsigned long long)key);
+    return m_directory + "/" + name + kExtension;
+}
+
+} // namespace sputnik::graphics::gl
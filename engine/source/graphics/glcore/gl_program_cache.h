@@ -0,0 +1,58 @@
+#pragma once
+
+#include "core/core.h"
+
+#include <span>
+#include <string>
+
+namespace sputnik::graphics::gl
+{
+
+/*!
+ * @brief Linked shader programs kept on disk as driver binaries (glGetProgramBinary), so that a program is compiled
+ * once per driver instead of every time the application starts.
+ *
+ * @details A binary is keyed by a hash of the preprocessed sources of the program and of the vendor, renderer and
+ * version strings of the driver, an edited shader or an updated driver misses the cache. Drivers may still reject a
+ * binary (load() returns false), the program is then compiled from its sources and stored again. The cache is
+ * disabled on drivers without program binary formats.
+ */
+class OglProgramCache
+{
+public:
+    static constexpr const char* kExtension = ".glbin";
+
+    NON_INSTATIABLE(OglProgramCache)
+
+    /*!
+     * @brief Directory the binaries are stored in, created when the first binary is stored.
+     */
+    static void               setDirectory(const std::string& directory);
+    static const std::string& getDirectory();
+
+    /*!
+     * @brief Key of a program with the given stages, one GL stage type and preprocessed source per stage.
+     */
+    static u64 computeKey(const std::span<const u32>& stage_types, const std::span<const std::string>& sources);
+
+    /*!
+     * @brief Loads the binary stored for key into program and returns its link status. Returns false when there is no
+     * binary for key or the driver rejects it.
+     */
+    static bool load(const u32& program, const u64& key);
+
+    /*!
+     * @brief Stores the binary of a successfully linked program. The program must have been linked with
+     * GL_PROGRAM_BINARY_RETRIEVABLE_HINT set.
+     */
+    static void store(const u32& program, const u64& key);
+
+    static bool isEnabled();
+
+private:
+    static std::string getPath(const u64& key);
+
+    inline static std::string m_directory = "../../data/shaders/cache";
+};
+
+} // namespace sputnik::graphics::gl
@@ -0,0 +1,471 @@
+#include "pch.h"
+
+#include "gl_render_queue.h"
+#include "gl_texture.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace sputnik::graphics::gl
+{
+
+namespace
+{
+
+constexpr u64 kPassShift            = 62;
+constexpr u64 kProgramShift         = 58;
+constexpr u64 kDiffuseTextureShift  = 46;
+constexpr u64 kSpecularTextureShift = 34;
+constexpr u64 kMaterialShift        = 18;
+
+constexpr u64 kProgramMask     = 0xf;
+constexpr u64 kTextureMask     = 0xfff;
+constexpr u64 kMaterialMask    = 0xffff;
+constexpr u64 kVertexArrayMask = 0x3ffff;
+
+// shorter runs of identical draws are cheaper to submit one by one than to copy into the instance buffer
+constexpr size_t kMinInstanceRun = 2;
+
+// draws closer to the camera than this are drawn with their full mesh
+constexpr float kMinLodDistance = 1e-3f;
+
+u64 hashMaterialUniforms(const DrawMaterial& material)
+{
+    // FNV-1a over the uniform values, folded to the width of the key field
+    const float values[] = {material.diffuse.x,
+                            material.diffuse.y,
+                            material.diffuse.z,
+                            material.specular.x,
+                            material.specular.y,
+                            material.specular.z,
+                            material.shininess};
+    u8          bytes[sizeof(values)];
+    std::memcpy(bytes, values, sizeof(values));
+
+    u32 hash = 2166136261u;
+    for(const u8& byte : bytes)
+    {
+        hash ^= byte;
+        hash *= 16777619u;
+    }
+    return u64((hash >> 16) ^ hash) & kMaterialMask;
+}
+
+u64 textureKey(const OglTexture2D* texture)
+{
+    return texture ? u64(texture->getId()) & kTextureMask : 0;
+}
+
+template <typename Packet>
+bool hasLowerSortKey(const Packet& a, const Packet& b)
+{
+    return a.sort_key < b.sort_key;
+}
+
+u32 offsetIndex(const u32& index, const u32& offset)
+{
+    return index == RenderQueue::kInvalidIndex ? index : index + offset;
+}
+
+template <typename T>
+void appendAndClear(std::vector<T>& destination, std::vector<T>& source)
+{
+    destination.insert(destination.end(), source.begin(), source.end());
+    source.clear();
+}
+
+} // namespace
+
+bool DrawMaterial::hasSameUniforms(const DrawMaterial& other) const
+{
+    return diffuse.x == other.diffuse.x && diffuse.y == other.diffuse.y && diffuse.z == other.diffuse.z &&
+           specular.x == other.specular.x && specular.y == other.specular.y && specular.z == other.specular.z &&
+           shininess == other.shininess;
+}
+
+u32 RenderQueue::addMaterial(const DrawMaterial& material)
+{
+    m_materials.push_back(material);
+    return u32(m_materials.size() - 1);
+}
+
+u32 RenderQueue::addTransform(const mat4& model)
+{
+    mat4 normal_matrix = model;
+    normal_matrix      = normal_matrix.inverted().transpose(); // (Transpose of inverse of the model matrix)
+    m_transforms.push_back({model, normal_matrix});
+    return u32(m_transforms.size() - 1);
+}
+
+u32 RenderQueue::addSkinTransforms(const std::vector<Matrix4>& skin_transformations)
+{
+    const u32 offset = u32(m_skin_transforms.size());
+    m_skin_transforms.insert(m_skin_transforms.end(), skin_transformations.begin(), skin_transformations.end());
+    return offset;
+}
+
+u32 RenderQueue::addBounds(const BoundingBox& world_bounds)
+{
+    m_bounds.push_back(world_bounds);
+    return u32(m_bounds.size() - 1);
+}
+
+u32 RenderQueue::addLods(const DrawLods& lods, const mat4& model)
+{
+    SPUTNIK_ASSERT(lods.lods.size() <= kMaxMeshLods, "Too many levels of detail.");
+
+    // the errors are object space distances, they scale with the longest axis of the model matrix
+    float scale = 0.0f;
+    for(u32 axis = 0; axis < 3; ++axis)
+    {
+        const float* column = &model.m[axis * 4];
+        scale = std::max(scale, std::sqrt(column[0] * column[0] + column[1] * column[1] + column[2] * column[2]));
+    }
+
+    DrawLodChain chain;
+    std::copy(lods.lods.begin(), lods.lods.end(), chain.lods);
+    chain.lod_count    = u32(lods.lods.size());
+    chain.scale        = scale;
+    chain.world_bounds = lods.bounds.transformed(model);
+    chain.history      = lods.history;
+    m_lod_chains.push_back(chain);
+    return u32(m_lod_chains.size() - 1);
+}
+
+u32 RenderQueue::addVertexDecode(const VertexDecode& decode)
+{
+    m_vertex_decodes.push_back(decode);
+    return u32(m_vertex_decodes.size() - 1);
+}
+
+u32 RenderQueue::addInstances(const std::span<const mat4>& models, const std::span<const vec4>& colors)
+{
+    SPUTNIK_ASSERT(colors.empty() || colors.size() == models.size(), "Expected one color per instance.");
+
+    const u32 offset = u32(m_instances.size());
+    m_instances.reserve(m_instances.size() + models.size());
+    for(size_t i = 0; i < models.size(); ++i)
+    {
+        mat4 normal_matrix = models[i];
+        normal_matrix      = normal_matrix.inverted().transpose(); // (Transpose of inverse of the model matrix)
+        m_instances.push_back({models[i], normal_matrix, colors.empty() ? vec4(1.0f, 1.0f, 1.0f, 1.0f) : colors[i]});
+    }
+    return offset;
+}
+
+void RenderQueue::push(DrawPacket packet)
+{
+    SPUTNIK_ASSERT(packet.material_index < m_materials.size(), "Draw packet references an unknown material.");
+    packet.sort_key = makeSortKey(packet, m_materials[packet.material_index]);
+    m_packets.push_back(packet);
+}
+
+void RenderQueue::pushStatic(StaticDrawPacket packet)
+{
+    SPUTNIK_ASSERT(packet.material_index < m_materials.size(), "Draw packet references an unknown material.");
+    DrawPacket key_packet;
+    key_packet.pass    = RenderPass::Opaque;
+    key_packet.program = DrawProgram::ShadowPass; // zero, static draws all use the same program
+    packet.sort_key    = makeSortKey(key_packet, m_materials[packet.material_index]);
+    m_static_packets.push_back(packet);
+}
+
+void RenderQueue::sort()
+{
+    std::sort(m_packets.begin(), m_packets.end(), hasLowerSortKey<DrawPacket>);
+    std::sort(m_static_packets.begin(), m_static_packets.end(), hasLowerSortKey<StaticDrawPacket>);
+}
+
+void RenderQueue::append(RenderQueue& other)
+{
+    const u32 material_offset  = u32(m_materials.size());
+    const u32 transform_offset = u32(m_transforms.size());
+    const u32 skin_offset      = u32(m_skin_transforms.size());
+    const u32 bounds_offset    = u32(m_bounds.size());
+    const u32 lod_offset       = u32(m_lod_chains.size());
+    const u32 decode_offset    = u32(m_vertex_decodes.size());
+    const u32 instance_offset  = u32(m_instances.size());
+
+    const size_t packet_count = m_packets.size();
+    for(DrawPacket packet : other.m_packets)
+    {
+        packet.material_index  = offsetIndex(packet.material_index, material_offset);
+        packet.transform_index = offsetIndex(packet.transform_index, transform_offset);
+        packet.bounds_index    = offsetIndex(packet.bounds_index, bounds_offset);
+        packet.lod_index       = offsetIndex(packet.lod_index, lod_offset);
+        packet.decode_index    = offsetIndex(packet.decode_index, decode_offset);
+        packet.skin_offset += skin_offset;
+        packet.instance_offset += instance_offset;
+        m_packets.push_back(packet);
+    }
+    std::inplace_merge(
+        m_packets.begin(), m_packets.begin() + packet_count, m_packets.end(), hasLowerSortKey<DrawPacket>);
+
+    const size_t static_packet_count = m_static_packets.size();
+    for(StaticDrawPacket packet : other.m_static_packets)
+    {
+        packet.material_index  = offsetIndex(packet.material_index, material_offset);
+        packet.transform_index = offsetIndex(packet.transform_index, transform_offset);
+        packet.bounds_index    = offsetIndex(packet.bounds_index, bounds_offset);
+        m_static_packets.push_back(packet);
+    }
+    std::inplace_merge(m_static_packets.begin(),
+                       m_static_packets.begin() + static_packet_count,
+                       m_static_packets.end(),
+                       hasLowerSortKey<StaticDrawPacket>);
+
+    other.m_packets.clear();
+    other.m_static_packets.clear();
+    appendAndClear(m_materials, other.m_materials);
+    appendAndClear(m_transforms, other.m_transforms);
+    appendAndClear(m_skin_transforms, other.m_skin_transforms);
+    appendAndClear(m_bounds, other.m_bounds);
+    appendAndClear(m_lod_chains, other.m_lod_chains);
+    appendAndClear(m_vertex_decodes, other.m_vertex_decodes);
+    appendAndClear(m_instances, other.m_instances);
+}
+
+u32 RenderQueue::cull(const Frustum& view_frustum, const Frustum* cascade_frusta, const u32& cascade_count)
+{
+    const auto cascade_visibility = [&](const BoundingBox& bounds)
+    {
+        u8 visibility = 0;
+        for(u32 cascade = 0; cascade < cascade_count; ++cascade)
+        {
+            if(cascade_frusta[cascade].intersects(bounds))
+            {
+                visibility |= cascadeVisibilityBit(cascade);
+            }
+        }
+        return visibility;
+    };
+
+    for(DrawPacket& packet : m_packets)
+    {
+        if(packet.bounds_index == kInvalidIndex)
+        {
+            continue;
+        }
+        const BoundingBox& bounds = m_bounds[packet.bounds_index];
+        if(packet.pass == RenderPass::Shadow)
+        {
+            packet.visibility = cascade_visibility(bounds);
+        }
+        else
+        {
+            packet.visibility = view_frustum.intersects(bounds) ? kVisibleInView : 0;
+        }
+    }
+
+    for(StaticDrawPacket& packet : m_static_packets)
+    {
+        if(packet.bounds_index == kInvalidIndex)
+        {
+            continue;
+        }
+        const BoundingBox& bounds = m_bounds[packet.bounds_index];
+        packet.visibility         = cascade_visibility(bounds) | (view_frustum.intersects(bounds) ? kVisibleInView : 0);
+    }
+
+    const size_t packet_count = m_packets.size() + m_static_packets.size();
+    std::erase_if(m_packets, [](const DrawPacket& packet) { return packet.visibility == 0; });
+    std::erase_if(m_static_packets, [](const StaticDrawPacket& packet) { return packet.visibility == 0; });
+    return u32(packet_count - m_packets.size() - m_static_packets.size());
+}
+
+u32 RenderQueue::selectLods(const vec3& camera_position, const float& projection_scale, const LodSettings& settings)
+{
+    // one level per chain, the packets of a draw share its chain
+    for(DrawLodChain& chain : m_lod_chains)
+    {
+        const vec3& min = chain.world_bounds.min;
+        const vec3& max = chain.world_bounds.max;
+        const float dx  = std::max({min.x - camera_position.x, 0.0f, camera_position.x - max.x});
+        const float dy  = std::max({min.y - camera_position.y, 0.0f, camera_position.y - max.y});
+        const float dz  = std::max({min.z - camera_position.z, 0.0f, camera_position.z - max.z});
+
+        const float distance        = std::max(std::sqrt(dx * dx + dy * dy + dz * dz), kMinLodDistance);
+        const float pixels_per_unit = projection_scale * chain.scale / distance;
+        const u32   current_lod     = chain.history ? *chain.history : 0;
+
+        chain.selected = sputnik::graphics::core::selectLod(
+            {chain.lods, chain.lod_count}, pixels_per_unit, current_lod, settings);
+    }
+
+    u32 reduced_draws = 0;
+    for(DrawPacket& packet : m_packets)
+    {
+        if(packet.lod_index == kInvalidIndex)
+        {
+            continue;
+        }
+        const DrawLodChain& chain = m_lod_chains[packet.lod_index];
+        const MeshLod&      lod   = chain.lods[chain.selected];
+        packet.first_index        = lod.first_index;
+        packet.element_count      = lod.index_count;
+        reduced_draws += chain.selected > 0 && packet.pass == RenderPass::Opaque ? 1 : 0;
+    }
+    return reduced_draws;
+}
+
+void RenderQueue::storeLodHistory()
+{
+    for(const DrawLodChain& chain : m_lod_chains)
+    {
+        if(chain.history)
+        {
+            *chain.history = u8(chain.selected);
+        }
+    }
+}
+
+u32 RenderQueue::mergeInstances()
+{
+    const auto is_mergeable = [](const DrawPacket& packet)
+    { return packet.program == DrawProgram::BlinnPhong || packet.program == DrawProgram::ShadowPass; };
+
+    const auto can_merge = [this](const DrawPacket& a, const DrawPacket& b)
+    {
+        if(a.pass != b.pass || a.program != b.program || a.vertex_array != b.vertex_array || a.indexed != b.indexed ||
+           a.element_count != b.element_count || a.first_index != b.first_index)
+        {
+            return false;
+        }
+        // the shadow pass only writes depth, materials do not matter there
+        if(a.pass == RenderPass::Shadow)
+        {
+            return true;
+        }
+        const DrawMaterial& material_a = m_materials[a.material_index];
+        const DrawMaterial& material_b = m_materials[b.material_index];
+        return material_a.diffuse_texture == material_b.diffuse_texture &&
+               material_a.specular_texture == material_b.specular_texture && material_a.hasSameUniforms(material_b);
+    };
+
+    // identical draws are adjacent in the sorted queue, every run is compacted into its first packet
+    u32    merged_draws = 0;
+    size_t write        = 0;
+    for(size_t first = 0; first < m_packets.size();)
+    {
+        size_t last = first + 1;
+        if(is_mergeable(m_packets[first]))
+        {
+            while(last < m_packets.size() && can_merge(m_packets[first], m_packets[last]))
+            {
+                ++last;
+            }
+        }
+
+        DrawPacket packet = m_packets[first];
+        if(last - first >= kMinInstanceRun)
+        {
+            packet.instance_offset = u32(m_instances.size());
+            packet.instance_count  = u32(last - first);
+            for(size_t i = first; i < last; ++i)
+            {
+                const DrawTransform& transform = m_transforms[m_packets[i].transform_index];
+                m_instances.push_back({transform.model, transform.normal_matrix, vec4(1.0f, 1.0f, 1.0f, 1.0f)});
+                packet.visibility |= m_packets[i].visibility;
+            }
+            packet.program =
+                packet.pass == RenderPass::Shadow ? DrawProgram::ShadowPassInstanced : DrawProgram::BlinnPhongInstanced;
+            packet.transform_index = kInvalidIndex;
+            packet.bounds_index    = kInvalidIndex;
+            packet.sort_key        = makeSortKey(packet, m_materials[packet.material_index]);
+            merged_draws += packet.instance_count;
+        }
+        m_packets[write++] = packet;
+        first              = last;
+    }
+    m_packets.resize(write);
+
+    if(merged_draws > 0)
+    {
+        sort();
+    }
+    return merged_draws;
+}
+
+void RenderQueue::clear()
+{
+    // keeps the capacity, the queue is refilled every frame
+    m_packets.clear();
+    m_static_packets.clear();
+    m_materials.clear();
+    m_transforms.clear();
+    m_skin_transforms.clear();
+    m_bounds.clear();
+    m_lod_chains.clear();
+    m_vertex_decodes.clear();
+    m_instances.clear();
+}
+
+bool RenderQueue::isEmpty() const
+{
+    return m_packets.empty() && m_static_packets.empty();
+}
+
+const std::vector<DrawPacket>& RenderQueue::getPackets() const
+{
+    return m_packets;
+}
+
+const std::vector<StaticDrawPacket>& RenderQueue::getStaticPackets() const
+{
+    return m_static_packets;
+}
+
+const DrawMaterial& RenderQueue::getMaterial(const u32& index) const
+{
+    return m_materials[index];
+}
+
+u32 RenderQueue::getMaterialCount() const
+{
+    return u32(m_materials.size());
+}
+
+const DrawTransform& RenderQueue::getTransform(const u32& index) const
+{
+    return m_transforms[index];
+}
+
+const VertexDecode& RenderQueue::getVertexDecode(const u32& index) const
+{
+    return m_vertex_decodes[index];
+}
+
+const Matrix4* RenderQueue::getSkinTransforms(const u32& offset) const
+{
+    return m_skin_transforms.data() + offset;
+}
+
+u32 RenderQueue::getSkinTransformCount() const
+{
+    return u32(m_skin_transforms.size());
+}
+
+const std::vector<DrawInstance>& RenderQueue::getInstances() const
+{
+    return m_instances;
+}
+
+u64 RenderQueue::makeSortKey(const DrawPacket& packet, const DrawMaterial& material)
+{
+    u64 key = u64(packet.pass) << kPassShift;
+    key |= (u64(packet.program) & kProgramMask) << kProgramShift;
+
+    // the shadow pass only writes depth, materials do not matter there
+    if(packet.pass != RenderPass::Shadow)
+    {
+        key |= textureKey(material.diffuse_texture) << kDiffuseTextureShift;
+        key |= textureKey(material.specular_texture) << kSpecularTextureShift;
+        key |= hashMaterialUniforms(material) << kMaterialShift;
+    }
+
+    key |= u64(packet.vertex_array) & kVertexArrayMask;
+    return key;
+}
+
+} // namespace sputnik::graphics::gl
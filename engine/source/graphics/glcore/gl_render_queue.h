@@ -0,0 +1,307 @@
+#pragma once
+
+#include "core/core.h"
+#include "graphics/core/geometry/bounds.h"
+#include "graphics/core/geometry/mesh_lod.h"
+#include "gl_vertex_array.h"
+
+#include <vector.hpp>
+#include <matrix.hpp>
+#include <matrix4.h>
+
+#include <span>
+#include <vector>
+
+namespace sputnik::graphics::gl
+{
+
+using namespace ramanujan;
+using namespace ramanujan::experimental;
+using sputnik::graphics::core::BoundingBox;
+using sputnik::graphics::core::Frustum;
+using sputnik::graphics::core::kMaxMeshLods;
+using sputnik::graphics::core::LodSettings;
+using sputnik::graphics::core::MeshLod;
+
+class OglTexture2D;
+
+/*!
+ * @brief Passes of the render queue, in the order they are submitted.
+ */
+enum class RenderPass : u8
+{
+    Shadow = 0,
+    Opaque
+};
+
+/*!
+ * @brief Shader programs a draw packet can be submitted with. The renderer maps these to its shader programs.
+ */
+enum class DrawProgram : u8
+{
+    ShadowPass = 0,
+    ShadowPassPvp,
+    BlinnPhong,
+    BlinnPhongPvp,
+    BlinnPhongSkinned,
+    BlinnPhongInstanced,
+    ShadowPassInstanced,
+    Count
+};
+
+/*!
+ * @brief Visibility bits of a draw. Bit i is set while the draw is inside shadow cascade i, kVisibleInView while it is
+ * inside the view frustum of the camera.
+ */
+constexpr u8 kVisibleInView     = 1u << 7;
+constexpr u8 kVisibleEverywhere = 0xff;
+
+inline u8 cascadeVisibilityBit(const u32& cascade)
+{
+    return u8(1u << cascade);
+}
+
+/*!
+ * @brief The part of a material that is uploaded per draw. Textures are not owned, they must outlive the frame.
+ */
+struct DrawMaterial
+{
+    vec3                diffuse{1.0f, 1.0f, 1.0f};
+    vec3                specular{1.0f, 1.0f, 1.0f};
+    float               shininess{32.0f};
+    const OglTexture2D* diffuse_texture{nullptr};
+    const OglTexture2D* specular_texture{nullptr};
+
+    /*!
+     * @brief Compares the uniform values only, the textures are tracked separately during submission.
+     */
+    bool hasSameUniforms(const DrawMaterial& other) const;
+};
+
+struct DrawTransform
+{
+    mat4 model;
+    mat4 normal_matrix;
+};
+
+/*!
+ * @brief Per instance data of an instanced draw. Matches the InstanceData struct of instance_data.glsl (std430).
+ */
+struct DrawInstance
+{
+    mat4 model;
+    mat4 normal_matrix;
+    vec4 color;
+};
+
+/*!
+ * @brief The levels of detail of an indexed draw. bounds are the object space bounds the distance to the camera is
+ * measured to, the bind pose bounds for skinned meshes. history holds the level the draw was drawn with last, it is
+ * owned by the drawing code and updated when the frame is submitted, nullptr selects the level without hysteresis.
+ */
+struct DrawLods
+{
+    std::span<const MeshLod> lods;
+    BoundingBox              bounds;
+    u8*                      history{nullptr};
+};
+
+/*!
+ * @brief The levels of detail of a recorded draw, shared by its packets so that its shadow is drawn with the same
+ * level as the draw itself.
+ */
+struct DrawLodChain
+{
+    MeshLod     lods[kMaxMeshLods];
+    u32         lod_count{0};
+    u32         selected{0};
+    float       scale{1.0f}; // object to world scale of the errors
+    BoundingBox world_bounds;
+    u8*         history{nullptr};
+};
+
+/*!
+ * @brief A single recorded draw. Everything it needs is referenced by index or by GL name, so a packet is cheap to
+ * sort and to copy.
+ */
+struct DrawPacket
+{
+    u64         sort_key{0};
+    u32         vertex_array{0};   // GL name of the vertex array captured at record time
+    u32         storage_buffer{0}; // shader storage buffer at binding 0, read by the pvp programs
+    u32         material_index{0};
+    u32         transform_index{0};
+    u32         skin_offset{0};
+    u32         skin_count{0};
+    u32         element_count{0};
+    u32         first_index{0}; // of indexed draws, in indices
+    u32         instance_count{0};
+    u32         instance_offset{0}; // first instance in the instance buffer of the frame
+    u32         bounds_index{~0u}; // world space bounds, RenderQueue::kInvalidIndex for draws that are never culled
+    u32         lod_index{~0u};    // level of detail chain, RenderQueue::kInvalidIndex for draws with a single level
+    u32         decode_index{~0u}; // vertex decode, RenderQueue::kInvalidIndex for full precision vertex arrays
+    u8          visibility{kVisibleEverywhere};
+    DrawProgram program{DrawProgram::BlinnPhong};
+    RenderPass  pass{RenderPass::Opaque};
+    bool        indexed{false};
+    IndexType   index_type{IndexType::UnsignedInt};
+};
+
+/*!
+ * @brief A draw of a mesh of the static geometry. These are not submitted one by one, the renderer batches all of them
+ * into multi draw indirect calls.
+ */
+struct StaticDrawPacket
+{
+    u64 sort_key{0};
+    u32 mesh_id{0};
+    u32 material_index{0};
+    u32 transform_index{0};
+    u32 bounds_index{~0u};
+    u8  visibility{kVisibleEverywhere};
+};
+
+/*!
+ * @brief Per frame submission counters of the render queue.
+ */
+struct RenderQueueStats
+{
+    u32 packets{0};
+    u32 program_binds{0};
+    u32 vertex_array_binds{0};
+    u32 texture_binds{0};
+    u32 material_uploads{0};
+    u32 static_draws{0};
+    u32 multi_draw_calls{0};
+    u32 culled_draws{0};
+    u32 instanced_draws{0};
+    u32 merged_draws{0};      // draws folded into instanced draws by the render queue
+    u32 reduced_lod_draws{0}; // draws drawn with a coarser level of detail than their full mesh
+    u32 recording_threads{0};
+    u32 debug_primitives{0};
+};
+
+/*!
+ * @brief Collects the draws of a frame so they can be submitted in one go, sorted to minimize state changes.
+ *
+ * @details The 64 bit sort key is laid out from the most to the least significant bits as
+ * pass (2) | program (4) | diffuse texture (12) | specular texture (12) | material (16) | vertex array (18).
+ * The texture and vertex array fields hold the low bits of the GL names and the material field a hash of the
+ * uniform values, so collisions only cost a redundant bind, submission always compares the actual state.
+ *
+ * A queue does not touch GL and is not synchronized, every recording thread fills its own queue and the queues are
+ * merged with append() before submission.
+ */
+class RenderQueue
+{
+public:
+    static constexpr u32 kInvalidIndex = ~0u;
+
+    RenderQueue() = default;
+
+    u32 addMaterial(const DrawMaterial& material);
+    u32 addTransform(const mat4& model);
+    u32 addSkinTransforms(const std::vector<Matrix4>& skin_transformations);
+    u32 addBounds(const BoundingBox& world_bounds);
+
+    /*!
+     * @brief Adds the levels of detail of a draw with the given model matrix, the packets that share them reference
+     * the returned index.
+     */
+    u32 addLods(const DrawLods& lods, const mat4& model);
+
+    /*!
+     * @brief Adds the decode of a vertex array with packed streams, the packets that draw it reference the returned
+     * index.
+     */
+    u32 addVertexDecode(const VertexDecode& decode);
+
+    /*!
+     * @brief Adds the instances of an instanced draw and returns the offset of the first one. colors is either empty
+     * (every instance is white) or holds one color per model.
+     */
+    u32 addInstances(const std::span<const mat4>& models, const std::span<const vec4>& colors);
+
+    /*!
+     * @brief Records a packet, its sort key is computed from the packet and its material.
+     */
+    void push(DrawPacket packet);
+
+    /*!
+     * @brief Records a draw of the static geometry, keyed by its textures and material only.
+     */
+    void pushStatic(StaticDrawPacket packet);
+
+    /*!
+     * @brief Sorts the recorded packets by their keys.
+     */
+    void sort();
+
+    /*!
+     * @brief Moves the packets and data of other into this queue, the indices of its packets are offset accordingly.
+     * Both queues must be sorted, the merged packets stay sorted. other is left empty.
+     */
+    void append(RenderQueue& other);
+
+    /*!
+     * @brief Tests the packets that have bounds against the view frustum (opaque pass) or the frusta of the shadow
+     * cascades (shadow pass), updates their visibility bits and drops the packets that are not visible at all.
+     *
+     * @return Number of dropped packets.
+     */
+    u32 cull(const Frustum& view_frustum, const Frustum* cascade_frusta, const u32& cascade_count);
+
+    /*!
+     * @brief Selects the level of detail of every draw that has several (see core::selectLod()) and points its
+     * packets to the index range of the level. projection_scale is the size in pixels of an object of unit size at a
+     * distance of one unit. Must run before mergeInstances(), only draws of the same level are merged. The history of
+     * the draws is only read, storeLodHistory() writes the selected levels back.
+     *
+     * @return Number of opaque draws that are drawn with a coarser level than their full mesh.
+     */
+    u32 selectLods(const vec3& camera_position, const float& projection_scale, const LodSettings& settings);
+
+    /*!
+     * @brief Writes the levels picked by selectLods() to the history of the draws. Queues can share a history, so this
+     * must not run in parallel with another queue's selectLods() or storeLodHistory().
+     */
+    void storeLodHistory();
+
+    /*!
+     * @brief Folds the runs of draws that only differ in their transform (same vertex array, index range, program
+     * and material) into single instanced draws. The packets must be sorted, they are sorted again afterwards.
+     * Skinned and pvp draws are never merged. A merged shadow draw is drawn into every cascade any of its draws was
+     * visible in.
+     *
+     * @return Number of draws that were folded into instanced draws.
+     */
+    u32 mergeInstances();
+
+    void clear();
+    bool isEmpty() const;
+
+    const std::vector<DrawPacket>&       getPackets() const;
+    const std::vector<StaticDrawPacket>& getStaticPackets() const;
+    const DrawMaterial&                  getMaterial(const u32& index) const;
+    u32                                  getMaterialCount() const;
+    const DrawTransform&                 getTransform(const u32& index) const;
+    const VertexDecode&                  getVertexDecode(const u32& index) const;
+    const Matrix4*                       getSkinTransforms(const u32& offset) const;
+    u32                                  getSkinTransformCount() const;
+    const std::vector<DrawInstance>&     getInstances() const;
+
+    static u64 makeSortKey(const DrawPacket& packet, const DrawMaterial& material);
+
+private:
+    std::vector<DrawPacket>       m_packets;
+    std::vector<StaticDrawPacket> m_static_packets;
+    std::vector<DrawMaterial>     m_materials;
+    std::vector<DrawTransform>    m_transforms;
+    std::vector<Matrix4>          m_skin_transforms;
+    std::vector<BoundingBox>      m_bounds;
+    std::vector<DrawLodChain>     m_lod_chains;
+    std::vector<VertexDecode>     m_vertex_decodes;
+    std::vector<DrawInstance>     m_instances;
+};
+
+} // namespace sputnik::graphics::gl
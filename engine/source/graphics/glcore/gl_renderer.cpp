@@ -3,12 +3,20 @@
 #include "editor/editor_camera.h"
 #include "graphics/glcore/gl_shader.h"
 #include "graphics/glcore/gl_buffer.h"
+#include "graphics/core/geometry/mesh.h"
 
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 
 #include <imgui.h>
 
+#include <algorithm>
+#include <cmath>
+#include <atomic>
+#include <cstring>
+#include <execution>
+#include <ranges>
+
 namespace sputnik::graphics::gl
 {
 
@@ -117,71 +125,63 @@ OglRenderer::OglRenderer(GLFWwindow* const window)
 
     // #endif // DEBUG
 
-    m_per_frame_gpu_buffer = std::make_shared<OglBuffer>(sizeof(PerFrameData));
-    m_per_frame_gpu_buffer->bind(BufferBindTarget::UniformBuffer, kPerFrameDataBindingPoint); // bind to binding point 0
-
-    m_light_gpu_buffer = std::make_shared<OglBuffer>(sizeof(Light));
-    m_light_gpu_buffer->bind(BufferBindTarget::UniformBuffer, kLightDataBindingPoint); // bind to binding point 1
+    // the programs below are configured back to back and only waited for when their uniforms are first looked up, so
+    // the driver compiles them concurrently
+    OglShaderProgram::initializeParallelCompilation((void* (*)(const char*))glfwGetProcAddress);
 
-    m_shadow_pass_buffer = std::make_shared<OglBuffer>(sizeof(ShadowPassBuffer));
-    m_shadow_pass_buffer->bind(BufferBindTarget::UniformBuffer,
-                               kShadowPassBufferBindingPoint); // bind to binding point 2
+    // the uniform blocks of the frame (binding points 0, 1 and 2) are bound out of the ring buffer in render()
+    m_frame_ring_buffer = std::make_unique<OglRingBuffer>(kFrameRingBufferBytes);
+    m_gpu_profiler      = std::make_unique<OglGpuProfiler>();
 
     m_vao = std::make_unique<OglVertexArray>();
 
-    m_sky_program = std::make_shared<OglShaderProgram>();
-    m_sky_program->setName("sky_program");
-    m_sky_program->addShaderStage("../../data/shaders/sky-rendering/sky.vert");
-    m_sky_program->addShaderStage("../../data/shaders/sky-rendering/sky.frag");
-    m_sky_program->configure();
-
-    m_grid_program = std::make_shared<OglShaderProgram>();
-    m_grid_program->setName("grid_program");
-    m_grid_program->addShaderStage("../../data/shaders/glsl/grid.vert");
-    m_grid_program->addShaderStage("../../data/shaders/glsl/grid.frag");
-    m_grid_program->configure();
-
-    m_shadow_pass_program = std::make_shared<OglShaderProgram>();
-    m_shadow_pass_program->setName("shadow_pass_program");
-    m_shadow_pass_program->addShaderStage("../../data/shaders/glsl/shadow_pass.vert");
-    m_shadow_pass_program->addShaderStage("../../data/shaders/glsl/shadow_pass.frag");
-    m_shadow_pass_program->configure();
-
-    m_shadow_pass_pvp_program = std::make_shared<OglShaderProgram>();
-    m_shadow_pass_pvp_program->setName("shadow_pass_pvp_program");
-    m_shadow_pass_pvp_program->addShaderStage("../../data/shaders/glsl/shadow_pass_pvp.vert");
-    m_shadow_pass_pvp_program->addShaderStage("../../data/shaders/glsl/shadow_pass.frag");
-    m_shadow_pass_pvp_program->configure();
-
-    m_blinn_phong_program = std::make_shared<OglShaderProgram>();
-    m_blinn_phong_program->setName("blinn_phong_program");
-    m_blinn_phong_program->addShaderStage("../../data/shaders/glsl/blinn_phong.vert");
-    m_blinn_phong_program->addShaderStage("../../data/shaders/glsl/blinn_phong.frag");
-    m_blinn_phong_program->configure();
-
-    m_blinn_phong_skinned_program = std::make_shared<OglShaderProgram>();
-    m_blinn_phong_skinned_program->setName("blinn_phong_skinned_program");
-    m_blinn_phong_skinned_program->addShaderStage("../../data/shaders/glsl/skinned.vert");
-    m_blinn_phong_skinned_program->addShaderStage("../../data/shaders/glsl/blinn_phong.frag");
-    m_blinn_phong_skinned_program->configure();
-
-    m_blinn_phong_pvp_program = std::make_shared<OglShaderProgram>();
-    m_blinn_phong_pvp_program->setName("blinn_phong_pvp_program");
-    m_blinn_phong_pvp_program->addShaderStage("../../data/shaders/glsl/blinn_phong_pvp.vert");
-    m_blinn_phong_pvp_program->addShaderStage("../../data/shaders/glsl/blinn_phong.frag");
-    m_blinn_phong_pvp_program->configure();
-
-    m_blinn_phong_instanced_program = std::make_shared<OglShaderProgram>();
-    m_blinn_phong_instanced_program->setName("blinn_phong_instanced_program");
-    m_blinn_phong_instanced_program->addShaderStage("../../data/shaders/glsl/blinn_phong_instanced.vert");
-    m_blinn_phong_instanced_program->addShaderStage("../../data/shaders/glsl/blinn_phong_instanced.frag");
-    m_blinn_phong_instanced_program->configure();
-
-    m_debug_draw_program = std::make_shared<OglShaderProgram>();
-    m_debug_draw_program->setName("debug_draw_program");
-    m_debug_draw_program->addShaderStage("../../data/shaders/glsl/debug_draw.vert");
-    m_debug_draw_program->addShaderStage("../../data/shaders/glsl/debug_draw.frag");
-    m_debug_draw_program->configure();
+    const std::string glsl = "../../data/shaders/glsl/";
+    const std::string sky  = "../../data/shaders/sky-rendering/";
+    m_shader_library       = std::make_unique<OglShaderLibrary>();
+
+    m_sky_program = m_shader_library->load("sky_program", {sky + "sky.vert", sky + "sky.frag"});
+
+    m_grid_program = m_shader_library->load("grid_program", {glsl + "grid.vert", glsl + "grid.frag"});
+
+    m_shadow_pass_program = m_shader_library->load("shadow_pass_program",
+                                                   {glsl + "shadow_pass.vert", glsl + "shadow_pass.frag"});
+
+    m_shadow_pass_pvp_program = m_shader_library->load("shadow_pass_pvp_program",
+                                                       {glsl + "shadow_pass_pvp.vert", glsl + "shadow_pass.frag"});
+
+    m_blinn_phong_program = m_shader_library->load("blinn_phong_program",
+                                                   {glsl + "blinn_phong.vert", glsl + "blinn_phong.frag"});
+
+    m_blinn_phong_skinned_program = m_shader_library->load("blinn_phong_skinned_program",
+                                                           {glsl + "skinned.vert", glsl + "blinn_phong.frag"});
+
+    m_blinn_phong_pvp_program = m_shader_library->load("blinn_phong_pvp_program",
+                                                       {glsl + "blinn_phong_pvp.vert", glsl + "blinn_phong.frag"});
+
+    m_blinn_phong_instanced_program =
+        m_shader_library->load("blinn_phong_instanced_program",
+                               {glsl + "blinn_phong_instanced.vert", glsl + "blinn_phong_instanced.frag"});
+
+    m_debug_draw_program = m_shader_library->load("debug_draw_program",
+                                                  {glsl + "debug_draw.vert", glsl + "debug_draw.frag"});
+
+    m_shadow_pass_indirect_program =
+        m_shader_library->load("shadow_pass_indirect_program",
+                               {glsl + "shadow_pass_indirect.vert", glsl + "shadow_pass.frag"});
+
+    m_blinn_phong_indirect_program =
+        m_shader_library->load("blinn_phong_indirect_program",
+                               {glsl + "blinn_phong_indirect.vert", glsl + "blinn_phong_indirect.frag"});
+
+    m_shadow_pass_instanced_program =
+        m_shader_library->load("shadow_pass_instanced_program",
+                               {glsl + "shadow_pass_instanced.vert", glsl + "shadow_pass.frag"});
+
+    resolveUniformLocations();
+#ifdef SPUTNIK_DEBUG
+    // the watcher thread is only worth its cost while iterating on shaders, release builds enable it from the UI
+    m_shader_library->setHotReloadEnabled(true);
+#endif // SPUTNIK_DEBUG
 
     m_light_direction = vec3(0.0f, sin(m_sun_angle), cos(m_sun_angle)).normalized();
 
@@ -218,8 +218,8 @@ OglRenderer::OglRenderer(GLFWwindow* const window)
             FramebufferAttachmentSpecification depth_attachment_spec;
             depth_attachment_spec.attachment_format = TextureFormat::Depth32F;
             framebuffer_spec.attachments            = {depth_attachment_spec};
-            framebuffer_spec.width                  = 1024;
-            framebuffer_spec.height                 = 1024;
+            framebuffer_spec.width                  = 2 * kShadowCascadeResolution; // 2x2 cascade atlas
+            framebuffer_spec.height                 = 2 * kShadowCascadeResolution;
             m_shadow_pass_framebuffer               = std::make_shared<OglFramebuffer>(framebuffer_spec);
         }
     }
@@ -265,28 +265,39 @@ void OglRenderer::render(const mat4& projection, const mat4& view, const vec3& c
     // render grid
     // render scene geometry
 
+    // shaders edited since the last frame are swapped in before anything is drawn with them
+    m_shader_library->update();
+    if(m_shader_library->getReloadCount() != m_shader_reload_count)
+    {
+        m_shader_reload_count = m_shader_library->getReloadCount();
+        resolveUniformLocations();
+    }
+
+    // the frame starts here, waits if the GPU is still reading the ring buffer region of this frame
+    m_frame_ring_buffer->beginFrame();
+    m_gpu_profiler->beginFrame();
+
     // update per frame gpu buffer
     m_per_frame_data.projection      = projection;
     m_per_frame_data.view            = view;
     m_per_frame_data.camera_position = camera_position;
-    m_per_frame_gpu_buffer->setData(&m_per_frame_data, sizeof(PerFrameData));
+    m_frame_ring_buffer->bind(BufferBindTarget::UniformBuffer,
+                              kPerFrameDataBindingPoint,
+                              m_frame_ring_buffer->upload(&m_per_frame_data, sizeof(PerFrameData)));
 
     // update shadow pass buffer
-    // m_shadow_pass_data.light_direction = {m_light_direction.x,
-    //                                      m_light_direction.y,
-    //                                      m_light_direction.z}; // not used right now in shader
-    // m_shadow_pass_data.light_position  = {light.position.x, light.position.y, light.position.z};
-    m_shadow_pass_data.light_projection =
-        glm::perspective(glm::radians(45.0f), 1024.0f / 1024.0f, 0.1f, 1000.0f); // Todo:: use light projection matrix
-    m_shadow_pass_data.light_view = glm::lookAt({light.position.x, light.position.y, light.position.z},
-                                                glm::vec3(0.0f),
-                                                glm::vec3(0.0f, 1.0f, 0.0f)); // Todo:: use light view matrix
-    m_shadow_pass_buffer->setData((void*)&m_shadow_pass_data, sizeof(ShadowPassBuffer));
-
-    // mat4::lookAt(light.position, light.position + m_light_direction, vec3(0.0f, 1.0f, 0.0f));
+    updateShadowCascades(projection, view, light);
+    m_frame_ring_buffer->bind(BufferBindTarget::UniformBuffer,
+                              kShadowPassBufferBindingPoint,
+                              m_frame_ring_buffer->upload(&m_shadow_pass_data, sizeof(ShadowPassBuffer)));
+    updateCullingFrusta();
+    m_lod_projection_scale =
+        projection.m[5] * 0.5f * (float)m_viewport_framebuffer->getSpecification().height; // cot(fov / 2) * height / 2
 
     // update light gpu buffer
-    m_light_gpu_buffer->setData((void*)&light, sizeof(Light));
+    m_frame_ring_buffer->bind(BufferBindTarget::UniformBuffer,
+                              kLightDataBindingPoint,
+                              m_frame_ring_buffer->upload(&light, sizeof(Light)));
 
     renderAtmosphericScattering(projection, view); // sky
                                                    // renderAtmosphericScattering(); // sky
@@ -298,10 +309,108 @@ void OglRenderer::render(const mat4& projection, const mat4& view, const vec3& c
     // Todo:: render scene geometry with indirect draw calls
 }
 
+void OglRenderer::updateShadowCascades(const mat4& projection, const mat4& view, const Light& light)
+{
+    const glm::mat4 camera_projection = glm::make_mat4(projection.m);
+    const glm::mat4 camera_view       = glm::make_mat4(view.m);
+
+    // The light is treated as directional for shadowing, shining from its position towards the origin.
+    const glm::vec3 light_position{light.position.x, light.position.y, light.position.z};
+    const glm::vec3 light_direction =
+        glm::length(light_position) > 0.0f ? -glm::normalize(light_position) : glm::vec3(0.0f, -1.0f, 0.0f);
+    const glm::vec3 light_up =
+        std::abs(light_direction.y) > 0.99f ? glm::vec3(0.0f, 0.0f, 1.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+    const glm::mat4 light_view = glm::lookAt(glm::vec3(0.0f), light_direction, light_up);
+
+    // near and far planes of the camera, recovered from its perspective projection
+    const float near_plane   = camera_projection[3][2] / (camera_projection[2][2] - 1.0f);
+    const float far_plane    = camera_projection[3][2] / (camera_projection[2][2] + 1.0f);
+    const float shadow_range = std::min(far_plane, kShadowDistance) - near_plane;
+
+    // corners of the camera frustum in world space, the near corners followed by the far corners
+    const glm::mat4 inv_view_projection = glm::inverse(camera_projection * camera_view);
+    glm::vec3       frustum_corners[8];
+    for(u32 i = 0; i < 8; ++i)
+    {
+        const glm::vec4 corner = inv_view_projection * glm::vec4(i & 1 ? 1.0f : -1.0f,
+                                                                 i & 2 ? 1.0f : -1.0f,
+                                                                 i & 4 ? 1.0f : -1.0f,
+                                                                 1.0f);
+        frustum_corners[i]     = glm::vec3(corner) / corner.w;
+    }
+
+    float cascade_near = near_plane;
+    for(u32 cascade = 0; cascade < kShadowCascadeCount; ++cascade)
+    {
+        // practical split scheme, a blend of the logarithmic and the uniform split
+        const float fraction     = float(cascade + 1) / float(kShadowCascadeCount);
+        const float log_split    = near_plane * std::pow((near_plane + shadow_range) / near_plane, fraction);
+        const float linear_split = near_plane + shadow_range * fraction;
+        const float cascade_far  = glm::mix(linear_split, log_split, kShadowCascadeSplitLambda);
+
+        // slice of the camera frustum covered by the cascade, view space depth is linear along the corner rays
+        glm::vec3 center{0.0f};
+        glm::vec3 slice_corners[8];
+        const float t_near = (cascade_near - near_plane) / (far_plane - near_plane);
+        const float t_far  = (cascade_far - near_plane) / (far_plane - near_plane);
+        for(u32 i = 0; i < 4; ++i)
+        {
+            const glm::vec3 ray  = frustum_corners[i + 4] - frustum_corners[i];
+            slice_corners[i]     = frustum_corners[i] + ray * t_near;
+            slice_corners[i + 4] = frustum_corners[i] + ray * t_far;
+            center += slice_corners[i] + slice_corners[i + 4];
+        }
+        center /= 8.0f;
+
+        // A bounding sphere keeps the size of the cascade constant while the camera rotates, snapping its center to
+        // whole shadow map texels keeps the shadow edges from shimmering while the camera moves.
+        float radius = 0.0f;
+        for(const glm::vec3& corner : slice_corners)
+        {
+            radius = std::max(radius, glm::length(corner - center));
+        }
+        radius = std::ceil(radius * 16.0f) / 16.0f;
+
+        const float texel_size   = 2.0f * radius / float(kShadowCascadeResolution);
+        glm::vec3   light_center = glm::vec3(light_view * glm::vec4(center, 1.0f));
+        light_center.x           = std::floor(light_center.x / texel_size) * texel_size;
+        light_center.y           = std::floor(light_center.y / texel_size) * texel_size;
+
+        const glm::mat4 light_projection = glm::ortho(light_center.x - radius,
+                                                      light_center.x + radius,
+                                                      light_center.y - radius,
+                                                      light_center.y + radius,
+                                                      -light_center.z - radius - kShadowCasterDistance,
+                                                      -light_center.z + radius);
+
+        m_shadow_pass_data.light_view_projections[cascade] = light_projection * light_view;
+        m_shadow_pass_data.cascade_splits[cascade]         = cascade_far;
+        cascade_near                                       = cascade_far;
+    }
+
+    // third row of the view matrix, negated since the camera looks down -z
+    m_shadow_pass_data.camera_depth_axis =
+        -glm::vec4(camera_view[0][2], camera_view[1][2], camera_view[2][2], camera_view[3][2]);
+    m_shadow_pass_data.light_direction = glm::vec4(light_direction, 0.0f);
+}
+
+void OglRenderer::updateCullingFrusta()
+{
+    const glm::mat4 view_projection =
+        glm::make_mat4(m_per_frame_data.projection.m) * glm::make_mat4(m_per_frame_data.view.m);
+    m_view_frustum = Frustum::fromMatrix(glm::value_ptr(view_projection));
+    for(u32 cascade = 0; cascade < kShadowCascadeCount; ++cascade)
+    {
+        m_cascade_frusta[cascade] =
+            Frustum::fromMatrix(glm::value_ptr(m_shadow_pass_data.light_view_projections[cascade]), false);
+    }
+}
+
 void OglRenderer::initializeRenderingState() {}
 
 void OglRenderer::lateUpdate(const core::TimeStep& timestep, GLFWwindow* const window)
 {
+    m_frame_ring_buffer->endFrame();
     glfwSwapBuffers(window);
 }
 
@@ -323,6 +432,8 @@ void OglRenderer::setClearColor(float r, float g, float b, float a)
 
 void OglRenderer::renderAtmosphericScattering(const mat4& projection, const mat4& view)
 {
+    OglGpuScope profile_scope(*m_gpu_profiler, "Sky");
+
     m_viewport_framebuffer->bind();
     m_vao->bind();
 
@@ -451,6 +562,8 @@ void OglRenderer::renderAtmosphericScattering()
 
 void OglRenderer::renderEditorGrid()
 {
+    OglGpuScope profile_scope(*m_gpu_profiler, "Grid");
+
     m_viewport_framebuffer->bind();
     m_vao->bind();
     m_grid_program->bind();
@@ -467,383 +580,949 @@ void OglRenderer::renderEditorGrid()
     m_viewport_framebuffer->unbind();
 }
 
-void OglRenderer::drawTriangles(const u64& vertex_count, const Material& material, const mat4& model)
+void OglRenderer::drawTriangles(const u64&         vertex_count,
+                                const Material&    material,
+                                const mat4&        model,
+                                const BoundingBox& bounds)
 {
+    u32 vertex_array   = 0;
+    u32 storage_buffer = 0;
+    captureBoundVertexData(material, vertex_array, storage_buffer);
+    recordDraw(getThreadRenderQueue(),
+               vertex_array,
+               storage_buffer,
+               vertex_count,
+               false,
+               IndexType::UnsignedInt,
+               material,
+               model,
+               nullptr,
+               &bounds);
+}
 
-    auto active_program = m_blinn_phong_program;
-    if(material.shader_name == "blinn_phong_pvp")
+void OglRenderer::drawTrianglesIndexed(const OglVertexArray& vertex_array,
+                                       const u64&            index_count,
+                                       const Material&       material,
+                                       const mat4&           model,
+                                       const BoundingBox&    bounds)
+{
+    submitTriangles(vertex_array, index_count, true, material, model, bounds);
+}
+
+void OglRenderer::drawTrianglesIndexed(const OglVertexArray&       vertex_array,
+                                       const u64&                  index_count,
+                                       const Material&             material,
+                                       const mat4&                 model,
+                                       const std::vector<Matrix4>& skin_transformations)
+{
+    // the bind pose bounds do not hold once the mesh is animated, skinned draws are never culled
+    submitTriangles(vertex_array, index_count, material, model, skin_transformations);
+}
+
+void OglRenderer::drawTrianglesInstanced(const u64&                   vertex_count,
+                                         const Material&              material,
+                                         const std::span<const mat4>& models,
+                                         const std::span<const vec4>& colors)
+{
+    if(!models.empty())
+    {
+        // callers bind the vertex array of their mesh before issuing the draw
+        GLint vertex_array = 0;
+        glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &vertex_array);
+        recordInstancedDraw(getThreadRenderQueue(),
+                            (u32)vertex_array,
+                            vertex_count,
+                            false,
+                            IndexType::UnsignedInt,
+                            material,
+                            models,
+                            colors);
+    }
+}
+
+void OglRenderer::drawTrianglesIndexedInstanced(const OglVertexArray&        vertex_array,
+                                                const u64&                   index_count,
+                                                const Material&              material,
+                                                const std::span<const mat4>& models,
+                                                const std::span<const vec4>& colors)
+{
+    submitTrianglesInstanced(vertex_array, index_count, true, material, models, colors);
+}
+
+void OglRenderer::submitTriangles(const OglVertexArray& vertex_array,
+                                  const u64&            element_count,
+                                  const bool&           indexed,
+                                  const Material&       material,
+                                  const mat4&           model,
+                                  const BoundingBox&    bounds,
+                                  const DrawLods&       lods)
+{
+    SPUTNIK_ASSERT(material.shader_name != "blinn_phong_pvp",
+                   "Vertex pulling draws must be recorded on the GL thread.");
+    recordDraw(getThreadRenderQueue(),
+               vertex_array.getId(),
+               0,
+               element_count,
+               indexed,
+               vertex_array.getIndexType(),
+               material,
+               model,
+               nullptr,
+               &bounds,
+               &lods,
+               &vertex_array.getVertexDecode());
+}
+
+void OglRenderer::submitTriangles(const OglVertexArray&       vertex_array,
+                                  const u64&                  index_count,
+                                  const Material&             material,
+                                  const mat4&                 model,
+                                  const std::vector<Matrix4>& skin_transformations,
+                                  const DrawLods&             lods)
+{
+    SPUTNIK_ASSERT(material.shader_name != "blinn_phong_pvp",
+                   "Vertex pulling draws must be recorded on the GL thread.");
+    recordDraw(getThreadRenderQueue(),
+               vertex_array.getId(),
+               0,
+               index_count,
+               true,
+               vertex_array.getIndexType(),
+               material,
+               model,
+               &skin_transformations,
+               nullptr,
+               &lods,
+               &vertex_array.getVertexDecode());
+}
+
+void OglRenderer::submitTrianglesInstanced(const OglVertexArray&        vertex_array,
+                                           const u64&                   element_count,
+                                           const bool&                  indexed,
+                                           const Material&              material,
+                                           const std::span<const mat4>& models,
+                                           const std::span<const vec4>& colors)
+{
+    if(!models.empty())
+    {
+        recordInstancedDraw(getThreadRenderQueue(),
+                            vertex_array.getId(),
+                            element_count,
+                            indexed,
+                            vertex_array.getIndexType(),
+                            material,
+                            models,
+                            colors,
+                            &vertex_array.getVertexDecode());
+    }
+}
+
+RenderQueue& OglRenderer::getThreadRenderQueue()
+{
+    // The lock is only taken the first time a thread records a draw. The registry keeps the queue alive after the
+    // thread has exited, until its draws have been submitted.
+    thread_local std::shared_ptr<RenderQueue> thread_render_queue;
+    if(!thread_render_queue)
     {
-        m_vao->bind();
-        active_program = m_blinn_phong_pvp_program;
+        thread_render_queue = std::make_shared<RenderQueue>();
+        std::lock_guard<std::mutex> lock(m_thread_render_queues_mutex);
+        m_thread_render_queues.push_back(thread_render_queue);
+    }
+    return *thread_render_queue;
+}
 
-        // active_program->setInt("shadow_map", 2);
-        // m_shadow_pass_framebuffer->bindDepthAttachmentTexture(2);
+// offset of the first index of an indexed draw, in the form glDrawElements* expects it
+static const void* getIndexOffset(const DrawPacket& packet)
+{
+    const u64 index_bytes = packet.index_type == IndexType::UnsignedShort ? sizeof(u16) : sizeof(u32);
+    return (const void*)(uintptr_t)(packet.first_index * index_bytes);
+}
 
-        // shadow pass
-        glEnable(GL_DEPTH_TEST);
-        m_shadow_pass_pvp_program->bind();
-        m_shadow_pass_pvp_program->setMat4("model", model);
-        m_shadow_pass_framebuffer->bind();
-        // m_shadow_pass_framebuffer->clear({1.0f, 0.0f, 0.0f, 1.0f});
+// decode of the vertex arrays with full precision streams
+static const VertexDecode kFullPrecisionDecode;
 
-        glDrawArrays(GL_TRIANGLES, 0, (GLsizei)vertex_count);
+static DrawMaterial toDrawMaterial(const Material& material)
+{
+    DrawMaterial draw_material;
+    draw_material.diffuse          = material.diffuse;
+    draw_material.specular         = material.specular;
+    draw_material.shininess        = material.shininess;
+    draw_material.diffuse_texture  = material.diff_texture.get();
+    draw_material.specular_texture = material.spec_texture.get();
+    return draw_material;
+}
 
-        m_shadow_pass_framebuffer->unbind();
-        m_shadow_pass_pvp_program->unbind();
-        glDisable(GL_DEPTH_TEST);
+void OglRenderer::captureBoundVertexData(const Material& material, u32& vertex_array, u32& storage_buffer) const
+{
+    if(material.shader_name == "blinn_phong_pvp")
+    {
+        // vertices are pulled from the storage buffer at binding 0, the vertex array is only a placeholder
+        GLint buffer = 0;
+        glGetIntegeri_v(GL_SHADER_STORAGE_BUFFER_BINDING, 0, &buffer);
+        vertex_array   = m_vao->getId();
+        storage_buffer = (u32)buffer;
     }
     else
     {
-        // shadow pass
-        glEnable(GL_DEPTH_TEST);
-        m_shadow_pass_program->bind();
-        m_shadow_pass_program->setMat4("model", model);
-        m_shadow_pass_framebuffer->bind();
-        // m_shadow_pass_framebuffer->clear({1.0f, 0.0f, 0.0f, 1.0f});
-
-        glDrawArrays(GL_TRIANGLES, 0, (GLsizei)vertex_count);
-
-        m_shadow_pass_framebuffer->unbind();
-        m_shadow_pass_program->unbind();
-        glDisable(GL_DEPTH_TEST);
+        // callers bind the vertex array of their mesh before issuing the draw
+        GLint array = 0;
+        glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &array);
+        vertex_array   = (u32)array;
+        storage_buffer = 0;
     }
+}
 
-    m_viewport_framebuffer->bind();
-    glEnable(GL_DEPTH_TEST);
+void OglRenderer::recordDraw(RenderQueue&                queue,
+                             const u32&                  vertex_array,
+                             const u32&                  storage_buffer,
+                             const u64&                  element_count,
+                             const bool&                 indexed,
+                             const IndexType&            index_type,
+                             const Material&             material,
+                             const mat4&                 model,
+                             const std::vector<Matrix4>* skin_transformations,
+                             const BoundingBox*          bounds,
+                             const DrawLods*             lods,
+                             const VertexDecode*         decode)
+{
+    DrawPacket packet;
+    packet.vertex_array    = vertex_array;
+    packet.storage_buffer  = storage_buffer;
+    packet.element_count   = (u32)element_count;
+    packet.indexed         = indexed;
+    packet.index_type      = index_type;
+    packet.material_index  = queue.addMaterial(toDrawMaterial(material));
+    packet.transform_index = queue.addTransform(model);
+    if(bounds && bounds->isValid())
     {
-        mat4 normal_matrix = model;
-        normal_matrix      = normal_matrix.inverted().transpose(); // (Transpose of inverse of the model matrix)
-
-        active_program->bind();
-        active_program->setMat4("model", model);
-        active_program->setMat4("normal_matrix", normal_matrix);
-        // m_blinn_phong_program->setFloat3("material.ambient", material.ambient);
-        active_program->setFloat3("material.diffuse", material.diffuse);
-        active_program->setFloat3("material.specular", material.specular);
-        active_program->setFloat("material.shininess", material.shininess);
-
-        active_program->setInt("shadow_map", 2);
-        m_shadow_pass_framebuffer->bindDepthAttachmentTexture(2);
-        if(material.diff_texture)
-        {
-            active_program->setInt("material.diffuse_texture", 0);
-            material.diff_texture->bind(0);
-        }
-        else
-        {
-            active_program->setInt("material.diffuse_texture", 0);
-            m_white_texture->bind(0);
-        }
-        if(material.spec_texture)
-        {
-            active_program->setInt("material.specular_texture", 1);
-            material.spec_texture->bind(1);
-        }
-        else
-        {
-            active_program->setInt("material.specular_texture", 1);
-            m_white_texture->bind(1);
-        }
+        packet.bounds_index = queue.addBounds(bounds->transformed(model));
+    }
+    if(skin_transformations && !skin_transformations->empty())
+    {
+        packet.skin_offset = queue.addSkinTransforms(*skin_transformations);
+        packet.skin_count  = (u32)skin_transformations->size();
+    }
+    if(indexed && lods && lods->lods.size() > 1)
+    {
+        packet.lod_index = queue.addLods(*lods, model);
+    }
+    if(decode && !decode->isIdentity())
+    {
+        packet.decode_index = queue.addVertexDecode(*decode);
+    }
 
-        glDrawArrays(GL_TRIANGLES, 0, (GLsizei)vertex_count);
-        if(material.shader_name == "blinn_phong_pvp")
-        {
-            m_vao->unbind();
-        }
+    const bool is_pvp = material.shader_name == "blinn_phong_pvp";
 
-        active_program->unbind();
+    if(is_pvp)
+    {
+        packet.program = DrawProgram::BlinnPhongPvp;
     }
-    glDisable(GL_DEPTH_TEST);
-    m_viewport_framebuffer->unbind();
+    else if(indexed && material.shader_name == "m_blinn_phong_skinned")
+    {
+        packet.program = DrawProgram::BlinnPhongSkinned;
+    }
+    else
+    {
+        packet.program = DrawProgram::BlinnPhong;
+    }
+    queue.push(packet);
+
+    DrawPacket shadow_packet = packet;
+    shadow_packet.pass       = RenderPass::Shadow;
+    shadow_packet.program    = is_pvp ? DrawProgram::ShadowPassPvp : DrawProgram::ShadowPass;
+    shadow_packet.skin_count = 0;
+    queue.push(shadow_packet);
 }
 
-void OglRenderer::drawTrianglesIndexed(const u64& index_count, const Material& material, const mat4& model)
+void OglRenderer::recordInstancedDraw(RenderQueue&                 queue,
+                                      const u32&                   vertex_array,
+                                      const u64&                   element_count,
+                                      const bool&                  indexed,
+                                      const IndexType&             index_type,
+                                      const Material&              material,
+                                      const std::span<const mat4>& models,
+                                      const std::span<const vec4>& colors,
+                                      const VertexDecode*          decode)
 {
-    // shadow pass
+    // the instances are read from the instance buffer of the frame
+    DrawPacket packet;
+    packet.vertex_array    = vertex_array;
+    packet.element_count   = (u32)element_count;
+    packet.indexed         = indexed;
+    packet.index_type      = index_type;
+    packet.material_index  = queue.addMaterial(toDrawMaterial(material));
+    packet.transform_index = RenderQueue::kInvalidIndex;
+    packet.instance_offset = queue.addInstances(models, colors);
+    packet.instance_count  = (u32)models.size();
+    packet.program         = DrawProgram::BlinnPhongInstanced;
+    if(decode && !decode->isIdentity())
     {
-        glEnable(GL_DEPTH_TEST);
-        glCullFace(GL_FRONT);
-        m_shadow_pass_program->bind();
-        m_shadow_pass_program->setMat4("model", model);
-        m_shadow_pass_framebuffer->bind();
-        // m_shadow_pass_framebuffer->clear({1.0f, 0.0f, 0.0f, 1.0f});
-
-        glDrawElements(GL_TRIANGLES, (GLsizei)index_count, GL_UNSIGNED_INT, 0);
-
-        m_shadow_pass_framebuffer->unbind();
-        m_shadow_pass_program->unbind();
-        glCullFace(GL_BACK);
-        glDisable(GL_DEPTH_TEST);
+        packet.decode_index = queue.addVertexDecode(*decode);
     }
+    queue.push(packet);
 
-    // render pass
+    DrawPacket shadow_packet = packet;
+    shadow_packet.pass       = RenderPass::Shadow;
+    shadow_packet.program    = DrawProgram::ShadowPassInstanced;
+    queue.push(shadow_packet);
+}
 
-    m_viewport_framebuffer->bind();
-    // m_viewport_framebuffer->clear({1.0f, 0.0f, 0.0f, 1.0f});
-    auto& active_program = m_blinn_phong_program;
-    if(material.shader_name == "blinn_phong_pvp")
+u32 OglRenderer::addStaticMesh(const std::vector<ramanujan::Vector3>& positions,
+                               const std::vector<ramanujan::Vector3>& normals,
+                               const std::vector<ramanujan::Vector2>& uvs,
+                               const std::vector<u32>&                indices)
+{
+    return m_static_geometry.addMesh(positions, normals, uvs, indices);
+}
+
+void OglRenderer::drawStaticMesh(const u32& mesh_id, const Material& material, const mat4& model)
+{
+    SPUTNIK_ASSERT(mesh_id < m_static_geometry.getMeshCount(), "Unknown static mesh: {}", mesh_id);
+
+    const BoundingBox& bounds = m_static_geometry.getMesh(mesh_id).bounds;
+
+    RenderQueue&     queue = getThreadRenderQueue();
+    StaticDrawPacket packet;
+    packet.mesh_id         = mesh_id;
+    packet.material_index  = queue.addMaterial(toDrawMaterial(material));
+    packet.transform_index = queue.addTransform(model);
+    packet.bounds_index    = queue.addBounds(bounds.transformed(model));
+    queue.pushStatic(packet);
+}
+
+u32 OglRenderer::addStaticInstance(const u32& mesh_id, const Material& material, const mat4& model)
+{
+    SPUTNIK_ASSERT(mesh_id < m_static_geometry.getMeshCount(), "Unknown static mesh: {}", mesh_id);
+
+    u32 instance_id = (u32)m_static_instances.size();
+    if(m_free_static_instances.empty())
     {
-        m_vao->bind();
-        active_program = m_blinn_phong_pvp_program;
+        m_static_instances.push_back({});
     }
-    else if(material.shader_name == "m_blinn_phong_skinned")
+    else
     {
-        active_program = m_blinn_phong_skinned_program;
+        instance_id = m_free_static_instances.back();
+        m_free_static_instances.pop_back();
     }
 
-    glEnable(GL_DEPTH_TEST);
-    {
-        mat4 normal_matrix = model;
-        normal_matrix      = normal_matrix.inverted().transpose(); // (Transpose of inverse of the model matrix)
+    const BoundingBox& bounds   = m_static_geometry.getMesh(mesh_id).bounds;
+    StaticInstance&    instance = m_static_instances[instance_id];
+    instance.mesh_id            = mesh_id;
+    instance.material           = material;
+    instance.model              = model;
+    instance.proxy              = m_static_instance_bvh.insert(bounds.transformed(model), instance_id);
+    return instance_id;
+}
+
+void OglRenderer::setStaticInstanceTransform(const u32& instance_id, const mat4& model)
+{
+    SPUTNIK_ASSERT(instance_id < m_static_instances.size() &&
+                       m_static_instances[instance_id].proxy != DynamicBvh::kNullNode,
+                   "Unknown static instance: {}",
+                   instance_id);
+
+    StaticInstance&    instance = m_static_instances[instance_id];
+    const BoundingBox& bounds   = m_static_geometry.getMesh(instance.mesh_id).bounds;
+    instance.model              = model;
+    m_static_instance_bvh.update(instance.proxy, bounds.transformed(model));
+}
+
+void OglRenderer::removeStaticInstance(const u32& instance_id)
+{
+    SPUTNIK_ASSERT(instance_id < m_static_instances.size() &&
+                       m_static_instances[instance_id].proxy != DynamicBvh::kNullNode,
+                   "Unknown static instance: {}",
+                   instance_id);
+
+    m_static_instance_bvh.remove(m_static_instances[instance_id].proxy);
+    m_static_instances[instance_id] = {};
+    m_free_static_instances.push_back(instance_id);
+}
 
-        active_program->bind();
-        active_program->setMat4("model", model);
-        active_program->setMat4("normal_matrix", normal_matrix);
-        // m_blinn_phong_program->setFloat3("material.ambient", material.ambient);
-        active_program->setFloat3("material.diffuse", material.diffuse);
-        active_program->setFloat3("material.specular", material.specular);
-        active_program->setFloat("material.shininess", material.shininess);
+void OglRenderer::cullStaticInstances()
+{
+    SPUTNIK_PROFILE_FUNCTION();
 
-        active_program->setInt("shadow_map", 2);
-        m_shadow_pass_framebuffer->bindDepthAttachmentTexture(2);
+    m_static_instance_visibility.assign(m_static_instances.size(), 0);
 
-        if(material.diff_texture)
-        {
-            active_program->setInt("material.diffuse_texture", 0);
-            material.diff_texture->bind(0);
-        }
-        else
+    const auto mark_visible = [this](const Frustum& frustum, const u8& visibility_bit)
+    {
+        m_static_instance_query.clear();
+        m_static_instance_bvh.query(frustum, m_static_instance_query);
+        for(const u32& instance_id : m_static_instance_query)
         {
-            active_program->setInt("material.diffuse_texture", 0);
-            m_white_texture->bind(0);
+            m_static_instance_visibility[instance_id] |= visibility_bit;
         }
-        if(material.spec_texture)
+    };
+
+    if(!m_frustum_culling)
+    {
+        mark_visible(Frustum(), kVisibleEverywhere);
+        return;
+    }
+
+    mark_visible(m_view_frustum, kVisibleInView);
+    for(u32 cascade = 0; cascade < kShadowCascadeCount; ++cascade)
+    {
+        mark_visible(m_cascade_frusta[cascade], cascadeVisibilityBit(cascade));
+    }
+}
+
+u32 OglRenderer::pushVisibleStaticInstances()
+{
+    u32 culled_instances = 0;
+    for(u32 instance_id = 0; instance_id < (u32)m_static_instance_visibility.size(); ++instance_id)
+    {
+        const StaticInstance& instance = m_static_instances[instance_id];
+        if(instance.proxy == DynamicBvh::kNullNode)
         {
-            active_program->setInt("material.specular_texture", 1);
-            material.spec_texture->bind(1);
+            continue;
         }
+        if(m_static_instance_visibility[instance_id] == 0)
         {
-            active_program->setInt("material.specular_texture", 1);
-            m_white_texture->bind(1);
+            ++culled_instances;
+            continue;
         }
 
-        glDrawElements(GL_TRIANGLES, (GLsizei)index_count, GL_UNSIGNED_INT, 0);
-        if(material.shader_name == "blinn_phong_pvp")
-        {
-            m_vao->unbind();
-        }
+        StaticDrawPacket packet;
+        packet.mesh_id         = instance.mesh_id;
+        packet.material_index  = m_static_instance_queue.addMaterial(toDrawMaterial(instance.material));
+        packet.transform_index = m_static_instance_queue.addTransform(instance.model);
+        packet.visibility      = m_static_instance_visibility[instance_id];
+        m_static_instance_queue.pushStatic(packet);
+    }
+    return culled_instances;
+}
 
-        active_program->unbind();
+void OglRenderer::mergeThreadRenderQueues()
+{
+    SPUTNIK_PROFILE_FUNCTION();
+
+    // The queues of the recording threads are culled and sorted in parallel, the hierarchy of the static instances is
+    // culled as one more task of the same loop. All of them only read the frusta and the level of detail history of
+    // the frame, every task writes to its own queue.
+    std::lock_guard<std::mutex>  lock(m_thread_render_queues_mutex);
+    const u32                    queue_count           = (u32)m_thread_render_queues.size();
+    const bool                   cull_static_instances = m_static_instance_bvh.getLeafCount() > 0;
+    const std::ranges::iota_view tasks(0u, queue_count + (cull_static_instances ? 1u : 0u));
+    std::atomic<u32>             culled_draws{0};
+    std::atomic<u32>             reduced_lod_draws{0};
+    std::for_each(std::execution::par,
+                  tasks.begin(),
+                  tasks.end(),
+                  [&](const u32& task)
+                  {
+                      if(task == queue_count)
+                      {
+                          SPUTNIK_PROFILE_SCOPE("Cull static instances");
+                          cullStaticInstances();
+                          culled_draws += pushVisibleStaticInstances();
+                          m_static_instance_queue.sort();
+                          return;
+                      }
+
+                      SPUTNIK_PROFILE_SCOPE("Cull and sort render queue");
+                      RenderQueue& queue = *m_thread_render_queues[task];
+                      reduced_lod_draws +=
+                          queue.selectLods(m_per_frame_data.camera_position, m_lod_projection_scale, m_lod_settings);
+                      if(m_frustum_culling)
+                      {
+                          culled_draws += queue.cull(m_view_frustum, m_cascade_frusta, kShadowCascadeCount);
+                      }
+                      queue.sort();
+                  });
+
+    // The sorted queues are merged on this thread, merging keeps the packets sorted. Draws of different queues can
+    // share a level of detail history, so the selected levels are written back here rather than in the parallel loop.
+    m_render_queue_stats.recording_threads = 0;
+    for(const std::shared_ptr<RenderQueue>& queue : m_thread_render_queues)
+    {
+        m_render_queue_stats.recording_threads += queue->isEmpty() ? 0 : 1;
+        queue->storeLodHistory();
+        m_render_queue.append(*queue);
     }
-    glDisable(GL_DEPTH_TEST);
-    m_viewport_framebuffer->unbind();
+    if(cull_static_instances)
+    {
+        m_render_queue.append(m_static_instance_queue);
+    }
+    m_render_queue_stats.culled_draws      = culled_draws;
+    m_render_queue_stats.reduced_lod_draws = reduced_lod_draws;
+
+    // the queues of threads that have exited are only referenced by the registry
+    std::erase_if(m_thread_render_queues,
+                  [](const std::shared_ptr<RenderQueue>& queue) { return queue.use_count() == 1; });
 }
 
-void OglRenderer::drawTrianglesIndexed(const u64&                  index_count,
-                                       const Material&             material,
-                                       const mat4&                 model,
-                                       const std::vector<Matrix4>& skin_transformations)
+void OglRenderer::flush()
 {
+    SPUTNIK_PROFILE_FUNCTION();
+
+    m_render_queue_stats = {};
+    mergeThreadRenderQueues();
+    if(m_render_queue.isEmpty())
+    {
+        renderDebugPass();
+        return;
+    }
 
-    // shadow pass
+    if(m_automatic_instancing)
     {
-        glEnable(GL_DEPTH_TEST);
-        m_shadow_pass_program->bind();
-        m_shadow_pass_framebuffer->bind();
-        // m_shadow_pass_framebuffer->clear({1.0f, 0.0f, 0.0f, 1.0f});
+        SPUTNIK_PROFILE_SCOPE("Merge instances");
+        m_render_queue_stats.merged_draws = m_render_queue.mergeInstances();
+    }
+
+    // The frame is a fixed sequence of passes over the sorted queue. All the shadow casters are rendered into every
+    // cascade of the shadow atlas first, the opaque pass then samples the complete atlas.
+    const std::vector<DrawPacket>& packets          = m_render_queue.getPackets();
+    const auto                     is_shadow_packet = [](const DrawPacket& packet)
+    { return packet.pass == RenderPass::Shadow; };
+    const auto first_opaque_packet = std::partition_point(packets.begin(), packets.end(), is_shadow_packet);
+
+    const std::span<const DrawPacket> shadow_packets(packets.begin(), first_opaque_packet);
+    const std::span<const DrawPacket> opaque_packets(first_opaque_packet, packets.end());
+
+    prepareMaterials();
+    prepareStaticDraws();
+
+    // the skinning palettes of all the skinned draws, the draws index it with their skin offset
+    const u64 skin_transform_bytes = m_render_queue.getSkinTransformCount() * sizeof(Matrix4);
+    m_frame_ring_buffer->bind(BufferBindTarget::ShaderStorageBuffer,
+                              kSkinTransformsBindingPoint,
+                              m_frame_ring_buffer->upload(m_render_queue.getSkinTransforms(0), skin_transform_bytes));
 
-        glDrawElements(GL_TRIANGLES, (GLsizei)index_count, GL_UNSIGNED_INT, 0);
+    // the instances of the explicitly instanced and the merged draws, the draws index it with their instance offset
+    const std::vector<DrawInstance>& instances = m_render_queue.getInstances();
+    m_frame_ring_buffer->bind(BufferBindTarget::ShaderStorageBuffer,
+                              kInstanceDataBindingPoint,
+                              m_frame_ring_buffer->upload(instances.data(), instances.size() * sizeof(DrawInstance)));
+
+    glEnable(GL_DEPTH_TEST);
+    renderShadowPass(shadow_packets);
+    renderOpaquePass(opaque_packets);
+    glDisable(GL_DEPTH_TEST);
+    renderDebugPass();
+
+    m_render_queue.clear();
+}
 
-        m_shadow_pass_framebuffer->unbind();
-        m_shadow_pass_program->unbind();
-        glDisable(GL_DEPTH_TEST);
+void OglRenderer::renderShadowPass(const std::span<const DrawPacket>& packets)
+{
+    if(packets.empty() && m_static_commands.empty())
+    {
+        return;
     }
 
-    auto active_program = m_blinn_phong_program;
-    if(material.shader_name == "blinn_phong_pvp")
+    OglGpuScope profile_scope(*m_gpu_profiler, "Shadow pass");
+
+    m_shadow_pass_framebuffer->bind();
+    glCullFace(GL_FRONT);
+    // casters in front of the near plane of a cascade are clamped to it instead of being clipped
+    glEnable(GL_DEPTH_CLAMP);
+    for(u32 cascade = 0; cascade < kShadowCascadeCount; ++cascade)
     {
-        m_vao->bind();
-        active_program = m_blinn_phong_pvp_program;
+        glViewport((cascade % 2) * kShadowCascadeResolution,
+                   (cascade / 2) * kShadowCascadeResolution,
+                   kShadowCascadeResolution,
+                   kShadowCascadeResolution);
+        submitPackets(packets, cascade);
+        submitStaticDraws(RenderPass::Shadow, cascade);
     }
-    else if(material.shader_name == "m_blinn_phong_skinned")
+    glDisable(GL_DEPTH_CLAMP);
+    glCullFace(GL_BACK);
+    m_shadow_pass_framebuffer->unbind();
+}
+
+void OglRenderer::renderOpaquePass(const std::span<const DrawPacket>& packets)
+{
+    if(packets.empty() && m_static_commands.empty())
     {
-        active_program = m_blinn_phong_skinned_program;
+        return;
     }
 
+    OglGpuScope profile_scope(*m_gpu_profiler, "Opaque pass");
+
     m_viewport_framebuffer->bind();
-    glEnable(GL_DEPTH_TEST);
+    m_shadow_pass_framebuffer->bindDepthAttachmentTexture(2);
+    submitPackets(packets, 0);
+    submitStaticDraws(RenderPass::Opaque, 0);
+    m_viewport_framebuffer->unbind();
+}
+
+void OglRenderer::submitPackets(const std::span<const DrawPacket>& packets, const u32& cascade)
+{
+    // Last bound state, anything equal to it is not bound again. The packets are sorted so that the expensive changes
+    // (program, textures) happen as rarely as possible.
+    constexpr u32 kUnbound               = RenderQueue::kInvalidIndex;
+    DrawProgram   current_program        = DrawProgram::Count;
+    u32           current_vertex_array   = kUnbound;
+    u32           current_storage_buffer = kUnbound;
+    u32           current_textures[2]    = {kUnbound, kUnbound};
+    u32           current_material       = kUnbound;
+    u32           current_decode         = kUnbound;
+    bool          decode_bound           = false; // kUnbound is also the index of the full precision decode
+
+    for(const DrawPacket& packet : packets)
     {
-        mat4 normal_matrix = model;
-        normal_matrix      = normal_matrix.inverted().transpose(); // (Transpose of inverse of the model matrix)
-
-        active_program->bind();
-        active_program->setMat4("model", model);
-        active_program->setMat4("normal_matrix", normal_matrix);
-        active_program->setMat4s("skin_transforms", skin_transformations);
-        // m_blinn_phong_program->setFloat3("material.ambient", material.ambient);
-        active_program->setFloat3("material.diffuse", material.diffuse);
-        active_program->setFloat3("material.specular", material.specular);
-        active_program->setFloat("material.shininess", material.shininess);
-
-        active_program->setInt("shadow_map", 2);
-        m_shadow_pass_framebuffer->bindDepthAttachmentTexture(2);
-
-        if(material.diff_texture)
+        // shadow packets are only drawn into the cascades they are visible in
+        const u8 visibility_bit = packet.pass == RenderPass::Shadow ? cascadeVisibilityBit(cascade) : kVisibleInView;
+        if((packet.visibility & visibility_bit) == 0)
         {
-            active_program->setInt("material.diffuse_texture", 0);
-            material.diff_texture->bind(0);
+            continue;
         }
-        else
+
+        const std::shared_ptr<OglShaderProgram>& program  = getDrawProgram(packet.program);
+        const DrawProgramUniforms&               uniforms = m_draw_program_uniforms[(u32)packet.program];
+        if(packet.program != current_program)
         {
-            active_program->setInt("material.diffuse_texture", 0);
-            m_white_texture->bind(0);
+            // the samplers have fixed units in the shaders, only the cascade is set per program
+            program->bind();
+            if(packet.pass == RenderPass::Shadow)
+            {
+                program->setInt(uniforms.cascade_index, (int)cascade);
+            }
+            current_program  = packet.program;
+            current_material = kUnbound;
+            decode_bound     = false;
+            ++m_render_queue_stats.program_binds;
         }
-        if(material.spec_texture)
+
+        // the decode uniforms default to zero, every program gets them with its first draw
+        if(!decode_bound || packet.decode_index != current_decode)
         {
-            active_program->setInt("material.specular_texture", 1);
-            material.spec_texture->bind(1);
+            const VertexDecode& decode = packet.decode_index == RenderQueue::kInvalidIndex
+                                             ? kFullPrecisionDecode
+                                             : m_render_queue.getVertexDecode(packet.decode_index);
+            program->setFloat3(uniforms.position_scale, decode.position_scale);
+            program->setFloat3(uniforms.position_offset, decode.position_offset);
+            program->setInt(uniforms.octahedral_normals, decode.octahedral_normals ? 1 : 0);
+            current_decode = packet.decode_index;
+            decode_bound   = true;
         }
+
+        if(packet.vertex_array != current_vertex_array)
         {
-            active_program->setInt("material.specular_texture", 1);
-            m_white_texture->bind(1);
+            glBindVertexArray(packet.vertex_array);
+            current_vertex_array = packet.vertex_array;
+            ++m_render_queue_stats.vertex_array_binds;
         }
 
-        glDrawElements(GL_TRIANGLES, (GLsizei)index_count, GL_UNSIGNED_INT, 0);
-        if(material.shader_name == "blinn_phong_pvp")
+        if((packet.program == DrawProgram::BlinnPhongPvp || packet.program == DrawProgram::ShadowPassPvp) &&
+           packet.storage_buffer != current_storage_buffer)
         {
-            m_vao->unbind();
+            glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, packet.storage_buffer);
+            current_storage_buffer = packet.storage_buffer;
         }
 
-        active_program->unbind();
-    }
-    glDisable(GL_DEPTH_TEST);
-    m_viewport_framebuffer->unbind();
-}
+        if(packet.pass == RenderPass::Opaque)
+        {
+            const DrawMaterial& material = m_render_queue.getMaterial(packet.material_index);
+
+            const OglTexture2D* textures[2] = {
+                material.diffuse_texture ? material.diffuse_texture : m_white_texture.get(),
+                material.specular_texture ? material.specular_texture : m_white_texture.get()};
+            for(u32 slot = 0; slot < 2; ++slot)
+            {
+                if(textures[slot]->getId() != current_textures[slot])
+                {
+                    textures[slot]->bind(slot);
+                    current_textures[slot] = textures[slot]->getId();
+                    ++m_render_queue_stats.texture_binds;
+                }
+            }
+
+            // the parameters live in the material buffer, only the slot changes
+            const u32 material_slot = m_material_slots[packet.material_index];
+            if(material_slot != current_material)
+            {
+                program->setUint(uniforms.material_index, material_slot);
+                current_material = material_slot;
+                ++m_render_queue_stats.material_uploads;
+            }
+        }
 
-void OglRenderer::drawTrianglesInstanced(const u64& vertex_count, const u64& instance_count, const Material& material)
-{
-    auto active_program = m_blinn_phong_instanced_program;
-    // if(material.shader_name == "blinn_phong_pvp")
-    //{
-    //     m_vao->bind();
-    //     active_program = m_blinn_phong_pvp_program;
-    // }
-    // else if(material.shader_name == "blinn_phong_instanced")
-    //{
-    //     active_program = m_blinn_phong_instanced_program;
-    // }
+        if(packet.transform_index != RenderQueue::kInvalidIndex)
+        {
+            const DrawTransform& transform = m_render_queue.getTransform(packet.transform_index);
+            program->setMat4(uniforms.model, transform.model);
+            if(packet.pass == RenderPass::Opaque)
+            {
+                program->setMat4(uniforms.normal_matrix, transform.normal_matrix);
+            }
+        }
 
-    m_viewport_framebuffer->bind();
-    glEnable(GL_DEPTH_TEST);
-    {
-        // mat4 normal_matrix = model;
-        // normal_matrix      = normal_matrix.inverted().transpose(); // (Transpose of inverse of the model matrix)
-
-        active_program->bind();
-        // active_program->setMat4("model", model);
-        // active_program->setMat4("normal_matrix", normal_matrix);
-        //  m_blinn_phong_program->setFloat3("material.ambient", material.ambient);
-        active_program->setFloat3("material.diffuse", material.diffuse);
-        active_program->setFloat3("material.specular", material.specular);
-        active_program->setFloat("material.shininess", material.shininess);
-        if(material.diff_texture)
+        if(packet.skin_count > 0)
         {
-            active_program->setInt("material.diffuse_texture", 0);
-            material.diff_texture->bind(0);
+            program->setUint(uniforms.skin_offset, packet.skin_offset);
         }
-        else
+
+        if(packet.instance_count > 0)
         {
-            active_program->setInt("material.diffuse_texture", 0);
-            m_white_texture->bind(0);
+            program->setUint(uniforms.instance_offset, packet.instance_offset);
+            ++m_render_queue_stats.instanced_draws;
+            if(packet.indexed)
+            {
+                glDrawElementsInstanced(GL_TRIANGLES,
+                                        (GLsizei)packet.element_count,
+                                        indexTypeToGLEnum(packet.index_type),
+                                        getIndexOffset(packet),
+                                        (GLsizei)packet.instance_count);
+            }
+            else
+            {
+                glDrawArraysInstanced(GL_TRIANGLES, 0, (GLsizei)packet.element_count, (GLsizei)packet.instance_count);
+            }
         }
-        if(material.spec_texture)
+        else if(packet.indexed)
         {
-            active_program->setInt("material.specular_texture", 1);
-            material.spec_texture->bind(1);
+            glDrawElements(GL_TRIANGLES,
+                           (GLsizei)packet.element_count,
+                           indexTypeToGLEnum(packet.index_type),
+                           getIndexOffset(packet));
         }
+        else
         {
-            active_program->setInt("material.specular_texture", 1);
-            m_white_texture->bind(1);
+            glDrawArrays(GL_TRIANGLES, 0, (GLsizei)packet.element_count);
         }
+        ++m_render_queue_stats.packets;
+    }
 
-        glDrawArraysInstanced(GL_TRIANGLES, 0, (GLsizei)vertex_count, (GLsizei)instance_count);
+    glBindVertexArray(0);
+    glUseProgram(0);
+}
+
+void OglRenderer::prepareStaticDraws()
+{
+    SPUTNIK_PROFILE_FUNCTION();
 
-        active_program->unbind();
+    m_static_commands.clear();
+    m_static_batches.clear();
+
+    const std::vector<StaticDrawPacket>& packets = m_render_queue.getStaticPackets();
+    if(packets.empty())
+    {
+        return;
     }
-    glDisable(GL_DEPTH_TEST);
-    m_viewport_framebuffer->unbind();
+
+    m_static_geometry.upload();
+
+    // Every packet gets one entry of per draw data, the base instance of a command is the index of that entry. The
+    // commands of the opaque pass come first: the packets are sorted by textures, every run of packets with the same
+    // textures becomes one batch. They are followed by the commands of every shadow cascade, only the packets that are
+    // visible in the pass get a command.
+    for(const StaticDrawPacket& packet : packets)
+    {
+        const DrawMaterial&    material = m_render_queue.getMaterial(packet.material_index);
+        const StaticMeshRange& mesh     = m_static_geometry.getMesh(packet.mesh_id);
+        if(packet.visibility & kVisibleInView)
+        {
+            if(m_static_batches.empty() || material.diffuse_texture != m_static_batches.back().diffuse_texture ||
+               material.specular_texture != m_static_batches.back().specular_texture)
+            {
+                m_static_batches.push_back(
+                    {(u32)m_static_commands.size(), 0, material.diffuse_texture, material.specular_texture});
+            }
+            ++m_static_batches.back().command_count;
+            const u32 draw = u32(&packet - packets.data());
+            m_static_commands.push_back({mesh.index_count, 1, mesh.first_index, mesh.base_vertex, draw});
+        }
+    }
+
+    for(u32 cascade = 0; cascade < kShadowCascadeCount; ++cascade)
+    {
+        StaticShadowRange& range = m_static_shadow_ranges[cascade];
+        range.first_command      = (u32)m_static_commands.size();
+        for(u32 draw = 0; draw < (u32)packets.size(); ++draw)
+        {
+            if(packets[draw].visibility & cascadeVisibilityBit(cascade))
+            {
+                const StaticMeshRange& mesh = m_static_geometry.getMesh(packets[draw].mesh_id);
+                m_static_commands.push_back({mesh.index_count, 1, mesh.first_index, mesh.base_vertex, draw});
+            }
+        }
+        range.command_count = (u32)m_static_commands.size() - range.first_command;
+    }
+
+    m_static_command_allocation = m_frame_ring_buffer->upload(
+        m_static_commands.data(), m_static_commands.size() * sizeof(DrawElementsIndirectCommand));
+
+    // The per draw data is written straight into the mapped ring buffer, without a staging copy. Every packet owns its
+    // entry, so the entries are filled in parallel.
+    const RingAllocation draw_data_allocation =
+        m_frame_ring_buffer->allocate(packets.size() * sizeof(StaticDrawData));
+    StaticDrawData* draw_data = (StaticDrawData*)draw_data_allocation.data;
+    std::for_each(std::execution::par_unseq,
+                  packets.begin(),
+                  packets.end(),
+                  [&](const StaticDrawPacket& packet)
+                  {
+                      const DrawTransform& transform = m_render_queue.getTransform(packet.transform_index);
+                      StaticDrawData&      entry     = draw_data[&packet - packets.data()];
+                      entry.model                    = transform.model;
+                      entry.normal_matrix            = transform.normal_matrix;
+                      entry.material_index           = m_material_slots[packet.material_index];
+                  });
+    m_frame_ring_buffer->bind(BufferBindTarget::ShaderStorageBuffer, kStaticDrawDataBindingPoint, draw_data_allocation);
+
+    m_render_queue_stats.static_draws = (u32)packets.size();
 }
 
-void OglRenderer::drawTrianglesIndexedInstanced(const u64&      index_count,
-                                                const u64&      instance_count,
-                                                const Material& material)
+void OglRenderer::prepareMaterials()
 {
-    auto active_program = m_blinn_phong_instanced_program;
+    SPUTNIK_PROFILE_FUNCTION();
 
-    m_viewport_framebuffer->bind();
-    glEnable(GL_DEPTH_TEST);
+    m_material_data.clear();
+    m_material_slots.assign(m_render_queue.getMaterialCount(), RenderQueue::kInvalidIndex);
+
+    const DrawMaterial* previous_material = nullptr;
+    const auto          assign_slot       = [&](const u32& material_index)
     {
-        // mat4 normal_matrix = model;
-        // normal_matrix      = normal_matrix.inverted().transpose(); // (Transpose of inverse of the model matrix)
-
-        active_program->bind();
-        // active_program->setMat4("model", model);
-        // active_program->setMat4("normal_matrix", normal_matrix);
-        //  m_blinn_phong_program->setFloat3("material.ambient", material.ambient);
-        active_program->setFloat3("material.diffuse", material.diffuse);
-        active_program->setFloat3("material.specular", material.specular);
-        active_program->setFloat("material.shininess", material.shininess);
-        if(material.diff_texture)
+        const DrawMaterial& material = m_render_queue.getMaterial(material_index);
+        if(!previous_material || !material.hasSameUniforms(*previous_material))
         {
-            active_program->setInt("material.diffuse_texture", 0);
-            material.diff_texture->bind(0);
+            m_material_data.push_back({vec4(material.diffuse.x, material.diffuse.y, material.diffuse.z, 1.0f),
+                                       vec4(material.specular.x,
+                                            material.specular.y,
+                                            material.specular.z,
+                                            material.shininess)});
+            previous_material = &material;
         }
-        else
+        m_material_slots[material_index] = (u32)m_material_data.size() - 1;
+    };
+
+    // the shadow pass does not read materials
+    for(const DrawPacket& packet : m_render_queue.getPackets())
+    {
+        if(packet.pass != RenderPass::Shadow)
         {
-            active_program->setInt("material.diffuse_texture", 0);
-            m_white_texture->bind(0);
+            assign_slot(packet.material_index);
         }
-        if(material.spec_texture)
+    }
+    for(const StaticDrawPacket& packet : m_render_queue.getStaticPackets())
+    {
+        assign_slot(packet.material_index);
+    }
+
+    m_frame_ring_buffer->bind(
+        BufferBindTarget::ShaderStorageBuffer,
+        kMaterialDataBindingPoint,
+        m_frame_ring_buffer->upload(m_material_data.data(), m_material_data.size() * sizeof(MaterialData)));
+}
+
+void OglRenderer::submitStaticDraws(const RenderPass& pass, const u32& cascade)
+{
+    if(m_static_commands.empty())
+    {
+        return;
+    }
+
+    m_static_geometry.getVertexArray().bind();
+    // the commands live in the ring buffer, the indirect offsets are relative to the start of the buffer they were
+    // uploaded to, which is no longer the current one if the ring grew later in the frame
+    const auto commands = [this](const u32& first_command)
+    {
+        return (const void*)(m_static_command_allocation.offset + first_command * sizeof(DrawElementsIndirectCommand));
+    };
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_static_command_allocation.buffer_id);
+
+    if(pass == RenderPass::Shadow)
+    {
+        // depth only, every static draw of the cascade goes into a single call
+        const StaticShadowRange& range = m_static_shadow_ranges[cascade];
+        if(range.command_count > 0)
         {
-            active_program->setInt("material.specular_texture", 1);
-            material.spec_texture->bind(1);
+            m_shadow_pass_indirect_program->bind();
+            m_shadow_pass_indirect_program->setInt(m_shadow_pass_indirect_cascade_index, (int)cascade);
+            glMultiDrawElementsIndirect(GL_TRIANGLES,
+                                        GL_UNSIGNED_INT,
+                                        commands(range.first_command),
+                                        (GLsizei)range.command_count,
+                                        0);
+            ++m_render_queue_stats.multi_draw_calls;
         }
+    }
+    else
+    {
+        m_blinn_phong_indirect_program->bind();
+
+        // without bindless textures every texture set needs its own call
+        for(const StaticBatch& batch : m_static_batches)
         {
-            active_program->setInt("material.specular_texture", 1);
-            m_white_texture->bind(1);
+            (batch.diffuse_texture ? batch.diffuse_texture : m_white_texture.get())->bind(0);
+            (batch.specular_texture ? batch.specular_texture : m_white_texture.get())->bind(1);
+            glMultiDrawElementsIndirect(GL_TRIANGLES,
+                                        GL_UNSIGNED_INT,
+                                        commands(batch.first_command),
+                                        (GLsizei)batch.command_count,
+                                        0);
+            ++m_render_queue_stats.multi_draw_calls;
         }
+    }
 
-        glDrawElementsInstanced(GL_TRIANGLES, (GLsizei)index_count, GL_UNSIGNED_INT, 0, (GLsizei)instance_count);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+    glUseProgram(0);
+    glBindVertexArray(0);
+}
 
-        active_program->unbind();
+const std::shared_ptr<OglShaderProgram>& OglRenderer::getDrawProgram(const DrawProgram& program) const
+{
+    switch(program)
+    {
+    case DrawProgram::ShadowPass:
+        return m_shadow_pass_program;
+    case DrawProgram::ShadowPassPvp:
+        return m_shadow_pass_pvp_program;
+    case DrawProgram::BlinnPhongPvp:
+        return m_blinn_phong_pvp_program;
+    case DrawProgram::BlinnPhongSkinned:
+        return m_blinn_phong_skinned_program;
+    case DrawProgram::BlinnPhongInstanced:
+        return m_blinn_phong_instanced_program;
+    case DrawProgram::ShadowPassInstanced:
+        return m_shadow_pass_instanced_program;
+    case DrawProgram::BlinnPhong:
+    default:
+        return m_blinn_phong_program;
     }
-    glDisable(GL_DEPTH_TEST);
-    m_viewport_framebuffer->unbind();
 }
 
-void OglRenderer::drawDebugLines(const std::vector<vec4>& vertices, const vec3& color, const float& line_width)
+void OglRenderer::resolveUniformLocations()
 {
-    m_viewport_framebuffer->bind();
-    glEnable(GL_DEPTH_TEST);
-    glLineWidth(line_width);
-    glEnable(GL_LINE_SMOOTH);
-    m_vao->bind();
-
-    m_debug_draw_program->bind();
-    m_debug_draw_program->setFloat3("color", color);
-    m_debug_draw_program->setMat4("model", mat4());
+    for(u32 program = 0; program < (u32)DrawProgram::Count; ++program)
+    {
+        const std::shared_ptr<OglShaderProgram>& draw_program = getDrawProgram((DrawProgram)program);
+        DrawProgramUniforms&                     uniforms     = m_draw_program_uniforms[program];
+        if(uniforms.generation == draw_program->getGeneration())
+        {
+            continue;
+        }
+        uniforms.generation         = draw_program->getGeneration();
+        uniforms.model              = draw_program->getUniformLocation("model");
+        uniforms.normal_matrix      = draw_program->getUniformLocation("normal_matrix");
+        uniforms.skin_offset        = draw_program->getUniformLocation("skin_offset");
+        uniforms.cascade_index      = draw_program->getUniformLocation("cascade_index");
+        uniforms.material_index     = draw_program->getUniformLocation("material_index");
+        uniforms.instance_offset    = draw_program->getUniformLocation("instance_offset");
+        uniforms.position_scale     = draw_program->getUniformLocation("position_scale");
+        uniforms.position_offset    = draw_program->getUniformLocation("position_offset");
+        uniforms.octahedral_normals = draw_program->getUniformLocation("octahedral_normals");
+    }
+    m_shadow_pass_indirect_cascade_index = m_shadow_pass_indirect_program->getUniformLocation("cascade_index");
+    m_debug_draw_viewport_size           = m_debug_draw_program->getUniformLocation("viewport_size");
+}
 
-    OglBuffer vbo((void*)vertices.data(), vertices.size() * sizeof(vec4));
-    vbo.bind(BufferBindTarget::ShaderStorageBuffer, 0);
+const RenderQueueStats& OglRenderer::getRenderQueueStats() const
+{
+    return m_render_queue_stats;
+}
 
-    glDrawArrays(GL_LINES, 0, (GLsizei)vertices.size());
+DebugDrawList& OglRenderer::getDebugDraw()
+{
+    return m_debug_draw;
+}
 
-    m_debug_draw_program->unbind();
-    m_vao->unbind();
-    glDisable(GL_LINE_SMOOTH);
-    glLineWidth(1.0f);
-    glDisable(GL_DEPTH_TEST);
-    m_viewport_framebuffer->unbind();
+void OglRenderer::drawDebugLines(const std::vector<vec4>& vertices, const vec3& color, const float& line_width)
+{
+    m_debug_draw.addLines(vertices, color, line_width);
 }
 
 void OglRenderer::drawDebugLines(const std::vector<vec4>& vertices,
@@ -851,27 +1530,7 @@ void OglRenderer::drawDebugLines(const std::vector<vec4>& vertices,
                                  const mat4&              model,
                                  const float&             line_width)
 {
-    m_viewport_framebuffer->bind();
-    glEnable(GL_DEPTH_TEST);
-    glLineWidth(line_width);
-    glEnable(GL_LINE_SMOOTH);
-    m_vao->bind();
-
-    m_debug_draw_program->bind();
-    m_debug_draw_program->setFloat3("color", color);
-    m_debug_draw_program->setMat4("model", model);
-
-    OglBuffer vbo((void*)vertices.data(), vertices.size() * sizeof(vec4));
-    vbo.bind(BufferBindTarget::ShaderStorageBuffer, 0);
-
-    glDrawArrays(GL_LINES, 0, (GLsizei)vertices.size());
-
-    m_debug_draw_program->unbind();
-    m_vao->unbind();
-    glDisable(GL_LINE_SMOOTH);
-    glLineWidth(1.0f);
-    glDisable(GL_DEPTH_TEST);
-    m_viewport_framebuffer->unbind();
+    m_debug_draw.addLines(vertices, color, model, line_width);
 }
 
 void OglRenderer::drawDebugLines(const std::vector<vec4>& vertices,
@@ -879,51 +1538,14 @@ void OglRenderer::drawDebugLines(const std::vector<vec4>& vertices,
                                  const glm::mat4&         model,
                                  const float&             line_width)
 {
-    m_viewport_framebuffer->bind();
-    glEnable(GL_DEPTH_TEST);
-    glLineWidth(line_width);
-    glEnable(GL_LINE_SMOOTH);
-    m_vao->bind();
-
-    m_debug_draw_program->bind();
-    m_debug_draw_program->setFloat3("color", color);
-    m_debug_draw_program->setMat4("model", model);
-
-    OglBuffer vbo((void*)vertices.data(), vertices.size() * sizeof(vec4));
-    vbo.bind(BufferBindTarget::ShaderStorageBuffer, 0);
-
-    glDrawArrays(GL_LINES, 0, (GLsizei)vertices.size());
-
-    m_debug_draw_program->unbind();
-    m_vao->unbind();
-    glDisable(GL_LINE_SMOOTH);
-    glLineWidth(1.0f);
-    glDisable(GL_DEPTH_TEST);
-    m_viewport_framebuffer->unbind();
+    mat4 ramanujan_model;
+    std::memcpy(ramanujan_model.m, glm::value_ptr(model), sizeof(ramanujan_model.m));
+    m_debug_draw.addLines(vertices, color, ramanujan_model, line_width);
 }
 
 void OglRenderer::drawDebugPoints(const std::vector<vec4>& vertices, const vec3& color, const float& point_size)
 {
-    m_viewport_framebuffer->bind();
-    glEnable(GL_DEPTH_TEST);
-    glPointSize(point_size);
-    m_vao->bind();
-
-    m_debug_draw_program->bind();
-    m_debug_draw_program->setFloat3("color", color);
-    m_debug_draw_program->setMat4("model", mat4());
-
-    // https://www.khronos.org/opengl/wiki/Shader_Storage_Buffer_Object
-    OglBuffer vbo((void*)vertices.data(), vertices.size() * sizeof(vec4));
-    vbo.bind(BufferBindTarget::ShaderStorageBuffer, 0);
-
-    glDrawArrays(GL_POINTS, 0, (GLsizei)vertices.size());
-
-    m_debug_draw_program->unbind();
-    m_vao->unbind();
-
-    glDisable(GL_DEPTH_TEST);
-    m_viewport_framebuffer->unbind();
+    m_debug_draw.addPoints(vertices, color, point_size);
 }
 
 void OglRenderer::drawDebugPoints(const std::vector<vec4>& vertices,
@@ -931,26 +1553,7 @@ void OglRenderer::drawDebugPoints(const std::vector<vec4>& vertices,
                                   const mat4&              model,
                                   const float&             point_size)
 {
-    m_viewport_framebuffer->bind();
-    glEnable(GL_DEPTH_TEST);
-    glPointSize(point_size);
-    m_vao->bind();
-
-    m_debug_draw_program->bind();
-    m_debug_draw_program->setFloat3("color", color);
-    m_debug_draw_program->setMat4("model", model);
-
-    // https://www.khronos.org/opengl/wiki/Shader_Storage_Buffer_Object
-    OglBuffer vbo((void*)vertices.data(), vertices.size() * sizeof(vec4));
-    vbo.bind(BufferBindTarget::ShaderStorageBuffer, 0);
-
-    glDrawArrays(GL_POINTS, 0, (GLsizei)vertices.size());
-
-    m_debug_draw_program->unbind();
-    m_vao->unbind();
-
-    glDisable(GL_DEPTH_TEST);
-    m_viewport_framebuffer->unbind();
+    m_debug_draw.addPoints(vertices, color, model, point_size);
 }
 
 void OglRenderer::drawDebugPoints(const std::vector<vec4>& vertices,
@@ -958,24 +1561,39 @@ void OglRenderer::drawDebugPoints(const std::vector<vec4>& vertices,
                                   const glm::mat4&         model,
                                   const float&             point_size)
 {
+    mat4 ramanujan_model;
+    std::memcpy(ramanujan_model.m, glm::value_ptr(model), sizeof(ramanujan_model.m));
+    m_debug_draw.addPoints(vertices, color, ramanujan_model, point_size);
+}
+
+void OglRenderer::renderDebugPass()
+{
+    m_debug_draw.collect(m_debug_primitives);
+    m_render_queue_stats.debug_primitives = (u32)m_debug_primitives.size();
+    if(m_debug_primitives.empty())
+    {
+        return;
+    }
+
+    OglGpuScope                     profile_scope(*m_gpu_profiler, "Debug pass");
+    const FramebufferSpecification& specification = m_viewport_framebuffer->getSpecification();
+
     m_viewport_framebuffer->bind();
     glEnable(GL_DEPTH_TEST);
-    glPointSize(point_size);
     m_vao->bind();
 
-    m_debug_draw_program->bind();
-    m_debug_draw_program->setFloat3("color", color);
-    m_debug_draw_program->setMat4("model", model);
+    m_frame_ring_buffer->bind(
+        BufferBindTarget::ShaderStorageBuffer,
+        kDebugPrimitivesBindingPoint,
+        m_frame_ring_buffer->upload(m_debug_primitives.data(), m_debug_primitives.size() * sizeof(DebugPrimitive)));
 
-    // https://www.khronos.org/opengl/wiki/Shader_Storage_Buffer_Object
-    OglBuffer vbo((void*)vertices.data(), vertices.size() * sizeof(vec4));
-    vbo.bind(BufferBindTarget::ShaderStorageBuffer, 0);
-
-    glDrawArrays(GL_POINTS, 0, (GLsizei)vertices.size());
+    m_debug_draw_program->bind();
+    m_debug_draw_program->setFloat2(m_debug_draw_viewport_size,
+                                    vec2((float)specification.width, (float)specification.height));
+    glDrawArraysInstanced(GL_TRIANGLES, 0, 6, (GLsizei)m_debug_primitives.size());
 
     m_debug_draw_program->unbind();
     m_vao->unbind();
-
     glDisable(GL_DEPTH_TEST);
     m_viewport_framebuffer->unbind();
 }
@@ -992,6 +1610,60 @@ void OglRenderer::drawUI()
         }
         ImGui::End();
     }
+
+    if(ImGui::Begin("Render Queue"))
+    {
+        ImGui::Text("Packets: %u", m_render_queue_stats.packets);
+        ImGui::Text("Program binds: %u", m_render_queue_stats.program_binds);
+        ImGui::Text("Vertex array binds: %u", m_render_queue_stats.vertex_array_binds);
+        ImGui::Text("Texture binds: %u", m_render_queue_stats.texture_binds);
+        ImGui::Text("Material uploads: %u", m_render_queue_stats.material_uploads);
+        ImGui::Text("Static draws: %u", m_render_queue_stats.static_draws);
+        ImGui::Text("Multi draw calls: %u", m_render_queue_stats.multi_draw_calls);
+        ImGui::Separator();
+        ImGui::Checkbox("Frustum culling", &m_frustum_culling);
+        ImGui::Text("Culled draws: %u", m_render_queue_stats.culled_draws);
+        ImGui::Text("Recording threads: %u", m_render_queue_stats.recording_threads);
+        ImGui::Checkbox("Automatic instancing", &m_automatic_instancing);
+        ImGui::Text("Instanced draws: %u (%u draws merged)",
+                    m_render_queue_stats.instanced_draws,
+                    m_render_queue_stats.merged_draws);
+        ImGui::Text("Debug primitives: %u", m_render_queue_stats.debug_primitives);
+        ImGui::Separator();
+        ImGui::Checkbox("Levels of detail", &m_lod_settings.enabled);
+        ImGui::SliderFloat("Max pixel error", &m_lod_settings.max_pixel_error, 0.25f, 16.0f);
+        ImGui::SliderFloat("LOD hysteresis", &m_lod_settings.hysteresis, 0.0f, 0.9f);
+        ImGui::SliderInt("Forced LOD", &m_lod_settings.forced_lod, -1, (int)kMaxMeshLods - 1);
+        ImGui::Text("Reduced LOD draws: %u", m_render_queue_stats.reduced_lod_draws);
+        ImGui::Text("Static instances: %u (hierarchy height %u)",
+                    m_static_instance_bvh.getLeafCount(),
+                    m_static_instance_bvh.getHeight());
+        using sputnik::graphics::core::Mesh;
+        using sputnik::graphics::core::VertexFormat;
+        bool packed_vertices = Mesh::getDefaultVertexFormat() == VertexFormat::Packed;
+        if(ImGui::Checkbox("Packed vertices (meshes loaded from now on)", &packed_vertices))
+        {
+            Mesh::setDefaultVertexFormat(packed_vertices ? VertexFormat::Packed : VertexFormat::Full);
+        }
+        ImGui::Separator();
+        ImGui::Text("Ring buffer: %llu / %llu KiB per frame",
+                    (unsigned long long)(m_frame_ring_buffer->getLastFrameBytes() / 1024),
+                    (unsigned long long)(m_frame_ring_buffer->getFrameCapacity() / 1024));
+        ImGui::Text("Ring buffer waits: %u", m_frame_ring_buffer->getWaitCount());
+        ImGui::Text("Dropped GPU timer samples: %u", m_gpu_profiler->getDroppedSampleCount());
+        ImGui::Separator();
+        bool hot_reload = m_shader_library->isHotReloadEnabled();
+        if(ImGui::Checkbox("Shader hot reload", &hot_reload))
+        {
+            m_shader_library->setHotReloadEnabled(hot_reload);
+        }
+        ImGui::Text("Shader reloads: %u (%u failed)",
+                    m_shader_library->getReloadCount(),
+                    m_shader_library->getFailedReloadCount());
+        ImGui::Text("Parallel shader compilation: %s",
+                    OglShaderProgram::isParallelCompilationEnabled() ? "yes" : "no");
+    }
+    ImGui::End();
 }
 
 const uint64_t& OglRenderer::getViewportAttachmentId() const
@@ -1014,16 +1686,23 @@ void OglRenderer::drawArraysInstanced(const u64& vertex_count, const u64& instan
     glDrawArraysInstanced(drawModeToGLEnum(mode), 0, (GLsizei)vertex_count, (GLsizei)instance_count);
 }
 
-void OglRenderer::drawElements(const u64& index_count, DrawMode mode)
+void OglRenderer::drawElements(const u64& index_count, DrawMode mode, const IndexType& index_type)
 {
-    glDrawElements(drawModeToGLEnum(mode), (GLsizei)index_count, GL_UNSIGNED_INT, 0);
+    glDrawElements(drawModeToGLEnum(mode), (GLsizei)index_count, indexTypeToGLEnum(index_type), 0);
     // glDrawElements(DrawModeToGLEnum(mode), index_count, GL_UNSIGNED_INT, indices); // does not work
     //(GLenum mode, GLsizei count, GLenum type, const void* indices);
 }
 
-void OglRenderer::drawElementsInstanced(const u64& index_count, const u64& instance_count, DrawMode mode)
+void OglRenderer::drawElementsInstanced(const u64&       index_count,
+                                        const u64&       instance_count,
+                                        DrawMode         mode,
+                                        const IndexType& index_type)
 {
-    glDrawElementsInstanced(drawModeToGLEnum(mode), (GLsizei)index_count, GL_UNSIGNED_INT, 0, (GLsizei)instance_count);
+    glDrawElementsInstanced(drawModeToGLEnum(mode),
+                            (GLsizei)index_count,
+                            indexTypeToGLEnum(index_type),
+                            0,
+                            (GLsizei)instance_count);
 }
 
 GLenum OglRenderer::drawModeToGLEnum(DrawMode mode)
@@ -1056,6 +1735,11 @@ GLenum OglRenderer::drawModeToGLEnum(DrawMode mode)
     return static_cast<unsigned int>(DrawMode::INVALID);
 }
 
+GLenum OglRenderer::indexTypeToGLEnum(const IndexType& index_type)
+{
+    return index_type == IndexType::UnsignedShort ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+}
+
 // void runShadowPass()
 //{
 //   Bind shadow pass framebuffer
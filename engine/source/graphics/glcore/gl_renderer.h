@@ -7,11 +7,22 @@
 #include "graphics/api/light.h"
 #include "graphics/api/color_material.h"
 #include "graphics/glcore/gl_buffer.h"
+#include "graphics/glcore/gl_ring_buffer.h"
+#include "graphics/glcore/gl_gpu_profiler.h"
 #include "graphics/glcore/gl_framebuffer.h"
+#include "graphics/glcore/gl_render_queue.h"
+#include "graphics/glcore/gl_shader_library.h"
+#include "graphics/glcore/gl_static_geometry.h"
+#include "graphics/core/geometry/bvh.h"
+#include "graphics/core/debug_draw.h"
 
 #include <vector.hpp>
 #include <matrix.hpp>
 
+#include <memory>
+#include <mutex>
+#include <span>
+
 struct GLFWwindow;
 
 namespace sputnik::graphics::gl
@@ -20,6 +31,9 @@ namespace sputnik::graphics::gl
 using namespace sputnik::core;
 using namespace ramanujan::experimental;
 using namespace sputnik::graphics::api;
+using sputnik::graphics::core::DebugDrawList;
+using sputnik::graphics::core::DebugPrimitive;
+using sputnik::graphics::core::DynamicBvh;
 
 enum class DrawMode
 {
@@ -43,15 +57,22 @@ struct PerFrameData
     alignas(16) vec3 camera_position;
 };
 
+// Cascaded shadow maps, the cascades are the tiles of a 2x2 depth atlas (see shadow_cascades.glsl)
+static constexpr u32   kShadowCascadeCount       = 4;
+static constexpr u32   kShadowCascadeResolution  = 1024;
+static constexpr float kShadowDistance           = 100.0f; // view space depth covered by the last cascade
+static constexpr float kShadowCascadeSplitLambda = 0.75f;  // 0 splits uniformly, 1 logarithmically
+static constexpr float kShadowCasterDistance     = 50.0f;  // extends the cascades towards the light
+
 /*!
  * @brief Uniform buffer bound to binding point 2.
  */
 struct ShadowPassBuffer
 {
-    alignas(16) glm::mat4 light_projection;
-    alignas(16) glm::mat4 light_view;
-    // alignas(16) glm::vec3 light_position;
-    // alignas(16) glm::vec3 light_direction;
+    alignas(16) glm::mat4 light_view_projections[kShadowCascadeCount];
+    alignas(16) glm::vec4 cascade_splits;    // view space depth where every cascade ends
+    alignas(16) glm::vec4 camera_depth_axis; // dot with a world position gives its view space depth
+    alignas(16) glm::vec4 light_direction;
 };
 
 struct DrawElementsIndirectCommand
@@ -71,6 +92,27 @@ struct DrawArraysIndirectCommand
     u32 base_instance;
 };
 
+/*!
+ * @brief Per draw data of the static geometry, shader storage buffer bound to binding point 3.
+ */
+struct StaticDrawData
+{
+    mat4 model;
+    mat4 normal_matrix;
+    u32  material_index;
+    u32  padding[3];
+};
+
+/*!
+ * @brief Material parameters of the frame, shader storage buffer bound to binding point 4. Every distinct material
+ * of the frame gets one entry, the draws select theirs by index.
+ */
+struct MaterialData
+{
+    alignas(16) vec4 diffuse;
+    alignas(16) vec4 specular_shininess; // xyz: specular, w: shininess
+};
+
 class OglRenderer
 {
 
@@ -100,19 +142,114 @@ public:
 
     static void drawArrays(const u64& vertex_count, DrawMode mode);
     static void drawArraysInstanced(const u64& vertex_count, const u64& instance_count, DrawMode mode);
-    static void drawElements(const u64& index_count, DrawMode mode);
-    static void drawElementsInstanced(const u64& index_count, const u64& instance_count, DrawMode mode);
+    static void drawElements(const u64&       index_count,
+                             DrawMode         mode,
+                             const IndexType& index_type = IndexType::UnsignedInt);
+    static void drawElementsInstanced(const u64&       index_count,
+                                      const u64&       instance_count,
+                                      DrawMode         mode,
+                                      const IndexType& index_type = IndexType::UnsignedInt);
 
     // parameters: vao, shader program, material, mat4 model
     // Canonical draw calls
-    void drawTriangles(const u64& vertex_count, const Material& material, const mat4& model);
-    void drawTrianglesIndexed(const u64& index_count, const Material& material, const mat4& model);
-    void drawTrianglesIndexed(const u64&                  index_count,
+    // Draws with valid (object space) bounds are culled against the view and shadow frusta during flush()
+    // Indexed draws take the vertex array of the mesh, its index type and vertex decode are not part of the GL state
+    void drawTriangles(const u64&         vertex_count,
+                       const Material&    material,
+                       const mat4&        model,
+                       const BoundingBox& bounds = {});
+    void drawTrianglesIndexed(const OglVertexArray& vertex_array,
+                              const u64&            index_count,
+                              const Material&       material,
+                              const mat4&           model,
+                              const BoundingBox&    bounds = {});
+    void drawTrianglesIndexed(const OglVertexArray&       vertex_array,
+                              const u64&                  index_count,
                               const Material&             material,
                               const mat4&                 model,
                               const std::vector<Matrix4>& skin_transformations);
-    void drawTrianglesInstanced(const u64& vertex_count, const u64& instance_count, const Material& material);
-    void drawTrianglesIndexedInstanced(const u64& index_count, const u64& instance_count, const Material& material);
+
+    /*!
+     * @brief Draws one instance of the bound mesh per model. The instances are streamed through the ring buffer, there
+     * is no need to attach per instance buffers to the vertex array. colors is either empty or holds one color per
+     * model, it tints the diffuse color of the material. Instanced draws cast shadows but are not culled.
+     */
+    void drawTrianglesInstanced(const u64&                   vertex_count,
+                                const Material&              material,
+                                const std::span<const mat4>& models,
+                                const std::span<const vec4>& colors = {});
+    void drawTrianglesIndexedInstanced(const OglVertexArray&        vertex_array,
+                                       const u64&                   index_count,
+                                       const Material&              material,
+                                       const std::span<const mat4>& models,
+                                       const std::span<const vec4>& colors = {});
+
+    /*!
+     * @brief Thread safe variants of the draws above. The vertex array is passed explicitly instead of being read from
+     * the GL state, so they do not call into GL and can be called from any thread, for example by workers that record
+     * the draws of a scene in parallel. Every thread records into a render queue of its own, flush() culls and sorts
+     * the queues of all the threads in parallel and merges them on the GL thread. The recording threads must be done
+     * with the frame before flush() is called. Vertex pulling materials (blinn_phong_pvp) are not supported here.
+     * Indexed draws with several levels of detail are drawn with the level their projected error calls for, the
+     * element count is the one of the full mesh.
+     */
+    void submitTriangles(const OglVertexArray& vertex_array,
+                         const u64&            element_count,
+                         const bool&           indexed,
+                         const Material&       material,
+                         const mat4&           model,
+                         const BoundingBox&    bounds = {},
+                         const DrawLods&       lods   = {});
+    void submitTriangles(const OglVertexArray&       vertex_array,
+                         const u64&                  index_count,
+                         const Material&             material,
+                         const mat4&                 model,
+                         const std::vector<Matrix4>& skin_transformations,
+                         const DrawLods&             lods = {});
+    void submitTrianglesInstanced(const OglVertexArray&        vertex_array,
+                                  const u64&                   element_count,
+                                  const bool&                  indexed,
+                                  const Material&              material,
+                                  const std::span<const mat4>& models,
+                                  const std::span<const vec4>& colors = {});
+
+    /*!
+     * @brief Adds a mesh to the static geometry and returns its id. Static meshes share one set of vertex and index
+     * buffers and are submitted with a single multi draw indirect call per pass (per texture set in the opaque pass).
+     */
+    u32  addStaticMesh(const std::vector<ramanujan::Vector3>& positions,
+                       const std::vector<ramanujan::Vector3>& normals,
+                       const std::vector<ramanujan::Vector2>& uvs,
+                       const std::vector<u32>&                indices);
+    void drawStaticMesh(const u32& mesh_id, const Material& material, const mat4& model);
+
+    /*!
+     * @brief Static mesh instances stay in the scene until they are removed, there is no need to draw them every
+     * frame. They are kept in a bounding volume hierarchy that is culled on a worker thread during flush(), only the
+     * visible instances are submitted.
+     */
+    u32  addStaticInstance(const u32& mesh_id, const Material& material, const mat4& model);
+    void setStaticInstanceTransform(const u32& instance_id, const mat4& model);
+    void removeStaticInstance(const u32& instance_id);
+
+    /*!
+     * @brief Submits all the triangle draws recorded since the last flush. The drawTriangles* calls above only record
+     * a packet with the currently bound vertex array, the packets are sorted by pass, program, textures and material
+     * here and bound state is only changed when it differs from the previous packet. Runs of draws that only differ in
+     * their transform are drawn as a single instanced draw. The shadow pass renders all the casters into every shadow
+     * cascade before the opaque pass runs. Must be called once per frame, after the scene has been drawn and before
+     * the viewport is presented.
+     */
+    void flush();
+
+    const RenderQueueStats& getRenderQueueStats() const;
+
+    /*!
+     * @brief Debug geometry of the frame, thread safe. It is drawn at the end of flush() with a single instanced draw,
+     * the drawDebugLines()/drawDebugPoints() functions below add to it.
+     */
+    DebugDrawList& getDebugDraw();
+
     void drawDebugLines(const std::vector<vec4>& vertices, const vec3& color, const float& line_width = 2.5f);
     void drawDebugLines(const std::vector<vec4>& vertices,
                         const vec3&              color,
@@ -147,6 +284,89 @@ private:
     void initializeRenderingState();
 
     static u32 drawModeToGLEnum(DrawMode mode);
+    static u32 indexTypeToGLEnum(const IndexType& index_type);
+
+    /*!
+     * @brief Fits every shadow cascade to its slice of the camera frustum.
+     */
+    void updateShadowCascades(const mat4& projection, const mat4& view, const Light& light);
+
+    /*!
+     * @brief Extracts the view frustum and the frusta of the shadow cascades that the draws are culled against.
+     */
+    void updateCullingFrusta();
+
+    /*!
+     * @brief Marks the static instances that are inside the view frustum or a shadow cascade and records the visible
+     * ones into m_static_instance_queue. Runs on a worker thread, it must only read the instances, their hierarchy and
+     * the frusta.
+     */
+    void cullStaticInstances();
+    u32  pushVisibleStaticInstances(); // returns the number of culled instances
+
+    /*!
+     * @brief Render queue of the calling thread, created the first time the thread records a draw.
+     */
+    RenderQueue& getThreadRenderQueue();
+
+    /*!
+     * @brief Culls and sorts the render queues of the recording threads in parallel and merges them into
+     * m_render_queue, together with the visible static instances.
+     */
+    void mergeThreadRenderQueues();
+
+    void renderShadowPass(const std::span<const DrawPacket>& packets);
+    void renderOpaquePass(const std::span<const DrawPacket>& packets);
+    void submitPackets(const std::span<const DrawPacket>& packets, const u32& cascade);
+
+    /*!
+     * @brief Builds the indirect commands and per draw data of the recorded static draws and uploads them.
+     */
+    void prepareStaticDraws();
+    void submitStaticDraws(const RenderPass& pass, const u32& cascade);
+
+    /*!
+     * @brief Gives every recorded material a slot in the material buffer and uploads it. Consecutive packets with the
+     * same material share a slot.
+     */
+    void prepareMaterials();
+
+    void renderDebugPass();
+
+    /*!
+     * @brief Reads the vertex array (and the storage buffer of the vertex pulling draws) the caller has bound. Only
+     * valid on the GL thread.
+     */
+    void captureBoundVertexData(const Material& material, u32& vertex_array, u32& storage_buffer) const;
+
+    void recordDraw(RenderQueue&                queue,
+                    const u32&                  vertex_array,
+                    const u32&                  storage_buffer,
+                    const u64&                  element_count,
+                    const bool&                 indexed,
+                    const IndexType&            index_type,
+                    const Material&             material,
+                    const mat4&                 model,
+                    const std::vector<Matrix4>* skin_transformations,
+                    const BoundingBox*          bounds,
+                    const DrawLods*             lods   = nullptr,
+                    const VertexDecode*         decode = nullptr);
+    void recordInstancedDraw(RenderQueue&                 queue,
+                             const u32&                   vertex_array,
+                             const u64&                   element_count,
+                             const bool&                  indexed,
+                             const IndexType&             index_type,
+                             const Material&              material,
+                             const std::span<const mat4>& models,
+                             const std::span<const vec4>& colors,
+                             const VertexDecode*          decode = nullptr);
+
+    const std::shared_ptr<OglShaderProgram>& getDrawProgram(const DrawProgram& program) const;
+
+    /*!
+     * @brief Looks up the cached uniform locations again for the programs swapped by a shader reload.
+     */
+    void resolveUniformLocations();
 
     // Todo:: Will be implemented once the event system is in place.
     // Or maybe render system handles this?
@@ -168,7 +388,9 @@ private:
     // A vertex array object for immediate drawing purposes (sky, grid, points, lines, maybe)
     std::unique_ptr<OglVertexArray> m_vao;
 
-    // Shader programs
+    // Shader programs, owned by the library, which reloads them when their files change
+    std::unique_ptr<OglShaderLibrary> m_shader_library;
+    u32                               m_shader_reload_count{0};
     std::shared_ptr<OglShaderProgram> m_sky_program;
     std::shared_ptr<OglShaderProgram> m_grid_program;
     std::shared_ptr<OglShaderProgram> m_shadow_pass_program;
@@ -178,6 +400,9 @@ private:
     std::shared_ptr<OglShaderProgram> m_blinn_phong_instanced_program;
     std::shared_ptr<OglShaderProgram> m_blinn_phong_pvp_program;
     std::shared_ptr<OglShaderProgram> m_debug_draw_program;
+    std::shared_ptr<OglShaderProgram> m_shadow_pass_indirect_program;
+    std::shared_ptr<OglShaderProgram> m_blinn_phong_indirect_program;
+    std::shared_ptr<OglShaderProgram> m_shadow_pass_instanced_program;
 
     // Framebuffers
     std::shared_ptr<OglFramebuffer> m_shadow_pass_framebuffer;
@@ -188,13 +413,14 @@ private:
     Light            m_light_data;
     ShadowPassBuffer m_shadow_pass_data;
 
-    // GPU buffers
-    const u8                   kPerFrameDataBindingPoint = 0;
-    std::shared_ptr<OglBuffer> m_per_frame_gpu_buffer;
-    const u8                   kLightDataBindingPoint = 1;
-    std::shared_ptr<OglBuffer> m_light_gpu_buffer;
-    const u8                   kShadowPassBufferBindingPoint = 2;
-    std::shared_ptr<OglBuffer> m_shadow_pass_buffer;
+    // GPU buffers, everything that is rewritten every frame is streamed through the ring buffer
+    static constexpr u64           kFrameRingBufferBytes = 4 * 1024 * 1024; // per frame in flight
+    std::unique_ptr<OglRingBuffer> m_frame_ring_buffer;
+    const u8                       kPerFrameDataBindingPoint     = 0;
+    const u8                       kLightDataBindingPoint        = 1;
+    const u8                       kShadowPassBufferBindingPoint = 2;
+    const u8                       kSkinTransformsBindingPoint   = 5;
+    const u8                       kInstanceDataBindingPoint     = 7;
 
     struct VertexData
     {
@@ -207,6 +433,89 @@ private:
 
     // Skinned vertex data
 
+    // Draws recorded for the current frame, one queue per recording thread. They are merged into m_render_queue
+    // during flush(). A queue stays registered while its thread is alive, the thread holds the other reference.
+    std::mutex                                m_thread_render_queues_mutex;
+    std::vector<std::shared_ptr<RenderQueue>> m_thread_render_queues;
+    RenderQueue                               m_static_instance_queue; // visible static instances
+    RenderQueue                               m_render_queue;
+    RenderQueueStats                          m_render_queue_stats;
+
+    // Uniform locations of the draw programs, resolved once so that submission does not look up uniforms by name
+    struct DrawProgramUniforms
+    {
+        i32 model{-1};
+        i32 normal_matrix{-1};
+        i32 skin_offset{-1};
+        i32 cascade_index{-1};
+        i32 material_index{-1};
+        i32 instance_offset{-1};
+        i32 position_scale{-1};
+        i32 position_offset{-1};
+        i32 octahedral_normals{-1};
+        u32 generation{~0u}; // of the program the locations were looked up in
+    };
+    DrawProgramUniforms m_draw_program_uniforms[(u32)DrawProgram::Count];
+    i32                 m_shadow_pass_indirect_cascade_index{-1};
+
+    // Materials of the current frame
+    std::vector<MaterialData> m_material_data;
+    std::vector<u32>          m_material_slots; // render queue material index -> slot in m_material_data
+    const u8                  kMaterialDataBindingPoint = 4;
+
+    // Static geometry and the per frame data of its multi draw indirect submission
+    struct StaticBatch
+    {
+        u32                 first_command;
+        u32                 command_count;
+        const OglTexture2D* diffuse_texture;
+        const OglTexture2D* specular_texture;
+    };
+    struct StaticShadowRange
+    {
+        u32 first_command;
+        u32 command_count;
+    };
+    OglStaticGeometry                        m_static_geometry;
+    std::vector<DrawElementsIndirectCommand> m_static_commands;
+    std::vector<StaticBatch>                 m_static_batches;
+    StaticShadowRange                        m_static_shadow_ranges[kShadowCascadeCount];
+    RingAllocation                           m_static_command_allocation; // indirect buffer of the frame
+    const u8                                 kStaticDrawDataBindingPoint = 3;
+
+    // Static instances and their visibility
+    struct StaticInstance
+    {
+        u32      mesh_id;
+        Material material;
+        mat4     model;
+        u32      proxy{DynamicBvh::kNullNode}; // kNullNode once the instance has been removed
+    };
+    std::vector<StaticInstance> m_static_instances;
+    std::vector<u32>            m_free_static_instances;
+    DynamicBvh                  m_static_instance_bvh;
+    std::vector<u32>            m_static_instance_query;
+    std::vector<u8>             m_static_instance_visibility;
+
+    // Debug geometry, collected during the frame and drawn after the opaque pass
+    DebugDrawList               m_debug_draw;
+    std::vector<DebugPrimitive> m_debug_primitives;
+    i32                         m_debug_draw_viewport_size{-1};
+    const u8                    kDebugPrimitivesBindingPoint = 6;
+
+    // Levels of detail, projection_scale is the size in pixels of a unit at a distance of one unit
+    LodSettings m_lod_settings;
+    float       m_lod_projection_scale{0.0f};
+
+    // Culling
+    bool    m_frustum_culling{true};
+    bool    m_automatic_instancing{true};
+    Frustum m_view_frustum;
+    Frustum m_cascade_frusta[kShadowCascadeCount];
+
+    // GPU time of the render passes, reported to the profiler
+    std::unique_ptr<OglGpuProfiler> m_gpu_profiler;
+
     // default textures
     std::shared_ptr<OglTexture2D> m_white_texture;
     std::shared_ptr<OglTexture2D> m_red_texture;
@@ -0,0 +1,190 @@
+#include "pch.h"
+
+#include "gl_ring_buffer.h"
+
+#include <glad/glad.h>
+
+#include <algorithm>
+#include <cstring>
+
+namespace sputnik::graphics::gl
+{
+
+// Useful references:
+// https://www.khronos.org/opengl/wiki/Buffer_Object_Streaming#Persistent_mapped_streaming
+// https://registry.khronos.org/OpenGL-Refpages/gl4/html/glFenceSync.xhtml
+// https://registry.khronos.org/OpenGL-Refpages/gl4/html/glClientWaitSync.xhtml
+
+static u64 alignUp(const u64& value, const u64& alignment)
+{
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+OglRingBuffer::OglRingBuffer(const u64& bytes_per_frame)
+{
+    GLint uniform_alignment = 0;
+    GLint storage_alignment = 0;
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &uniform_alignment);
+    glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &storage_alignment);
+    m_alignment = std::max<u64>({m_alignment, (u64)uniform_alignment, (u64)storage_alignment});
+
+    createBuffer(bytes_per_frame);
+}
+
+OglRingBuffer::~OglRingBuffer()
+{
+    for(void*& fence : m_fences)
+    {
+        if(fence)
+        {
+            glDeleteSync((GLsync)fence);
+            fence = nullptr;
+        }
+    }
+    m_buffer->unmap();
+}
+
+void OglRingBuffer::beginFrame()
+{
+    m_last_frame_bytes = m_head;
+    m_frame            = (m_frame + 1) % kFrameCount;
+    m_head             = 0;
+
+    // the region is reused once the GPU has consumed the frame that wrote it kFrameCount frames ago
+    if(GLsync fence = (GLsync)m_fences[m_frame])
+    {
+        GLenum result = glClientWaitSync(fence, 0, 0);
+        if(result == GL_TIMEOUT_EXPIRED)
+        {
+            ++m_wait_count;
+            do
+            {
+                result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000); // 1 second
+            } while(result == GL_TIMEOUT_EXPIRED);
+        }
+        SPUTNIK_ASSERT(result != GL_WAIT_FAILED, "Failed to wait for the ring buffer fence.");
+        glDeleteSync(fence);
+        m_fences[m_frame] = nullptr;
+    }
+
+    for(RetiredBuffer& retired : m_retired_buffers)
+    {
+        --retired.frames_left;
+    }
+    std::erase_if(m_retired_buffers, [](const RetiredBuffer& retired) { return retired.frames_left == 0; });
+}
+
+void OglRingBuffer::endFrame()
+{
+    if(m_fences[m_frame])
+    {
+        glDeleteSync((GLsync)m_fences[m_frame]);
+    }
+    m_fences[m_frame] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+RingAllocation OglRingBuffer::allocate(const u64& bytes)
+{
+    u64 offset = alignUp(m_head, m_alignment);
+    if(offset + bytes > m_frame_bytes)
+    {
+        grow(offset + bytes);
+        offset = 0;
+    }
+    m_head = offset + bytes;
+
+    RingAllocation allocation;
+    allocation.offset    = (u64)m_frame * m_frame_bytes + offset;
+    allocation.data      = m_mapped + allocation.offset;
+    allocation.bytes     = bytes;
+    allocation.buffer_id = m_buffer->getId();
+    return allocation;
+}
+
+RingAllocation OglRingBuffer::upload(const void* data, const u64& bytes)
+{
+    const RingAllocation allocation = allocate(bytes);
+    if(bytes > 0)
+    {
+        std::memcpy(allocation.data, data, bytes);
+    }
+    return allocation;
+}
+
+void OglRingBuffer::bind(const BufferBindTarget& bind_target, const u32& bind_index, const RingAllocation& allocation)
+{
+    if(allocation.bytes == 0)
+    {
+        return;
+    }
+    OglBuffer* buffer = findBuffer(allocation.buffer_id);
+    SPUTNIK_ASSERT(buffer, "The ring buffer allocation belongs to a buffer that was already released.");
+    buffer->bind(bind_target, bind_index, (void*)allocation.offset, (void*)allocation.bytes);
+}
+
+const u32& OglRingBuffer::getId() const
+{
+    return m_buffer->getId();
+}
+
+u64 OglRingBuffer::getFrameCapacity() const
+{
+    return m_frame_bytes;
+}
+
+u64 OglRingBuffer::getLastFrameBytes() const
+{
+    return m_last_frame_bytes;
+}
+
+u32 OglRingBuffer::getWaitCount() const
+{
+    return m_wait_count;
+}
+
+void OglRingBuffer::createBuffer(const u64& bytes_per_frame)
+{
+    const u32 flags = BufferUsageFlagBits::kMapWriteBit | BufferUsageFlagBits::kMapPersistentBit |
+                      BufferUsageFlagBits::kMapCoherentBit;
+
+    m_frame_bytes = alignUp(bytes_per_frame, m_alignment);
+    m_buffer      = std::make_unique<OglBuffer>(m_frame_bytes * kFrameCount, flags);
+    m_mapped      = (u8*)m_buffer->map(0, m_frame_bytes * kFrameCount, flags);
+}
+
+void OglRingBuffer::grow(const u64& bytes)
+{
+    // Allocations made earlier in the frame still point into the old buffer, it stays mapped and is retired instead of
+    // deleted. The regions of the new buffer have never been used, so none of them needs a fence.
+    ENGINE_WARN("Ring buffer frame region of {} bytes exceeded, growing it.", m_frame_bytes);
+
+    m_retired_buffers.push_back({std::move(m_buffer), kFrameCount});
+    for(void*& fence : m_fences)
+    {
+        if(fence)
+        {
+            glDeleteSync((GLsync)fence);
+            fence = nullptr;
+        }
+    }
+    createBuffer(std::max(bytes, 2 * m_frame_bytes));
+    m_head = 0;
+}
+
+OglBuffer* OglRingBuffer::findBuffer(const u32& id) const
+{
+    if(m_buffer->getId() == id)
+    {
+        return m_buffer.get();
+    }
+    for(const RetiredBuffer& retired : m_retired_buffers)
+    {
+        if(retired.buffer->getId() == id)
+        {
+            return retired.buffer.get();
+        }
+    }
+    return nullptr;
+}
+
+} // namespace sputnik::graphics::gl
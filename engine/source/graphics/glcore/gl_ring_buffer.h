@@ -0,0 +1,97 @@
+#pragma once
+
+#include "core/core.h"
+#include "gl_buffer.h"
+
+#include <memory>
+#include <vector>
+
+namespace sputnik::graphics::gl
+{
+
+/*!
+ * @brief A range of the ring buffer handed out for the current frame. data stays writable until the frame ends.
+ *
+ * @details The buffer can grow in the middle of a frame, so an allocation remembers the buffer it was made from. Bind
+ * it through OglRingBuffer::bind() or its buffer id, never through OglRingBuffer::getId().
+ */
+struct RingAllocation
+{
+    void* data{nullptr};
+    u64   offset{0}; // from the start of the buffer
+    u64   bytes{0};
+    u32   buffer_id{0};
+};
+
+/*!
+ * @brief Persistently mapped, coherent buffer for data that is rewritten every frame (uniform blocks, per draw data,
+ * debug geometry, skinning palettes).
+ *
+ * @details The buffer is split into kFrameCount regions, one per frame in flight. Allocations are bumped out of the
+ * region of the current frame and written through the mapping, so no buffer is created and no glBufferSubData is
+ * issued on the hot path. endFrame() fences the region, beginFrame() waits for the fence of the region it is about to
+ * reuse, which only blocks when the CPU is kFrameCount frames ahead of the GPU.
+ *
+ * A frame that does not fit its region grows the buffer. The old buffer stays mapped and alive until the GPU is done
+ * with it, the allocations made from it earlier in the frame keep pointing into it.
+ */
+class OglRingBuffer
+{
+public:
+    static constexpr u32 kFrameCount = 3;
+
+    OglRingBuffer(const u64& bytes_per_frame);
+    ~OglRingBuffer();
+
+    OglRingBuffer(const OglRingBuffer&)            = delete;
+    OglRingBuffer& operator=(const OglRingBuffer&) = delete;
+
+    void beginFrame();
+    void endFrame();
+
+    /*!
+     * @brief Reserves bytes in the region of the current frame. Every allocation is aligned for uniform and shader
+     * storage buffer bindings.
+     */
+    RingAllocation allocate(const u64& bytes);
+    RingAllocation upload(const void* data, const u64& bytes);
+
+    /*!
+     * @brief Binds the allocation to an indexed binding point (uniform or shader storage buffer), using the buffer the
+     * allocation was made from. Empty allocations are not bound.
+     */
+    void bind(const BufferBindTarget& bind_target, const u32& bind_index, const RingAllocation& allocation);
+
+    /*!
+     * @brief The buffer new allocations are made from, it changes when the buffer grows.
+     */
+    const u32& getId() const;
+    u64        getFrameCapacity() const;
+    u64        getLastFrameBytes() const;
+    u32        getWaitCount() const; // frames that had to wait for the GPU
+
+private:
+    void createBuffer(const u64& bytes_per_frame);
+    void grow(const u64& bytes);
+
+    OglBuffer* findBuffer(const u32& id) const;
+
+    struct RetiredBuffer
+    {
+        std::unique_ptr<OglBuffer> buffer;
+        u32                        frames_left;
+    };
+
+    std::unique_ptr<OglBuffer> m_buffer;
+    u8*                        m_mapped{nullptr};
+    u64                        m_frame_bytes{0};
+    u64                        m_alignment{16};
+    u32                        m_frame{0};
+    u64                        m_head{0};
+    u64                        m_last_frame_bytes{0};
+    u32                        m_wait_count{0};
+    void*                      m_fences[kFrameCount]{}; // GLsync, one per region
+    std::vector<RetiredBuffer> m_retired_buffers;
+};
+
+} // namespace sputnik::graphics::gl
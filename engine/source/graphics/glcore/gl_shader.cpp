@@ -1,9 +1,12 @@
 #include "pch.h"
 #include "gl_shader.h"
+#include "gl_program_cache.h"
 
 #include <glad/glad.h>
 #include <glm/gtc/type_ptr.hpp>
 
+#include <filesystem>
+
 namespace sputnik::graphics::gl
 {
 
@@ -59,20 +62,52 @@ const std::unordered_map<u32, u32> kGlShaderTypeToGlShaderBit = {
     {GL_TESS_EVALUATION_SHADER, GL_TESS_EVALUATION_SHADER_BIT},
     {GL_COMPUTE_SHADER, GL_COMPUTE_SHADER_BIT}};
 
+// GL_KHR_parallel_shader_compile and GL_ARB_parallel_shader_compile, the glad loader is generated without them
+constexpr GLenum kCompletionStatus = 0x91B1;
+using MaxShaderCompilerThreadsProc = void(APIENTRYP)(GLuint count);
+
+std::string getShaderInfoLog(const u32& shader)
+{
+    int length = 0;
+    glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &length);
+    std::string message(std::max(length, 1), '\0');
+    glGetShaderInfoLog(shader, length, &length, message.data());
+    message.resize(length);
+    return message;
+}
+
+std::string getProgramInfoLog(const u32& program)
+{
+    int length = 0;
+    glGetProgramiv(program, GL_INFO_LOG_LENGTH, &length);
+    std::string message(std::max(length, 1), '\0');
+    glGetProgramInfoLog(program, length, &length, message.data());
+    message.resize(length);
+    return message;
+}
+
 const char* getShaderStageTypeString(cstring shader_file)
 {
     size_t length = strlen(shader_file);
     return shader_file + length - 4;
 }
 
-std::string readShaderSource(cstring shader_file)
+// dependencies collects every file read, shader_file first, then its includes depth first
+std::string readShaderSource(cstring shader_file, std::vector<std::string>* dependencies = nullptr)
 {
+    if(dependencies)
+    {
+        dependencies->push_back(std::filesystem::path(shader_file).lexically_normal().generic_string());
+    }
+
     std::ifstream     shader_file_stream(shader_file);
     std::stringstream shader_source_stream;
     shader_source_stream << shader_file_stream.rdbuf();
     shader_file_stream.close();
     std::string shader_source = shader_source_stream.str();
 
+    // includes are resolved relative to the including file
+    const std::filesystem::path shader_directory = std::filesystem::path(shader_file).parent_path();
     while(shader_source.find("#include ") != shader_source.npos)
     {
         const auto pos  = shader_source.find("#include ");
@@ -83,15 +118,28 @@ std::string readShaderSource(cstring shader_file)
             SPUTNIK_ASSERT_MESSAGE(false, "Invalid include statement in shader: {}", shader_file);
             return std::string();
         }
-        const auto include_shader_file = shader_source.substr(pos1 + 1, pos2 - pos1 - 1);
-        // const auto include_shader_source = readShaderSource(include_shader_file.c_str());
-        const auto include_shader_source = readShaderSource(("../../data/shaders/glsl/" + include_shader_file).c_str());
-        // const auto include_shader_source = readShaderSource(("../data/shaders/glsl/" + include_shader_file).c_str());
+        const auto include_shader_file   = shader_source.substr(pos1 + 1, pos2 - pos1 - 1);
+        const auto include_shader_source =
+            readShaderSource((shader_directory / include_shader_file).string().c_str(), dependencies);
         shader_source.replace(pos, pos2 - pos + 1, include_shader_source);
     }
     return shader_source;
 }
 
+bool readShaderStage(cstring shader_file_path, ShaderStageSource& stage_source, std::vector<std::string>* dependencies)
+{
+    auto itr = kStringToShaderStageType.find(getShaderStageTypeString(shader_file_path));
+    if(itr == kStringToShaderStageType.end())
+    {
+        ENGINE_ERROR("Unknown shader type: {}", shader_file_path);
+        return false;
+    }
+    stage_source.type   = itr->second;
+    stage_source.source = readShaderSource(shader_file_path, dependencies);
+    stage_source.path   = shader_file_path;
+    return true;
+}
+
 //////////////////////////////////////// EXPERIMENTAL STARTS HERE ////////////////////////////////////////
 
 #ifdef EXPERIMENTAL_SHADER
@@ -219,32 +267,99 @@ OglShaderProgram& OglShaderProgram::operator=(OglShaderProgram&& other) noexcept
 {
     if(this != &other)
     {
-        m_id            = other.m_id;
-        m_shader_stages = std::move(other.m_shader_stages);
-        m_attributes    = std::move(other.m_attributes);
-        m_uniforms      = std::move(other.m_uniforms);
-        other.m_id      = 0;
+        m_id                 = other.m_id;
+        m_shader_stages      = std::move(other.m_shader_stages);
+        m_attributes         = std::move(other.m_attributes);
+        m_uniforms           = std::move(other.m_uniforms);
+        m_link_pending       = other.m_link_pending;
+        m_linked             = other.m_linked;
+        m_generation         = other.m_generation;
+        m_stage_sources      = std::move(other.m_stage_sources);
+        m_binary_key         = other.m_binary_key;
+        m_loaded_from_binary = other.m_loaded_from_binary;
+        m_name               = std::move(other.m_name);
+        other.m_id           = 0;
+        other.m_link_pending = false;
     }
     return *this;
 }
 
+void OglShaderProgram::initializeParallelCompilation(void* (*loader)(const char* name))
+{
+    // Reference: https://registry.khronos.org/OpenGL/extensions/KHR/KHR_parallel_shader_compile.txt
+    cstring entry_point     = nullptr;
+    GLint   extension_count = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &extension_count);
+    for(GLint i = 0; i < extension_count; ++i)
+    {
+        const std::string_view extension = (const char*)glGetStringi(GL_EXTENSIONS, (GLuint)i);
+        if(extension == "GL_KHR_parallel_shader_compile")
+        {
+            entry_point = "glMaxShaderCompilerThreadsKHR";
+            break;
+        }
+        if(extension == "GL_ARB_parallel_shader_compile")
+        {
+            entry_point = "glMaxShaderCompilerThreadsARB";
+        }
+    }
+
+    const auto max_shader_compiler_threads =
+        entry_point ? (MaxShaderCompilerThreadsProc)loader(entry_point) : MaxShaderCompilerThreadsProc{nullptr};
+    if(!max_shader_compiler_threads)
+    {
+        ENGINE_INFO("Parallel shader compilation is not supported, shaders are compiled on the render thread.");
+        return;
+    }
+
+    // 0xFFFFFFFF lets the driver choose the number of threads
+    max_shader_compiler_threads(0xFFFFFFFF);
+    m_parallel_compilation = true;
+}
+
+bool OglShaderProgram::isParallelCompilationEnabled()
+{
+    return m_parallel_compilation;
+}
+
 void OglShaderProgram::addShaderStage(cstring shader_filepath)
 {
-    OglShaderStage shader_stage(shader_filepath);
-    m_shader_stages.push_back(std::move(shader_stage));
+    ShaderStageSource stage_source;
+    if(!readShaderStage(shader_filepath, stage_source))
+    {
+        SPUTNIK_ASSERT_MESSAGE(false, "Unknown shader type: {}", shader_filepath);
+        return;
+    }
+    m_stage_sources.push_back(std::move(stage_source));
 }
 
 void OglShaderProgram::addShaderStage(const ShaderStageType& stage_type, cstring shader_source)
 {
-    OglShaderStage shader_stage(stage_type, shader_source);
-    m_shader_stages.push_back(std::move(shader_stage));
+    m_stage_sources.push_back({stage_type, shader_source, std::string()});
+}
+
+void OglShaderProgram::addShaderStage(ShaderStageSource stage_source)
+{
+    m_stage_sources.push_back(std::move(stage_source));
 }
 
 void OglShaderProgram::configure()
 {
-    link();
-    populateAttributes();
-    populateUniforms();
+    std::vector<u32>         stage_types;
+    std::vector<std::string> sources;
+    for(const ShaderStageSource& stage_source : m_stage_sources)
+    {
+        stage_types.push_back(kShaderStageTypeToGlType.at(stage_source.type));
+        sources.push_back(stage_source.source);
+    }
+
+    m_binary_key         = OglProgramCache::computeKey(stage_types, sources);
+    m_loaded_from_binary = OglProgramCache::load(m_id, m_binary_key);
+    if(!m_loaded_from_binary)
+    {
+        link();
+    }
+    m_link_pending = true;
 }
 
 const u32& OglShaderProgram::getId() const
@@ -252,24 +367,94 @@ const u32& OglShaderProgram::getId() const
     return m_id;
 }
 
+bool OglShaderProgram::isLinkComplete() const
+{
+    if(!m_link_pending || !m_parallel_compilation)
+    {
+        return true;
+    }
+
+    // does not block, unlike GL_LINK_STATUS
+    GLint complete = GL_FALSE;
+    glGetProgramiv(m_id, kCompletionStatus, &complete);
+    return complete == GL_TRUE;
+}
+
 void OglShaderProgram::link()
 {
+    for(const ShaderStageSource& stage_source : m_stage_sources)
+    {
+        m_shader_stages.emplace_back(stage_source.type, stage_source.source.c_str());
+    }
     for(auto& shader_module : m_shader_stages)
     {
         glAttachShader(m_id, shader_module.getId());
     }
+
+    // Reference: https://registry.khronos.org/OpenGL-Refpages/gl4/html/glProgramParameter.xhtml
+    // keeps the binary retrievable, resolveLink() stores it in the program binary cache
+    glProgramParameteri(m_id, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
     glLinkProgram(m_id);
+}
+
+bool OglShaderProgram::isLinked() const
+{
+    if(m_link_pending)
+    {
+        finishLink();
+    }
+    return m_linked;
+}
+
+void OglShaderProgram::swap(OglShaderProgram& other)
+{
+    std::swap(m_id, other.m_id);
+    std::swap(m_attributes, other.m_attributes);
+    std::swap(m_uniforms, other.m_uniforms);
+    std::swap(m_shader_stages, other.m_shader_stages);
+    std::swap(m_link_pending, other.m_link_pending);
+    std::swap(m_linked, other.m_linked);
+    std::swap(m_stage_sources, other.m_stage_sources);
+    std::swap(m_binary_key, other.m_binary_key);
+    std::swap(m_loaded_from_binary, other.m_loaded_from_binary);
+    ++m_generation;
+}
+
+const u32& OglShaderProgram::getGeneration() const
+{
+    return m_generation;
+}
+
+void OglShaderProgram::resolveLink() const
+{
+    if(!m_link_pending)
+    {
+        return;
+    }
+
+    finishLink();
+    if(!m_linked)
+    {
+        SPUTNIK_ASSERT_MESSAGE(false, "Shader linking failed. Shader Program:{}", m_name);
+    }
+}
+
+void OglShaderProgram::finishLink() const
+{
+    m_link_pending = false;
 
     int success = 0;
     glGetProgramiv(m_id, GL_LINK_STATUS, &success);
     if(!success)
     {
-        int length;
-        glGetProgramiv(m_id, GL_INFO_LOG_LENGTH, &length);
-        char* message = (char*)_malloca(length * sizeof(char));
-        glGetProgramInfoLog(m_id, length, &length, message);
-        SPUTNIK_ASSERT_MESSAGE(false, "Shader linking failed. Shader Program:{}\n{}", m_name, message);
+        for(size_t stage = 0; stage < m_shader_stages.size(); ++stage)
+        {
+            const std::string& path = m_stage_sources[stage].path;
+            m_shader_stages[stage].checkCompileStatus(path.empty() ? m_name : path);
+        }
+        ENGINE_ERROR("Shader linking failed. Shader Program:{}\n{}", m_name, getProgramInfoLog(m_id));
         clear();
+        return;
     }
 
     success = -1;
@@ -277,22 +462,25 @@ void OglShaderProgram::link()
     glGetProgramiv(m_id, GL_VALIDATE_STATUS, &success);
     if(!success)
     {
-        int length;
-        glGetProgramiv(m_id, GL_INFO_LOG_LENGTH, &length);
-        char* message = (char*)_malloca(length * sizeof(char));
-        glGetProgramInfoLog(m_id, length, &length, message);
         SPUTNIK_ASSERT_MESSAGE(false,
-                               "Shader validation failed. Shader Program:{}\Validation errors: {}",
+                               "Shader validation failed. Shader Program:{}\nValidation errors: {}",
                                m_name,
-                               message);
-        clear();
+                               getProgramInfoLog(m_id));
+    }
+
+    if(!m_loaded_from_binary)
+    {
+        OglProgramCache::store(m_id, m_binary_key);
     }
 
     // delete shaders here
     clear();
+    populateAttributes();
+    populateUniforms();
+    m_linked = true;
 }
 
-void OglShaderProgram::populateAttributes()
+void OglShaderProgram::populateAttributes() const
 {
     // Reference: https://registry.khronos.org/OpenGL-Refpages/gl4/html/glGetAttribLocation.xhtml
 
@@ -301,7 +489,6 @@ void OglShaderProgram::populateAttributes()
     char   name[128];
     int    size;
     GLenum type;
-    glUseProgram(m_id);
     glGetProgramiv(m_id, GL_ACTIVE_ATTRIBUTES, &count); // Get total number of active attributes in the shader program
     for(int i = 0; i < count; ++i)
     {
@@ -313,10 +500,9 @@ void OglShaderProgram::populateAttributes()
             m_attributes[name] = attrib;
         }
     }
-    glUseProgram(0);
 }
 
-void OglShaderProgram::populateUniforms()
+void OglShaderProgram::populateUniforms() const
 {
     int    count = -1;
     int    length;
@@ -325,7 +511,6 @@ void OglShaderProgram::populateUniforms()
     GLenum type;
     char   subscripted_uniform_name[256];
 
-    glUseProgram(m_id);
     glGetProgramiv(m_id, GL_ACTIVE_UNIFORMS, &count); // Get total number of active uniforms in the shader program
 
     for(int i = 0; i < count; ++i)
@@ -364,17 +549,17 @@ void OglShaderProgram::populateUniforms()
             m_uniforms[uniform_name] = uniform;
         }
     }
-
-    glUseProgram(0);
 }
 
-void OglShaderProgram::clear()
+void OglShaderProgram::clear() const
 {
     m_shader_stages.clear();
+    m_stage_sources.clear();
 }
 
-const u32& OglShaderProgram::getAttributeId(const std::string& name) const
+const u32& OglShaderProgram::getAttributeId(std::string_view name) const
 {
+    resolveLink();
     auto itr = m_attributes.find(name);
     if(itr == m_attributes.end())
     {
@@ -383,8 +568,9 @@ const u32& OglShaderProgram::getAttributeId(const std::string& name) const
     return itr->second;
 }
 
-const u32& OglShaderProgram::getUniformId(const std::string& name) const
+const u32& OglShaderProgram::getUniformId(std::string_view name) const
 {
+    resolveLink();
     auto itr = m_uniforms.find(name);
     if(itr == m_uniforms.end())
     {
@@ -393,8 +579,16 @@ const u32& OglShaderProgram::getUniformId(const std::string& name) const
     return itr->second;
 }
 
+i32 OglShaderProgram::getUniformLocation(std::string_view name) const
+{
+    resolveLink();
+    auto itr = m_uniforms.find(name);
+    return itr == m_uniforms.end() ? -1 : (i32)itr->second;
+}
+
 void OglShaderProgram::bind()
 {
+    resolveLink();
     glUseProgram(m_id);
 }
 
@@ -403,67 +597,103 @@ void OglShaderProgram::unbind()
     glUseProgram(0);
 }
 
-void OglShaderProgram::setInt(const std::string& name, const int value)
+void OglShaderProgram::setInt(std::string_view name, const int value)
 {
     u32 uniform_id = getUniformId(name);
     glUniform1i(uniform_id, value);
 }
 
-void OglShaderProgram::setIntArray(const std::string& name, int const* values, uint32_t count)
+void OglShaderProgram::setIntArray(std::string_view name, int const* values, uint32_t count)
 {
     u32 uniform_id = getUniformId(name);
     glUniform1iv(uniform_id, count, values);
 }
 
-void OglShaderProgram::setFloat(const std::string& name, const float& value)
+void OglShaderProgram::setFloat(std::string_view name, const float& value)
 {
     u32 uniform_id = getUniformId(name);
     glUniform1f(uniform_id, value);
 }
 
-void OglShaderProgram::setFloat2(const std::string& name, const vec2& value)
+void OglShaderProgram::setFloat2(std::string_view name, const vec2& value)
 {
     u32 uniform_id = getUniformId(name);
     glUniform2f(uniform_id, value.x, value.y); // or glUniform2fv(location, 1, &value[0]);
 }
 
-void OglShaderProgram::setFloat3(const std::string& name, const vec3& value)
+void OglShaderProgram::setFloat3(std::string_view name, const vec3& value)
 {
     u32 uniform_id = getUniformId(name);
     glUniform3f(uniform_id, value.x, value.y, value.z); // or glUniform3fv(location, 1, &value[0]);
 }
 
-void OglShaderProgram::setFloat4(const std::string& name, const vec4& value)
+void OglShaderProgram::setFloat4(std::string_view name, const vec4& value)
 {
     u32 uniform_id = getUniformId(name);
     glUniform4f(uniform_id, value.x, value.y, value.z, value.w); // or glUniform4fv(location, 1, &value[0]);
 }
 
-void OglShaderProgram::setMat4(const std::string& name, const mat4& value)
+void OglShaderProgram::setMat4(std::string_view name, const mat4& value)
 {
     u32 uniform_id = getUniformId(name);
     glUniformMatrix4fv(uniform_id, 1, GL_FALSE, (float*)&value.m[0]);
 }
 
-void OglShaderProgram::setMat4s(const std::string& name, const std::vector<Matrix4>& value)
+void OglShaderProgram::setMat4s(std::string_view name, const std::vector<Matrix4>& value)
 {
     u32 uniform_id = getUniformId(name);
     // glUniformMatrix4fv(uniform_id, (GLsizei)value.size(), GL_FALSE, (float*)&value[0]);
     glUniformMatrix4fv(uniform_id, (GLsizei)value.size(), GL_FALSE, (float*)&value[0].v[0]);
 }
 
-void OglShaderProgram::setMat3(const std::string& name, const mat3& value)
+void OglShaderProgram::setMat4s(std::string_view name, const Matrix4* values, const u32& count)
+{
+    u32 uniform_id = getUniformId(name);
+    glUniformMatrix4fv(uniform_id, (GLsizei)count, GL_FALSE, (float*)&values[0].v[0]);
+}
+
+void OglShaderProgram::setMat3(std::string_view name, const mat3& value)
 {
     u32 uniform_id = getUniformId(name);
     glUniformMatrix3fv(uniform_id, 1, GL_FALSE, (float*)&value.m[0]);
 }
 
-void OglShaderProgram::setMat4(const std::string& name, const glm::mat4& value)
+void OglShaderProgram::setMat4(std::string_view name, const glm::mat4& value)
 {
     u32 uniform_id = getUniformId(name);
     glUniformMatrix4fv(uniform_id, 1, GL_FALSE, glm::value_ptr(value[0]));
 }
 
+void OglShaderProgram::setInt(const i32& location, const int value)
+{
+    glUniform1i(location, value);
+}
+
+void OglShaderProgram::setUint(const i32& location, const u32& value)
+{
+    glUniform1ui(location, value);
+}
+
+void OglShaderProgram::setFloat2(const i32& location, const vec2& value)
+{
+    glUniform2f(location, value.x, value.y);
+}
+
+void OglShaderProgram::setFloat3(const i32& location, const vec3& value)
+{
+    glUniform3f(location, value.x, value.y, value.z);
+}
+
+void OglShaderProgram::setMat4(const i32& location, const mat4& value)
+{
+    glUniformMatrix4fv(location, 1, GL_FALSE, (float*)&value.m[0]);
+}
+
+void OglShaderProgram::setMat4s(const i32& location, const Matrix4* values, const u32& count)
+{
+    glUniformMatrix4fv(location, (GLsizei)count, GL_FALSE, (float*)&values[0].v[0]);
+}
+
 void OglShaderProgram::setName(const std::string& name)
 {
     m_name = name;
@@ -483,17 +713,6 @@ OglShaderStage::OglShaderStage(cstring shader_file_path)
     m_stage_type                   = itr->second;
     glShaderSource(m_id, 1, &shader_source_cstr, nullptr);
     glCompileShader(m_id);
-    int success = 0;
-    glGetShaderiv(m_id, GL_COMPILE_STATUS, &success);
-    if(!success)
-    {
-        int length;
-        glGetShaderiv(m_id, GL_INFO_LOG_LENGTH, &length);
-        char* message = (char*)_malloca(length * sizeof(char));
-        glGetShaderInfoLog(m_id, length, &length, message);
-        SPUTNIK_ASSERT_MESSAGE(false, "Shader compilation failed: {}", message);
-        glDeleteShader(m_id);
-    }
     // ENGINE_INFO("Shader loaded: {}, source: {}", shader_file_path, shader_source);
 }
 
@@ -510,17 +729,6 @@ OglShaderStage::OglShaderStage(const ShaderStageType& stage_type, cstring shader
     m_stage_type = itr->second;
     glShaderSource(m_id, 1, &shader_source, nullptr);
     glCompileShader(m_id);
-    int success = 0;
-    glGetShaderiv(m_id, GL_COMPILE_STATUS, &success);
-    if(!success)
-    {
-        int length;
-        glGetShaderiv(m_id, GL_INFO_LOG_LENGTH, &length);
-        char* message = (char*)_malloca(length * sizeof(char));
-        glGetShaderInfoLog(m_id, length, &length, message);
-        SPUTNIK_ASSERT_MESSAGE(false, "Shader compilation failed: {}", message);
-        glDeleteShader(m_id);
-    }
     // ENGINE_INFO("Shader loaded: source: {}", shader_source);
 }
 
@@ -556,4 +764,15 @@ const u32& OglShaderStage::getStageType() const
     return m_stage_type;
 }
 
+bool OglShaderStage::checkCompileStatus(std::string_view name) const
+{
+    int success = 0;
+    glGetShaderiv(m_id, GL_COMPILE_STATUS, &success);
+    if(!success)
+    {
+        ENGINE_ERROR("Shader compilation failed: {}\n{}", name, getShaderInfoLog(m_id));
+    }
+    return success;
+}
+
 } // namespace sputnik::graphics::gl
@@ -8,6 +8,8 @@
 
 #include <glm/glm.hpp>
 
+#include <string_view>
+
 namespace sputnik::graphics::gl
 {
 
@@ -94,6 +96,10 @@ protected:
 
 //////////////////////////// EXPERIMENTAL ENDS ///////////////////////////////
 
+/*!
+ * @brief A compiled shader stage. The constructors only submit the source to the driver, which may compile it on a
+ * background thread, the compile status is read by checkCompileStatus().
+ */
 class OglShaderStage
 {
 public:
@@ -107,6 +113,11 @@ public:
     const u32& getId() const;
     const u32& getStageType() const;
 
+    /*!
+     * @brief Waits for the compilation, logs the compile errors and returns whether the stage compiled.
+     */
+    bool checkCompileStatus(std::string_view name) const;
+
 protected:
     OglShaderStage(const OglShaderStage& other)      = delete;
     OglShaderStage& operator=(OglShaderStage& other) = delete;
@@ -116,6 +127,47 @@ protected:
     u32 m_stage_type;
 };
 
+/*!
+ * @brief Lets the uniform and attribute maps be searched with string views and literals without constructing a
+ * temporary std::string for every lookup.
+ */
+struct ShaderNameHash
+{
+    using is_transparent = void;
+
+    size_t operator()(std::string_view name) const { return std::hash<std::string_view>{}(name); }
+};
+
+using ShaderNameMap = std::unordered_map<std::string, u32, ShaderNameHash, std::equal_to<>>;
+
+/*!
+ * @brief The source of a shader stage with its includes expanded, kept until the program is configured.
+ */
+struct ShaderStageSource
+{
+    ShaderStageType type;
+    std::string     source;
+    std::string     path; // empty for stages added from a source string
+};
+
+/*!
+ * @brief Reads a shader stage, its type is taken from the file extension and its #include <file> directives are
+ * expanded, relative to the including file. The files read are appended to dependencies, shader_file_path first.
+ * Returns false for an unknown extension.
+ */
+bool readShaderStage(cstring                   shader_file_path,
+                     ShaderStageSource&        stage_source,
+                     std::vector<std::string>* dependencies = nullptr);
+
+/*!
+ * @brief A linked shader program.
+ *
+ * @details configure() does not wait for the driver. The program is loaded from the program binary cache when the
+ * sources have been linked before on this driver, otherwise its stages are compiled and linked, on the driver's
+ * threads when GL_KHR_parallel_shader_compile is available. The link status is checked, and the attributes and
+ * uniforms are enumerated, the first time the program is used, so configuring every program before using any of them
+ * lets the driver compile them all concurrently.
+ */
 class OglShaderProgram
 {
 public:
@@ -125,27 +177,72 @@ public:
     OglShaderProgram(OglShaderProgram&& other) noexcept;
     OglShaderProgram& operator=(OglShaderProgram&& other) noexcept;
 
+    /*!
+     * @brief Lets the driver compile and link on as many threads as it likes, when it supports
+     * GL_KHR_parallel_shader_compile or GL_ARB_parallel_shader_compile. Called once after the context is created,
+     * loader resolves the GL entry points (glfwGetProcAddress).
+     */
+    static void initializeParallelCompilation(void* (*loader)(const char* name));
+    static bool isParallelCompilationEnabled();
+
     void       addShaderStage(cstring shader_filepath);
     void       addShaderStage(const ShaderStageType& stage_type, cstring shader_source);
+    void       addShaderStage(ShaderStageSource stage_source);
     void       configure();
     const u32& getId() const;
-    const u32& getAttributeId(const std::string& name) const;
-    const u32& getUniformId(const std::string& name) const;
+
+    /*!
+     * @brief Whether the program can be used without waiting for the driver to finish compiling it. Always true
+     * without parallel shader compilation.
+     */
+    bool isLinkComplete() const;
+
+    /*!
+     * @brief Waits for the link and returns whether it succeeded. Unlike the first use of a program that failed to
+     * link, this logs the errors without asserting.
+     */
+    bool isLinked() const;
+
+    /*!
+     * @brief Exchanges the GL programs and the attribute and uniform maps of two programs, keeping their names. Used to
+     * swap a reloaded program in, the users of this object keep their reference to it. Uniform locations cached
+     * outside the program are only valid for the generation they were looked up in.
+     */
+    void       swap(OglShaderProgram& other);
+    const u32& getGeneration() const;
+
+    const u32& getAttributeId(std::string_view name) const;
+    const u32& getUniformId(std::string_view name) const;
+
+    /*!
+     * @brief Location of a uniform, -1 if the program does not use it. Setting a uniform at location -1 is silently
+     * ignored by OpenGL, so the result can be cached and used even for uniforms that got optimized out.
+     */
+    i32 getUniformLocation(std::string_view name) const;
 
     void bind();
     void unbind();
 
-    virtual void setInt(const std::string& name, const int value);
-    virtual void setIntArray(const std::string& name, int const* values, uint32_t count);
-    virtual void setFloat(const std::string& name, const float& value);
-    virtual void setFloat2(const std::string& name, const vec2& value);
-    virtual void setFloat3(const std::string& name, const vec3& value);
-    virtual void setFloat4(const std::string& name, const vec4& value);
-    virtual void setMat4(const std::string& name, const mat4& value);
-    virtual void setMat4s(const std::string& name, const std::vector<Matrix4>& value);
-    virtual void setMat3(const std::string& name, const mat3& value);
-
-    virtual void setMat4(const std::string& name, const glm::mat4& value);
+    virtual void setInt(std::string_view name, const int value);
+    virtual void setIntArray(std::string_view name, int const* values, uint32_t count);
+    virtual void setFloat(std::string_view name, const float& value);
+    virtual void setFloat2(std::string_view name, const vec2& value);
+    virtual void setFloat3(std::string_view name, const vec3& value);
+    virtual void setFloat4(std::string_view name, const vec4& value);
+    virtual void setMat4(std::string_view name, const mat4& value);
+    virtual void setMat4s(std::string_view name, const std::vector<Matrix4>& value);
+    virtual void setMat4s(std::string_view name, const Matrix4* values, const u32& count);
+    virtual void setMat3(std::string_view name, const mat3& value);
+
+    virtual void setMat4(std::string_view name, const glm::mat4& value);
+
+    // Setters for locations resolved once with getUniformLocation(), for the per draw uniforms
+    void setInt(const i32& location, const int value);
+    void setUint(const i32& location, const u32& value);
+    void setFloat2(const i32& location, const vec2& value);
+    void setFloat3(const i32& location, const vec3& value);
+    void setMat4(const i32& location, const mat4& value);
+    void setMat4s(const i32& location, const Matrix4* values, const u32& count);
 
     void setName(const std::string& name);
 
@@ -155,13 +252,20 @@ protected:
 
     void link();
 
+    /*!
+     * @brief Checks the link status of a configured program on its first use and enumerates its attributes and
+     * uniforms. Called by every method that needs the program to be linked.
+     */
+    void resolveLink() const;
+    void finishLink() const;
+
     /**
      * This method enumerates over all the attributes stored in the shader program, and stores them as key-value pairs
      * where
      * key: attribute name
      * value: attributes location in the shader
      */
-    void populateAttributes();
+    void populateAttributes() const;
 
     /**
      * This method enumerates over all the attributes stored in the shader program, and stores them as key-value pairs
@@ -169,16 +273,27 @@ protected:
      * key: uniform name
      * value: uniform location in the shader
      */
-    void populateUniforms();
+    void populateUniforms() const;
 
-    void clear();
+    void clear() const;
 
 private:
-    u32                                  m_id;
-    std::unordered_map<std::string, u32> m_attributes; // maps attribute name -> index in the shader
-    std::unordered_map<std::string, u32> m_uniforms;   // maps uniform name -> index in the shader
-    std::vector<OglShaderStage>          m_shader_stages;
-    std::string                          m_name;
+    inline static bool m_parallel_compilation = false;
+
+    u32 m_id;
+
+    // filled in by resolveLink() on the first use of the program, hence mutable
+    mutable ShaderNameMap               m_attributes; // maps attribute name -> index in the shader
+    mutable ShaderNameMap               m_uniforms;   // maps uniform name -> index in the shader
+    mutable std::vector<OglShaderStage> m_shader_stages;
+    mutable bool                        m_link_pending = false;
+    mutable bool                        m_linked       = false;
+
+    mutable std::vector<ShaderStageSource> m_stage_sources; // cleared once the program is linked
+    u64                                    m_binary_key         = 0;
+    bool                                   m_loaded_from_binary = false;
+    u32                                    m_generation         = 0; // incremented by swap()
+    std::string                            m_name;
 };
 
 } // namespace sputnik::graphics::gl
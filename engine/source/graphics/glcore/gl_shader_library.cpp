@@ -0,0 +1,228 @@
+#include "pch.h"
+#include "gl_shader_library.h"
+
+#include <algorithm>
+#include <chrono>
+
+namespace sputnik::graphics::gl
+{
+
+OglShaderLibrary::OglShaderLibrary() {}
+
+OglShaderLibrary::~OglShaderLibrary()
+{
+    setHotReloadEnabled(false);
+}
+
+std::shared_ptr<OglShaderProgram> OglShaderLibrary::load(const std::string&              name,
+                                                         const std::vector<std::string>& stage_paths)
+{
+    std::shared_ptr<OglShaderProgram> program = std::make_shared<OglShaderProgram>();
+    program->setName(name);
+
+    std::vector<std::string> dependencies;
+    for(const std::string& stage_path : stage_paths)
+    {
+        ShaderStageSource stage_source;
+        if(!readShaderStage(stage_path.c_str(), stage_source, &dependencies))
+        {
+            SPUTNIK_ASSERT_MESSAGE(false, "Unknown shader type: {}", stage_path);
+            continue;
+        }
+        program->addShaderStage(std::move(stage_source));
+    }
+    program->configure();
+
+    if(isHotReloadEnabled())
+    {
+        for(const std::string& dependency : dependencies)
+        {
+            m_watcher.watch(dependency);
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_graph_mutex);
+        m_stage_paths.push_back(stage_paths);
+        m_dependencies.emplace_back();
+        setDependencies((u32)m_programs.size(), std::move(dependencies));
+    }
+    m_programs.push_back({name, program, nullptr});
+    return program;
+}
+
+void OglShaderLibrary::setHotReloadEnabled(const bool& enabled)
+{
+    if(enabled == isHotReloadEnabled())
+    {
+        return;
+    }
+
+    if(!enabled)
+    {
+        m_stopping = true;
+        m_watch_thread.join();
+        m_stopping = false;
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_graph_mutex);
+        for(const auto& [file, programs] : m_dependents)
+        {
+            m_watcher.watch(file);
+        }
+    }
+    m_watch_thread = std::thread(&OglShaderLibrary::watchFiles, this);
+}
+
+bool OglShaderLibrary::isHotReloadEnabled() const
+{
+    return m_watch_thread.joinable();
+}
+
+void OglShaderLibrary::update()
+{
+    std::vector<PendingReload> pending;
+    {
+        std::lock_guard<std::mutex> lock(m_pending_mutex);
+        pending.swap(m_pending);
+    }
+
+    for(PendingReload& reload : pending)
+    {
+        // an edit may add includes, they are watched from now on
+        for(const std::string& dependency : reload.dependencies)
+        {
+            m_watcher.watch(dependency);
+        }
+        {
+            std::lock_guard<std::mutex> lock(m_graph_mutex);
+            setDependencies(reload.program, std::move(reload.dependencies));
+        }
+
+        // a replacement that is still compiling is superseded by the newer sources
+        ProgramEntry& entry = m_programs[reload.program];
+        entry.replacement   = std::make_unique<OglShaderProgram>();
+        entry.replacement->setName(entry.name);
+        for(ShaderStageSource& stage_source : reload.stages)
+        {
+            entry.replacement->addShaderStage(std::move(stage_source));
+        }
+        entry.replacement->configure();
+    }
+
+    for(ProgramEntry& entry : m_programs)
+    {
+        if(!entry.replacement || !entry.replacement->isLinkComplete())
+        {
+            continue;
+        }
+
+        if(entry.replacement->isLinked())
+        {
+            entry.program->swap(*entry.replacement);
+            ++m_reload_count;
+            ENGINE_INFO("Reloaded the shader program {}.", entry.name);
+        }
+        else
+        {
+            ++m_failed_reload_count;
+            ENGINE_ERROR("Could not reload the shader program {}, the previous version stays in use.", entry.name);
+        }
+        // deletes the previous GL program after a swap
+        entry.replacement.reset();
+    }
+}
+
+u32 OglShaderLibrary::getReloadCount() const
+{
+    return m_reload_count;
+}
+
+u32 OglShaderLibrary::getFailedReloadCount() const
+{
+    return m_failed_reload_count;
+}
+
+void OglShaderLibrary::watchFiles()
+{
+    while(!m_stopping)
+    {
+        std::vector<std::string> changes = m_watcher.waitForChanges(kWatchTimeoutMs);
+        if(changes.empty())
+        {
+            continue;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(kSettleTimeMs));
+        for(std::string& change : m_watcher.waitForChanges(0))
+        {
+            if(std::find(changes.begin(), changes.end(), change) == changes.end())
+            {
+                changes.push_back(std::move(change));
+            }
+        }
+
+        std::vector<u32>                      programs;
+        std::vector<std::vector<std::string>> stage_paths;
+        {
+            std::lock_guard<std::mutex> lock(m_graph_mutex);
+            for(const std::string& change : changes)
+            {
+                auto dependents = m_dependents.find(change);
+                if(dependents == m_dependents.end())
+                {
+                    continue;
+                }
+                for(const u32& program : dependents->second)
+                {
+                    if(std::find(programs.begin(), programs.end(), program) == programs.end())
+                    {
+                        programs.push_back(program);
+                        stage_paths.push_back(m_stage_paths[program]);
+                    }
+                }
+            }
+        }
+
+        // the sources are read and preprocessed here, the GL thread only hands them to the driver
+        std::vector<PendingReload> reloads(programs.size());
+        for(size_t i = 0; i < programs.size(); ++i)
+        {
+            reloads[i].program = programs[i];
+            for(const std::string& stage_path : stage_paths[i])
+            {
+                ShaderStageSource stage_source;
+                readShaderStage(stage_path.c_str(), stage_source, &reloads[i].dependencies);
+                reloads[i].stages.push_back(std::move(stage_source));
+            }
+        }
+        ENGINE_INFO("{} shader files changed, reloading {} programs.", changes.size(), programs.size());
+
+        std::lock_guard<std::mutex> lock(m_pending_mutex);
+        for(PendingReload& reload : reloads)
+        {
+            m_pending.push_back(std::move(reload));
+        }
+    }
+}
+
+void OglShaderLibrary::setDependencies(const u32& program, std::vector<std::string> dependencies)
+{
+    // a file included twice is one dependency
+    std::sort(dependencies.begin(), dependencies.end());
+    dependencies.erase(std::unique(dependencies.begin(), dependencies.end()), dependencies.end());
+
+    for(const std::string& file : m_dependencies[program])
+    {
+        std::vector<u32>& dependents = m_dependents[file];
+        dependents.erase(std::remove(dependents.begin(), dependents.end(), program), dependents.end());
+    }
+    for(const std::string& file : dependencies)
+    {
+        m_dependents[file].push_back(program);
+    }
+    m_dependencies[program] = std::move(dependencies);
+}
+
+} // namespace sputnik::graphics::gl
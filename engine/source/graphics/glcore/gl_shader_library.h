@@ -0,0 +1,100 @@
+#pragma once
+
+#include "core/core.h"
+#include "core/io/file_watcher.h"
+#include "gl_shader.h"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace sputnik::graphics::gl
+{
+
+/*!
+ * @brief The shader programs of the renderer, loaded from files, with hot reload.
+ *
+ * @details The library keeps the include graph of its programs, the files every program reads through its stages and
+ * their includes. With hot reload enabled a thread watches these files (see core::FileWatcher) and, when some of them
+ * change, reads and preprocesses the programs that depend on them, and only those. update() hands the new sources to
+ * the driver, which compiles them on its own threads when parallel shader compilation is available, and swaps each
+ * program in once it linked (OglShaderProgram::swap()). A program that fails to compile or link is logged and the
+ * previous version stays in use.
+ *
+ * Only the uniform map of the reloaded program is rebuilt. Uniform locations cached by the users of a program are
+ * refreshed when its generation changes.
+ */
+class OglShaderLibrary
+{
+public:
+    static constexpr u32 kWatchTimeoutMs = 250;
+
+    // editors touch a file several times while saving it, the changes of this window are reloaded together
+    static constexpr u32 kSettleTimeMs = 50;
+
+    OglShaderLibrary();
+    ~OglShaderLibrary();
+
+    NON_COPYABLE(OglShaderLibrary);
+
+    /*!
+     * @brief Creates and configures a program with one stage per file, the stage types are taken from the extensions.
+     */
+    std::shared_ptr<OglShaderProgram> load(const std::string& name, const std::vector<std::string>& stage_paths);
+
+    void setHotReloadEnabled(const bool& enabled);
+    bool isHotReloadEnabled() const;
+
+    /*!
+     * @brief Starts compiling the programs whose files changed and swaps in the ones that finished. Called once per
+     * frame on the GL thread, before the programs are used.
+     */
+    void update();
+
+    u32 getReloadCount() const;
+    u32 getFailedReloadCount() const;
+
+private:
+    struct ProgramEntry
+    {
+        std::string                       name;
+        std::shared_ptr<OglShaderProgram> program;
+        std::unique_ptr<OglShaderProgram> replacement; // compiling, swapped in by update() once it is linked
+    };
+
+    struct PendingReload
+    {
+        u32                            program;
+        std::vector<ShaderStageSource> stages;
+        std::vector<std::string>       dependencies;
+    };
+
+    void watchFiles();
+
+    // m_graph_mutex must be held
+    void setDependencies(const u32& program, std::vector<std::string> dependencies);
+
+private:
+    std::vector<ProgramEntry> m_programs; // GL thread only
+
+    std::mutex                                        m_graph_mutex;
+    std::vector<std::vector<std::string>>             m_stage_paths;  // by program
+    std::vector<std::vector<std::string>>             m_dependencies; // by program, the files it reads
+    std::unordered_map<std::string, std::vector<u32>> m_dependents;   // programs that read a file, directly or not
+
+    core::FileWatcher m_watcher;
+    std::thread       m_watch_thread;
+    std::atomic<bool> m_stopping{false};
+
+    std::mutex                 m_pending_mutex;
+    std::vector<PendingReload> m_pending; // filled by the watch thread
+
+    u32 m_reload_count{0};
+    u32 m_failed_reload_count{0};
+};
+
+} // namespace sputnik::graphics::gl
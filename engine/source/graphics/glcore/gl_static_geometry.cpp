@@ -0,0 +1,109 @@
+#include "pch.h"
+
+#include "gl_static_geometry.h"
+#include "gl_buffer.h"
+#include "gl_vertex_array.h"
+
+namespace sputnik::graphics::gl
+{
+
+OglStaticGeometry::OglStaticGeometry() {}
+
+OglStaticGeometry::~OglStaticGeometry() {}
+
+u32 OglStaticGeometry::addMesh(const std::vector<ramanujan::Vector3>& positions,
+                               const std::vector<ramanujan::Vector3>& normals,
+                               const std::vector<ramanujan::Vector2>& uvs,
+                               const std::vector<u32>&                indices)
+{
+    SPUTNIK_ASSERT(!positions.empty(), "Static mesh without positions.");
+
+    StaticMeshRange range;
+    range.base_vertex = (u32)m_vertices.size();
+    range.first_index = (u32)m_indices.size();
+    range.bounds      = BoundingBox::fromPoints(positions);
+
+    for(size_t i = 0; i < positions.size(); ++i)
+    {
+        StaticVertex vertex{};
+        vertex.position[0] = positions[i].x;
+        vertex.position[1] = positions[i].y;
+        vertex.position[2] = positions[i].z;
+        if(i < normals.size())
+        {
+            vertex.normal[0] = normals[i].x;
+            vertex.normal[1] = normals[i].y;
+            vertex.normal[2] = normals[i].z;
+        }
+        if(i < uvs.size())
+        {
+            vertex.uv[0] = uvs[i].x;
+            vertex.uv[1] = uvs[i].y;
+        }
+        m_vertices.push_back(vertex);
+    }
+
+    // indices stay relative to the mesh, the base vertex of the draw command offsets them
+    if(indices.empty())
+    {
+        for(u32 i = 0; i < (u32)positions.size(); ++i)
+        {
+            m_indices.push_back(i);
+        }
+    }
+    else
+    {
+        m_indices.insert(m_indices.end(), indices.begin(), indices.end());
+    }
+    range.index_count = (u32)m_indices.size() - range.first_index;
+
+    m_meshes.push_back(range);
+    m_is_dirty = true;
+    return (u32)m_meshes.size() - 1;
+}
+
+void OglStaticGeometry::upload()
+{
+    if(!m_is_dirty)
+    {
+        return;
+    }
+
+    // the buffers are immutable, every upload allocates new ones
+    m_vertex_array  = std::make_unique<OglVertexArray>();
+    m_vertex_buffer = std::make_unique<OglBuffer>((void*)m_vertices.data(), m_vertices.size() * sizeof(StaticVertex));
+    m_index_buffer  = std::make_unique<OglBuffer>((void*)m_indices.data(), m_indices.size() * sizeof(u32));
+
+    m_vertex_array->addVertexBuffer(
+        *m_vertex_buffer.get(),
+        {.binding_index = 0, .stride = sizeof(StaticVertex)},
+        {{.name = "position", .location = 0, .type = VertexAttributeType::Float3, .normalized = false},
+         {.name = "normal", .location = 1, .type = VertexAttributeType::Float3, .normalized = false},
+         {.name = "uv", .location = 2, .type = VertexAttributeType::Float2, .normalized = false}});
+    m_vertex_array->setIndexBuffer(*m_index_buffer.get());
+
+    m_is_dirty = false;
+}
+
+bool OglStaticGeometry::isEmpty() const
+{
+    return m_meshes.empty();
+}
+
+u32 OglStaticGeometry::getMeshCount() const
+{
+    return (u32)m_meshes.size();
+}
+
+const StaticMeshRange& OglStaticGeometry::getMesh(const u32& mesh_id) const
+{
+    SPUTNIK_ASSERT(mesh_id < m_meshes.size(), "Unknown static mesh.");
+    return m_meshes[mesh_id];
+}
+
+const OglVertexArray& OglStaticGeometry::getVertexArray() const
+{
+    return *m_vertex_array.get();
+}
+
+} // namespace sputnik::graphics::gl
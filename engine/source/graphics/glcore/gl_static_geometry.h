@@ -0,0 +1,86 @@
+#pragma once
+
+#include "core/core.h"
+#include "graphics/core/geometry/bounds.h"
+
+#include <vector2.h>
+#include <vector3.h>
+
+#include <memory>
+#include <vector>
+
+namespace sputnik::graphics::gl
+{
+
+using sputnik::graphics::core::BoundingBox;
+
+class OglBuffer;
+class OglVertexArray;
+
+/*!
+ * @brief Location of a mesh inside the shared vertex and index buffers of the static geometry.
+ */
+struct StaticMeshRange
+{
+    u32         index_count{0};
+    u32         first_index{0};
+    u32         base_vertex{0};
+    BoundingBox bounds; // object space
+};
+
+/*!
+ * @brief Vertex and index mega-buffers for meshes that never change after they are loaded. All the meshes share a
+ * single vertex array so that they can be drawn with one multi draw indirect call per pass.
+ *
+ * @details Meshes are appended on the CPU and the GPU buffers are rebuilt lazily by upload(), usually during the first
+ * flush after a model has been registered. The vertices are interleaved (position, normal, uv) and match the vertex
+ * inputs of the blinn phong shaders.
+ */
+class OglStaticGeometry
+{
+public:
+    OglStaticGeometry();
+    ~OglStaticGeometry();
+
+    OglStaticGeometry(const OglStaticGeometry&)            = delete;
+    OglStaticGeometry& operator=(const OglStaticGeometry&) = delete;
+
+    /*!
+     * @brief Appends a mesh, normals and uvs are optional. Non indexed meshes get a trivial index list.
+     *
+     * @return Id of the mesh, used to draw it.
+     */
+    u32 addMesh(const std::vector<ramanujan::Vector3>& positions,
+                const std::vector<ramanujan::Vector3>& normals,
+                const std::vector<ramanujan::Vector2>& uvs,
+                const std::vector<u32>&                indices);
+
+    /*!
+     * @brief Rebuilds the GPU buffers if meshes have been added since the last upload.
+     */
+    void upload();
+
+    bool                   isEmpty() const;
+    u32                    getMeshCount() const;
+    const StaticMeshRange& getMesh(const u32& mesh_id) const;
+    const OglVertexArray&  getVertexArray() const;
+
+private:
+    struct StaticVertex
+    {
+        float position[3];
+        float normal[3];
+        float uv[2];
+    };
+
+    std::vector<StaticVertex>    m_vertices;
+    std::vector<u32>             m_indices;
+    std::vector<StaticMeshRange> m_meshes;
+    bool                         m_is_dirty{false};
+
+    std::unique_ptr<OglBuffer>      m_vertex_buffer;
+    std::unique_ptr<OglBuffer>      m_index_buffer;
+    std::unique_ptr<OglVertexArray> m_vertex_array;
+};
+
+} // namespace sputnik::graphics::gl
@@ -1,18 +1,30 @@
 #include "pch.h"
 
 #include "gl_texture.h"
+#include "dds_image.h"
+#include "core/io/mapped_file.h"
+#include "core/profiling/import_profiler.h"
 
 #include <glad/glad.h>
 #include <stb_image.h>
 
+#include <algorithm>
+#include <bit>
+#include <filesystem>
+
 // Useful links:
 // https://www.khronos.org/opengl/wiki/Image_Format
 // https://registry.khronos.org/OpenGL-Refpages/gl4/html/glTexStorage2D.xhtml
 // https://registry.khronos.org/OpenGL-Refpages/gl4/html/glTexSubImage2D.xhtml
+// https://registry.khronos.org/OpenGL/extensions/EXT/EXT_texture_compression_s3tc.txt
 
 namespace sputnik::graphics::gl
 {
 
+// EXT_texture_compression_s3tc is not part of core, so glad does not define its formats
+constexpr u32 kGlCompressedRgbaS3tcDxt1 = 0x83F1;
+constexpr u32 kGlCompressedRgbaS3tcDxt5 = 0x83F3;
+
 static u32 getOglTextureFormat(const TextureFormat& format)
 {
     // Reference: https://registry.khronos.org/OpenGL-Refpages/gl4/html/glTexStorage2D.xhtml
@@ -56,6 +68,14 @@ static u32 getOglTextureFormat(const TextureFormat& format)
         return GL_DEPTH24_STENCIL8;
     case TextureFormat::Depth32FStencil8:
         return GL_DEPTH32F_STENCIL8;
+    case TextureFormat::BC1:
+        return kGlCompressedRgbaS3tcDxt1;
+    case TextureFormat::BC3:
+        return kGlCompressedRgbaS3tcDxt5;
+    case TextureFormat::BC5:
+        return GL_COMPRESSED_RG_RGTC2;
+    case TextureFormat::BC7:
+        return GL_COMPRESSED_RGBA_BPTC_UNORM;
     default:
         break;
     }
@@ -156,6 +176,11 @@ static u32 getOglTextureFilter(const TextureFilter& filter)
     return 0;
 }
 
+static bool usesMipmaps(const TextureFilter& min_filter)
+{
+    return min_filter != TextureFilter::Nearest && min_filter != TextureFilter::Linear;
+}
+
 static u32 getBytesPerPixel(const TextureFormat& format)
 {
     switch(format)
@@ -206,6 +231,10 @@ std::ostream& operator<<(std::ostream& os, const TextureFormat& format)
         SPUTNIK_CASE_TO_OSTREAM(TextureFormat::Depth32F, os);
         SPUTNIK_CASE_TO_OSTREAM(TextureFormat::Depth24Stencil8, os);
         SPUTNIK_CASE_TO_OSTREAM(TextureFormat::Depth32FStencil8, os);
+        SPUTNIK_CASE_TO_OSTREAM(TextureFormat::BC1, os);
+        SPUTNIK_CASE_TO_OSTREAM(TextureFormat::BC3, os);
+        SPUTNIK_CASE_TO_OSTREAM(TextureFormat::BC5, os);
+        SPUTNIK_CASE_TO_OSTREAM(TextureFormat::BC7, os);
         SPUTNIK_CASE_DEFAULT_TO_OSTREAM(os);
     }
     return os;
@@ -226,6 +255,41 @@ std::ostream& operator<<(std::ostream& os, const TextureSwizzle& swizzle)
     return os;
 }
 
+bool isCompressedFormat(const TextureFormat& format)
+{
+    return format == TextureFormat::BC1 || format == TextureFormat::BC3 || format == TextureFormat::BC5 ||
+           format == TextureFormat::BC7;
+}
+
+u32 getFullMipLevelCount(const u32& width, const u32& height)
+{
+    return (u32)std::bit_width(std::max({width, height, 1u}));
+}
+
+u64 getTextureLevelBytes(const TextureFormat& format, const u32& width, const u32& height)
+{
+    if(isCompressedFormat(format))
+    {
+        // 4x4 blocks, partial blocks at the right and bottom edges are stored whole
+        const u64 block_bytes = format == TextureFormat::BC1 ? 8 : 16;
+        return ((u64)width + 3) / 4 * (((u64)height + 3) / 4) * block_bytes;
+    }
+    return (u64)width * height * getBytesPerPixel(format);
+}
+
+bool isTextureFormatSupported(const TextureFormat& format)
+{
+    if(!isCompressedFormat(format))
+    {
+        return true;
+    }
+
+    // RGTC (BC5) and BPTC (BC7) are core, S3TC (BC1, BC3) is an extension that is missing on some drivers
+    GLint supported = GL_FALSE;
+    glGetInternalformativ(GL_TEXTURE_2D, getOglTextureFormat(format), GL_INTERNALFORMAT_SUPPORTED, 1, &supported);
+    return supported == GL_TRUE;
+}
+
 static i32 getOglTextureSwizzle(const TextureSwizzle& swizzle)
 {
     switch(swizzle)
@@ -249,6 +313,23 @@ static i32 getOglTextureSwizzle(const TextureSwizzle& swizzle)
     return 0;
 }
 
+// stbi_load() with the import statistics of the file, the pixels stay allocated until the texture is uploaded
+static unsigned char* loadImage(cstring path, const bool& flip_vertically, int& width, int& height, int& channels)
+{
+    sputnik::core::ImportScope import_scope(path, sputnik::core::ImportStage::DecodeImage);
+
+    stbi_set_flip_vertically_on_load(flip_vertically);
+    unsigned char* data = stbi_load(path, &width, &height, &channels, 0);
+    if(data)
+    {
+        std::error_code error;
+        const u64       file_bytes = (u64)std::filesystem::file_size(path, error);
+        import_scope.addBytesRead(error ? 0 : file_bytes);
+        import_scope.addBytesAllocated((u64)width * height * channels);
+    }
+    return data;
+}
+
 OglTexture2D::OglTexture2D(cstring              texture_filepath,
                            bool                 flip_vertically,
                            const TextureFormat& texture_format,
@@ -262,9 +343,14 @@ OglTexture2D::OglTexture2D(cstring              texture_filepath,
     , m_height{0}
     , m_format{TextureFormat::RGB8}
 {
-    int width, height, channels;
-    stbi_set_flip_vertically_on_load(flip_vertically);
-    unsigned char* data = stbi_load(texture_filepath, &width, &height, &channels, 0);
+    if(DdsImage::isDdsFile(texture_filepath))
+    {
+        initFromDds(texture_filepath, r_wrap, s_wrap, t_wrap, min_filter, mag_filter);
+        return;
+    }
+
+    int            width, height, channels;
+    unsigned char* data = loadImage(texture_filepath, flip_vertically, width, height, channels);
     SPUTNIK_ASSERT_MESSAGE(data, "Failed to load texture: {}", texture_filepath);
     switch(channels)
     {
@@ -287,6 +373,9 @@ OglTexture2D::OglTexture2D(cstring              texture_filepath,
     m_width  = width;
     m_height = height;
     // m_format = texture_format;
+
+    sputnik::core::ImportScope import_scope(texture_filepath, sputnik::core::ImportStage::Upload);
+    import_scope.addBytesUploaded(getTextureLevelBytes(m_format, m_width, m_height));
     init(data, r_wrap, s_wrap, t_wrap, min_filter, mag_filter);
 }
 
@@ -350,6 +439,7 @@ OglTexture2D& OglTexture2D::operator=(OglTexture2D&& other) noexcept
         m_width    = other.m_width;
         m_height   = other.m_height;
         m_format   = other.m_format;
+        m_levels   = other.m_levels;
         other.m_id = 0;
     }
     return *this;
@@ -363,6 +453,86 @@ void OglTexture2D::setData(void* data, const u32& size) const
                            expected_size,
                            size);
     glTextureSubImage2D(m_id, 0, 0, 0, m_width, m_height, getOglTextureDataFormat(m_format), GL_UNSIGNED_BYTE, data);
+    generateMipmaps();
+}
+
+void OglTexture2D::setLevelData(const u32& level, const void* data) const
+{
+    SPUTNIK_ASSERT(level < m_levels, "Texture level out of range.");
+
+    const u32 width  = std::max(m_width >> level, 1u);
+    const u32 height = std::max(m_height >> level, 1u);
+    if(isCompressedFormat(m_format))
+    {
+        glCompressedTextureSubImage2D(m_id,
+                                      level,
+                                      0,
+                                      0,
+                                      width,
+                                      height,
+                                      getOglTextureFormat(m_format),
+                                      (GLsizei)getTextureLevelBytes(m_format, width, height),
+                                      data);
+        return;
+    }
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTextureSubImage2D(m_id, level, 0, 0, width, height, getOglTextureDataFormat(m_format), GL_UNSIGNED_BYTE, data);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+}
+
+void OglTexture2D::setRowsFromBuffer(const u32& unpack_buffer,
+                                     const u64& offset,
+                                     const u32& first_row,
+                                     const u32& row_count,
+                                     const u32& level) const
+{
+    SPUTNIK_ASSERT(level < m_levels, "Texture level out of range.");
+
+    const u32 width  = std::max(m_width >> level, 1u);
+    const u32 height = std::max(m_height >> level, 1u);
+    SPUTNIK_ASSERT(first_row + row_count <= height, "Texture rows out of range.");
+
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, unpack_buffer);
+    if(isCompressedFormat(m_format))
+    {
+        SPUTNIK_ASSERT(first_row % 4 == 0 && (row_count % 4 == 0 || first_row + row_count == height),
+                       "Compressed texture rows must cover whole blocks.");
+        glCompressedTextureSubImage2D(m_id,
+                                      level,
+                                      0,
+                                      first_row,
+                                      width,
+                                      row_count,
+                                      getOglTextureFormat(m_format),
+                                      (GLsizei)getTextureLevelBytes(m_format, width, row_count),
+                                      (const void*)offset);
+    }
+    else
+    {
+        // the rows are tightly packed, RGB8 rows are not a multiple of the default four byte alignment
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glTextureSubImage2D(m_id,
+                            level,
+                            0,
+                            first_row,
+                            width,
+                            row_count,
+                            getOglTextureDataFormat(m_format),
+                            GL_UNSIGNED_BYTE,
+                            (const void*)offset);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+}
+
+void OglTexture2D::generateMipmaps() const
+{
+    // compressed formats are not renderable, their chains come with the file
+    if(m_levels > 1 && !isCompressedFormat(m_format))
+    {
+        glGenerateTextureMipmap(m_id);
+    }
 }
 
 void OglTexture2D::setFiltering(const TextureFilter& min_filter, const TextureFilter& mag_filter) const
@@ -392,6 +562,26 @@ const u32& OglTexture2D::getId() const
     return m_id;
 }
 
+u32 OglTexture2D::getWidth() const
+{
+    return m_width;
+}
+
+u32 OglTexture2D::getHeight() const
+{
+    return m_height;
+}
+
+TextureFormat OglTexture2D::getFormat() const
+{
+    return m_format;
+}
+
+u32 OglTexture2D::getMipLevelCount() const
+{
+    return m_levels;
+}
+
 void OglTexture2D::init(void*                data,
                         const TextureWrap&   r_wrap,
                         const TextureWrap&   s_wrap,
@@ -404,7 +594,11 @@ void OglTexture2D::init(void*                data,
     glTextureParameteri(m_id, GL_TEXTURE_MAG_FILTER, getOglTextureFilter(mag_filter));
     glTextureParameteri(m_id, GL_TEXTURE_WRAP_S, getOglTextureWrap(s_wrap));
     glTextureParameteri(m_id, GL_TEXTURE_WRAP_T, getOglTextureWrap(s_wrap));
-    glTextureStorage2D(m_id, 1, getOglTextureFormat(m_format), m_width, m_height);
+    if(m_levels == 0)
+    {
+        m_levels = usesMipmaps(min_filter) ? getFullMipLevelCount(m_width, m_height) : 1;
+    }
+    glTextureStorage2D(m_id, m_levels, getOglTextureFormat(m_format), m_width, m_height);
     if(data)
     {
         glTextureSubImage2D(m_id,
@@ -416,6 +610,7 @@ void OglTexture2D::init(void*                data,
                             getOglTextureDataFormat(m_format),
                             GL_UNSIGNED_BYTE,
                             data);
+        generateMipmaps();
     }
 }
 
@@ -425,8 +620,7 @@ void OglTexture2D::init(const TextureSpecification& spec)
     if(spec.texture_filepath)
     {
         int width, height, channels;
-        stbi_set_flip_vertically_on_load(spec.flip_vertically);
-        data = stbi_load(spec.texture_filepath, &width, &height, &channels, 0);
+        data = loadImage(spec.texture_filepath, spec.flip_vertically, width, height, channels);
         SPUTNIK_ASSERT_MESSAGE(data, "Failed to load texture: {}", spec.texture_filepath);
         switch(channels)
         {
@@ -470,9 +664,18 @@ void OglTexture2D::init(const TextureSpecification& spec)
     };
     glTextureParameteriv(m_id, GL_TEXTURE_SWIZZLE_RGBA, swizzle);
 
-    glTextureStorage2D(m_id, 1, getOglTextureFormat(m_format), m_width, m_height);
+    m_levels = usesMipmaps(spec.min_filter) ? getFullMipLevelCount(m_width, m_height) : 1;
+    if(spec.mip_levels > 0)
+    {
+        m_levels = std::min(spec.mip_levels, getFullMipLevelCount(m_width, m_height));
+    }
+    glTextureStorage2D(m_id, m_levels, getOglTextureFormat(m_format), m_width, m_height);
     if(data)
     {
+        // a texture created from memory is an upload of the asset being imported, if any
+        sputnik::core::ImportScope import_scope(spec.texture_filepath ? spec.texture_filepath : "",
+                                                sputnik::core::ImportStage::Upload);
+        import_scope.addBytesUploaded(getTextureLevelBytes(m_format, m_width, m_height));
         glTextureSubImage2D(m_id,
                             0,
                             0,
@@ -482,6 +685,60 @@ void OglTexture2D::init(const TextureSpecification& spec)
                             getOglTextureDataFormat(m_format),
                             GL_UNSIGNED_BYTE,
                             data);
+        generateMipmaps();
+    }
+}
+
+void OglTexture2D::initFromDds(cstring              texture_filepath,
+                               const TextureWrap&   r_wrap,
+                               const TextureWrap&   s_wrap,
+                               const TextureWrap&   t_wrap,
+                               const TextureFilter& min_filter,
+                               const TextureFilter& mag_filter)
+{
+    sputnik::core::MappedFile file;
+    DdsImage                  image;
+    bool                      loaded = false;
+    {
+        // the file is mapped, its pages are read as the levels are uploaded
+        sputnik::core::ImportScope import_scope(texture_filepath, sputnik::core::ImportStage::DecodeImage);
+        loaded = file.open(texture_filepath) && image.parse(file.getBytes(), texture_filepath);
+        import_scope.addBytesRead(loaded ? file.getBytes().size() : 0);
+    }
+    SPUTNIK_ASSERT_MESSAGE(loaded, "Failed to load texture: {}", texture_filepath);
+
+    // the chain of the file is used as is, a compressed chain can not be generated on the GPU
+    const bool decode = !isTextureFormatSupported(image.getFormat());
+    m_width           = image.getWidth();
+    m_height          = image.getHeight();
+    m_format          = decode ? TextureFormat::RGBA8 : image.getFormat();
+    m_levels          = image.getLevelCount();
+    if(decode)
+    {
+        ENGINE_WARN("{} is not supported by the driver, {} is decoded on the CPU.",
+                    image.getFormat(),
+                    texture_filepath);
+    }
+
+    sputnik::core::ImportScope import_scope(texture_filepath, sputnik::core::ImportStage::Upload);
+    init(nullptr, r_wrap, s_wrap, t_wrap, min_filter, mag_filter);
+    for(u32 level = 0; level < m_levels; ++level)
+    {
+        import_scope.addBytesUploaded(
+            getTextureLevelBytes(m_format, std::max(m_width >> level, 1u), std::max(m_height >> level, 1u)));
+        if(decode)
+        {
+            const std::vector<u8> pixels = decodeBlocks(image.getFormat(),
+                                                        image.getLevel(level),
+                                                        std::max(m_width >> level, 1u),
+                                                        std::max(m_height >> level, 1u));
+            SPUTNIK_ASSERT_MESSAGE(!pixels.empty(), "Failed to decode texture: {}", texture_filepath);
+            setLevelData(level, pixels.data());
+        }
+        else
+        {
+            setLevelData(level, image.getLevel(level).data());
+        }
     }
 }
 
@@ -26,7 +26,11 @@ enum class TextureFormat : u32
     Depth32,
     Depth32F,
     Depth24Stencil8,
-    Depth32FStencil8
+    Depth32FStencil8,
+    BC1, // RGB with 1 bit alpha, 4 bits per pixel
+    BC3, // RGBA, 8 bits per pixel
+    BC5, // RG, 8 bits per pixel
+    BC7  // RGBA, 8 bits per pixel
 };
 
 enum class TextureWrap : u32
@@ -63,6 +67,16 @@ enum class TextureSwizzle : i32
 std::ostream& operator<<(std::ostream& os, const TextureFormat& format);
 std::ostream& operator<<(std::ostream& os, const TextureSwizzle& format);
 
+bool isCompressedFormat(const TextureFormat& format);
+u32  getFullMipLevelCount(const u32& width, const u32& height);
+u64  getTextureLevelBytes(const TextureFormat& format, const u32& width, const u32& height);
+
+/*!
+ * @brief Whether the driver can sample textures of the format. Uncompressed formats are always supported. GL thread
+ * only.
+ */
+bool isTextureFormatSupported(const TextureFormat& format);
+
 struct TextureSpecification
 {
     u32            width;
@@ -80,8 +94,16 @@ struct TextureSpecification
     TextureSwizzle b_swizzle       = TextureSwizzle::Blue;
     TextureSwizzle a_swizzle       = TextureSwizzle::Alpha;
     bool           flip_vertically = false;
+    u32            mip_levels      = 0; // 0 allocates the full chain when min_filter samples mipmaps, otherwise 1
 };
 
+/*!
+ * @brief An immutable 2D texture.
+ *
+ * @details Textures whose min filter samples mipmaps get a full mip chain, it is generated from level 0 whenever level
+ * 0 is set. Textures loaded from a .dds file keep the block compressed levels stored in the file (see DdsImage), they
+ * are decoded to RGBA8 when the driver does not support the format.
+ */
 class OglTexture2D
 {
 public:
@@ -91,7 +113,7 @@ public:
                  const TextureWrap&   r_wrap          = TextureWrap::Repeat,
                  const TextureWrap&   s_wrap          = TextureWrap::Repeat,
                  const TextureWrap&   t_wrap          = TextureWrap::Repeat,
-                 const TextureFilter& min_filter      = TextureFilter::Linear,
+                 const TextureFilter& min_filter      = TextureFilter::LinearMipmapLinear,
                  const TextureFilter& mag_filter      = TextureFilter::Nearest);
 
     OglTexture2D(const u32&           width,
@@ -121,13 +143,39 @@ public:
     OglTexture2D& operator=(OglTexture2D&& other) noexcept;
 
     void setData(void* data, const u32& size) const;
+
+    /*!
+     * @brief Uploads a whole level, tightly packed pixels or blocks in the format of the texture. The chain is not
+     * regenerated.
+     */
+    void setLevelData(const u32& level, const void* data) const;
+
+    /*!
+     * @brief Uploads the rows [first_row, first_row + row_count) of a level from a pixel unpack buffer. The rows are
+     * tightly packed at offset in the buffer. Compressed levels are uploaded in rows of blocks, first_row must be a
+     * multiple of 4 and row_count too unless the rows reach the bottom of the level.
+     */
+    void setRowsFromBuffer(const u32& unpack_buffer,
+                           const u64& offset,
+                           const u32& first_row,
+                           const u32& row_count,
+                           const u32& level = 0) const;
+
+    /*!
+     * @brief Regenerates levels 1 and up from level 0. Does nothing for textures without a chain or compressed ones.
+     */
+    void generateMipmaps() const;
     void setFiltering(const TextureFilter& min_filter, const TextureFilter& mag_filter) const;
     void setWrapping(const TextureWrap& s_wrap, const TextureWrap& t_wrap) const;
 
     void bind(const u32& slot = 0) const;
     void unbind(const u32& slot = 0);
 
-    const u32& getId() const;
+    const u32&    getId() const;
+    u32           getWidth() const;
+    u32           getHeight() const;
+    TextureFormat getFormat() const;
+    u32           getMipLevelCount() const;
 
 private:
     OglTexture2D(const OglTexture2D&)            = delete;
@@ -141,12 +189,19 @@ private:
               const TextureFilter& mag_filter);
 
     void init(const TextureSpecification& spec);
+    void initFromDds(cstring              texture_filepath,
+                     const TextureWrap&   r_wrap,
+                     const TextureWrap&   s_wrap,
+                     const TextureWrap&   t_wrap,
+                     const TextureFilter& min_filter,
+                     const TextureFilter& mag_filter);
 
 private:
     u32           m_id;
     u32           m_width;
     u32           m_height;
     TextureFormat m_format;
+    u32           m_levels{0};
 };
 
 } // namespace sputnik::graphics::gl
@@ -43,6 +43,11 @@ cstring attributeTypeToString(const VertexAttributeType& type)
         SPUTNIK_CASE_TO_STRING(VertexAttributeType::Int3);
         SPUTNIK_CASE_TO_STRING(VertexAttributeType::Int4);
         SPUTNIK_CASE_TO_STRING(VertexAttributeType::Bool);
+        SPUTNIK_CASE_TO_STRING(VertexAttributeType::Short2);
+        SPUTNIK_CASE_TO_STRING(VertexAttributeType::UShort4);
+        SPUTNIK_CASE_TO_STRING(VertexAttributeType::Half2);
+        SPUTNIK_CASE_TO_STRING(VertexAttributeType::UByte4);
+        SPUTNIK_CASE_TO_STRING(VertexAttributeType::UByteInt4);
     }
     return "Unknown";
 }
@@ -57,7 +62,12 @@ std::unordered_map<VertexAttributeType, u32> kAttributeTypeToSize = {{VertexAttr
                                                                      {VertexAttributeType::Int4, 4 * 4},
                                                                      {VertexAttributeType::Mat3, 3 * 3 * 4},
                                                                      {VertexAttributeType::Mat4, 4 * 4 * 4},
-                                                                     {VertexAttributeType::Bool, 1}};
+                                                                     {VertexAttributeType::Bool, 1},
+                                                                     {VertexAttributeType::Short2, 2 * 2},
+                                                                     {VertexAttributeType::UShort4, 4 * 2},
+                                                                     {VertexAttributeType::Half2, 2 * 2},
+                                                                     {VertexAttributeType::UByte4, 4},
+                                                                     {VertexAttributeType::UByteInt4, 4}};
 
 std::unordered_map<VertexAttributeType, u32> kAttributeTypeToComponentCount = {{VertexAttributeType::Float, 1},
                                                                                {VertexAttributeType::Float2, 2},
@@ -69,7 +79,12 @@ std::unordered_map<VertexAttributeType, u32> kAttributeTypeToComponentCount = {{
                                                                                {VertexAttributeType::Int4, 4},
                                                                                {VertexAttributeType::Mat3, 3 * 3},
                                                                                {VertexAttributeType::Mat4, 4 * 4},
-                                                                               {VertexAttributeType::Bool, 1}};
+                                                                               {VertexAttributeType::Bool, 1},
+                                                                               {VertexAttributeType::Short2, 2},
+                                                                               {VertexAttributeType::UShort4, 4},
+                                                                               {VertexAttributeType::Half2, 2},
+                                                                               {VertexAttributeType::UByte4, 4},
+                                                                               {VertexAttributeType::UByteInt4, 4}};
 
 std::unordered_map<VertexAttributeType, u32> kAttributeTypeToGlType = {{VertexAttributeType::Float, GL_FLOAT},
                                                                        {VertexAttributeType::Float2, GL_FLOAT},
@@ -81,7 +96,14 @@ std::unordered_map<VertexAttributeType, u32> kAttributeTypeToGlType = {{VertexAt
                                                                        {VertexAttributeType::Int4, GL_INT},
                                                                        {VertexAttributeType::Mat3, GL_FLOAT},
                                                                        {VertexAttributeType::Mat4, GL_FLOAT},
-                                                                       {VertexAttributeType::Bool, GL_BOOL}};
+                                                                       {VertexAttributeType::Bool, GL_BOOL},
+                                                                       {VertexAttributeType::Short2, GL_SHORT},
+                                                                       {VertexAttributeType::UShort4,
+                                                                        GL_UNSIGNED_SHORT},
+                                                                       {VertexAttributeType::Half2, GL_HALF_FLOAT},
+                                                                       {VertexAttributeType::UByte4, GL_UNSIGNED_BYTE},
+                                                                       {VertexAttributeType::UByteInt4,
+                                                                        GL_UNSIGNED_BYTE}};
 
 inline u32 getAttributeSize(VertexAttributeType type)
 {
@@ -115,6 +137,19 @@ inline u32 getOglType(VertexAttributeType type)
     return itr->second;
 }
 
+// attributes the shaders read as integers, their format is set with glVertexArrayAttribIFormat
+inline bool isIntegerType(VertexAttributeType type)
+{
+    return type == VertexAttributeType::Int || type == VertexAttributeType::Int2 || type == VertexAttributeType::Int3 ||
+           type == VertexAttributeType::Int4 || type == VertexAttributeType::UByteInt4;
+}
+
+bool VertexDecode::isIdentity() const
+{
+    return !octahedral_normals && position_scale.x == 1.0f && position_scale.y == 1.0f && position_scale.z == 1.0f &&
+           position_offset.x == 0.0f && position_offset.y == 0.0f && position_offset.z == 0.0f;
+}
+
 OglVertexArray::OglVertexArray() : m_id{0}, m_next_slot_index{0}
 {
     glGenVertexArrays(1, &m_id);
@@ -188,12 +223,24 @@ void OglVertexArray::addVertexBuffer(
         //                          getOglType(specification.type),
         //                          specification.normalized ? GL_TRUE : GL_FALSE,
         //                          offset);
-        glVertexArrayAttribFormat(m_id,
-                                  m_next_slot_index,
-                                  getComponentCount(specification.type),
-                                  getOglType(specification.type),
-                                  specification.normalized ? GL_TRUE : GL_FALSE,
-                                  offset);
+        // Integer attributes keep their values, glVertexArrayAttribFormat would convert them to floats.
+        if(isIntegerType(specification.type))
+        {
+            glVertexArrayAttribIFormat(m_id,
+                                       m_next_slot_index,
+                                       getComponentCount(specification.type),
+                                       getOglType(specification.type),
+                                       offset);
+        }
+        else
+        {
+            glVertexArrayAttribFormat(m_id,
+                                      m_next_slot_index,
+                                      getComponentCount(specification.type),
+                                      getOglType(specification.type),
+                                      specification.normalized ? GL_TRUE : GL_FALSE,
+                                      offset);
+        }
 
         // Bind the attribute stream at the specified slot index to the specified binding index.
         // glVertexArrayAttribBinding(m_id, slot_index, binding_specification.binding_index);
@@ -212,13 +259,29 @@ void OglVertexArray::addVertexBuffer(
     unbind();
 }
 
-void OglVertexArray::setIndexBuffer(const OglBuffer& buffer)
+void OglVertexArray::setIndexBuffer(const OglBuffer& buffer, const IndexType& index_type)
 {
     // Reference:
     // https://registry.khronos.org/OpenGL-Refpages/gl4/html/glVertexArrayElementBuffer.xhtml
     bind();
     glVertexArrayElementBuffer(m_id, buffer.getId());
     unbind();
+    m_index_type = index_type;
+}
+
+const IndexType& OglVertexArray::getIndexType() const
+{
+    return m_index_type;
+}
+
+void OglVertexArray::setVertexDecode(const VertexDecode& decode)
+{
+    m_vertex_decode = decode;
+}
+
+const VertexDecode& OglVertexArray::getVertexDecode() const
+{
+    return m_vertex_decode;
 }
 
 } // namespace sputnik::graphics::gl
\ No newline at end of file
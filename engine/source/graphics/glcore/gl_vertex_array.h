@@ -23,7 +23,18 @@ enum class VertexAttributeType : u32
     Int2,
     Int3,
     Int4,
-    Bool
+    Bool,
+    Short2,   // read as floats, normalized to [-1, 1] when the attribute is normalized
+    UShort4,  // read as floats, normalized to [0, 1] when the attribute is normalized
+    Half2,    // read as floats
+    UByte4,   // read as floats, normalized to [0, 1] when the attribute is normalized
+    UByteInt4 // read as integers, like Int4
+};
+
+enum class IndexType : u8
+{
+    UnsignedShort,
+    UnsignedInt
 };
 
 cstring attributeTypeToString(const VertexAttributeType& type);
@@ -44,6 +55,20 @@ struct Vertex
     //}
 };
 
+/*!
+ * @brief How the vertex shaders decode the streams of a vertex array (see vertex_decode.glsl). Packed positions are
+ * unorm16 in the bounds of the mesh and are decoded to position_offset + position_scale * position, packed normals are
+ * octahedral snorm16 pairs. The default decodes full precision streams.
+ */
+struct VertexDecode
+{
+    vec3 position_scale{1.0f, 1.0f, 1.0f};
+    vec3 position_offset{0.0f, 0.0f, 0.0f};
+    bool octahedral_normals{false};
+
+    bool isIdentity() const;
+};
+
 struct VertexInputBindingSpecification
 {
     u32 binding_index;
@@ -77,15 +102,27 @@ public:
                          const VertexInputBindingSpecification&                          buffer_specification,
                          const std::initializer_list<VertexInputAttributeSpecification>& attribute_specifications);
 
-    void setIndexBuffer(const OglBuffer& buffer);
+    /*!
+     * @brief Sets the element buffer. The vertex array remembers the type of its indices for the draws that use it.
+     */
+    void             setIndexBuffer(const OglBuffer& buffer, const IndexType& index_type = IndexType::UnsignedInt);
+    const IndexType& getIndexType() const;
+
+    /*!
+     * @brief The vertex array remembers how its streams are packed, the draws that use it capture the decode.
+     */
+    void                setVertexDecode(const VertexDecode& decode);
+    const VertexDecode& getVertexDecode() const;
 
 private:
     OglVertexArray(const OglVertexArray&)            = delete;
     OglVertexArray& operator=(const OglVertexArray&) = delete;
 
 private:
-    u32 m_id;
-    u32 m_next_slot_index;
+    u32          m_id;
+    u32          m_next_slot_index;
+    IndexType    m_index_type{IndexType::UnsignedInt};
+    VertexDecode m_vertex_decode;
 };
 
 } // namespace sputnik::graphics::gl
\ No newline at end of file
@@ -1,9 +1,13 @@
 #include "pch.h"
 #include "gltf_loader.h"
 #include "graphics/core/animation/track.h"
+#include "core/profiling/import_profiler.h"
 
 #include <transform.h>
 
+#include <cstring>
+#include <filesystem>
+
 namespace sputnik
 {
 
@@ -269,10 +273,26 @@ void MeshFromAttribute(sputnik::graphics::core::Mesh& out_mesh,
 
 } // End of MeshFromAttribute()
 
+u64 GetMeshBytes(Mesh& mesh)
+{
+    return mesh.GetPosition().size() * sizeof(Vector3) + mesh.GetNormal().size() * sizeof(Vector3) +
+           mesh.GetTexCoord().size() * sizeof(Vector2) + mesh.GetWeights().size() * sizeof(Vector4) +
+           mesh.GetInfluences().size() * sizeof(IVector4) + mesh.GetIndices().size() * sizeof(unsigned int);
+}
+
 } // namespace helper
 
+std::string GltfLoader::GetFilePath(Data* data)
+{
+    std::lock_guard<std::mutex> lock(m_file_paths_mutex);
+    const auto                  file_path = m_file_paths.find(data);
+    return file_path != m_file_paths.end() ? file_path->second : std::string();
+}
+
 Data* GltfLoader::LoadFile(const char* path)
 {
+    sputnik::core::ImportScope import_scope(path, sputnik::core::ImportStage::ParseFile);
+
     cgltf_options options;
     memset(&options, 0, sizeof(cgltf_options));
     Data* data = NULL;
@@ -292,6 +312,25 @@ Data* GltfLoader::LoadFile(const char* path)
         return 0;
     }
 
+    // cgltf keeps the file in memory until FreeFile(), together with the buffers cgltf_load_buffers() reads or decodes
+    std::error_code error;
+    const u64       file_bytes = (u64)std::filesystem::file_size(path, error);
+    import_scope.addBytesRead(error ? 0 : file_bytes);
+    import_scope.addBytesAllocated(error ? 0 : file_bytes);
+    for(size_t i = 0; i < data->buffers_count; ++i)
+    {
+        const cgltf_buffer& buffer = data->buffers[i];
+        if(buffer.uri == 0)
+        {
+            continue; // the binary chunk of a .glb, part of the file
+        }
+        import_scope.addBytesAllocated(buffer.size);
+        if(strncmp(buffer.uri, "data:", 5) != 0)
+        {
+            import_scope.addBytesRead(buffer.size);
+        }
+    }
+
     result = cgltf_validate(data); // validate the gltf file just loaded
     if(result != cgltf_result_success)
     {
@@ -299,6 +338,9 @@ Data* GltfLoader::LoadFile(const char* path)
         // assert() // "Invalid file"
         return 0;
     }
+
+    std::lock_guard<std::mutex> lock(m_file_paths_mutex);
+    m_file_paths[data] = path;
     return data;
 }
 
@@ -310,6 +352,10 @@ void GltfLoader::FreeFile(Data* data)
     }
     else
     {
+        {
+            std::lock_guard<std::mutex> lock(m_file_paths_mutex);
+            m_file_paths.erase(data);
+        }
         cgltf_free(data);
     }
 }
@@ -317,6 +363,8 @@ void GltfLoader::FreeFile(Data* data)
 void GltfLoader::LoadAnimationClips(Data*                                                data,
                                     std::vector<sputnik::graphics::core::AnimationClip>& out_animation_clips)
 {
+    sputnik::core::ImportScope import_scope(GetFilePath(data), sputnik::core::ImportStage::LoadAnimationClips);
+
     size_t num_clips = data->animations_count;
     size_t num_nodes = data->nodes_count;
 
@@ -335,16 +383,19 @@ void GltfLoader::LoadAnimationClips(Data*
             {
                 VectorTrack& track = out_animation_clips[i][node_id].GetPositionTrack();
                 helper::CreateTrackFromChannel<Vector3, 3>(track, channel);
+                import_scope.addBytesAllocated(track.GetSize() * sizeof(VectorFrame));
             }
             else if(channel.target_path == cgltf_animation_path_type_scale)
             {
                 VectorTrack& track = out_animation_clips[i][node_id].GetScaleTrack();
                 helper::CreateTrackFromChannel<Vector3, 3>(track, channel);
+                import_scope.addBytesAllocated(track.GetSize() * sizeof(VectorFrame));
             }
             else if(channel.target_path == cgltf_animation_path_type_rotation)
             {
                 QuaternionTrack& track = out_animation_clips[i][node_id].GetRotationTrack();
                 helper::CreateTrackFromChannel<Quaternion, 4>(track, channel);
+                import_scope.addBytesAllocated(track.GetSize() * sizeof(QuaternionFrame));
             }
         } // channel loop ends
 
@@ -456,11 +507,21 @@ sputnik::graphics::core::Pose GltfLoader::LoadBindPose(Data* data)
 
 sputnik::graphics::core::Skeleton GltfLoader::LoadSkeleton(Data* data)
 {
-    return sputnik::graphics::core::Skeleton(LoadRestPose(data), LoadBindPose(data), LoadJointNanes(data));
+    sputnik::core::ImportScope import_scope(GetFilePath(data), sputnik::core::ImportStage::LoadSkeleton);
+
+    sputnik::graphics::core::Skeleton skeleton(LoadRestPose(data), LoadBindPose(data), LoadJointNanes(data));
+
+    // every joint has a transform and a parent in both poses, an inverse bind matrix and a name
+    const u64 joint_count = skeleton.GetJointNames().size();
+    import_scope.addBytesAllocated(
+        joint_count * (2 * (sizeof(ramanujan::Transform) + sizeof(int)) + sizeof(Matrix4) + sizeof(std::string)));
+    return skeleton;
 }
 
 std::vector<sputnik::graphics::core::Mesh> GltfLoader::LoadMeshes(Data* data)
 {
+    sputnik::core::ImportScope import_scope(GetFilePath(data), sputnik::core::ImportStage::LoadMeshes);
+
     std::vector<sputnik::graphics::core::Mesh> result;
     Node*                                      nodes      = data->nodes;
     size_t                                     node_count = data->nodes_count;
@@ -502,7 +563,9 @@ std::vector<sputnik::graphics::core::Mesh> GltfLoader::LoadMeshes(Data* data)
                 }
             }
 
+            mesh.computeBounds();
             mesh.initializeGpuBuffers();
+            import_scope.addBytesAllocated(helper::GetMeshBytes(mesh));
             //mesh.ResetOpenglBuffersToBindPose();
         }
     }
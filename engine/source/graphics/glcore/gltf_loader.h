@@ -8,6 +8,10 @@
 #include "graphics/core/animation/skeleton.h"
 #include "graphics/core/geometry/mesh.h"
 
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
 // Todo: Major refactoring required. This class needs a major upgrade.
 namespace sputnik::gltf
 {
@@ -31,6 +35,13 @@ public:
     static sputnik::graphics::core::Skeleton          LoadSkeleton(Data* data);
     static std::vector<sputnik::graphics::core::Mesh> LoadMeshes(Data* data);
     static std::vector<sputnik::graphics::core::Mesh> LoadStaticMeshes(cgltf_data* data);
+
+private:
+    static std::string GetFilePath(Data* data);
+
+    // the files opened with LoadFile(), the other loaders report their import statistics to the file they read
+    inline static std::mutex                                   m_file_paths_mutex;
+    inline static std::unordered_map<const Data*, std::string> m_file_paths;
 };
 
 } // namespace sputnik::gltf
\ No newline at end of file
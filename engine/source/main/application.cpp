@@ -4,6 +4,8 @@
 #include "core/layers/layer.h"
 #include "core/systems/render_system.h"
 #include "core/systems/physics_system.h"
+#include "core/profiling/profiler.h"
+#include "graphics/api/asset_manager.h"
 
 #include <GLFW/glfw3.h>
 
@@ -32,41 +34,64 @@ Application::Application(const std::string& application_name)
     m_editor = sputnik::editor::Editor::getInstance();
 }
 
-Application::~Application() {}
+Application::~Application()
+{
+    // the cache owns GL objects, they are released while the window and its context are still alive
+    graphics::api::AssetManager::getInstance()->shutdown();
+}
 
 void Application::Run()
 {
     m_render_system->setClearColor(0.16f, 0.16f, 0.16f, 1.00f);
+    core::Profiler*              profiler      = core::Profiler::getInstance();
+    graphics::api::AssetManager* asset_manager = graphics::api::AssetManager::getInstance();
     while(m_is_running)
     {
+        profiler->beginFrame();
+
         float          time      = (float)glfwGetTime();
         core::TimeStep time_step = time - m_last_frame_time;
         m_last_frame_time        = time;
 
         m_render_system->clear();
 
+        // assets that finished loading in the background are uploaded before the layers update, so they can be used
+        // in the same frame
+        asset_manager->update();
+
         if(!m_is_minimized)
         {
             m_editor->beginViewportFrame();
-            m_physics_system->simulatePhysics(time_step);
-            m_render_system->update(time_step);
-            for(const std::shared_ptr<core::Layer>& layer : m_application_layer_stack)
             {
-                layer->OnPreUpdate(time_step);
+                SPUTNIK_PROFILE_SCOPE("Physics");
+                m_physics_system->simulatePhysics(time_step);
             }
-
-            for(const std::shared_ptr<core::Layer>& layer : m_application_layer_stack)
             {
-                layer->OnUpdate(time_step);
+                SPUTNIK_PROFILE_SCOPE("Render system update");
+                m_render_system->update(time_step);
             }
-
-            for(const std::shared_ptr<core::Layer>& layer : m_application_layer_stack)
             {
-                layer->OnPostUpdate(time_step);
+                SPUTNIK_PROFILE_SCOPE("Layer update");
+                for(const std::shared_ptr<core::Layer>& layer : m_application_layer_stack)
+                {
+                    layer->OnPreUpdate(time_step);
+                }
+
+                for(const std::shared_ptr<core::Layer>& layer : m_application_layer_stack)
+                {
+                    layer->OnUpdate(time_step);
+                }
+
+                for(const std::shared_ptr<core::Layer>& layer : m_application_layer_stack)
+                {
+                    layer->OnPostUpdate(time_step);
+                }
             }
+            m_render_system->flush();
             m_editor->endViewportFrame();
 
-            // UI pass
+            // UI pass, the frame is presented at the end of it (lateUpdate swaps the buffers)
+            SPUTNIK_PROFILE_SCOPE("UI and present");
             m_editor->beginFrame();
             m_editor->update(time_step);
             if(m_editor->isViewportActive())
@@ -94,6 +119,8 @@ void Application::Run()
             m_input_manager->LateUpdate(time_step);
             m_render_system->lateUpdate(time_step);
         }
+
+        profiler->endFrame();
     }
 }
 
@@ -1,5 +1,6 @@
 #include "pch.h"
 #include "mass_aggregate_system.hpp"
+#include "physics/physics_snapshot.h"
 
 #include <algorithm>
 #include <execution>
@@ -100,8 +101,11 @@ void MassAggregateSystem::addForce(const unsigned int& index, const vec3& force)
 
 void MassAggregateSystem::update(const real& dt) noexcept
 {
+    sputnik::physics::PhysicsStageTimer timer;
+
     // update spring forces
     updateInternalForces(0.0f, dt);
+    m_last_step_stats.force_seconds = timer.lap();
 
     // integrate
     switch(m_active_integration_method)
@@ -121,10 +125,16 @@ void MassAggregateSystem::update(const real& dt) noexcept
     default:
         break;
     }
+    m_last_step_stats.integrate_seconds = timer.lap();
 
     // collision detection/resolution
 }
 
+const sputnik::physics::PhysicsStepStats& MassAggregateSystem::getLastStepStats() const noexcept
+{
+    return m_last_step_stats;
+}
+
 void MassAggregateSystem::setIntegrationMethod(const IntegrationMethod& method) noexcept
 {
     m_active_integration_method = method;
@@ -141,6 +151,65 @@ void MassAggregateSystem::registerForceGenerator(
     m_force_generators.push_back(force_generator);
 }
 
+std::vector<uint8_t> MassAggregateSystem::saveSnapshot() const noexcept
+{
+    sputnik::physics::SnapshotWriter writer(sputnik::physics::SnapshotType::MassAggregateSystem);
+
+    writer.write(m_active_integration_method);
+    writer.writeArray(m_masses);
+    writer.writeArray(m_positions);
+    writer.writeArray(m_velocities);
+    writer.writeArray(m_accelerations);
+    writer.writeArray(m_damping_values);
+    writer.writeArray(m_inverse_masses);
+    writer.writeArray(m_accumulated_forces);
+    writer.writeArray(m_is_fixed);
+
+    return writer.release();
+}
+
+bool MassAggregateSystem::restoreSnapshot(const std::vector<uint8_t>& snapshot) noexcept
+{
+    sputnik::physics::SnapshotReader reader(snapshot, sputnik::physics::SnapshotType::MassAggregateSystem);
+
+    // Decode into scratch copies so that a mismatching snapshot leaves the system untouched.
+    IntegrationMethod integration_method{m_active_integration_method};
+    std::vector<real> masses(m_masses.size());
+    std::vector<vec3> positions(m_positions.size());
+    std::vector<vec3> velocities(m_velocities.size());
+    std::vector<vec3> accelerations(m_accelerations.size());
+    std::vector<real> damping_values(m_damping_values.size());
+    std::vector<real> inverse_masses(m_inverse_masses.size());
+    std::vector<vec3> accumulated_forces(m_accumulated_forces.size());
+    std::vector<bool> is_fixed(m_is_fixed.size());
+
+    reader.read(integration_method);
+    reader.readArray(masses);
+    reader.readArray(positions);
+    reader.readArray(velocities);
+    reader.readArray(accelerations);
+    reader.readArray(damping_values);
+    reader.readArray(inverse_masses);
+    reader.readArray(accumulated_forces);
+    reader.readArray(is_fixed);
+    if(!reader.isComplete())
+    {
+        return false;
+    }
+
+    m_active_integration_method = integration_method;
+    m_masses                    = std::move(masses);
+    m_positions                 = std::move(positions);
+    m_velocities                = std::move(velocities);
+    m_accelerations             = std::move(accelerations);
+    m_damping_values            = std::move(damping_values);
+    m_inverse_masses            = std::move(inverse_masses);
+    m_accumulated_forces        = std::move(accumulated_forces);
+    m_is_fixed                  = std::move(is_fixed);
+
+    return true;
+}
+
 void MassAggregateSystem::integrateExplicitEuler(const real& dt) noexcept
 {
     size_t num_particles = m_masses.size();
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "physics/physics_core.h"
+#include "physics/physics_step_stats.h"
 #include "force_generators.hpp"
 
 #include <precision.h>
@@ -8,6 +9,7 @@
 
 #include <vector>
 #include <functional>
+#include <cstdint>
 
 namespace physics::mad
 {
@@ -62,6 +64,12 @@ public:
 
     void update(const real& dt) noexcept;
 
+    /*!
+     * @brief Per stage timings of the last update() call. The system has no collision stage yet, so the contact timings
+     * are always zero.
+     */
+    [[nodiscard]] const sputnik::physics::PhysicsStepStats& getLastStepStats() const noexcept;
+
     void                                   setIntegrationMethod(const IntegrationMethod& method) noexcept;
     [[nodiscard]] const IntegrationMethod& getIntegrationMethod() const noexcept;
 
@@ -70,6 +78,23 @@ public:
     // register callbacks for the force generators
     void registerForceGenerator(const std::function<void(MassAggregateSystem* const)>& force_generator) noexcept;
 
+    /*!
+     * @brief Captures the per-particle state and the active integration method. Springs and force generators are
+     * configuration and are not part of the snapshot.
+     *
+     * @details The integrators only ever write the state of the particle they are processing and forces are
+     * accumulated serially in spring order, so stepping a restored system gives bitwise identical results no matter
+     * how many threads the parallel integration runs on.
+     */
+    [[nodiscard]] std::vector<uint8_t> saveSnapshot() const noexcept;
+
+    /*!
+     * @brief Restores a snapshot taken with saveSnapshot() from a system with the same particle count.
+     *
+     * @return True on success. On failure the system is left untouched.
+     */
+    bool restoreSnapshot(const std::vector<uint8_t>& snapshot) noexcept;
+
 protected:
     void integrateExplicitEuler(const real& dt) noexcept;
     void integrateSemiImplicitEuler(const real& dt) noexcept;
@@ -89,6 +114,8 @@ protected:
 
     IntegrationMethod m_active_integration_method{IntegrationMethod::SemiImplicitEuler};
 
+    sputnik::physics::PhysicsStepStats m_last_step_stats;
+
     // a list of springs to apply forces to the particles
     // maybe have a super class called force generators this will be subclassed by springs, winds, etc.
 
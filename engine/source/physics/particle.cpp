@@ -160,6 +160,11 @@ void Particle::getAcceleration(vec3& acceleration) const noexcept
     acceleration = m_acceleration;
 }
 
+const vec3& Particle::getAccumulatedForce() const noexcept
+{
+    return m_accumulated_force;
+}
+
 void Particle::clearAccumulator() noexcept
 {
     m_accumulated_force.clear();
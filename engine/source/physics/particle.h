@@ -120,6 +120,8 @@ public:
      */
     void addForce(const vec3& force) noexcept;
 
+    const vec3& getAccumulatedForce() const noexcept;
+
     void clearAccumulator() noexcept;
 
 protected:
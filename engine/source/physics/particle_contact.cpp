@@ -148,6 +148,11 @@ void ParticleContactResolver::setIterations(const unsigned& iterations) noexcept
     m_iterations = iterations;
 }
 
+const unsigned& ParticleContactResolver::getIterations() const noexcept
+{
+    return m_iterations;
+}
+
 void ParticleContactResolver::resolveContacts(std::vector<std::shared_ptr<ParticleContact>>& contact_array,
                                               const unsigned&                                num_contacts,
                                               const real&                                    duration) noexcept
@@ -99,6 +99,8 @@ public:
      */
     void setIterations(const unsigned& iterations) noexcept;
 
+    const unsigned& getIterations() const noexcept;
+
     /*!
      * @brief Resolves a set of particle contacts for both penetration and velocity.
      *
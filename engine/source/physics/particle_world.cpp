@@ -1,6 +1,7 @@
 #include "pch.h"
 #include "particle_world.h"
 #include "physics_core.h"
+#include "physics_snapshot.h"
 
 namespace sputnik::physics
 {
@@ -40,11 +41,18 @@ void ParticleWorld::startFrame() noexcept
 
 void ParticleWorld::simulatePhysics(real duration) noexcept
 {
+    PhysicsStageTimer timer;
+
     m_force_registry.updateForces(duration);
+    m_last_step_stats.force_seconds = timer.lap();
 
     integrate(duration);
+    m_last_step_stats.integrate_seconds = timer.lap();
+
+    unsigned total_contacts                      = generateContacts();
+    m_last_step_stats.contact_generation_seconds = timer.lap();
+    m_last_step_stats.contact_count              = total_contacts;
 
-    unsigned total_contacts = generateContacts();
     if(total_contacts)
     {
         if(m_calculate_iterations)
@@ -53,6 +61,7 @@ void ParticleWorld::simulatePhysics(real duration) noexcept
         }
         m_contact_resolver.resolveContacts(m_contacts, total_contacts, duration);
     }
+    m_last_step_stats.contact_resolution_seconds = timer.lap();
 }
 
 std::vector<std::shared_ptr<Particle>>& ParticleWorld::getParticles() noexcept
@@ -70,6 +79,86 @@ ParticleForceRegistry& ParticleWorld::getForceRegistry() noexcept
     return m_force_registry;
 }
 
+const PhysicsStepStats& ParticleWorld::getLastStepStats() const noexcept
+{
+    return m_last_step_stats;
+}
+
+std::vector<uint8_t> ParticleWorld::saveSnapshot() const noexcept
+{
+    SnapshotWriter writer(SnapshotType::ParticleWorld);
+
+    writer.write(m_contact_resolver.getIterations());
+
+    writer.write(static_cast<uint64_t>(m_particles.size()));
+    for(const auto& particle : m_particles)
+    {
+        writer.write(particle->getPosition());
+        writer.write(particle->getVelocity());
+        writer.write(particle->getAcceleration());
+        writer.write(particle->getAccumulatedForce());
+        writer.write(particle->getDamping());
+        writer.write(particle->getInverseMass());
+    }
+
+    return writer.release();
+}
+
+bool ParticleWorld::restoreSnapshot(const std::vector<uint8_t>& snapshot) noexcept
+{
+    struct ParticleState
+    {
+        vec3 position;
+        vec3 velocity;
+        vec3 acceleration;
+        vec3 accumulated_force;
+        real damping;
+        real inverse_mass;
+    };
+
+    SnapshotReader reader(snapshot, SnapshotType::ParticleWorld);
+
+    unsigned iterations{0};
+    uint64_t num_particles{0};
+    reader.read(iterations);
+    reader.read(num_particles);
+    if(!reader.isValid() || num_particles != m_particles.size())
+    {
+        return false;
+    }
+
+    // Decode everything first so that a truncated snapshot leaves the world untouched.
+    std::vector<ParticleState> particle_states(m_particles.size());
+    for(auto& state : particle_states)
+    {
+        reader.read(state.position);
+        reader.read(state.velocity);
+        reader.read(state.acceleration);
+        reader.read(state.accumulated_force);
+        reader.read(state.damping);
+        reader.read(state.inverse_mass);
+    }
+    if(!reader.isComplete())
+    {
+        return false;
+    }
+
+    m_contact_resolver.setIterations(iterations);
+    for(size_t i = 0; i < m_particles.size(); ++i)
+    {
+        const auto& state = particle_states[i];
+        m_particles[i]->setPosition(state.position);
+        m_particles[i]->setVelocity(state.velocity);
+        m_particles[i]->setAcceleration(state.acceleration);
+        m_particles[i]->setDamping(state.damping);
+        m_particles[i]->setInverseMass(state.inverse_mass);
+        m_particles[i]->clearAccumulator();
+        m_particles[i]->addForce(state.accumulated_force);
+    }
+
+    return true;
+}
+
 void ParticleWorld::integrate(real duration) noexcept
 {
     for(auto& particle : m_particles)
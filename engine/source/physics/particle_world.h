@@ -2,6 +2,9 @@
 
 #include "particle_force_registry.h"
 #include "particle_contact.h"
+#include "physics_step_stats.h"
+
+#include <cstdint>
 
 namespace sputnik::physics
 {
@@ -53,6 +56,30 @@ public:
      */
     ParticleForceRegistry& getForceRegistry() noexcept;
 
+    /*!
+     * @brief Returns the per stage timings of the last call to simulatePhysics().
+     *
+     * @return The timings of the last step.
+     */
+    const PhysicsStepStats& getLastStepStats() const noexcept;
+
+    /*!
+     * @brief Captures the complete dynamic state of the world: particle state and the contact resolver settings.
+     * Force generators and contact generators are configuration and are not captured.
+     *
+     * @return The snapshot as a compact binary blob.
+     */
+    std::vector<uint8_t> saveSnapshot() const noexcept;
+
+    /*!
+     * @brief Restores a snapshot taken with saveSnapshot(). The world must contain the same particles (in the same
+     * order) as when the snapshot was taken. Stepping the world after a restore reproduces the original run bitwise.
+     *
+     * @param snapshot The snapshot to restore.
+     * @return True on success. On failure the world is left untouched.
+     */
+    bool restoreSnapshot(const std::vector<uint8_t>& snapshot) noexcept;
+
     //void registerParticleForce();
 
 protected:
@@ -107,6 +134,11 @@ protected:
      * True if the physics world should calculate the number of iterations to give the contact resolver at each frame.
      */
     bool m_calculate_iterations;
+
+    /**
+     * Timings of the last simulation step.
+     */
+    PhysicsStepStats m_last_step_stats;
 };
 
 class GroundContactGenerator : public ParticleContactGenerator
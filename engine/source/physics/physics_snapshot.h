@@ -0,0 +1,157 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace sputnik::physics
+{
+
+/*!
+ * @brief Identifies the simulation a snapshot was taken from, so that a snapshot can't be restored into a different
+ * kind of world by accident.
+ */
+enum class SnapshotType : uint32_t
+{
+    ParticleWorld,
+    MassAggregateSystem,
+    RigidBodyWorld
+};
+
+/*!
+ * @brief Compact binary stream of simulation state. Values are stored as raw bytes, i.e. the bit patterns of the floats
+ * are preserved exactly and a restored simulation continues bitwise identically to the original one (given the same
+ * binary and the same inputs). Snapshots are not meant to be portable across builds or platforms.
+ */
+class SnapshotWriter
+{
+public:
+    SnapshotWriter(const SnapshotType& type, const uint32_t& version = 1)
+    {
+        write(kSnapshotMagic);
+        write(type);
+        write(version);
+    }
+
+    template <typename T>
+    void write(const T& value)
+    {
+        static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable types can be written to a snapshot!");
+        const auto* bytes = reinterpret_cast<const uint8_t*>(&value);
+        m_data.insert(m_data.end(), bytes, bytes + sizeof(T));
+    }
+
+    template <typename T>
+    void writeArray(const std::vector<T>& values)
+    {
+        static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable types can be written to a snapshot!");
+        write(static_cast<uint64_t>(values.size()));
+        const auto* bytes = reinterpret_cast<const uint8_t*>(values.data());
+        m_data.insert(m_data.end(), bytes, bytes + values.size() * sizeof(T));
+    }
+
+    void writeArray(const std::vector<bool>& values)
+    {
+        write(static_cast<uint64_t>(values.size()));
+        for(const bool value : values)
+        {
+            write(static_cast<uint8_t>(value ? 1 : 0));
+        }
+    }
+
+    [[nodiscard]] const std::vector<uint8_t>& getData() const noexcept { return m_data; }
+
+    [[nodiscard]] std::vector<uint8_t> release() noexcept { return std::move(m_data); }
+
+    static constexpr uint32_t kSnapshotMagic = 0x50534E53; // "SNSP"
+
+private:
+    std::vector<uint8_t> m_data;
+};
+
+/*!
+ * @brief Reads a snapshot written by SnapshotWriter. Reads past the end of the data, or into an array of a different
+ * size, put the reader into a failed state; callers check isValid() once they are done instead of after every read.
+ */
+class SnapshotReader
+{
+public:
+    SnapshotReader(const std::vector<uint8_t>& data, const SnapshotType& type, const uint32_t& version = 1)
+        : m_data(data.data())
+        , m_size(data.size())
+    {
+        uint32_t     magic{0};
+        SnapshotType stored_type{};
+        uint32_t     stored_version{0};
+        read(magic);
+        read(stored_type);
+        read(stored_version);
+        m_valid = m_valid && magic == SnapshotWriter::kSnapshotMagic && stored_type == type && stored_version == version;
+    }
+
+    template <typename T>
+    void read(T& value)
+    {
+        static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable types can be read from a snapshot!");
+        if(!m_valid || m_offset + sizeof(T) > m_size)
+        {
+            m_valid = false;
+            return;
+        }
+        std::memcpy(&value, m_data + m_offset, sizeof(T));
+        m_offset += sizeof(T);
+    }
+
+    /*!
+     * @brief Reads an array into an existing vector. The stored size must match the size of the vector, snapshots
+     * restore state into a simulation of the same topology and never resize it.
+     */
+    template <typename T>
+    void readArray(std::vector<T>& values)
+    {
+        static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable types can be read from a snapshot!");
+        uint64_t count{0};
+        read(count);
+        if(!m_valid || count != values.size() || m_offset + count * sizeof(T) > m_size)
+        {
+            m_valid = false;
+            return;
+        }
+        std::memcpy(values.data(), m_data + m_offset, count * sizeof(T));
+        m_offset += count * sizeof(T);
+    }
+
+    void readArray(std::vector<bool>& values)
+    {
+        uint64_t count{0};
+        read(count);
+        if(!m_valid || count != values.size())
+        {
+            m_valid = false;
+            return;
+        }
+        for(size_t i = 0; i < count; ++i)
+        {
+            uint8_t value{0};
+            read(value);
+            values[i] = value != 0;
+        }
+    }
+
+    [[nodiscard]] bool isValid() const noexcept { return m_valid; }
+
+    /*!
+     * @brief True if the snapshot was valid and every byte of it was consumed.
+     */
+    [[nodiscard]] bool isComplete() const noexcept { return m_valid && m_offset == m_size; }
+
+private:
+    const uint8_t* m_data{nullptr};
+    size_t         m_size{0};
+    size_t         m_offset{0};
+    bool           m_valid{true};
+};
+
+} // namespace sputnik::physics
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+namespace sputnik::physics
+{
+
+/*!
+ * @brief Wall clock cost of the stages of the most recent simulation step. The worlds fill it in on every step, reading
+ * the clock once per stage, so it's cheap enough to be always on.
+ */
+struct PhysicsStepStats
+{
+    double   force_seconds{0.0};
+    double   integrate_seconds{0.0};
+    double   contact_generation_seconds{0.0};
+    double   contact_resolution_seconds{0.0};
+    double   broadphase_seconds{0.0}; // rebuilding the acceleration structures, zero for worlds without one
+    uint32_t contact_count{0};
+
+    [[nodiscard]] double getTotalSeconds() const noexcept
+    {
+        return force_seconds + integrate_seconds + contact_generation_seconds + contact_resolution_seconds +
+               broadphase_seconds;
+    }
+};
+
+/*!
+ * @brief Splits a step into consecutive stages. Every lap returns the seconds elapsed since the previous lap (or since
+ * construction) and starts the next stage.
+ */
+class PhysicsStageTimer
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    PhysicsStageTimer() noexcept : m_lap_start(Clock::now()) {}
+
+    double lap() noexcept
+    {
+        const Clock::time_point             now     = Clock::now();
+        const std::chrono::duration<double> elapsed = now - m_lap_start;
+        m_lap_start                                 = now;
+        return elapsed.count();
+    }
+
+private:
+    Clock::time_point m_lap_start;
+};
+
+} // namespace sputnik::physics
@@ -49,6 +49,28 @@ void Random::seed(unsigned s)
     p2 = 10;
 }
 
+Random::State Random::getState() const
+{
+    State state;
+    state.p1 = p1;
+    state.p2 = p2;
+    for(unsigned i = 0; i < 17; i++)
+    {
+        state.buffer[i] = buffer[i];
+    }
+    return state;
+}
+
+void Random::setState(const State& state)
+{
+    p1 = state.p1;
+    p2 = state.p2;
+    for(unsigned i = 0; i < 17; i++)
+    {
+        buffer[i] = state.buffer[i];
+    }
+}
+
 unsigned Random::rotl(unsigned n, unsigned r)
 {
     return (n << r) | (n >> (32 - r));
@@ -36,6 +36,18 @@ using namespace ramanujan::experimental;
 class Random
 {
 public:
+    /**
+     * The complete internal state of the stream. Restoring a
+     * previously captured state replays the exact same sequence
+     * of numbers.
+     */
+    struct State
+    {
+        int      p1;
+        int      p2;
+        unsigned buffer[17];
+    };
+
     /**
      * left bitwise rotation
      */
@@ -127,6 +139,16 @@ public:
      */
     //Quaternion randomQuaternion();
 
+    /**
+     * Captures the current state of the stream.
+     */
+    State getState() const;
+
+    /**
+     * Restores a state captured with getState().
+     */
+    void setState(const State& state);
+
 private:
     // Internal mechanics
     int      p1, p2;
@@ -101,7 +101,12 @@ include "demos/physics-mass-aggregate-rope/physics-mass-aggregate-rope.lua"
 include "demos/physics-mass-aggregate-cloth/physics-mass-aggregate-cloth.lua"
 include "demos/physics-mass-aggregate-cube/physics-mass-aggregate-cube.lua"
 include "demos/physics-sandbox/physics-sandbox.lua"
+include "demos/physics-benchmark/physics-benchmark.lua"
 -- include "demos/physics-mass-spring-rope/physics-mass-spring-rope.lua"
 -- include "demos/physics-mass-aggregate-rope/physics-mass-aggregate-rope.lua"
 group ""
 
+group "tools"
+include "demos/mesh-cooker/mesh-cooker.lua"
+group ""
+